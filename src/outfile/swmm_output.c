@@ -16,8 +16,18 @@
 #include <stdlib.h>
 #include <string.h>
 
+#ifdef _WIN32
+  #include <windows.h>
+#else
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+#endif
+
 #include "errormanager.h"
 #include "messages.h"
+#include "shared/outcodec.h"
 
 #include "swmm_output.h"
 
@@ -31,6 +41,7 @@
 #endif
 
 #define INT4 int      // Must be a 4 byte / 32 bit integer type
+#define INT8 long long    // Must be a 8 byte / 64 bit integer type
 #define REAL4 float   // Must be a 4 byte / 32 bit real type
 
 #define RECORDSIZE 4  // Memory alignment 4 byte word size for both int and real
@@ -39,6 +50,11 @@
 #define NELEMENTTYPES 5    // Number of element types
 #define MEMCHECK(x) (((x) == NULL) ? 414 : 0)
 
+#define MAGICNUMBER      516114522    // Begins every output file
+#define CHUNKMAGICNUMBER 516114523    // Ends a file with chunked results
+#define COLUMNAR_LAYOUT  1            // Layout code of columnar results
+#define COMPRESSED_LAYOUT 2           // Layout code of packed columnar results
+
 
 struct IDentry {
     char* IDname;
@@ -77,6 +93,23 @@ typedef struct Handle {
     F_OFF ResultsPos;        // file position where results start
     F_OFF BytesPerPeriod;    // bytes used for results in each period
 
+    int Layout;          // layout code of results (0 = period by period)
+    int ChunkPeriods;    // periods per chunk of columnar results (or 0)
+
+    // --- compressed layout: each chunk's series are packed in blocks
+    int    SeriesPerBlock;    // series packed together in a block
+    F_OFF* chunkPos;          // file position of each chunk (and of the end)
+    INT4*  blockSizes;        // packed size of each block of a chunk
+    int    sizesChunk;        // chunk whose block sizes are loaded (or -1)
+    int    cachedChunk;       // chunk and block whose series are
+    int    cachedBlock;       //   held in blockValues (or -1)
+    float* blockValues;       // unpacked series of a block
+    unsigned char* blockWork;      // work space used for unpacking
+    unsigned char* packedBlock;    // packed block read from file
+
+    char* map;               // read-only memory map of file (or NULL)
+    F_OFF mapSize;           // number of bytes mapped
+
     error_handle_t* error_handle;
 } data_t, *SMO_Handle;
 
@@ -88,11 +121,21 @@ void errorLookup(int errcode, char *errmsg, int length);
 int  validateFile(data_t *p_data);
 void initElementNames(data_t *p_data);
 
-double getTimeValue(data_t *p_data, int timeIndex);
-float  getSubcatchValue(data_t *p_data, int timeIndex, int subcatchIndex, SMO_subcatchAttribute attr);
-float  getNodeValue(data_t *p_data, int timeIndex, int nodeIndex, SMO_nodeAttribute attr);
-float  getLinkValue(data_t *p_data, int timeIndex, int linkIndex, SMO_linkAttribute attr);
-float  getSystemValue(data_t *p_data, int timeIndex, SMO_systemAttribute attr);
+void mapFile(data_t *p_data);
+void unmapFile(data_t *p_data);
+const char *getBlock(data_t *p_data, F_OFF offset, size_t size, char *buffer);
+void readBlock(data_t *p_data, F_OFF offset, void *dest, size_t size);
+
+int    getElementCount(data_t *p_data, SMO_elementType type);
+int    getVarCount(data_t *p_data, SMO_elementType type);
+F_OFF  getValueOffset(data_t *p_data, SMO_elementType type, int index, int attr);
+F_OFF  getValuePos(data_t *p_data, int timeIndex, F_OFF valueOffset);
+float  getValue(data_t *p_data, int timeIndex, F_OFF valueOffset);
+void   getValues(data_t *p_data, int timeIndex, F_OFF valueOffset, int n, float *values);
+void   getSeries(data_t *p_data, F_OFF valueOffset, int startPeriod, int len, float *values);
+int    readChunkIndex(data_t *p_data);
+const float *unpackBlock(data_t *p_data, int chunk, int block, int m);
+void   getPackedRun(data_t *p_data, int timeIndex, F_OFF valueOffset, int n, float *values);
 
 int   _fopen(FILE **f, const char *name, const char *mode);
 int   _fseek(FILE *stream, F_OFF offset, int whence);
@@ -155,9 +198,16 @@ int EXPORT_OUT_API SMO_close(SMO_Handle p_handle)
 
         dst_errormanager(p_data->error_handle);
 
+        unmapFile(p_data);
         if (p_data->file != NULL)
             fclose(p_data->file);
 
+        free(p_data->chunkPos);
+        free(p_data->blockSizes);
+        free(p_data->blockValues);
+        free(p_data->blockWork);
+        free(p_data->packedBlock);
+
         free(p_data);
     }
 
@@ -238,6 +288,10 @@ int EXPORT_OUT_API SMO_open(SMO_Handle p_handle, const char *path)
                  p_data->Nnodes * p_data->NodeVars +
                  p_data->Nlinks * p_data->LinkVars + p_data->SysVars) *
                     RECORDSIZE;
+
+            // --- map the file into memory so that results can be read
+            //     without seeking (file access is used if this fails)
+            mapFile(p_data);
         }
     }
     // If error close the binary file
@@ -479,7 +533,7 @@ int EXPORT_OUT_API SMO_getSubcatchSeries(SMO_Handle p_handle, int subcatchIndex,
 //  start and length using timeIndex and length respectively.
 //
 {
-    int    k, len, errorcode = 0;
+    int    len, errorcode = 0;
     float  *temp;
     data_t *p_data;
 
@@ -497,10 +551,9 @@ int EXPORT_OUT_API SMO_getSubcatchSeries(SMO_Handle p_handle, int subcatchIndex,
         MEMCHECK(temp = newFloatArray(len = endPeriod - startPeriod))
     errorcode = 411;
     else {
-        // loop over and build time series
-        for (k = 0; k < len; k++)
-            temp[k] =
-                getSubcatchValue(p_data, startPeriod + k, subcatchIndex, attr);
+        // read value at same position in each period
+        getSeries(p_data, getValueOffset(p_data, SMO_subcatch, subcatchIndex, attr),
+                  startPeriod, len, temp);
 
         *outValueArray = temp;
         *length         = len;
@@ -517,7 +570,7 @@ int EXPORT_OUT_API SMO_getNodeSeries(SMO_Handle p_handle, int nodeIndex,
 //  start and length using timeIndex and length respectively.
 //
 {
-    int    k, len, errorcode = 0;
+    int    len, errorcode = 0;
     float  *temp;
     data_t *p_data;
 
@@ -535,9 +588,9 @@ int EXPORT_OUT_API SMO_getNodeSeries(SMO_Handle p_handle, int nodeIndex,
         MEMCHECK(temp = newFloatArray(len = endPeriod - startPeriod))
     errorcode = 411;
     else {
-        // loop over and build time series
-        for (k = 0; k < len; k++)
-            temp[k] = getNodeValue(p_data, startPeriod + k, nodeIndex, attr);
+        // read value at same position in each period
+        getSeries(p_data, getValueOffset(p_data, SMO_node, nodeIndex, attr),
+                  startPeriod, len, temp);
 
         *outValueArray = temp;
         *length         = len;
@@ -554,7 +607,7 @@ int EXPORT_OUT_API SMO_getLinkSeries(SMO_Handle p_handle, int linkIndex,
 //  start and length using timeIndex and length respectively.
 //
 {
-    int    k, len, errorcode = 0;
+    int    len, errorcode = 0;
     float  *temp;
     data_t *p_data;
 
@@ -572,9 +625,9 @@ int EXPORT_OUT_API SMO_getLinkSeries(SMO_Handle p_handle, int linkIndex,
         MEMCHECK(temp = newFloatArray(len = endPeriod - startPeriod))
     errorcode = 411;
     else {
-        // loop over and build time series
-        for (k = 0; k < len; k++)
-            temp[k] = getLinkValue(p_data, startPeriod + k, linkIndex, attr);
+        // read value at same position in each period
+        getSeries(p_data, getValueOffset(p_data, SMO_link, linkIndex, attr),
+                  startPeriod, len, temp);
 
         *outValueArray = temp;
         *length         = len;
@@ -590,7 +643,7 @@ int EXPORT_OUT_API SMO_getSystemSeries(SMO_Handle p_handle, SMO_systemAttribute
 //  start and length using timeIndex and length respectively.
 //
 {
-    int    k, len, errorcode = 0;
+    int    len, errorcode = 0;
     float  *temp;
     data_t *p_data;
 
@@ -606,9 +659,9 @@ int EXPORT_OUT_API SMO_getSystemSeries(SMO_Handle p_handle, SMO_systemAttribute
         MEMCHECK(temp = newFloatArray(len = endPeriod - startPeriod))
     errorcode = 411;
     else {
-        // loop over and build time series
-        for (k = 0; k < len; k++)
-            temp[k] = getSystemValue(p_data, startPeriod + k, attr);
+        // read value at same position in each period
+        getSeries(p_data, getValueOffset(p_data, SMO_sys, 0, attr),
+                  startPeriod, len, temp);
 
         *outValueArray = temp;
         *length         = len;
@@ -617,6 +670,109 @@ int EXPORT_OUT_API SMO_getSystemSeries(SMO_Handle p_handle, SMO_systemAttribute
     return set_error(p_data->error_handle, errorcode);
 }
 
+int EXPORT_OUT_API SMO_getElementSeries(SMO_Handle p_handle, SMO_elementType type,
+    int *elementIndexes, int numElements, int *attributes, int numAttributes,
+    int startPeriod, int endPeriod, float **outValueArray, int *length)
+//
+//  Purpose: Get time series results for several attributes of several
+//  elements of the same type in a single pass through the results. Series
+//  are returned one after the other for each attribute of the first
+//  element, then for each attribute of the second element, and so on.
+//
+{
+    int    i, j, k, n, len, count, span = 0, errorcode = 0;
+    float  *temp = NULL;
+    F_OFF  *offsets = NULL;
+    F_OFF  minOffset = 0, maxOffset, offset;
+    char   *buffer = NULL;
+    const char *block;
+    data_t *p_data;
+
+    p_data = (data_t *)p_handle;
+
+    if (p_data == NULL)
+        return -1;
+    n = numElements * numAttributes;
+    count = getElementCount(p_data, type);
+
+    if (count == 0 || numElements <= 0 || numAttributes <= 0)
+        errorcode = 421;
+    else if (startPeriod < 0 || startPeriod >= p_data->Nperiods ||
+             endPeriod <= startPeriod || endPeriod > p_data->Nperiods)
+        errorcode = 422;
+    else {
+        for (i = 0; i < numElements; i++)
+            if (elementIndexes[i] < 0 || elementIndexes[i] >= count)
+                errorcode = 423;
+        for (j = 0; j < numAttributes; j++)
+            if (attributes[j] < 0 || attributes[j] >= getVarCount(p_data, type))
+                errorcode = 421;
+    }
+    if (errorcode == 0) {
+        len = endPeriod - startPeriod;
+        offsets = (F_OFF *)malloc(n * sizeof(F_OFF));
+        temp = newFloatArray(n * len);
+        if (MEMCHECK(offsets) || MEMCHECK(temp))
+            errorcode = 411;
+    }
+    if (errorcode == 0 && p_data->ChunkPeriods > 0) {
+        // --- in columnar layout each series is read chunk by chunk
+        for (i = 0; i < numElements; i++)
+            for (j = 0; j < numAttributes; j++)
+                getSeries(p_data,
+                          getValueOffset(p_data, type, elementIndexes[i],
+                                         attributes[j]),
+                          startPeriod, len,
+                          &temp[(i * numAttributes + j) * len]);
+    }
+    else if (errorcode == 0) {
+        // --- find where each requested value lies within a period
+        minOffset = maxOffset = getValueOffset(p_data, type,
+                                               elementIndexes[0], attributes[0]);
+        for (i = 0; i < numElements; i++) {
+            for (j = 0; j < numAttributes; j++) {
+                offset = getValueOffset(p_data, type, elementIndexes[i],
+                                        attributes[j]);
+                offsets[i * numAttributes + j] = offset;
+                if (offset < minOffset) minOffset = offset;
+                if (offset > maxOffset) maxOffset = offset;
+            }
+        }
+
+        // --- buffer for the span of each period holding requested values
+        //     (not needed when the file is mapped into memory)
+        span = (int)(maxOffset - minOffset) + RECORDSIZE;
+        if (p_data->map == NULL && MEMCHECK(buffer = newCharArray(span)))
+            errorcode = 411;
+    }
+    if (errorcode == 0 && p_data->ChunkPeriods == 0) {
+        // --- pull all requested values from each period in turn
+        offset = p_data->ResultsPos + startPeriod * p_data->BytesPerPeriod +
+                 minOffset;
+        for (k = 0; k < len; k++) {
+            block = getBlock(p_data, offset, span, buffer);
+            for (i = 0; i < n; i++) {
+                if (block == NULL)
+                    temp[i * len + k] = 0.0f;
+                else
+                    memcpy(&temp[i * len + k], block + (offsets[i] - minOffset),
+                           RECORDSIZE);
+            }
+            offset += p_data->BytesPerPeriod;
+        }
+    }
+    if (errorcode == 0) {
+        *outValueArray = temp;
+        *length        = n * len;
+        temp           = NULL;
+    }
+
+    free(temp);
+    free(offsets);
+    free(buffer);
+    return set_error(p_data->error_handle, errorcode);
+}
+
 int EXPORT_OUT_API SMO_getSubcatchAttribute(SMO_Handle p_handle, int periodIndex,
     SMO_subcatchAttribute attr, float **outValueArray, int *length)
 //
@@ -639,7 +795,8 @@ int EXPORT_OUT_API SMO_getSubcatchAttribute(SMO_Handle p_handle, int periodIndex
     else {
         // loop over and pull result
         for (k = 0; k < p_data->Nsubcatch; k++)
-            temp[k] = getSubcatchValue(p_data, periodIndex, k, attr);
+            temp[k] = getValue(p_data, periodIndex,
+                               getValueOffset(p_data, SMO_subcatch, k, attr));
 
         *outValueArray = temp;
         *length        = p_data->Nsubcatch;
@@ -670,7 +827,8 @@ int EXPORT_OUT_API SMO_getNodeAttribute(SMO_Handle p_handle, int periodIndex,
     else {
         // loop over and pull result
         for (k = 0; k < p_data->Nnodes; k++)
-            temp[k] = getNodeValue(p_data, periodIndex, k, attr);
+            temp[k] = getValue(p_data, periodIndex,
+                               getValueOffset(p_data, SMO_node, k, attr));
 
         *outValueArray = temp;
         *length        = p_data->Nnodes;
@@ -701,7 +859,8 @@ int EXPORT_OUT_API SMO_getLinkAttribute(SMO_Handle p_handle, int periodIndex,
     else {
         // loop over and pull result
         for (k = 0; k < p_data->Nlinks; k++)
-            temp[k] = getLinkValue(p_data, periodIndex, k, attr);
+            temp[k] = getValue(p_data, periodIndex,
+                               getValueOffset(p_data, SMO_link, k, attr));
 
         *outValueArray = temp;
         *length        = p_data->Nlinks;
@@ -730,7 +889,8 @@ int EXPORT_OUT_API SMO_getSystemAttribute(SMO_Handle p_handle, int periodIndex,
         MEMCHECK(temp = newFloatArray(1)) errorcode = 411;
     else {
         // don't need to loop since there's only one system
-        temp[0] = getSystemValue(p_data, periodIndex, attr);
+        temp[0] = getValue(p_data, periodIndex,
+                           getValueOffset(p_data, SMO_sys, 0, attr));
 
         *outValueArray = temp;
         *length        = 1;
@@ -747,7 +907,6 @@ int EXPORT_OUT_API SMO_getSubcatchResult(SMO_Handle p_handle, int periodIndex,
 {
     int    errorcode = 0;
     float  *temp;
-    F_OFF  offset;
     data_t *p_data;
 
     p_data = (data_t *)p_handle;
@@ -761,14 +920,9 @@ int EXPORT_OUT_API SMO_getSubcatchResult(SMO_Handle p_handle, int periodIndex,
     else if
         MEMCHECK(temp = newFloatArray(p_data->SubcatchVars)) errorcode = 411;
     else {
-        // --- compute offset into output file
-        offset = p_data->ResultsPos + (periodIndex)*p_data->BytesPerPeriod +
-                 2 * RECORDSIZE;
-        // add offset for subcatchment
-        offset += (subcatchIndex * p_data->SubcatchVars) * RECORDSIZE;
-
-        _fseek(p_data->file, offset, SEEK_SET);
-        fread(temp, RECORDSIZE, p_data->SubcatchVars, p_data->file);
+        getValues(p_data, periodIndex,
+                  getValueOffset(p_data, SMO_subcatch, subcatchIndex, 0),
+                  p_data->SubcatchVars, temp);
 
         *outValueArray = temp;
         *arrayLength   = p_data->SubcatchVars;
@@ -785,7 +939,6 @@ int EXPORT_OUT_API SMO_getNodeResult(SMO_Handle p_handle, int periodIndex,
 {
     int    errorcode = 0;
     float  *temp;
-    F_OFF  offset;
     data_t *p_data;
 
     p_data = (data_t *)p_handle;
@@ -799,16 +952,9 @@ int EXPORT_OUT_API SMO_getNodeResult(SMO_Handle p_handle, int periodIndex,
     else if
         MEMCHECK(temp = newFloatArray(p_data->NodeVars)) errorcode = 411;
     else {
-        // calculate byte offset to start time for series
-        offset = p_data->ResultsPos + (periodIndex)*p_data->BytesPerPeriod +
-                 2 * RECORDSIZE;
-        // add offset for subcatchment and node
-        offset += (p_data->Nsubcatch * p_data->SubcatchVars +
-                   nodeIndex * p_data->NodeVars) *
-                  RECORDSIZE;
-
-        _fseek(p_data->file, offset, SEEK_SET);
-        fread(temp, RECORDSIZE, p_data->NodeVars, p_data->file);
+        getValues(p_data, periodIndex,
+                  getValueOffset(p_data, SMO_node, nodeIndex, 0),
+                  p_data->NodeVars, temp);
 
         *outValueArray = temp;
         *arrayLength   = p_data->NodeVars;
@@ -825,7 +971,6 @@ int EXPORT_OUT_API SMO_getLinkResult(SMO_Handle p_handle, int periodIndex,
 {
     int    errorcode = 0;
     float  *temp;
-    F_OFF  offset;
     data_t *p_data;
 
     p_data = (data_t *)p_handle;
@@ -839,17 +984,9 @@ int EXPORT_OUT_API SMO_getLinkResult(SMO_Handle p_handle, int periodIndex,
     else if
         MEMCHECK(temp = newFloatArray(p_data->LinkVars)) errorcode = 411;
     else {
-        // calculate byte offset to start time for series
-        offset = p_data->ResultsPos + (periodIndex)*p_data->BytesPerPeriod +
-                 2 * RECORDSIZE;
-        // add offset for subcatchment and node and link
-        offset +=
-            (p_data->Nsubcatch * p_data->SubcatchVars +
-             p_data->Nnodes * p_data->NodeVars + linkIndex * p_data->LinkVars) *
-            RECORDSIZE;
-
-        _fseek(p_data->file, offset, SEEK_SET);
-        fread(temp, RECORDSIZE, p_data->LinkVars, p_data->file);
+        getValues(p_data, periodIndex,
+                  getValueOffset(p_data, SMO_link, linkIndex, 0),
+                  p_data->LinkVars, temp);
 
         *outValueArray = temp;
         *arrayLength   = p_data->LinkVars;
@@ -866,7 +1003,6 @@ int EXPORT_OUT_API SMO_getSystemResult(SMO_Handle p_handle, int periodIndex,
 {
     int    errorcode = 0;
     float  *temp;
-    F_OFF  offset;
     data_t *p_data;
 
     p_data = (data_t *)p_handle;
@@ -878,18 +1014,9 @@ int EXPORT_OUT_API SMO_getSystemResult(SMO_Handle p_handle, int periodIndex,
     else if
         MEMCHECK(temp = newFloatArray(p_data->SysVars)) errorcode = 411;
     {
-        // calculate byte offset to start time for series
-        offset = p_data->ResultsPos + (periodIndex)*p_data->BytesPerPeriod +
-                 2 * RECORDSIZE;
-        // add offset for subcatchment and node and link (system starts after
-        // the last link)
-        offset += (p_data->Nsubcatch * p_data->SubcatchVars +
-                   p_data->Nnodes * p_data->NodeVars +
-                   p_data->Nlinks * p_data->LinkVars) *
-                  RECORDSIZE;
-
-        _fseek(p_data->file, offset, SEEK_SET);
-        fread(temp, RECORDSIZE, p_data->SysVars, p_data->file);
+        getValues(p_data, periodIndex,
+                  getValueOffset(p_data, SMO_sys, 0, 0),
+                  p_data->SysVars, temp);
 
         *outValueArray = temp;
         *arrayLength   = p_data->SysVars;
@@ -993,6 +1120,30 @@ int validateFile(data_t *p_data) {
     _fseek(p_data->file, 0L, SEEK_SET);
     fread(&magic1, RECORDSIZE, 1, p_data->file);
 
+    // --- chunked results are followed by their layout code & chunk size
+    p_data->Layout       = 0;
+    p_data->ChunkPeriods = 0;
+    p_data->sizesChunk   = -1;
+    p_data->cachedChunk  = -1;
+    p_data->cachedBlock  = -1;
+    if (magic1 == MAGICNUMBER && magic2 == CHUNKMAGICNUMBER) {
+        _fseek(p_data->file, -9 * RECORDSIZE, SEEK_END);
+        fread(&(p_data->SeriesPerBlock), RECORDSIZE, 1, p_data->file);
+        fread(&(p_data->Layout), RECORDSIZE, 1, p_data->file);
+        fread(&(p_data->ChunkPeriods), RECORDSIZE, 1, p_data->file);
+        magic2 = magic1;
+        if (p_data->ChunkPeriods <= 0)
+            magic2 = 0;
+        else if (p_data->Layout == COMPRESSED_LAYOUT) {
+            if (p_data->SeriesPerBlock <= 0 || p_data->Nperiods <= 0)
+                magic2 = 0;
+            else if ((errorcode = readChunkIndex(p_data)) != 0)
+                return errorcode;
+        }
+        else if (p_data->Layout != COLUMNAR_LAYOUT)
+            magic2 = 0;
+    }
+
     // Is this a valid SWMM binary output file?
     if (magic1 != magic2)
         errorcode = 435;
@@ -1029,99 +1180,373 @@ void initElementNames(data_t *p_data) {
     }
 }
 
-double getTimeValue(data_t *p_data, int timeIndex) {
-
-    F_OFF  offset;
-    double value;
+void mapFile(data_t *p_data)
+//
+//  Purpose: Maps the output file into memory for reading.
+//
+{
+    F_OFF size;
 
-    // --- compute offset into output file
-    offset = p_data->ResultsPos + timeIndex * p_data->BytesPerPeriod;
+    _fseek(p_data->file, 0, SEEK_END);
+    size = _ftell(p_data->file);
+    if (size <= 0 || (unsigned long long)size > (size_t)-1)
+        return;
 
-    // --- re-position the file and read the result
-    _fseek(p_data->file, offset, SEEK_SET);
-    fread(&value, RECORDSIZE * 2, 1, p_data->file);
+#ifdef _WIN32
+    {
+        HANDLE file, mapping;
+
+        file = CreateFileA(p_data->name, GENERIC_READ, FILE_SHARE_READ, NULL,
+                           OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+        if (file == INVALID_HANDLE_VALUE)
+            return;
+        mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (mapping != NULL) {
+            p_data->map = (char *)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+            CloseHandle(mapping);
+        }
+        CloseHandle(file);
+    }
+#else
+    {
+        int   fd;
+        void *view;
+
+        fd = open(p_data->name, O_RDONLY);
+        if (fd < 0)
+            return;
+        view = mmap(NULL, (size_t)size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (view != MAP_FAILED)
+            p_data->map = (char *)view;
+    }
+#endif
 
-    return value;
+    if (p_data->map != NULL)
+        p_data->mapSize = size;
 }
 
-float getSubcatchValue(data_t *p_data, int timeIndex, int subcatchIndex,
-    SMO_subcatchAttribute attr) {
+void unmapFile(data_t *p_data)
+//
+//  Purpose: Releases the memory map of the output file.
+//
+{
+    if (p_data->map == NULL)
+        return;
+#ifdef _WIN32
+    UnmapViewOfFile(p_data->map);
+#else
+    munmap(p_data->map, (size_t)p_data->mapSize);
+#endif
+    p_data->map     = NULL;
+    p_data->mapSize = 0;
+}
 
-    F_OFF offset;
-    float value;
+const char *getBlock(data_t *p_data, F_OFF offset, size_t size, char *buffer)
+//
+//  Purpose: Returns a pointer to size bytes of the file starting at offset.
+//  This points into the memory map if there is one, otherwise the bytes are
+//  read into buffer. Returns NULL if the bytes cannot be read.
+//
+{
+    if (p_data->map != NULL) {
+        if (offset < 0 || offset + (F_OFF)size > p_data->mapSize)
+            return NULL;
+        return p_data->map + offset;
+    }
+    _fseek(p_data->file, offset, SEEK_SET);
+    if (fread(buffer, 1, size, p_data->file) != size)
+        return NULL;
+    return buffer;
+}
 
-    // --- compute offset into output file
-    offset = p_data->ResultsPos + timeIndex * p_data->BytesPerPeriod +
-             2 * RECORDSIZE;
-    // offset for subcatch
-    offset += RECORDSIZE * (subcatchIndex * p_data->SubcatchVars + attr);
+void readBlock(data_t *p_data, F_OFF offset, void *dest, size_t size)
+//
+//  Purpose: Copies size bytes of the file starting at offset into dest.
+//
+{
+    const char *block = getBlock(p_data, offset, size, (char *)dest);
 
-    // --- re-position the file and read the result
-    _fseek(p_data->file, offset, SEEK_SET);
-    fread(&value, RECORDSIZE, 1, p_data->file);
+    if (block == NULL)
+        memset(dest, 0, size);
+    else if (block != (char *)dest)
+        memcpy(dest, block, size);
+}
 
-    return value;
+int getElementCount(data_t *p_data, SMO_elementType type)
+//
+//  Purpose: Returns number of elements of a type with reported results.
+//
+{
+    switch (type) {
+        case SMO_subcatch: return p_data->Nsubcatch;
+        case SMO_node:     return p_data->Nnodes;
+        case SMO_link:     return p_data->Nlinks;
+        case SMO_sys:      return 1;
+        default:           return 0;
+    }
 }
 
-float getNodeValue(data_t *p_data, int timeIndex, int nodeIndex,
-    SMO_nodeAttribute attr) {
+int getVarCount(data_t *p_data, SMO_elementType type)
+//
+//  Purpose: Returns number of reported variables for a type of element.
+//
+{
+    switch (type) {
+        case SMO_subcatch: return p_data->SubcatchVars;
+        case SMO_node:     return p_data->NodeVars;
+        case SMO_link:     return p_data->LinkVars;
+        case SMO_sys:      return p_data->SysVars;
+        default:           return 0;
+    }
+}
 
-    F_OFF offset;
-    float value;
+F_OFF getValueOffset(data_t *p_data, SMO_elementType type, int index, int attr)
+//
+//  Purpose: Returns byte offset of an element's attribute value from the
+//  start of a reporting period's results.
+//
+{
+    F_OFF offset = 2 * RECORDSIZE;    // skip period's date
+
+    switch (type) {
+        case SMO_sys:
+            offset += (F_OFF)p_data->Nlinks * p_data->LinkVars * RECORDSIZE;
+            index = 0;
+            // fall through
+        case SMO_link:
+            offset += (F_OFF)p_data->Nnodes * p_data->NodeVars * RECORDSIZE;
+            // fall through
+        case SMO_node:
+            offset += (F_OFF)p_data->Nsubcatch * p_data->SubcatchVars * RECORDSIZE;
+            // fall through
+        default:
+            break;
+    }
+    offset += ((F_OFF)index * getVarCount(p_data, type) + attr) * RECORDSIZE;
+    return offset;
+}
 
-    // --- compute offset into output file
-    offset = p_data->ResultsPos + timeIndex * p_data->BytesPerPeriod +
-             2 * RECORDSIZE;
-    // offset for node
-    offset += RECORDSIZE * (p_data->Nsubcatch * p_data->SubcatchVars +
-                            nodeIndex * p_data->NodeVars + attr);
+F_OFF getValuePos(data_t *p_data, int timeIndex, F_OFF valueOffset)
+//
+//  Purpose: Returns file position of the value at a given offset within a
+//  period's results. In columnar layout a chunk of periods holds their dates
+//  followed by the series of each value over the chunk.
+//
+{
+    int   i, n;
+    F_OFF first, slot;
+
+    if (p_data->ChunkPeriods == 0)
+        return p_data->ResultsPos + timeIndex * p_data->BytesPerPeriod +
+               valueOffset;
+
+    // --- only the last chunk can hold fewer than ChunkPeriods periods
+    i     = timeIndex % p_data->ChunkPeriods;
+    first = timeIndex - i;
+    n     = p_data->ChunkPeriods;
+    if (p_data->Nperiods - first < n)
+        n = (int)(p_data->Nperiods - first);
+    slot = (valueOffset - DATESIZE) / RECORDSIZE;
+    return p_data->ResultsPos + first * p_data->BytesPerPeriod +
+           (F_OFF)n * DATESIZE + (slot * n + i) * RECORDSIZE;
+}
 
-    // --- re-position the file and read the result
-    _fseek(p_data->file, offset, SEEK_SET);
-    fread(&value, RECORDSIZE, 1, p_data->file);
+float getValue(data_t *p_data, int timeIndex, F_OFF valueOffset)
+//
+//  Purpose: Returns the value at a given offset within a period's results.
+//
+{
+    float value;
 
+    if (p_data->Layout == COMPRESSED_LAYOUT)
+        getPackedRun(p_data, timeIndex, valueOffset, 1, &value);
+    else
+        readBlock(p_data, getValuePos(p_data, timeIndex, valueOffset), &value,
+                  RECORDSIZE);
     return value;
 }
 
-float getLinkValue(data_t *p_data, int timeIndex, int linkIndex,
-    SMO_linkAttribute attr) {
+void getValues(data_t *p_data, int timeIndex, F_OFF valueOffset, int n,
+    float *values)
+//
+//  Purpose: Reads n consecutive values starting at a given offset within a
+//  period's results.
+//
+{
+    int k;
+
+    if (p_data->ChunkPeriods == 0)
+        readBlock(p_data, getValuePos(p_data, timeIndex, valueOffset), values,
+                  n * RECORDSIZE);
+    else
+        for (k = 0; k < n; k++)
+            values[k] = getValue(p_data, timeIndex,
+                                 valueOffset + k * RECORDSIZE);
+}
 
+void getSeries(data_t *p_data, F_OFF valueOffset, int startPeriod, int len,
+    float *values)
+//
+//  Purpose: Reads the value at a given offset within each of len successive
+//  periods' results.
+//
+{
+    int   k, run;
     F_OFF offset;
-    float value;
 
-    // --- compute offset into output file
-    offset = p_data->ResultsPos + timeIndex * p_data->BytesPerPeriod +
-             2 * RECORDSIZE;
-    // offset for link
-    offset += RECORDSIZE * (p_data->Nsubcatch * p_data->SubcatchVars +
-                            p_data->Nnodes * p_data->NodeVars +
-                            linkIndex * p_data->LinkVars + attr);
-
-    // --- re-position the file and read the result
-    _fseek(p_data->file, offset, SEEK_SET);
-    fread(&value, RECORDSIZE, 1, p_data->file);
+    // --- in columnar layout the values within each chunk are contiguous
+    if (p_data->ChunkPeriods > 0) {
+        for (k = 0; k < len; k += run) {
+            run = p_data->ChunkPeriods - (startPeriod + k) % p_data->ChunkPeriods;
+            if (run > len - k)
+                run = len - k;
+            if (p_data->Layout == COMPRESSED_LAYOUT)
+                getPackedRun(p_data, startPeriod + k, valueOffset, run,
+                             &values[k]);
+            else
+                readBlock(p_data,
+                          getValuePos(p_data, startPeriod + k, valueOffset),
+                          &values[k], run * RECORDSIZE);
+        }
+        return;
+    }
 
-    return value;
+    offset = p_data->ResultsPos + startPeriod * p_data->BytesPerPeriod +
+             valueOffset;
+    for (k = 0; k < len; k++) {
+        readBlock(p_data, offset, &values[k], RECORDSIZE);
+        offset += p_data->BytesPerPeriod;
+    }
 }
 
-float getSystemValue(data_t *p_data, int timeIndex, SMO_systemAttribute attr) {
+int readChunkIndex(data_t *p_data)
+//
+//  Purpose: Reads the file position of each chunk of compressed results,
+//  which are listed just before the block size, layout code and chunk size.
+//
+{
+    int   k, n;
+    INT8  pos;
+    F_OFF end;
+
+    n = (int)((p_data->Nperiods + p_data->ChunkPeriods - 1) /
+              p_data->ChunkPeriods);
+    p_data->chunkPos = (F_OFF *)malloc((n + 1) * sizeof(F_OFF));
+    if (MEMCHECK(p_data->chunkPos))
+        return 411;
+
+    end = _ftell(p_data->file) - 3 * RECORDSIZE;
+    _fseek(p_data->file, end - (F_OFF)(n + 1) * sizeof(INT8), SEEK_SET);
+    for (k = 0; k <= n; k++) {
+        if (fread(&pos, sizeof(INT8), 1, p_data->file) != 1)
+            return 435;
+        p_data->chunkPos[k] = (F_OFF)pos;
+        if (k > 0 && p_data->chunkPos[k] < p_data->chunkPos[k - 1])
+            return 435;
+    }
+    return 0;
+}
 
-    F_OFF offset;
-    float value;
+const float *unpackBlock(data_t *p_data, int chunk, int block, int m)
+//
+//  Purpose: Returns the unpacked series of a block of a compressed chunk of
+//  m periods, or NULL if they cannot be read. The most recent block is kept
+//  so that successive reads from it don't unpack it again.
+//
+{
+    int   b, nSlots, nBlocks, nSeries;
+    size_t maxSize, maxValues;
+    INT4  size;
+    F_OFF pos;
+    const char *packed;
+
+    if (chunk == p_data->cachedChunk && block == p_data->cachedBlock)
+        return p_data->blockValues;
+    p_data->cachedChunk = -1;
+
+    nSlots  = (int)((p_data->BytesPerPeriod - DATESIZE) / RECORDSIZE);
+    nBlocks = (nSlots + p_data->SeriesPerBlock - 1) / p_data->SeriesPerBlock;
+    nSeries = nSlots - block * p_data->SeriesPerBlock;
+    if (nSeries > p_data->SeriesPerBlock)
+        nSeries = p_data->SeriesPerBlock;
+
+    // --- allocate buffers for the largest block on first use
+    maxValues = (size_t)p_data->SeriesPerBlock * p_data->ChunkPeriods;
+    maxSize   = outcodec_bound(maxValues);
+    if (p_data->blockValues == NULL) {
+        p_data->blockSizes  = (INT4 *)calloc(nBlocks, sizeof(INT4));
+        p_data->blockValues = (float *)malloc(maxValues * sizeof(float));
+        p_data->blockWork   = (unsigned char *)malloc(maxValues * RECORDSIZE);
+        p_data->packedBlock = (unsigned char *)malloc(maxSize);
+        if (!p_data->blockSizes || !p_data->blockValues ||
+            !p_data->blockWork || !p_data->packedBlock) {
+            free(p_data->blockSizes);
+            free(p_data->blockValues);
+            free(p_data->blockWork);
+            free(p_data->packedBlock);
+            p_data->blockSizes  = NULL;
+            p_data->blockValues = NULL;
+            p_data->blockWork   = NULL;
+            p_data->packedBlock = NULL;
+            return NULL;
+        }
+    }
 
-    // --- compute offset into output file
-    offset = p_data->ResultsPos + timeIndex * p_data->BytesPerPeriod +
-             2 * RECORDSIZE;
-    //  offset for system
-    offset += RECORDSIZE * (p_data->Nsubcatch * p_data->SubcatchVars +
-                            p_data->Nnodes * p_data->NodeVars +
-                            p_data->Nlinks * p_data->LinkVars + attr);
+    // --- the packed size of each block ends the chunk
+    if (chunk != p_data->sizesChunk) {
+        p_data->sizesChunk = -1;
+        pos = p_data->chunkPos[chunk + 1] - (F_OFF)nBlocks * RECORDSIZE;
+        readBlock(p_data, pos, p_data->blockSizes, nBlocks * RECORDSIZE);
+        p_data->sizesChunk = chunk;
+    }
 
-    // --- re-position the file and read the result
-    _fseek(p_data->file, offset, SEEK_SET);
-    fread(&value, RECORDSIZE, 1, p_data->file);
+    // --- the chunk's dates are followed by its packed blocks
+    pos = p_data->chunkPos[chunk] + (F_OFF)m * DATESIZE;
+    for (b = 0; b < block; b++)
+        pos += p_data->blockSizes[b];
+    size = p_data->blockSizes[block];
+    if (size <= 0 || (size_t)size > maxSize)
+        return NULL;
+    packed = getBlock(p_data, pos, size, (char *)p_data->packedBlock);
+    if (packed == NULL ||
+        outcodec_unpack((const unsigned char *)packed, size, nSeries, m,
+                        p_data->blockWork, p_data->blockValues) < 0)
+        return NULL;
+
+    p_data->cachedChunk = chunk;
+    p_data->cachedBlock = block;
+    return p_data->blockValues;
+}
 
-    return value;
+void getPackedRun(data_t *p_data, int timeIndex, F_OFF valueOffset, int n,
+    float *values)
+//
+//  Purpose: Reads the value at a given offset within each of n successive
+//  periods' compressed results, all of which lie in the same chunk.
+//
+{
+    int   i, m, chunk, block;
+    F_OFF first, slot;
+    const float *series;
+
+    // --- only the last chunk can hold fewer than ChunkPeriods periods
+    i     = timeIndex % p_data->ChunkPeriods;
+    chunk = timeIndex / p_data->ChunkPeriods;
+    first = timeIndex - i;
+    m     = p_data->ChunkPeriods;
+    if (p_data->Nperiods - first < m)
+        m = (int)(p_data->Nperiods - first);
+
+    slot   = (valueOffset - DATESIZE) / RECORDSIZE;
+    block  = (int)(slot / p_data->SeriesPerBlock);
+    series = unpackBlock(p_data, chunk, block, m);
+    if (series == NULL)
+        memset(values, 0, n * RECORDSIZE);
+    else
+        memcpy(values,
+               series + (slot - (F_OFF)block * p_data->SeriesPerBlock) * m + i,
+               n * RECORDSIZE);
 }
 
 int _fopen(FILE **f, const char *name, const char *mode) {
@@ -0,0 +1,227 @@
+/*
+ *  shared/outcodec.c - Lossless codec for blocks of binary output results
+ *
+ *  Created on: Oct 15, 2026
+ *
+ *  The LZ77 stream is a series of sequences, each made up of a token byte
+ *  (number of literals in the high nibble, match length less MIN_MATCH in
+ *  the low nibble), extra literal length bytes, the literals, a 2 byte
+ *  little endian match offset and extra match length bytes. A nibble of
+ *  15 is followed by extra length bytes, each adding its value and a
+ *  byte of 255 continuing the count. The final sequence has no match.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "outcodec.h"
+
+
+#define MIN_MATCH  4
+#define MAX_OFFSET 65535
+#define HASH_BITS  14
+
+
+static unsigned int read32(const unsigned char *p)
+{
+    unsigned int v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+
+static unsigned int hash32(unsigned int v)
+{
+    return (v * 2654435761u) >> (32 - HASH_BITS);
+}
+
+
+static size_t putLength(unsigned char *dst, size_t op, size_t len)
+// Writes the extra bytes of a length that didn't fit in its nibble
+{
+    for (len -= 15; len >= 255; len -= 255)
+        dst[op++] = 255;
+    dst[op++] = (unsigned char)len;
+    return op;
+}
+
+
+static size_t putSequence(unsigned char *dst, size_t op,
+                          const unsigned char *lit, size_t nLit,
+                          size_t offset, size_t matchLen)
+// Writes a sequence of literals followed by a match (if matchLen > 0)
+{
+    size_t m = matchLen > 0 ? matchLen - MIN_MATCH : 0;
+
+    dst[op++] = (unsigned char)(((nLit < 15 ? nLit : 15) << 4) |
+                                (m < 15 ? m : 15));
+    if (nLit >= 15)
+        op = putLength(dst, op, nLit);
+    memcpy(dst + op, lit, nLit);
+    op += nLit;
+    if (matchLen > 0) {
+        dst[op++] = (unsigned char)(offset & 0xFF);
+        dst[op++] = (unsigned char)(offset >> 8);
+        if (m >= 15)
+            op = putLength(dst, op, m);
+    }
+    return op;
+}
+
+
+static size_t lzCompress(const unsigned char *src, size_t n,
+                         unsigned char *dst)
+// Compresses n bytes of src into dst, returning the compressed size
+// (or 0 if out of memory)
+{
+    size_t ip = 0, anchor = 0, op = 0, ref, len;
+    unsigned int h;
+    size_t *table = (size_t *)calloc((size_t)1 << HASH_BITS, sizeof(size_t));
+
+    if (table == NULL)
+        return 0;
+
+    while (ip + MIN_MATCH <= n) {
+        h = hash32(read32(src + ip));
+        ref = table[h];
+        table[h] = ip + 1;
+
+        // --- look for a match at the last position with the same hash
+        if (ref > 0 && ip - (ref - 1) <= MAX_OFFSET &&
+            read32(src + ref - 1) == read32(src + ip)) {
+            ref--;
+            len = MIN_MATCH;
+            while (ip + len < n && src[ref + len] == src[ip + len])
+                len++;
+            op = putSequence(dst, op, src + anchor, ip - anchor, ip - ref, len);
+            ip += len;
+            anchor = ip;
+        }
+
+        // --- skip ahead faster the longer no match is found
+        else
+            ip += 1 + ((ip - anchor) >> 6);
+    }
+    op = putSequence(dst, op, src + anchor, n - anchor, 0, 0);
+    free(table);
+    return op;
+}
+
+
+static int getLength(const unsigned char *src, size_t size, size_t *ip,
+                     size_t *len)
+// Reads the extra bytes of a length, returning -1 if past end of src
+{
+    unsigned char b;
+
+    do {
+        if (*ip >= size)
+            return -1;
+        b = src[(*ip)++];
+        *len += b;
+    } while (b == 255);
+    return 0;
+}
+
+
+static int lzDecompress(const unsigned char *src, size_t size,
+                        unsigned char *dst, size_t n)
+// Decompresses src into exactly n bytes of dst, returning 0 on success
+// or -1 if src is corrupt
+{
+    size_t ip = 0, op = 0, nLit, len, offset;
+    unsigned char token;
+
+    for (;;) {
+        if (ip >= size)
+            return -1;
+        token = src[ip++];
+
+        // --- copy literals
+        nLit = token >> 4;
+        if (nLit == 15 && getLength(src, size, &ip, &nLit) < 0)
+            return -1;
+        if (nLit > size - ip || nLit > n - op)
+            return -1;
+        memcpy(dst + op, src + ip, nLit);
+        ip += nLit;
+        op += nLit;
+        if (op == n)
+            return ip == size ? 0 : -1;
+
+        // --- copy match (which may overlap the bytes it produces)
+        if (size - ip < 2)
+            return -1;
+        offset = src[ip] | ((size_t)src[ip + 1] << 8);
+        ip += 2;
+        len = token & 0x0F;
+        if (len == 15 && getLength(src, size, &ip, &len) < 0)
+            return -1;
+        len += MIN_MATCH;
+        if (offset == 0 || offset > op || len > n - op)
+            return -1;
+        for (; len > 0; len--, op++)
+            dst[op] = dst[op - offset];
+    }
+}
+
+
+size_t outcodec_bound(size_t nValues)
+//
+//  Returns the largest number of bytes that nValues values can pack into.
+//
+{
+    size_t n = 4 * nValues;
+    return n + n / 255 + 16;
+}
+
+
+size_t outcodec_pack(const float *series, size_t nSeries, size_t len,
+                     unsigned char *work, unsigned char *packed)
+//
+//  Packs nSeries series of len values each (stored one after the other)
+//  into packed (of at least outcodec_bound(nSeries * len) bytes) using
+//  work (of at least 4 * nSeries * len bytes). Returns the packed size,
+//  or 0 if out of memory.
+//
+{
+    size_t i, k, n = nSeries * len;
+    unsigned int u, d, prev = 0;
+
+    for (k = 0; k < n; k++) {
+        if (k % len == 0)
+            prev = 0;
+        memcpy(&u, &series[k], sizeof(u));
+        d    = u - prev;
+        prev = u;
+        for (i = 0; i < 4; i++)
+            work[i * n + k] = (unsigned char)(d >> (8 * i));
+    }
+    return lzCompress(work, 4 * n, packed);
+}
+
+
+int outcodec_unpack(const unsigned char *packed, size_t packedSize,
+                    size_t nSeries, size_t len, unsigned char *work,
+                    float *series)
+//
+//  Unpacks nSeries series of len values each from packed using work (of
+//  at least 4 * nSeries * len bytes). Returns 0 on success or -1 if the
+//  packed data are corrupt.
+//
+{
+    size_t k, n = nSeries * len;
+    unsigned int u = 0;
+
+    if (lzDecompress(packed, packedSize, work, 4 * n) < 0)
+        return -1;
+    for (k = 0; k < n; k++) {
+        if (k % len == 0)
+            u = 0;
+        u += (unsigned int)work[k] | ((unsigned int)work[n + k] << 8) |
+             ((unsigned int)work[2 * n + k] << 16) |
+             ((unsigned int)work[3 * n + k] << 24);
+        memcpy(&series[k], &u, sizeof(u));
+    }
+    return 0;
+}
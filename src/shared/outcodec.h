@@ -0,0 +1,40 @@
+/*
+ *  shared/outcodec.h - Lossless codec for blocks of binary output results
+ *
+ *  Created on: Oct 15, 2026
+ *
+ *  A block holds several series of 4 byte floating point values, each of
+ *  the same length. It is packed by replacing each value's bit pattern by
+ *  its difference from the previous value in the series, regrouping the
+ *  bytes so that the n-th bytes of all values are stored together and
+ *  compressing the result with a byte oriented LZ77 coder.
+ */
+
+#ifndef OUTCODEC_H_
+#define OUTCODEC_H_
+
+
+#include <stddef.h>
+
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+
+size_t outcodec_bound(size_t nValues);
+
+size_t outcodec_pack(const float *series, size_t nSeries, size_t len,
+                     unsigned char *work, unsigned char *packed);
+
+int outcodec_unpack(const unsigned char *packed, size_t packedSize,
+                    size_t nSeries, size_t len, unsigned char *work,
+                    float *series);
+
+
+#if defined(__cplusplus)
+}
+#endif
+
+
+#endif /* OUTCODEC_H_ */
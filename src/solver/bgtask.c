@@ -0,0 +1,206 @@
+//-----------------------------------------------------------------------------
+//   bgtask.c
+//
+//   Project:  EPA SWMM5
+//   Version:  5.2
+//   Date:     10/16/26 (Build 5.2.4+)
+//
+//   Runs tasks one at a time on a background thread.
+//
+//   The runner holds at most one task. The calling thread waits for the
+//   runner to become idle before handing it a new task, and the runner's
+//   thread waits for a task (or a request to quit) when it is idle.
+//-----------------------------------------------------------------------------
+
+#include <stdlib.h>
+#include "bgtask.h"
+
+#ifdef _WIN32
+  #include <windows.h>
+#else
+  #include <pthread.h>
+#endif
+
+struct TBgTask
+{
+#ifdef _WIN32
+    HANDLE             thread;
+    CRITICAL_SECTION   lock;
+    CONDITION_VARIABLE changed;        // signals a change of task or quit
+#else
+    pthread_t          thread;
+    pthread_mutex_t    lock;
+    pthread_cond_t     changed;        // signals a change of task or quit
+#endif
+    void (*task)(void*);               // task being run (NULL if idle)
+    void*  arg;                        // argument passed to task
+    int    quit;                       // TRUE if thread should exit
+};
+
+//-----------------------------------------------------------------------------
+//  Local functions
+//-----------------------------------------------------------------------------
+static void lock(TBgTask* runner);
+static void unlock(TBgTask* runner);
+static void waitForChange(TBgTask* runner);
+static void signalChange(TBgTask* runner);
+
+#ifdef _WIN32
+static DWORD WINAPI runTasks(LPVOID p);
+#else
+static void* runTasks(void* p);
+#endif
+
+//=============================================================================
+
+TBgTask* bgtask_create()
+//
+//  Input:   none
+//  Output:  returns a task runner (or NULL if one could not be started)
+//  Purpose: starts a thread that runs tasks in the background.
+//
+{
+    TBgTask* runner = (TBgTask *)calloc(1, sizeof(TBgTask));
+    if ( runner == NULL ) return NULL;
+
+#ifdef _WIN32
+    InitializeCriticalSection(&runner->lock);
+    InitializeConditionVariable(&runner->changed);
+    runner->thread = CreateThread(NULL, 0, runTasks, runner, 0, NULL);
+    if ( runner->thread == NULL )
+    {
+        DeleteCriticalSection(&runner->lock);
+        free(runner);
+        return NULL;
+    }
+#else
+    pthread_mutex_init(&runner->lock, NULL);
+    pthread_cond_init(&runner->changed, NULL);
+    if ( pthread_create(&runner->thread, NULL, runTasks, runner) != 0 )
+    {
+        pthread_cond_destroy(&runner->changed);
+        pthread_mutex_destroy(&runner->lock);
+        free(runner);
+        return NULL;
+    }
+#endif
+    return runner;
+}
+
+//=============================================================================
+
+void bgtask_run(TBgTask* runner, void (*task)(void*), void* arg)
+//
+//  Input:   runner = a task runner
+//           task = function to run
+//           arg = argument passed to task
+//  Output:  none
+//  Purpose: hands a task to the runner once its previous task has finished.
+//
+{
+    if ( runner == NULL )
+    {
+        task(arg);
+        return;
+    }
+    lock(runner);
+    while ( runner->task ) waitForChange(runner);
+    runner->task = task;
+    runner->arg = arg;
+    signalChange(runner);
+    unlock(runner);
+}
+
+//=============================================================================
+
+void bgtask_wait(TBgTask* runner)
+//
+//  Input:   runner = a task runner
+//  Output:  none
+//  Purpose: waits for the runner to finish its current task.
+//
+{
+    if ( runner == NULL ) return;
+    lock(runner);
+    while ( runner->task ) waitForChange(runner);
+    unlock(runner);
+}
+
+//=============================================================================
+
+void bgtask_delete(TBgTask* runner)
+//
+//  Input:   runner = a task runner
+//  Output:  none
+//  Purpose: waits for the runner to finish its current task, then stops
+//           its thread and frees it.
+//
+{
+    if ( runner == NULL ) return;
+    lock(runner);
+    while ( runner->task ) waitForChange(runner);
+    runner->quit = 1;
+    signalChange(runner);
+    unlock(runner);
+
+#ifdef _WIN32
+    WaitForSingleObject(runner->thread, INFINITE);
+    CloseHandle(runner->thread);
+    DeleteCriticalSection(&runner->lock);
+#else
+    pthread_join(runner->thread, NULL);
+    pthread_cond_destroy(&runner->changed);
+    pthread_mutex_destroy(&runner->lock);
+#endif
+    free(runner);
+}
+
+//=============================================================================
+
+#ifdef _WIN32
+DWORD WINAPI runTasks(LPVOID p)
+#else
+void* runTasks(void* p)
+#endif
+//
+//  Input:   p = a task runner
+//  Output:  none
+//  Purpose: runs each task handed to the runner until asked to quit.
+//
+{
+    TBgTask* runner = (TBgTask *)p;
+
+    lock(runner);
+    for (;;)
+    {
+        while ( runner->task == NULL && !runner->quit ) waitForChange(runner);
+        if ( runner->task == NULL ) break;
+        unlock(runner);
+        runner->task(runner->arg);
+        lock(runner);
+        runner->task = NULL;
+        signalChange(runner);
+    }
+    unlock(runner);
+    return 0;
+}
+
+//=============================================================================
+
+#ifdef _WIN32
+void lock(TBgTask* runner)          { EnterCriticalSection(&runner->lock); }
+void unlock(TBgTask* runner)        { LeaveCriticalSection(&runner->lock); }
+void waitForChange(TBgTask* runner)
+{
+    SleepConditionVariableCS(&runner->changed, &runner->lock, INFINITE);
+}
+void signalChange(TBgTask* runner)  { WakeAllConditionVariable(&runner->changed); }
+#else
+void lock(TBgTask* runner)          { pthread_mutex_lock(&runner->lock); }
+void unlock(TBgTask* runner)        { pthread_mutex_unlock(&runner->lock); }
+void waitForChange(TBgTask* runner)
+{
+    pthread_cond_wait(&runner->changed, &runner->lock);
+}
+void signalChange(TBgTask* runner)  { pthread_cond_broadcast(&runner->changed); }
+#endif
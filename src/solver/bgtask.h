@@ -0,0 +1,24 @@
+//-----------------------------------------------------------------------------
+//   bgtask.h
+//
+//   Header file for running tasks on a background thread (bgtask.c).
+//
+//   A task runner executes the tasks handed to it one at a time, in the
+//   order they were submitted, on a thread of its own. bgtask_run waits
+//   for the previous task to finish before submitting the next one, so a
+//   caller alternating between two buffers can fill one of them while the
+//   other is being processed. A NULL runner executes tasks immediately on
+//   the calling thread.
+//-----------------------------------------------------------------------------
+
+#ifndef BGTASK_H
+#define BGTASK_H
+
+typedef struct TBgTask TBgTask;
+
+TBgTask* bgtask_create(void);
+void     bgtask_run(TBgTask* runner, void (*task)(void*), void* arg);
+void     bgtask_wait(TBgTask* runner);
+void     bgtask_delete(TBgTask* runner);
+
+#endif //BGTASK_H
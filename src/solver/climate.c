@@ -75,38 +75,38 @@ typedef struct
 //  Shared variables
 //-----------------------------------------------------------------------------
 // Temperature variables
-static double    Tmin;                 // min. daily temperature (deg F)
-static double    Tmax;                 // max. daily temperature (deg F)
-static double    Trng;                 // 1/2 range of daily temperatures
-static double    Trng1;                // prev. max - current min. temp.
-static double    Tave;                 // average daily temperature (deg F)
-static double    Hrsr;                 // time of min. temp. (hrs)
-static double    Hrss;                 // time of max. temp (hrs)
-static double    Hrday;                // avg. of min/max temp times
-static double    Dhrdy;                // hrs. between min. & max. temp. times
-static double    Dydif;                // hrs. between max. & min. temp. times
-static DateTime  LastDay;              // date of last day with temp. data
-static TMovAve   Tma;                  // moving average of daily temperatures
+static THREADLOCAL double    Tmin;                 // min. daily temperature (deg F)
+static THREADLOCAL double    Tmax;                 // max. daily temperature (deg F)
+static THREADLOCAL double    Trng;                 // 1/2 range of daily temperatures
+static THREADLOCAL double    Trng1;                // prev. max - current min. temp.
+static THREADLOCAL double    Tave;                 // average daily temperature (deg F)
+static THREADLOCAL double    Hrsr;                 // time of min. temp. (hrs)
+static THREADLOCAL double    Hrss;                 // time of max. temp (hrs)
+static THREADLOCAL double    Hrday;                // avg. of min/max temp times
+static THREADLOCAL double    Dhrdy;                // hrs. between min. & max. temp. times
+static THREADLOCAL double    Dydif;                // hrs. between max. & min. temp. times
+static THREADLOCAL DateTime  LastDay;              // date of last day with temp. data
+static THREADLOCAL TMovAve   Tma;                  // moving average of daily temperatures
 
 // Evaporation variables
-static DateTime  NextEvapDate;         // next date when evap. rate changes
-static double    NextEvapRate;         // next evaporation rate (user units)
+static THREADLOCAL DateTime  NextEvapDate;         // next date when evap. rate changes
+static THREADLOCAL double    NextEvapRate;         // next evaporation rate (user units)
 
 // Climate file variables
-static int      FileFormat;            // file format (see ClimateFileFormats)
-static int      FileYear;              // current year of file data
-static int      FileMonth;             // current month of year of file data
-static int      FileDay;               // current day of month of file data
-static int      FileLastDay;           // last day of current month of file data
-static int      FileElapsedDays;       // number of days read from file
-static double   FileValue[4];          // current day's values of climate data
-static double   FileData[4][32];       // month's worth of daily climate data
-static char     FileLine[MAXLINE+1];   // line from climate data file
-
-static int      FileFieldPos[4];       // start of data fields for file record
-static int      FileDateFieldPos;      // start of date field for file record 
-static int      FileWindType;          // wind speed type
-static int      FileTempUnits;         // GHCND file temperature units (C10, C or F)
+static THREADLOCAL int      FileFormat;            // file format (see ClimateFileFormats)
+static THREADLOCAL int      FileYear;              // current year of file data
+static THREADLOCAL int      FileMonth;             // current month of year of file data
+static THREADLOCAL int      FileDay;               // current day of month of file data
+static THREADLOCAL int      FileLastDay;           // last day of current month of file data
+static THREADLOCAL int      FileElapsedDays;       // number of days read from file
+static THREADLOCAL double   FileValue[4];          // current day's values of climate data
+static THREADLOCAL double   FileData[4][32];       // month's worth of daily climate data
+static THREADLOCAL char     FileLine[MAXLINE+1];   // line from climate data file
+
+static THREADLOCAL int      FileFieldPos[4];       // start of data fields for file record
+static THREADLOCAL int      FileDateFieldPos;      // start of date field for file record 
+static THREADLOCAL int      FileWindType;          // wind speed type
+static THREADLOCAL int      FileTempUnits;         // GHCND file temperature units (C10, C or F)
 
 //-----------------------------------------------------------------------------
 //  External functions (defined in funcs.h)
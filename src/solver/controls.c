@@ -51,6 +51,13 @@
 //  Build 5.2.1:
 //  - A refactoring bug from 5.2.0 causing duplicate actions to be added
 //    to the list of control actions to take was fixed.
+//  Build 5.2.4+:
+//  - Premises and actions are allocated from a memory pool that is freed
+//    at once.
+//  - Rule premises are compiled into arrays of clauses that share the
+//    values of distinct premise variables, and a rule is only re-evaluated
+//    when the values of its variables change.
+//  - Links already on the list of control actions are found directly.
 //-----------------------------------------------------------------------------
 #define _CRT_SECURE_NO_DEPRECATE
 
@@ -58,6 +65,7 @@
 #include <stdlib.h>
 #include <math.h>
 #include "headers.h"
+#include "mempool.h"
 
 //-----------------------------------------------------------------------------
 //  Constants
@@ -158,24 +166,64 @@ struct  TRule
    struct   TAction*  elseActions;     // linked list of actions if false
 };
 
+// Compiled Premise Clause
+struct  TClause
+{
+   int      isOr;                      // TRUE for an OR clause
+   int      relation;                  // relational operator (>, <, =, etc)
+   int      attribute;                 // attribute of left hand side variable
+   int      exprIndex;                 // expression index (-1 if N/A)
+   int      lhs;                       // index of lhs variable's value
+   int      rhs;                       // index of rhs variable's value
+                                       // (-1 if rhs is a fixed value)
+   double   value;                     // right hand side value
+};
+
+// Compiled Control Rule
+struct  TRuleCode
+{
+   int      firstClause;               // index of rule's first clause
+   int      lastClause;                // index past rule's last clause
+   int      firstVar;                  // start of rule's variables in RuleVar
+   int      lastVar;                   // end of rule's variables in RuleVar
+   char     always;                    // TRUE if evaluated at every time step
+   char     evaluated;                 // TRUE if rule has been evaluated
+   char     result;                    // result of last evaluation
+   char     setsControl;               // TRUE if evaluation set ControlValue
+   double   controlValue;              // ControlValue set by evaluation
+   double   setPoint;                  // SetPoint set by evaluation
+};
+
 //-----------------------------------------------------------------------------
 //  Shared variables
 //-----------------------------------------------------------------------------
-struct   TRule*       Rules;           // array of control rules
-struct   TActionList* ActionList;      // linked list of control actions
-int      InputState;                   // state of rule interpreter
-int      RuleCount;                    // total number of rules
-double   ControlValue;                 // value of controller variable
-double   SetPoint;                     // value of controller setpoint
-DateTime CurrentDate;                  // current date in whole days 
-DateTime CurrentTime;                  // current time of day (decimal)
-
-int     VariableCount;
-int     ExpressionCount;
-int     CurrentVariable;
-int     CurrentExpression;
-struct  TNamedVariable* NamedVariable; // array of named variables
-struct  TExpression* Expression;       // array of math expressions
+THREADLOCAL struct   TRule*       Rules;           // array of control rules
+THREADLOCAL struct   TActionList* ActionList;      // linked list of control actions
+THREADLOCAL alloc_handle_t*       RulePool;        // memory pool for premises & actions
+THREADLOCAL int      InputState;                   // state of rule interpreter
+THREADLOCAL int      RuleCount;                    // total number of rules
+THREADLOCAL double   ControlValue;                 // value of controller variable
+THREADLOCAL double   SetPoint;                     // value of controller setpoint
+THREADLOCAL DateTime CurrentDate;                  // current date in whole days 
+THREADLOCAL DateTime CurrentTime;                  // current time of day (decimal)
+
+THREADLOCAL int     VariableCount;
+THREADLOCAL int     ExpressionCount;
+THREADLOCAL int     CurrentVariable;
+THREADLOCAL int     CurrentExpression;
+THREADLOCAL struct  TNamedVariable* NamedVariable; // array of named variables
+THREADLOCAL struct  TExpression* Expression;       // array of math expressions
+
+THREADLOCAL struct  TClause*     Clause;           // compiled premise clauses
+THREADLOCAL struct  TRuleCode*   RuleCode;         // compiled control rules
+THREADLOCAL int*                 RuleVar;          // variables used by each rule
+THREADLOCAL struct  TVariable*   PremiseVar;       // distinct premise variables
+THREADLOCAL double*              PremiseValue;     // values of premise variables
+THREADLOCAL char*                PremiseChanged;   // TRUE if value changed
+THREADLOCAL int                  PremiseVarCount;  // number of premise variables
+THREADLOCAL int                  ControlSet;       // TRUE if ControlValue was set
+THREADLOCAL struct  TActionList** LinkAction;      // action list item of each link
+THREADLOCAL struct  TActionList* FreeAction;       // first unused action list item
 
 //-----------------------------------------------------------------------------
 //  External functions (declared in funcs.h)
@@ -197,7 +245,12 @@ int    getPremiseVariable(char* tok[], int nToks, int* k, struct TVariable* v);
 int    getPremiseValue(char* token, int attrib, double* value);
 int    addAction(int r, char* Tok[], int nToks);
 
-int    evaluatePremise(struct TPremise* p, double tStep);
+int    compileRules(void);
+int    findPremiseVar(struct TVariable v, int* slots, int nSlots);
+void   deleteCompiledRules(void);
+void   updatePremiseValues(void);
+int    evaluateRule(int r, double tStep);
+int    evaluateClause(struct TClause* c, double tStep);
 double getVariableValue(struct TVariable v);
 int    compareTimes(double lhsValue, int relation, double rhsValue,
        double halfStep);
@@ -231,6 +284,8 @@ void controls_init()
 //
 {
     Rules = NULL;
+    RulePool = NULL;
+    RuleCode = NULL;
     NamedVariable = NULL;
     Expression = NULL;
     RuleCount = 0;
@@ -269,6 +324,8 @@ int  controls_create(int n)
     {
         Rules = (struct TRule *) calloc(RuleCount, sizeof(struct TRule));
         if (Rules == NULL) return ERR_MEMORY;
+        RulePool = AllocNewPool();
+        if (RulePool == NULL) return ERR_MEMORY;
         for ( r=0; r<RuleCount; r++ )
         {
             Rules[r].ID = NULL;
@@ -503,7 +560,6 @@ int controls_evaluate(DateTime currentTime, DateTime elapsedTime, double tStep)
 {
     int    r;                          // control rule index
     int    result;                     // TRUE if rule premises satisfied
-    struct TPremise* p;                // pointer to rule premise clause
     struct TAction*  a;                // pointer to rule action clause
 
     // --- save date and time to shared variables
@@ -511,28 +567,20 @@ int controls_evaluate(DateTime currentTime, DateTime elapsedTime, double tStep)
     CurrentTime = currentTime - floor(currentTime);
     ElapsedTime = elapsedTime;
 
-    // --- evaluate each rule
+    // --- compile rules when first evaluated (after all were read)
     if ( RuleCount == 0 ) return 0;
+    if ( RuleCode == NULL && !compileRules() )
+    {
+        report_writeErrorMsg(ERR_MEMORY, "");
+        return 0;
+    }
+
+    // --- evaluate each rule using current values of premise variables
     clearActionList();
+    updatePremiseValues();
     for (r=0; r<RuleCount; r++)
     {
-        // --- evaluate rule's premises
-        result = TRUE;
-        p = Rules[r].firstPremise;
-        while (p)
-        {
-            if ( p->type == r_OR )
-            {
-                if ( result == FALSE )
-                    result = evaluatePremise(p, tStep);
-            }
-            else
-            {
-                if ( result == FALSE ) break;
-                result = evaluatePremise(p, tStep);
-            }
-            p = p->next;
-        }    
+        result = evaluateRule(r, tStep);
 
         // --- if premises true, add THEN clauses to action list
         //     else add ELSE clauses to action list
@@ -642,7 +690,7 @@ int  addPremise(int r, int type, char* tok[], int nToks)
     if ( n < nToks && findmatch(tok[n], RuleKeyWords) >= 0 ) return ERR_RULE;
 
     // --- create the premise object
-    p = (struct TPremise *) malloc(sizeof(struct TPremise));
+    p = (struct TPremise *) AllocFromPool(RulePool, sizeof(struct TPremise));
     if ( !p ) return ERR_MEMORY;
     p->type      = type;
     p->exprIndex = exprIndex;
@@ -994,7 +1042,7 @@ int  addAction(int r, char* tok[], int nToks)
     if ( n < nToks && findmatch(tok[n], RuleKeyWords) >= 0 ) return ERR_RULE;
 
     // --- create the action object
-    a = (struct TAction *) malloc(sizeof(struct TAction));
+    a = (struct TAction *) AllocFromPool(RulePool, sizeof(struct TAction));
     if ( !a ) return ERR_MEMORY;
     a->rule      = r;
     a->link      = link;
@@ -1083,6 +1131,225 @@ int  setActionSetting(char* tok[], int nToks, int* curve, int* tseries,
 
 //=============================================================================
 
+int compileRules(void)
+//
+//  Input:   none
+//  Output:  returns TRUE if successful
+//  Purpose: compiles the premises of all control rules into an array of
+//           clauses whose variables are drawn from a list of distinct
+//           premise variables.
+//
+{
+    int    r, n = 0, m = 0, nClauses = 0, nSlots = 16;
+    int*   slots;
+    struct TPremise*  p;
+    struct TRuleCode* rc;
+    struct TClause*   c;
+
+    // --- count premise clauses
+    for (r = 0; r < RuleCount; r++)
+    {
+        for (p = Rules[r].firstPremise; p; p = p->next) nClauses++;
+    }
+
+    // --- allocate compiled rules and a hash table of premise variables
+    while ( nSlots < 4 * nClauses ) nSlots *= 2;
+    RuleCode = (struct TRuleCode *) calloc(RuleCount, sizeof(struct TRuleCode));
+    Clause = (struct TClause *) calloc(nClauses + 1, sizeof(struct TClause));
+    RuleVar = (int *) calloc(2 * nClauses + 1, sizeof(int));
+    PremiseVar = (struct TVariable *) calloc(2 * nClauses + 1,
+                 sizeof(struct TVariable));
+    PremiseValue = (double *) calloc(2 * nClauses + 1, sizeof(double));
+    PremiseChanged = (char *) calloc(2 * nClauses + 1, sizeof(char));
+    LinkAction = (struct TActionList **) calloc(Nobjects[LINK] + 1,
+                 sizeof(struct TActionList *));
+    slots = (int *) malloc(nSlots * sizeof(int));
+    if ( !RuleCode || !Clause || !RuleVar || !PremiseVar || !PremiseValue ||
+         !PremiseChanged || !LinkAction || !slots )
+    {
+        FREE(slots);
+        deleteCompiledRules();
+        return FALSE;
+    }
+    for (r = 0; r < nSlots; r++) slots[r] = -1;
+    PremiseVarCount = 0;
+
+    // --- compile each rule's premises
+    for (r = 0; r < RuleCount; r++)
+    {
+        rc = &RuleCode[r];
+        rc->firstClause = n;
+        rc->firstVar = m;
+        for (p = Rules[r].firstPremise; p; p = p->next)
+        {
+            c = &Clause[n++];
+            c->isOr = (p->type == r_OR);
+            c->relation = p->relation;
+            c->attribute = p->lhsVar.attribute;
+            c->exprIndex = p->exprIndex;
+            c->value = p->value;
+            c->lhs = -1;
+            c->rhs = -1;
+            if ( p->exprIndex < 0 )
+            {
+                c->lhs = findPremiseVar(p->lhsVar, slots, nSlots);
+                RuleVar[m++] = c->lhs;
+            }
+            if ( p->value == MISSING )
+            {
+                c->rhs = findPremiseVar(p->rhsVar, slots, nSlots);
+                RuleVar[m++] = c->rhs;
+            }
+
+            // --- expressions and time comparisons, which depend on the
+            //     time step, are evaluated at every time step
+            if ( p->exprIndex >= 0 ||
+                 c->attribute == r_TIME || c->attribute == r_CLOCKTIME ||
+                 c->attribute == r_TIMEOPEN || c->attribute == r_TIMECLOSED )
+                rc->always = TRUE;
+        }
+        rc->lastClause = n;
+        rc->lastVar = m;
+    }
+    free(slots);
+    return TRUE;
+}
+
+//=============================================================================
+
+int findPremiseVar(struct TVariable v, int* slots, int nSlots)
+//
+//  Input:   v = a rule premise variable
+//           slots = hash table of indexes of premise variables
+//           nSlots = size of hash table (a power of 2)
+//  Output:  returns index of variable in list of premise variables
+//  Purpose: finds a variable in the list of distinct premise variables,
+//           adding it to the list if not already there.
+//
+{
+    unsigned int h;
+    int k;
+
+    h = ((unsigned int)v.object * 31u + (unsigned int)v.attribute) * 2654435761u
+        + (unsigned int)v.index;
+    h = (h ^ (h >> 15)) & (nSlots - 1);
+    while ( (k = slots[h]) >= 0 )
+    {
+        if ( PremiseVar[k].object == v.object &&
+             PremiseVar[k].index == v.index &&
+             PremiseVar[k].attribute == v.attribute ) return k;
+        h = (h + 1) & (nSlots - 1);
+    }
+    k = PremiseVarCount++;
+    PremiseVar[k] = v;
+    slots[h] = k;
+    return k;
+}
+
+//=============================================================================
+
+void deleteCompiledRules(void)
+//
+//  Input:   none
+//  Output:  none
+//  Purpose: frees the memory used for compiled control rules.
+//
+{
+    FREE(RuleCode);
+    FREE(Clause);
+    FREE(RuleVar);
+    FREE(PremiseVar);
+    FREE(PremiseValue);
+    FREE(PremiseChanged);
+    FREE(LinkAction);
+    PremiseVarCount = 0;
+}
+
+//=============================================================================
+
+void updatePremiseValues(void)
+//
+//  Input:   none
+//  Output:  none
+//  Purpose: retrieves the current value of each distinct premise variable
+//           and notes if it has changed since the previous evaluation.
+//
+{
+    int    k;
+    double x;
+
+    for (k = 0; k < PremiseVarCount; k++)
+    {
+        x = getVariableValue(PremiseVar[k]);
+        PremiseChanged[k] = (x != PremiseValue[k]);
+        PremiseValue[k] = x;
+    }
+}
+
+//=============================================================================
+
+int evaluateRule(int r, double tStep)
+//
+//  Input:   r = rule index
+//           tStep = current time step (days)
+//  Output:  returns TRUE if the rule's premises are satisfied
+//  Purpose: evaluates the premises of a compiled control rule.
+//
+//  Note:    a rule whose variables have not changed since it was last
+//           evaluated keeps its previous result, and restores the values
+//           of ControlValue and SetPoint that evaluating it would set.
+{
+    int    k;
+    int    result;
+    int    changed;
+    struct TRuleCode* rc = &RuleCode[r];
+    struct TClause*   c;
+
+    // --- check if any of rule's variables changed
+    changed = rc->always || !rc->evaluated;
+    for (k = rc->firstVar; k < rc->lastVar && !changed; k++)
+    {
+        changed = PremiseChanged[RuleVar[k]];
+    }
+    if ( !changed )
+    {
+        if ( rc->setsControl )
+        {
+            ControlValue = rc->controlValue;
+            SetPoint = rc->setPoint;
+        }
+        return rc->result;
+    }
+
+    // --- evaluate rule's premises
+    ControlSet = FALSE;
+    result = TRUE;
+    for (k = rc->firstClause; k < rc->lastClause; k++)
+    {
+        c = &Clause[k];
+        if ( c->isOr )
+        {
+            if ( result == FALSE )
+                result = evaluateClause(c, tStep);
+        }
+        else
+        {
+            if ( result == FALSE ) break;
+            result = evaluateClause(c, tStep);
+        }
+    }
+
+    // --- save result of evaluation
+    rc->evaluated = TRUE;
+    rc->result = (char)result;
+    rc->setsControl = (char)ControlSet;
+    rc->controlValue = ControlValue;
+    rc->setPoint = SetPoint;
+    return result;
+}
+
+//=============================================================================
+
 void  updateActionValue(struct TAction* a, DateTime currentTime, double dt)
 //
 //  Input:   a = an action object
@@ -1171,34 +1438,35 @@ void updateActionList(struct TAction* a)
 //  Output:  none
 //  Purpose: adds a new action to the list of actions to be taken.
 //
+//  Note:    items in use are at the front of the list, so the first unused
+//           item (FreeAction) is where a new action is placed.
 {
     struct TActionList* listItem;
     struct TAction* a1;
     double priority = Rules[a->rule].priority;
 
     // --- check if link referred to in action is already listed
-    listItem = ActionList;
-    while ( listItem )
+    listItem = LinkAction[a->link];
+    if ( listItem )
     {
+        // --- replace old action if new action has higher priority
         a1 = listItem->action;
-        if ( !a1 ) break;
-        if ( a1->link == a->link )
-        {
-            // --- replace old action if new action has higher priority
-            if ( priority > Rules[a1->rule].priority ) listItem->action = a;
-            return;
-        }
-        listItem = listItem->next;
+        if ( priority > Rules[a1->rule].priority ) listItem->action = a;
+        return;
     }
 
     // --- action not listed so add it to ActionList                           //5.2.1
-    if ( !listItem )
+    listItem = FreeAction;
+    if ( listItem ) FreeAction = listItem->next;
+    else
     {
         listItem = (struct TActionList *) malloc(sizeof(struct TActionList));
+        if ( !listItem ) return;
         listItem->next = ActionList;
         ActionList = listItem;
     }
     listItem->action = a;
+    LinkAction[a->link] = listItem;
 }
 
 //=============================================================================
@@ -1240,9 +1508,9 @@ int executeActionList(DateTime currentTime)
 
 //=============================================================================
 
-int evaluatePremise(struct TPremise* p, double tStep)
+int evaluateClause(struct TClause* c, double tStep)
 //
-//  Input:   p = a control rule premise condition
+//  Input:   c = a compiled control rule premise clause
 //           tStep = current time step (days)
 //  Output:  returns TRUE if the condition is true or FALSE otherwise
 //  Purpose: evaluates the truth of a control rule premise condition.
@@ -1252,32 +1520,33 @@ int evaluatePremise(struct TPremise* p, double tStep)
     int    result = FALSE;
 
     // --- check if left hand side (lhs) of premise is an expression
-    if (p->exprIndex >= 0)
-        lhsValue = mathexpr_eval(Expression[p->exprIndex].expression,
+    if (c->exprIndex >= 0)
+        lhsValue = mathexpr_eval(Expression[c->exprIndex].expression,
             getNamedVariableValue);
 
     // --- otherwise get value of the lhs variable
     else
-        lhsValue = getVariableValue(p->lhsVar);
+        lhsValue = PremiseValue[c->lhs];
 
     // --- if right hand side (rhs) of premise is a variable then get its value
-    if ( p->value == MISSING ) rhsValue = getVariableValue(p->rhsVar);
-    else                       rhsValue = p->value;
+    if ( c->rhs >= 0 ) rhsValue = PremiseValue[c->rhs];
+    else               rhsValue = c->value;
     if ( lhsValue == MISSING || rhsValue == MISSING ) return FALSE;
 
     // --- compare the lhs of the premise to the rhs
-    switch (p->lhsVar.attribute)
+    switch (c->attribute)
     {
     case r_TIME:
     case r_CLOCKTIME:
-        return compareTimes(lhsValue, p->relation, rhsValue, tStep/2.0); 
+        return compareTimes(lhsValue, c->relation, rhsValue, tStep/2.0); 
     case r_TIMEOPEN:
     case r_TIMECLOSED:
-        result = compareTimes(lhsValue, p->relation, rhsValue, tStep/2.0);
+        result = compareTimes(lhsValue, c->relation, rhsValue, tStep/2.0);
         ControlValue = lhsValue * 24.0;  // convert time from days to hours
+        ControlSet = TRUE;
         return result;
     default:
-        return compareValues(lhsValue, p->relation, rhsValue);
+        return compareValues(lhsValue, c->relation, rhsValue);
     }
 }
 
@@ -1438,6 +1707,7 @@ int compareValues(double lhsValue, int relation, double rhsValue)
 {
     SetPoint = rhsValue;
     ControlValue = lhsValue;
+    ControlSet = TRUE;
     switch (relation)
     {
       case EQ: if ( lhsValue == rhsValue ) return TRUE; break;
@@ -1461,11 +1731,13 @@ void clearActionList(void)
 {
     struct TActionList* listItem;
     listItem = ActionList;
-    while ( listItem )
+    while ( listItem && listItem->action )
     {
+        LinkAction[listItem->action->link] = NULL;
         listItem->action = NULL;
         listItem = listItem->next;
     }
+    FreeAction = ActionList;
 }
 
 //=============================================================================
@@ -1487,6 +1759,7 @@ void  deleteActionList(void)
         listItem = nextItem;
     }
     ActionList = NULL;
+    FreeAction = NULL;
 }
 
 //=============================================================================
@@ -1498,35 +1771,9 @@ void  deleteRules(void)
 //  Purpose: frees the memory used for all of the control rules.
 //
 {
-   struct TPremise* p;
-   struct TPremise* pnext;
-   struct TAction*  a;
-   struct TAction*  anext;
-   int r;
-   for (r=0; r<RuleCount; r++)
-   {
-      p = Rules[r].firstPremise;
-      while ( p )
-      {
-         pnext = p->next;
-         free(p);
-         p = pnext;
-      }
-      a = Rules[r].thenActions;
-      while (a )
-      {
-         anext = a->next;
-         free(a);
-         a = anext;
-      }
-      a = Rules[r].elseActions;
-      while (a )
-      {
-         anext = a->next;
-         free(a);
-         a = anext;
-      }
-   }
+   deleteCompiledRules();
+   AllocDeletePool(RulePool);
+   RulePool = NULL;
    FREE(Rules);
    RuleCount = 0;
 }
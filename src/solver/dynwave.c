@@ -15,6 +15,19 @@
 //   to solve the explicit form of the continuity and momentum equations
 //   for conduits.
 //
+//   Options added in Build 5.2.4+ (details are in the comments of the
+//   functions named):
+//   - DYNWAVE_SOLVER NEWTON solves the heads of all nodes together with
+//     Newton iterations (findNodeHeads()).
+//   - ACTIVE_SET re-solves only the unconverged nodes and their neighbors
+//     in later Picard iterations (findActiveSet()).
+//   - LOCAL_STEP_CLASSES re-solves fast nodes & links over local steps
+//     that are fractions of the routing step (refineStepClass()).
+//   - With several threads, each thread solves a connected sub-domain of
+//     the network (createDomains(), findRoutingSolution()).
+//   - NETWORK_ORDERING RCM stores the packed node & conduit state in
+//     reverse Cuthill-McKee order (orderDomains()).
+//
 //   Update History
 //   ==============
 //   Build 5.1.002:
@@ -47,12 +60,41 @@
 //   Build 5.2.4:
 //   - Conduit evap+seepage outflow split evenly between outflow from
 //     conduit's upstream and non-outfall downstream nodes.
+//   Build 5.2.4+:
+//   - Node inflow/outflow from conduits gathered in parallel over nodes
+//     using each node's list of incident links.
+//   - Node & conduit state used in each iteration kept in packed arrays
+//     (structure-of-arrays) that are synchronized with Node[] & Link[].
+//   - Counts made by worker threads merged into the run time profile.
+//   - Newton iteration solver for node heads added as an alternative to
+//     Picard iterations.
+//   - Option added to re-solve only the active set of unconverged nodes
+//     and their neighbors in later Picard iterations.
+//   - Option added to solve nodes & links with local time steps finer
+//     than the routing step.
+//   - Nodes & links split into a sub-domain of the network for each
+//     thread instead of sharing out loops over their raw index order.
+//   - Packed node & conduit state stored by position, with an option to
+//     renumber the positions in reverse Cuthill-McKee order.
+//   - One team of threads kept for all iterations of a time step instead
+//     of forking threads in each stage of each iteration.
+//   - Fewer threads used on networks too small to keep them all busy.
 //-----------------------------------------------------------------------------
 #define _CRT_SECURE_NO_DEPRECATE
 
 #include <stdlib.h>
 #include <math.h>
 #include "headers.h"
+#include "profile.h"
+#include "sparse.h"
+#include "partition.h"
+
+#if defined(_OPENMP)
+  #include <omp.h>
+#else
+  static int omp_get_thread_num(void) { return 0; }
+  static int omp_get_num_threads(void) { return 1; }
+#endif
 
 //-----------------------------------------------------------------------------
 //     Constants 
@@ -64,35 +106,129 @@ static const double DEFAULT_HEADTOL     = 0.005;  // Default head tolerance (ft)
 static const double EXTRAN_CROWN_CUTOFF = 0.96;   // crown cutoff for EXTRAN
 static const double SLOT_CROWN_CUTOFF   = 0.985257; // crown cutoff for SLOT
 static const int    DEFAULT_MAXTRIALS   = 8;      // Max. trials per time step
+static const double NEWTON_COURANT      = 2.0;    // Courant limit multiplier
+                                                  // for Newton iterations
+static const int    CONDUIT_WEIGHT      = 2;      // work of a conduit flow
+                                                  // relative to a node depth
+static const int    MIN_THREAD_WORK     = 500;    // min. work (node depths)
+                                                  // per thread per iteration
 
 
 //-----------------------------------------------------------------------------
 //  Data Structures
 //-----------------------------------------------------------------------------
+// Node state used in each iteration, stored as separate arrays so that
+// sweeps over the nodes do not pull in the rest of the TNode record
 typedef struct 
 {
-    char    converged;                 // TRUE if iterations for a node done
-    double  newSurfArea;               // current surface area (ft2)
-    double  oldSurfArea;               // previous surface area (ft2)
-    double  sumdqdh;                   // sum of dqdh from adjoining links
-    double  dYdT;                      // change in depth w.r.t. time (ft/sec)
+    char*   converged;                 // TRUE if iterations for a node done
+    char*   active;                    // TRUE if node re-solved in iteration
+    double* newDepth;                  // current depth (ft)
+    double* oldDepth;                  // depth at start of time step (ft)
+    double* oldNetInflow;              // net inflow at start of time step (cfs)
+    double* latInflow;                 // lateral inflow (cfs)
+    double* latOutflow;                // losses + negative lateral inflow (cfs)
+    double* inflow;                    // total inflow (cfs)
+    double* outflow;                   // total outflow (cfs)
+    double* newSurfArea;               // current surface area (ft2)
+    double* oldSurfArea;               // previous surface area (ft2)
+    double* sumdqdh;                   // sum of dqdh from adjoining links
+    double* dYdT;                      // change in depth w.r.t. time (ft/sec)
 } TXnode;
 
+// Non-dummy conduit results seen by the conduit's end nodes
+typedef struct
+{
+    double* flow;                      // flow rate (cfs)
+    double* dqdh;                      // derivative of flow w.r.t. head
+    double* surfArea1;                 // surface area at upstream node (ft2)
+    double* surfArea2;                 // surface area at downstream node (ft2)
+    double* loss1;                     // evap + seepage loss at upstream node (cfs)
+    double* loss2;                     // evap + seepage loss at downstream node (cfs)
+} TXlink;
+
+// Step classes and the state of nodes & links at the start of a routing
+// step used with local time steps
+typedef struct
+{
+    char*   nodeClass;                 // step class of each node
+    char*   linkClass;                 // step class of each link
+    double* oldDepth;                  // node depth at start of step (ft)
+    double* oldVolume;                 // node volume at start of step (ft3)
+    double* oldNetInflow;              // node net inflow at start of step (cfs)
+    double* oldFlow;                   // link flow at start of step (cfs)
+    double* inflowVol;                 // node inflow volume over step (ft3)
+    double* outflowVol;                // node outflow volume over step (ft3)
+    double* overflowVol;               // node overflow volume over step (ft3)
+} TXclass;
+
 //-----------------------------------------------------------------------------
 //  Shared Variables
 //-----------------------------------------------------------------------------
-static double  VariableStep;           // size of variable time step (sec)
-static TXnode* Xnode;                  // extended nodal information
-
-static double  Omega;                  // actual under-relaxation parameter
-static int     Steps;                  // number of Picard iterations
+static THREADLOCAL double  VariableStep;           // size of variable time step (sec)
+static THREADLOCAL TXnode  Xnode;                  // packed node state (by position)
+static THREADLOCAL TXlink  Xlink;                  // packed conduit results (by position)
+static THREADLOCAL int*    NodeLinkStart;          // start of each node position's links in NodeLinks
+static THREADLOCAL int*    NodeLinks;              // conduits on each node (2*position + end)
+static THREADLOCAL int*    NcNodes;                // positions of nodes with non-conduit links
+static THREADLOCAL int     NcNodeCount;            // number of such nodes
+static THREADLOCAL int*    ActiveNodes;            // node positions re-solved in iteration
+static THREADLOCAL int*    ActiveLinks;            // conduit positions re-solved in iteration
+static THREADLOCAL int     ActiveNodeCount;        // number of active nodes (-1 if all)
+static THREADLOCAL int     ActiveLinkCount;        // number of active conduits (-1 if all)
+
+// Sub-domains of the network worked on by each thread and the position of
+// each node & link in the packed state (sub-domain by sub-domain)
+static THREADLOCAL int     DomainCount;            // number of sub-domains
+static THREADLOCAL int*    NodeDomain;             // sub-domain of each node
+static THREADLOCAL int*    LinkDomain;             // sub-domain of each link
+static THREADLOCAL int*    NodeOrder;              // node at each position
+static THREADLOCAL int*    LinkOrder;              // link at each position
+static THREADLOCAL int*    NodePos;                // position of each node
+static THREADLOCAL int*    LinkPos;                // position of each link
+static THREADLOCAL int*    DomainNodeStart;        // first node position of each sub-domain
+static THREADLOCAL int*    DomainLinkStart;        // first link position of each sub-domain
+static THREADLOCAL int*    ActiveNodeStart;        // start of each sub-domain in ActiveNodes
+static THREADLOCAL int*    ActiveLinkStart;        // start of each sub-domain in ActiveLinks
+
+static THREADLOCAL double  Omega;                  // actual under-relaxation parameter
+static THREADLOCAL int     Steps;                  // number of Picard iterations
+static THREADLOCAL int     Converged;              // TRUE if all nodes converged
+
+// Local time steps of nodes & links finer than the routing step
+static THREADLOCAL TXclass Xclass;                 // step classes & saved state
+static THREADLOCAL int     MaxClass;               // finest class in current step
+static THREADLOCAL int     StepClass;              // class being solved
+static THREADLOCAL double  ClassTime[MAXSTEPCLASSES+1]; // start of each class's
+                                                        // current step (sec)
+
+// Newton solver's equations for the change in head at each node
+static THREADLOCAL TSparse* HeadSolver;            // sparse equation solver
+static THREADLOCAL double*  HeadDiag;              // diagonal coeff. of each node (ft2)
+static THREADLOCAL double*  HeadOffdiag;           // off-diagonal coeff. of each link (ft2)
+static THREADLOCAL double*  HeadRhs;               // -residual, then head change
+static THREADLOCAL char*    HeadFixed;             // TRUE if node's head held fixed
+static THREADLOCAL int      HeadSolved;            // TRUE if head changes were found
 
 //-----------------------------------------------------------------------------
 //  Function declarations
 //-----------------------------------------------------------------------------
+static int    allocHotState(void);
+static void   freeHotState(void);
+static int    createNodeLinkLists(void);
+static int    createHeadSolver(void);
+static int    createStepClasses(void);
+static int    createDomains(void);
+static int    orderDomains(void);
+static void   findActiveRanges(void);
+static int*   getNodeList(int** start);
+static int*   getLinkList(int** start);
+
 static void   initRoutingStep(void);
+static int    findRoutingSolution(double dt);
 static void   initNodeStates(void);
 static void   findBypassedLinks();
+static void   findActiveSet(void);
 static void   findLimitedLinks();
 
 static void   findLinkFlows(double dt);
@@ -101,17 +237,35 @@ static void   findNonConduitFlow(int link, double dt);
 static void   findNonConduitSurfArea(int link);
 static double getModPumpFlow(int link, double q, double dt);
 static void   updateNodeFlows(int link);
+static void   updateNodeFlow(int link, int node);
+static void   gatherNodeFlows(int node);
+static void   packConduitState(int link);
+static void   copyNodeFlows(int toNodes);
 static void   updateConvergenceStats();
 
 static int    findNodeDepths(double dt);
 static void   setNodeDepth(int node, double dt);
+static int    isNodeSurcharged(int node, int isPonded, double y);
+static void   saveNodeDepth(int node, int canPond, double dV, double yNew,
+              double dt);
 static double getFloodedDepth(int node, int canPond, double dV, double yNew,
               double yMax, double dt);
 
+static int    findNodeHeads(double dt);
+static int    solveHeadChanges(double dt);
+static void   setNodeHead(int node, double yNew, double dt);
+
 static double getVariableStep(double maxStep);
 static double getLinkStep(double tMin, int *minLink);
+static double getCourantStep(int link, double factor);
 static double getNodeStep(double tMin, int *minNode);
 
+static void   findStepClasses(double tStep);
+static void   refineStepClass(int stepClass, double dt);
+static void   setActiveClass(int stepClass, int restart, double dt);
+static void   addClassFlows(int stepClass, double dt);
+static void   endLocalSteps(double tStep);
+
 //=============================================================================
 
 void dynwave_init()
@@ -125,19 +279,21 @@ void dynwave_init()
     double z;
 
     VariableStep = 0.0;
-    Xnode = (TXnode *) calloc(Nobjects[NODE], sizeof(TXnode));
-    if ( Xnode == NULL )
+    if ( !allocHotState() || !createDomains() || !createNodeLinkLists() ||
+         (DynwaveSolver == NEWTON_SOLVER && !createHeadSolver()) ||
+         (LocalStepClasses > 0 && !createStepClasses()) )
     {
         report_writeErrorMsg(ERR_MEMORY,
             " Not enough memory for dynamic wave routing.");
         return;
     }
-    
+    profile_addCount(PROFILE_DOMAINS, DomainCount);
+
     // --- initialize node surface areas & crown elev.
     for (i = 0; i < Nobjects[NODE]; i++ )
     {
-        Xnode[i].newSurfArea = 0.0;
-        Xnode[i].oldSurfArea = 0.0;
+        Xnode.newSurfArea[i] = 0.0;
+        Xnode.oldSurfArea[i] = 0.0;
         Node[i].crownElev = Node[i].invertElev;
     }
 
@@ -169,7 +325,418 @@ void  dynwave_close()
 //  Purpose: frees memory allocated for dynamic wave routing method.
 //
 {
-    FREE(Xnode);
+    freeHotState();
+}
+
+//=============================================================================
+
+int allocHotState()
+//
+//  Input:   none
+//  Output:  returns TRUE if successful, FALSE if out of memory
+//  Purpose: allocates the packed node & conduit state arrays.
+//
+{
+    int     n = Nobjects[NODE];
+    int     m = Nobjects[LINK];
+    double* x;
+
+    // --- all double-valued arrays share a single block of memory
+    x = (double *) calloc(11 * n + 6 * m + 1, sizeof(double));
+    Xnode.newDepth = x;
+    if ( x == NULL ) return FALSE;
+    Xnode.oldDepth     = (x += n);
+    Xnode.oldNetInflow = (x += n);
+    Xnode.latInflow    = (x += n);
+    Xnode.latOutflow   = (x += n);
+    Xnode.inflow       = (x += n);
+    Xnode.outflow      = (x += n);
+    Xnode.newSurfArea  = (x += n);
+    Xnode.oldSurfArea  = (x += n);
+    Xnode.sumdqdh      = (x += n);
+    Xnode.dYdT         = (x += n);
+    Xlink.flow         = (x += n);
+    Xlink.dqdh         = (x += m);
+    Xlink.surfArea1    = (x += m);
+    Xlink.surfArea2    = (x += m);
+    Xlink.loss1        = (x += m);
+    Xlink.loss2        = (x += m);
+
+    Xnode.converged = (char *) calloc(2 * n + 1, sizeof(char));
+    Xnode.active = Xnode.converged + n;
+    NodeLinkStart = (int *) calloc(n + 1, sizeof(int));
+    NodeLinks = (int *) calloc(2 * m + 1, sizeof(int));
+    NcNodes = (int *) calloc(n + 1, sizeof(int));
+    ActiveNodes = (int *) calloc(n + 1, sizeof(int));
+    ActiveLinks = (int *) calloc(m + 1, sizeof(int));
+    ActiveNodeCount = -1;
+    ActiveLinkCount = -1;
+    return ( Xnode.converged && NodeLinkStart && NodeLinks && NcNodes &&
+             ActiveNodes && ActiveLinks );
+}
+
+//=============================================================================
+
+void freeHotState()
+//
+//  Input:   none
+//  Output:  none
+//  Purpose: frees the packed node & conduit state arrays.
+//
+{
+    FREE(Xnode.newDepth);
+    FREE(Xnode.converged);
+    FREE(NodeLinkStart);
+    FREE(NodeLinks);
+    FREE(NcNodes);
+    NcNodeCount = 0;
+    FREE(ActiveNodes);
+    FREE(ActiveLinks);
+    FREE(NodeDomain);
+    DomainCount = 0;
+    sparse_delete(HeadSolver);
+    HeadSolver = NULL;
+    FREE(HeadDiag);
+    FREE(HeadFixed);
+    FREE(Xclass.nodeClass);
+    FREE(Xclass.oldDepth);
+    MaxClass = 0;
+}
+
+//=============================================================================
+
+int createNodeLinkLists()
+//
+//  Input:   none
+//  Output:  returns TRUE if successful, FALSE if out of memory
+//  Purpose: lists the non-dummy conduits attached to each node and the
+//           nodes attached to any other type of link.
+//
+//  Note: nodes are listed by position and a NodeLinks entry of 2*q refers
+//        to the upstream end of the conduit at position q and one of
+//        2*q+1 to its downstream end. Each node's conduits stay in index
+//        order so its flow totals do not depend on the positions.
+//
+{
+    int  i, j, k, m, p;
+    int* startPos = (int *) calloc(Nobjects[NODE] + 1, sizeof(int));
+    int* links = (int *) calloc(2 * Nobjects[LINK] + 1, sizeof(int));
+
+    if ( startPos == NULL || links == NULL )
+    {
+        FREE(startPos);
+        FREE(links);
+        return FALSE;
+    }
+    toposort_getNodeLinks(startPos, links);
+
+    m = 0;
+    NcNodeCount = 0;
+    for (p = 0; p < Nobjects[NODE]; p++)
+    {
+        i = NodeOrder[p];
+        NodeLinkStart[p] = m;
+        for (k = startPos[i]; k < startPos[i+1]; k++)
+        {
+            j = links[k];
+            if ( !isTrueConduit(j) ) continue;
+            if ( Link[j].node1 == i ) NodeLinks[m++] = 2 * LinkPos[j];
+            if ( Link[j].node2 == i ) NodeLinks[m++] = 2 * LinkPos[j] + 1;
+        }
+        for (k = startPos[i]; k < startPos[i+1]; k++)
+        {
+            if ( !isTrueConduit(links[k]) )
+            {
+                NcNodes[NcNodeCount++] = p;
+                break;
+            }
+        }
+    }
+    NodeLinkStart[Nobjects[NODE]] = m;
+    FREE(startPos);
+    FREE(links);
+    return TRUE;
+}
+
+//=============================================================================
+
+int createDomains()
+//
+//  Input:   none
+//  Output:  returns TRUE if successful, FALSE if out of memory
+//  Purpose: splits the nodes & links into a sub-domain for each thread
+//           and finds their positions in the packed state.
+//
+//  Note: a link belongs to the sub-domain of its upstream node, so each
+//        node is weighted by the work of the conduits it owns when the
+//        network is split (see partition.c). A network with too little
+//        work for each thread gets fewer sub-domains.
+//
+{
+    int  i, d;
+    int  n = Nobjects[NODE];
+    int  m = Nobjects[LINK];
+    int  nd = MAX(NumThreads, 1);
+    int  work = n;
+    int  result = TRUE;
+    int* x;
+    int* weight = NULL;
+    int* node1;
+    int* node2;
+
+    // --- use fewer threads (down to a single one) when there is too
+    //     little work in an iteration to outweigh their synchronization
+    for (i = 0; i < m; i++) if ( isTrueConduit(i) ) work += CONDUIT_WEIGHT;
+    nd = MIN(nd, MAX(1, work / MIN_THREAD_WORK));
+
+    x = (int *) calloc(3 * n + 3 * m + 4 * (nd + 1), sizeof(int));
+    NodeDomain = x;
+    if ( x == NULL ) return FALSE;
+    LinkDomain      = (x += n);
+    NodeOrder       = (x += m);
+    LinkOrder       = (x += n);
+    NodePos         = (x += m);
+    LinkPos         = (x += n);
+    DomainNodeStart = (x += m);
+    DomainLinkStart = (x += nd + 1);
+    ActiveNodeStart = (x += nd + 1);
+    ActiveLinkStart = (x += nd + 1);
+    DomainCount = nd;
+    if ( nd == 1 && NetworkOrdering == INPUT_ORDERING ) return orderDomains();
+
+    // --- split the node-link graph (a single thread keeps it whole)
+    //     and renumber the nodes of each part
+    if ( nd > 1 ) weight = (int *) calloc(n + 1, sizeof(int));
+    node1 = (int *) calloc(m + 1, sizeof(int));
+    node2 = (int *) calloc(m + 1, sizeof(int));
+    if ( (nd > 1 && weight == NULL) || node1 == NULL || node2 == NULL )
+        result = FALSE;
+    else
+    {
+        if ( weight ) for (i = 0; i < n; i++) weight[i] = 1;
+        for (i = 0; i < m; i++)
+        {
+            node1[i] = Link[i].node1;
+            node2[i] = Link[i].node2;
+            if ( weight && isTrueConduit(i) ) weight[node1[i]] += CONDUIT_WEIGHT;
+        }
+        if ( nd > 1 )
+        {
+            d = partition_create(n, m, node1, node2, weight, nd, NodeDomain);
+            if ( d < 0 ) result = FALSE;
+        }
+        if ( result && NetworkOrdering == RCM_ORDERING )
+            result = partition_order(n, m, node1, node2, NodeDomain, NodeOrder);
+    }
+    FREE(weight);
+    FREE(node1);
+    FREE(node2);
+    return ( result && orderDomains() );
+}
+
+//=============================================================================
+
+int orderDomains()
+//
+//  Input:   none
+//  Output:  returns TRUE if successful, FALSE if out of memory
+//  Purpose: assigns the positions of the nodes & links in the packed state.
+//
+//  The nodes & links of each sub-domain take a contiguous range of
+//  positions. Within a sub-domain, nodes are in index order or, with
+//  NETWORK_ORDERING RCM, in the order already placed in NodeOrder, and
+//  links are in the order of their upstream nodes, so neighboring nodes
+//  & conduits sit close together in memory. Node[] and Link[] keep the
+//  input order, so nothing outside this module sees the positions.
+//
+{
+    int  i, d, p;
+    int  n = Nobjects[NODE];
+    int  m = Nobjects[LINK];
+    int  nd = DomainCount;
+    int* count;
+
+    for (i = 0; i < m; i++) LinkDomain[i] = NodeDomain[Link[i].node1];
+
+    // --- find the first position of each sub-domain
+    //     (using the active list starts as the next open positions)
+    for (i = 0; i < n; i++) DomainNodeStart[NodeDomain[i] + 1]++;
+    for (i = 0; i < m; i++) DomainLinkStart[LinkDomain[i] + 1]++;
+    for (d = 0; d < nd; d++)
+    {
+        DomainNodeStart[d+1] += DomainNodeStart[d];
+        DomainLinkStart[d+1] += DomainLinkStart[d];
+        ActiveNodeStart[d] = DomainNodeStart[d];
+        ActiveLinkStart[d] = DomainLinkStart[d];
+    }
+
+    // --- place the nodes (already ordered with RCM)
+    if ( NetworkOrdering != RCM_ORDERING )
+    {
+        for (i = 0; i < n; i++)
+            NodeOrder[ ActiveNodeStart[NodeDomain[i]]++ ] = i;
+    }
+    for (p = 0; p < n; p++) NodePos[NodeOrder[p]] = p;
+
+    // --- place the links
+    if ( NetworkOrdering != RCM_ORDERING )
+    {
+        for (i = 0; i < m; i++)
+            LinkOrder[ ActiveLinkStart[LinkDomain[i]]++ ] = i;
+    }
+
+    // --- with RCM, list links by the position of their upstream node
+    //     (counting the links on each node position first)
+    else
+    {
+        count = (int *) calloc(n + 1, sizeof(int));
+        if ( count == NULL ) return FALSE;
+        for (i = 0; i < m; i++) count[NodePos[Link[i].node1]]++;
+        for (p = 0, d = 0; p < n; p++)
+        {
+            i = count[p];
+            count[p] = d;
+            d += i;
+        }
+        for (i = 0; i < m; i++)
+            LinkOrder[ count[NodePos[Link[i].node1]]++ ] = i;
+        FREE(count);
+    }
+    for (p = 0; p < m; p++) LinkPos[LinkOrder[p]] = p;
+    return TRUE;
+}
+
+//=============================================================================
+
+void findActiveRanges()
+//
+//  Input:   none
+//  Output:  none
+//  Purpose: finds where each sub-domain starts in the lists of active
+//           nodes & conduits.
+//
+//  Note: the active lists must be made in order of position.
+//
+{
+    int d, k;
+
+    for (d = 0; d <= DomainCount; d++)
+    {
+        ActiveNodeStart[d] = 0;
+        ActiveLinkStart[d] = 0;
+    }
+    for (k = 0; k < ActiveNodeCount; k++)
+        ActiveNodeStart[NodeDomain[NodeOrder[ActiveNodes[k]]] + 1]++;
+    for (k = 0; k < ActiveLinkCount; k++)
+        ActiveLinkStart[LinkDomain[LinkOrder[ActiveLinks[k]]] + 1]++;
+    for (d = 0; d < DomainCount; d++)
+    {
+        ActiveNodeStart[d+1] += ActiveNodeStart[d];
+        ActiveLinkStart[d+1] += ActiveLinkStart[d];
+    }
+}
+
+//=============================================================================
+
+int* getNodeList(int** start)
+//
+//  Input:   none
+//  Output:  start = start of each sub-domain in the list;
+//           returns the positions of the nodes being solved, listed by
+//           sub-domain, or NULL if all nodes are solved
+//  Purpose: finds the list of nodes to solve in an iteration.
+//
+{
+    if ( ActiveNodeCount >= 0 )
+    {
+        *start = ActiveNodeStart;
+        return ActiveNodes;
+    }
+    *start = DomainNodeStart;
+    return NULL;
+}
+
+//=============================================================================
+
+int* getLinkList(int** start)
+//
+//  Input:   none
+//  Output:  start = start of each sub-domain in the list;
+//           returns the positions of the links being solved, listed by
+//           sub-domain, or NULL if all links are solved
+//  Purpose: finds the list of links to solve in an iteration.
+//
+{
+    if ( ActiveLinkCount >= 0 )
+    {
+        *start = ActiveLinkStart;
+        return ActiveLinks;
+    }
+    *start = DomainLinkStart;
+    return NULL;
+}
+
+//=============================================================================
+
+int createHeadSolver()
+//
+//  Input:   none
+//  Output:  returns TRUE if successful, FALSE if out of memory
+//  Purpose: creates the sparse solver for the Newton iterations on node
+//           heads, with an off-diagonal coefficient for each non-dummy
+//           conduit.
+//
+{
+    int  i;
+    int  n = Nobjects[NODE];
+    int  m = Nobjects[LINK];
+    int* node1 = (int *) calloc(m + 1, sizeof(int));
+    int* node2 = (int *) calloc(m + 1, sizeof(int));
+
+    HeadDiag = (double *) calloc(2 * n + m + 1, sizeof(double));
+    HeadFixed = (char *) calloc(n + 1, sizeof(char));
+    if ( node1 && node2 && HeadDiag && HeadFixed )
+    {
+        HeadRhs = HeadDiag + n;
+        HeadOffdiag = HeadRhs + n;
+        for (i = 0; i < m; i++)
+        {
+            node1[i] = isTrueConduit(i) ? Link[i].node1 : -1;
+            node2[i] = isTrueConduit(i) ? Link[i].node2 : -1;
+        }
+        HeadSolver = sparse_create(n, m, node1, node2);
+    }
+    FREE(node1);
+    FREE(node2);
+    return ( HeadSolver != NULL );
+}
+
+//=============================================================================
+
+int createStepClasses()
+//
+//  Input:   none
+//  Output:  returns TRUE if successful, FALSE if out of memory
+//  Purpose: allocates the step classes & saved state used with local
+//           time steps.
+//
+{
+    int     n = Nobjects[NODE];
+    int     m = Nobjects[LINK];
+    double* x;
+
+    Xclass.nodeClass = (char *) calloc(n + m + 1, sizeof(char));
+    Xclass.linkClass = Xclass.nodeClass + n;
+    x = (double *) calloc(6 * n + m + 1, sizeof(double));
+    Xclass.oldDepth = x;
+    if ( Xclass.nodeClass == NULL || x == NULL ) return FALSE;
+    Xclass.oldVolume    = (x += n);
+    Xclass.oldNetInflow = (x += n);
+    Xclass.inflowVol    = (x += n);
+    Xclass.outflowVol   = (x += n);
+    Xclass.overflowVol  = (x += n);
+    Xclass.oldFlow      = (x += n);
+    return TRUE;
 }
 
 //=============================================================================
@@ -229,36 +796,102 @@ int dynwave_execute(double tStep)
 //  Purpose: routes flows through drainage network over current time step.
 //
 {
-    int converged;
+    int    i, p;
+    int    steps;
+    int    converged;
+    int    useClasses = (LocalStepClasses > 0 &&
+                         DynwaveSolver == PICARD_SOLVER);
+    double startTime = 0.0;            // wall clock time at start (sec)
+    double localTime = 0.0;            // wall clock time of local steps (sec)
 
     // --- initialize
     if ( ErrorCode ) return 0;
+    if ( useClasses ) startTime = profile_getClock();
+    initRoutingStep();
+    MaxClass = 0;
+    if ( useClasses ) findStepClasses(tStep);
+
+    // --- solve for all nodes & links over the full time step
+    StepClass = 0;
+    ClassTime[0] = 0.0;
+    converged = findRoutingSolution(tStep);
+    steps = Steps;
+    if ( !converged ) updateConvergenceStats();
+
+    // --- re-solve nodes & links of finer step classes over local steps
+    if ( MaxClass > 0 )
+    {
+        localTime = profile_getClock();
+        refineStepClass(1, tStep / 2.0);
+        localTime = profile_getClock() - localTime;
+    }
+
+    // --- save final node flows to Node[]
+    for (p = 0; p < Nobjects[NODE]; p++)
+    {
+        i = NodeOrder[p];
+        Node[i].inflow = Xnode.inflow[p];
+        Node[i].outflow = Xnode.outflow[p];
+    }
+    if ( useClasses )
+    {
+        endLocalSteps(tStep);
+        stats_updateLocalStepTime(profile_getClock() - startTime, localTime);
+    }
+
+    //  --- identify any capacity-limited conduits
+    findLimitedLinks();
+    return steps;
+}
+
+//=============================================================================
+
+int findRoutingSolution(double dt)
+//
+//  Input:   dt = time step (sec)
+//  Output:  returns TRUE if the solution converged
+//  Purpose: iterates the solution for the flows & depths of the active
+//           nodes & links over a time step.
+//
+//  All iterations are made by one team of threads that each work on their
+//  own sub-domains. The steps that visit the whole network are made by the
+//  team's master thread, with the team meeting at a barrier before and
+//  after them, and every thread reads the shared loop variables (Steps and
+//  Converged) only while the master cannot be changing them.
+//
+{
     Steps = 0;
-    converged = FALSE;
     Omega = OMEGA;
-    initRoutingStep();
+    Converged = FALSE;
 
+#pragma omp parallel num_threads(DomainCount)
+{
     // --- keep iterating until convergence 
     while ( Steps < MaxTrials )
     {
         // --- execute a routing step & check for nodal convergence
         initNodeStates();
-        findLinkFlows(tStep);
-        converged = findNodeDepths(tStep);
-        Steps++;
-        if ( Steps > 1 )
-        {
-            if ( converged ) break;
+        findLinkFlows(dt);
+        if ( DynwaveSolver == NEWTON_SOLVER ) findNodeHeads(dt);
+        else findNodeDepths(dt);
 
-            // --- check if link calculations can be skipped in next step
-            findBypassedLinks();
+        // --- check if link calculations can be skipped in next step
+        //     (Newton iterations need current flows in all links)
+        #pragma omp master
+        {
+            Steps++;
+            if ( Steps > 1 && !Converged && DynwaveSolver == PICARD_SOLVER )
+            {
+                if ( ActiveSet && StepClass == 0 ) findActiveSet();
+                else findBypassedLinks();
+            }
         }
+        #pragma omp barrier
+        if ( Steps > 1 && Converged ) break;
     }
-    if ( !converged ) updateConvergenceStats();
-
-    //  --- identify any capacity-limited conduits
-    findLimitedLinks();
-    return Steps;
+    profile_mergeCounts();
+}
+    return Converged;
 }
 
 //=============================================================================
@@ -268,18 +901,38 @@ void updateConvergenceStats()
     int i;
     NonConvergeCount++;
     for (i = 0; i < Nobjects[NODE]; i++)
-        stats_updateConvergenceStats(i, Xnode[i].converged);
+        stats_updateConvergenceStats(i, Xnode.converged[NodePos[i]]);
 }
 
 //=============================================================================
 
 void   initRoutingStep()
 {
-    int i;
-    for (i = 0; i < Nobjects[NODE]; i++)
+    int i, p;
+    ActiveNodeCount = -1;
+    ActiveLinkCount = -1;
+    for (p = 0; p < Nobjects[NODE]; p++)
     {
-        Xnode[i].converged = FALSE;
-        Xnode[i].dYdT = 0.0;
+        i = NodeOrder[p];
+        Xnode.converged[p] = FALSE;
+        Xnode.dYdT[p] = 0.0;
+
+        // --- load node's state at start of time step
+        Xnode.newDepth[p] = Node[i].newDepth;
+        Xnode.oldDepth[p] = Node[i].oldDepth;
+        Xnode.oldNetInflow[p] = Node[i].oldNetInflow;
+
+        // --- lateral inflow & losses remain fixed over the time step
+        Xnode.latInflow[p] = 0.0;
+        Xnode.latOutflow[p] = Node[i].losses;
+        if ( Node[i].newLatFlow >= 0.0 )
+        {    
+            Xnode.latInflow[p] += Node[i].newLatFlow;
+        }
+        else
+        {    
+            Xnode.latOutflow[p] -= Node[i].newLatFlow;
+        }
     }
     for (i = 0; i < Nobjects[LINK]; i++)
     {
@@ -300,33 +953,36 @@ void initNodeStates()
 //  Output:  none
 //  Purpose: initializes node's surface area, inflow & outflow
 //
+//  Note: each thread initializes the nodes of its own sub-domains, which
+//        only it gathers flows to in findLinkFlows().
+//
 {
-    int i;
+    int  i, d, k, p;
+    int* start;
+    int* nodes = getNodeList(&start);
 
-    for (i = 0; i < Nobjects[NODE]; i++)
+    for (d = omp_get_thread_num(); d < DomainCount; d += omp_get_num_threads())
     {
-        // --- initialize nodal surface area
-        if ( AllowPonding )
-        {
-            Xnode[i].newSurfArea = node_getPondedArea(i, Node[i].newDepth);
-        }
-        else
+        for (k = start[d]; k < start[d+1]; k++)
         {
-            Xnode[i].newSurfArea = node_getSurfArea(i, Node[i].newDepth);
-        }
+            p = nodes ? nodes[k] : k;
+            i = NodeOrder[p];
 
-        // --- initialize nodal inflow & outflow
-        Node[i].inflow = 0.0;
-        Node[i].outflow = Node[i].losses;
-        if ( Node[i].newLatFlow >= 0.0 )
-        {    
-            Node[i].inflow += Node[i].newLatFlow;
-        }
-        else
-        {    
-            Node[i].outflow -= Node[i].newLatFlow;
+            // --- initialize nodal surface area
+            if ( AllowPonding )
+            {
+                Xnode.newSurfArea[p] = node_getPondedArea(i, Xnode.newDepth[p]);
+            }
+            else
+            {
+                Xnode.newSurfArea[p] = node_getSurfArea(i, Xnode.newDepth[p]);
+            }
+
+            // --- initialize nodal inflow & outflow
+            Xnode.inflow[p] = Xnode.latInflow[p];
+            Xnode.outflow[p] = Xnode.latOutflow[p];
+            Xnode.sumdqdh[p] = 0.0;
         }
-        Xnode[i].sumdqdh = 0.0;
     }
 }
 
@@ -337,8 +993,8 @@ void   findBypassedLinks()
     int i;
     for (i = 0; i < Nobjects[LINK]; i++)
     {
-        if ( Xnode[Link[i].node1].converged &&
-             Xnode[Link[i].node2].converged )
+        if ( Xnode.converged[NodePos[Link[i].node1]] &&
+             Xnode.converged[NodePos[Link[i].node2]] )
              Link[i].bypassed = TRUE;
         else Link[i].bypassed = FALSE;
     }
@@ -346,6 +1002,48 @@ void   findBypassedLinks()
 
 //=============================================================================
 
+void findActiveSet()
+//
+//  Input:   none
+//  Output:  none
+//  Purpose: finds the nodes & conduits to re-solve in the next iteration.
+//
+//  Links between two converged nodes are bypassed. The active nodes are
+//  those that have not converged, those at either end of a link that is
+//  not bypassed (whose inflow & outflow will change) and those attached
+//  to non-conduit links (whose flows are always re-accumulated). The
+//  inflow, outflow & depth of the remaining nodes stay as they are.
+//
+{
+    int i, k;
+
+    findBypassedLinks();
+    for (k = 0; k < Nobjects[NODE]; k++)
+    {
+        Xnode.active[k] = !Xnode.converged[k];
+    }
+    for (k = 0; k < NcNodeCount; k++) Xnode.active[NcNodes[k]] = TRUE;
+
+    ActiveLinkCount = 0;
+    for (k = 0; k < Nobjects[LINK]; k++)
+    {
+        i = LinkOrder[k];
+        if ( Link[i].bypassed ) continue;
+        Xnode.active[NodePos[Link[i].node1]] = TRUE;
+        Xnode.active[NodePos[Link[i].node2]] = TRUE;
+        if ( isTrueConduit(i) ) ActiveLinks[ActiveLinkCount++] = k;
+    }
+
+    ActiveNodeCount = 0;
+    for (k = 0; k < Nobjects[NODE]; k++)
+    {
+        if ( Xnode.active[k] ) ActiveNodes[ActiveNodeCount++] = k;
+    }
+    findActiveRanges();
+}
+
+//=============================================================================
+
 void  findLimitedLinks()
 //
 //  Input:   none
@@ -381,34 +1079,64 @@ void  findLimitedLinks()
 
 void findLinkFlows(double dt)
 {
-    int i;
-
-    // --- find new flow in each non-dummy conduit
-#pragma omp parallel num_threads(NumThreads)
-{
-    #pragma omp for
-    for ( i = 0; i < Nobjects[LINK]; i++)
+    int  i, d, k, j, q;
+    int* linkStart;
+    int* nodeStart;
+    int* links = getLinkList(&linkStart);
+    int* nodes = getNodeList(&nodeStart);
+
+    // --- find new flow in each non-dummy conduit of the thread's
+    //     sub-domains
+    for (d = omp_get_thread_num(); d < DomainCount; d += omp_get_num_threads())
     {
-        if ( isTrueConduit(i) && !Link[i].bypassed )
-            dwflow_findConduitFlow(i, Steps, Omega, dt);
+        for (k = linkStart[d]; k < linkStart[d+1]; k++)
+        {
+            q = links ? links[k] : k;
+            j = LinkOrder[q];
+            if ( isTrueConduit(j) && !Link[j].bypassed )
+            {
+                dwflow_findConduitFlow(j, Steps, Omega, dt);
+                packConduitState(q);
+            }
+        }
     }
-}
 
     // --- update inflow/outflows for nodes attached to non-dummy conduits
-    for ( i = 0; i < Nobjects[LINK]; i++)
+    //     once the flows in conduits cut from other sub-domains are known
+    //     (each node gathers from its own links in link order, so results
+    //     do not depend on the number of threads)
+    #pragma omp barrier
+    for (d = omp_get_thread_num(); d < DomainCount; d += omp_get_num_threads())
     {
-        if ( isTrueConduit(i) ) updateNodeFlows(i);
+        for (k = nodeStart[d]; k < nodeStart[d+1]; k++)
+        {
+            gatherNodeFlows(nodes ? nodes[k] : k);
+        }
     }
+    #pragma omp barrier
 
     // --- find new flows for all dummy conduits, pumps & regulators
-    for ( i = 0; i < Nobjects[LINK]; i++)
+    //     (their end nodes' flows are worked on directly in Node[] since
+    //     they are also used by link_getInflow() and node_getMaxOutflow())
+    if ( NcNodeCount == 0 ) return;
+    #pragma omp master
     {
-        if ( !isTrueConduit(i) )
+        copyNodeFlows(TRUE);
+        for ( i = 0; i < Nobjects[LINK]; i++)
         {
-            if ( !Link[i].bypassed ) findNonConduitFlow(i, dt);
-            updateNodeFlows(i);
+            if ( !isTrueConduit(i) )
+            {
+                // --- skip links whose end nodes are not being solved
+                if ( ActiveNodeCount >= 0 &&
+                     !Xnode.active[NodePos[Link[i].node1]] )
+                    continue;
+                if ( !Link[i].bypassed ) findNonConduitFlow(i, dt);
+                updateNodeFlows(i);
+            }
         }
+        copyNodeFlows(FALSE);
     }
+    #pragma omp barrier
 }
 
 //=============================================================================
@@ -492,7 +1220,7 @@ double getModPumpFlow(int i, double q, double dt)
       case TYPE3_PUMP:
          newNetInflow = Node[j].inflow - Node[j].outflow - q;
          netFlowVolume = 0.5 * (Node[j].oldNetInflow + newNetInflow ) * dt;
-         y = Node[j].oldDepth + netFlowVolume / Xnode[j].newSurfArea;
+         y = Node[j].oldDepth + netFlowVolume / Xnode.newSurfArea[NodePos[j]];
          if ( y <= 0.0 ) return Node[j].inflow;
     }
     return q;
@@ -528,64 +1256,186 @@ void  findNonConduitSurfArea(int i)
 void updateNodeFlows(int i)
 //
 //  Input:   i = link index
-//           q = link flow rate (cfs)
 //  Output:  none
 //  Purpose: updates cumulative inflow & outflow at link's end nodes.
 //
 {
-    int    k;
-    int    barrels = 1;
-    int    n1 = Link[i].node1;
-    int    n2 = Link[i].node2;
-    double q = Link[i].newFlow;
-    double conduitLossRate = 0.0;
+    updateNodeFlow(i, Link[i].node1);
+    if ( Link[i].node2 != Link[i].node1 ) updateNodeFlow(i, Link[i].node2);
+}
+
+//=============================================================================
 
-    // --- update total inflow & outflow at upstream/downstream nodes
-    if ( q >= 0.0 )
+void gatherNodeFlows(int n)
+//
+//  Input:   n = node position
+//  Output:  none
+//  Purpose: updates cumulative inflow & outflow at a node from all of the
+//           non-dummy conduits attached to it.
+//
+{
+    int    k, i;
+    double q;
+    double inflow = Xnode.inflow[n];
+    double outflow = Xnode.outflow[n];
+    double surfArea = Xnode.newSurfArea[n];
+    double sumdqdh = Xnode.sumdqdh[n];
+
+    for (k = NodeLinkStart[n]; k < NodeLinkStart[n+1]; k++)
     {
-        Node[n1].outflow += q;
-        Node[n2].inflow  += q;
+        i = NodeLinks[k] >> 1;
+        q = Xlink.flow[i];
+
+        // --- node is at conduit's upstream end
+        if ( (NodeLinks[k] & 1) == 0 )
+        {
+            if ( q >= 0.0 ) outflow += q;
+            else            inflow  -= q;
+            if ( Xlink.loss1[i] > 0.0 ) outflow += Xlink.loss1[i];
+            surfArea += Xlink.surfArea1[i];
+        }
+
+        // --- node is at conduit's downstream end
+        else
+        {
+            if ( q >= 0.0 ) inflow  += q;
+            else            outflow -= q;
+            if ( Xlink.loss2[i] > 0.0 ) outflow += Xlink.loss2[i];
+            surfArea += Xlink.surfArea2[i];
+        }
+        sumdqdh += Xlink.dqdh[i];
     }
-    else
+    Xnode.inflow[n] = inflow;
+    Xnode.outflow[n] = outflow;
+    Xnode.newSurfArea[n] = surfArea;
+    Xnode.sumdqdh[n] = sumdqdh;
+}
+
+//=============================================================================
+
+void packConduitState(int j)
+//
+//  Input:   j = position of a non-dummy conduit
+//  Output:  none
+//  Purpose: saves the conduit results that its end nodes gather.
+//
+{
+    int    i = LinkOrder[j];
+    int    k = Link[i].subIndex;
+    int    n1 = Link[i].node1;
+    int    n2 = Link[i].node2;
+    int    barrels = Conduit[k].barrels;
+    double lossRate;
+
+    // --- uniform evap & seepage loss from conduit
+    //     (outfall nodes do not share evap & seepage losses)
+    lossRate = (Conduit[k].evapLossRate + Conduit[k].seepLossRate) * barrels;
+    if (Node[n1].type != OUTFALL && Node[n2].type != OUTFALL) lossRate /= 2.0;
+
+    Xlink.flow[j] = Link[i].newFlow;
+    Xlink.dqdh[j] = Link[i].dqdh;
+    Xlink.surfArea1[j] = Link[i].surfArea1 * barrels;
+    Xlink.surfArea2[j] = Link[i].surfArea2 * barrels;
+    Xlink.loss1[j] = (Node[n1].type != OUTFALL) ? lossRate : 0.0;
+    Xlink.loss2[j] = (Node[n2].type != OUTFALL) ? lossRate : 0.0;
+}
+
+//=============================================================================
+
+void copyNodeFlows(int toNodes)
+//
+//  Input:   toNodes = TRUE to copy packed flows to Node[], FALSE to copy back
+//  Output:  none
+//  Purpose: exchanges inflow & outflow between the packed node state and
+//           Node[] for the nodes attached to non-conduit links.
+//
+{
+    int k, n, p;
+
+    for (k = 0; k < NcNodeCount; k++)
     {
-        Node[n1].inflow   -= q;
-        Node[n2].outflow  -= q;
+        p = NcNodes[k];
+        n = NodeOrder[p];
+        if ( toNodes )
+        {
+            Node[n].inflow = Xnode.inflow[p];
+            Node[n].outflow = Xnode.outflow[p];
+        }
+        else
+        {
+            Xnode.inflow[p] = Node[n].inflow;
+            Xnode.outflow[p] = Node[n].outflow;
+        }
     }
- 
-    // --- add any uniform evap & seepage loss from conduit link
+}
+
+//=============================================================================
+
+void updateNodeFlow(int i, int n)
+//
+//  Input:   i = link index
+//           n = index of one of the link's end nodes
+//  Output:  none
+//  Purpose: updates cumulative inflow & outflow at one end node of a link.
+//
+{
+    int    k;
+    int    barrels = 1;
+    int    n1 = Link[i].node1;
+    int    n2 = Link[i].node2;
+    double q = Link[i].newFlow;
+    double conduitLossRate = 0.0;
+
+    // --- find any uniform evap & seepage loss rate from conduit link
     if ( Link[i].type == CONDUIT )
     {
         k = Link[i].subIndex;
         barrels = Conduit[k].barrels;
         conduitLossRate = (Conduit[k].evapLossRate + Conduit[k].seepLossRate) *
                           barrels;
-        if (conduitLossRate > 0.0)
-        {
-            // --- outfall nodes do not share evap & seepage losses
-            if (Node[n1].type != OUTFALL && Node[n2].type != OUTFALL)
-                conduitLossRate /= 2.0;
-            if (Node[n1].type != OUTFALL)
-                Node[n1].outflow += conduitLossRate;
-            if (Node[n2].type != OUTFALL)
-                Node[n2].outflow += conduitLossRate;
-        }
+
+        // --- outfall nodes do not share evap & seepage losses
+        if (Node[n1].type != OUTFALL && Node[n2].type != OUTFALL)
+            conduitLossRate /= 2.0;
     }
-    
-    // --- add surf. area contributions to upstream/downstream nodes
-    Xnode[Link[i].node1].newSurfArea += Link[i].surfArea1 * barrels;
-    Xnode[Link[i].node2].newSurfArea += Link[i].surfArea2 * barrels;
 
-    // --- update summed value of dqdh at each end node
-    Xnode[Link[i].node1].sumdqdh += Link[i].dqdh;
-    if ( Link[i].type == PUMP )
+    // --- link's upstream node
+    if ( n == n1 )
     {
-        k = Link[i].subIndex;
-        if ( Pump[k].type != TYPE4_PUMP )
+        // --- update total inflow & outflow
+        if ( q >= 0.0 ) Node[n1].outflow += q;
+        else            Node[n1].inflow  -= q;
+
+        // --- add conduit losses
+        if ( conduitLossRate > 0.0 && Node[n1].type != OUTFALL )
+            Node[n1].outflow += conduitLossRate;
+
+        // --- add surf. area contribution & dqdh
+        Xnode.newSurfArea[NodePos[n1]] += Link[i].surfArea1 * barrels;
+        Xnode.sumdqdh[NodePos[n1]] += Link[i].dqdh;
+    }
+
+    // --- link's downstream node
+    if ( n == n2 )
+    {
+        // --- update total inflow & outflow
+        if ( q >= 0.0 ) Node[n2].inflow  += q;
+        else            Node[n2].outflow -= q;
+
+        // --- add conduit losses
+        if ( conduitLossRate > 0.0 && Node[n2].type != OUTFALL )
+            Node[n2].outflow += conduitLossRate;
+
+        // --- add surf. area contribution & dqdh
+        Xnode.newSurfArea[NodePos[n2]] += Link[i].surfArea2 * barrels;
+        if ( Link[i].type == PUMP )
         {
-            Xnode[n2].sumdqdh += Link[i].dqdh;
+            k = Link[i].subIndex;
+            if ( Pump[k].type != TYPE4_PUMP )
+                Xnode.sumdqdh[NodePos[n2]] += Link[i].dqdh;
         }
+        else Xnode.sumdqdh[NodePos[n2]] += Link[i].dqdh;
     }
-    else Xnode[n2].sumdqdh += Link[i].dqdh;
 }
 
 //=============================================================================
@@ -598,37 +1448,59 @@ int findNodeDepths(double dt)
 //  Purpose: finds new depth at all nodes and checks if convergence achieved.
 //
 {
-    int i;
-    double yOld = 0.0;       // previous node depth (ft)
+    int    i, d, k, j, p;
+    int    domainConverged = TRUE;
+    int*   start;
+    int*   nodes = getNodeList(&start);
+    double yOld;                       // previous node depth (ft)
 
     // --- compute outfall depths based on flow in connecting link
-    for ( i = 0; i < Nobjects[LINK]; i++ ) link_setOutfallDepth(i);
+    #pragma omp master
+    {
+        for ( i = 0; i < Nobjects[LINK]; i++ )
+        {
+            if ( ActiveNodeCount >= 0 &&
+                 !Xnode.active[NodePos[Link[i].node1]] &&
+                 !Xnode.active[NodePos[Link[i].node2]] ) continue;
+            link_setOutfallDepth(i);
+        }
+        Converged = TRUE;
+    }
+    #pragma omp barrier
 
-    // --- compute new depth for all non-outfall nodes and determine if
-    //     depth change from previous iteration is below tolerance
-#pragma omp parallel num_threads(NumThreads)
-{
-    #pragma omp for private(yOld)
-    for ( i = 0; i < Nobjects[NODE]; i++ )
+    // --- compute new depth for all active non-outfall nodes and determine
+    //     if depth change from previous iteration is below tolerance
+    //     (inactive nodes have already converged)
+    for (d = omp_get_thread_num(); d < DomainCount; d += omp_get_num_threads())
     {
-        if ( Node[i].type == OUTFALL ) continue;
-        yOld = Node[i].newDepth;
-        setNodeDepth(i, dt);
-        Xnode[i].converged = TRUE;
-        if ( fabs(yOld - Node[i].newDepth) > HeadTol )
+        for (k = start[d]; k < start[d+1]; k++)
         {
-            Xnode[i].converged = FALSE;
+            p = nodes ? nodes[k] : k;
+            j = NodeOrder[p];
+            if ( Node[j].type == OUTFALL )
+            {
+                Xnode.newDepth[p] = Node[j].newDepth;
+                continue;
+            }
+            yOld = Xnode.newDepth[p];
+            setNodeDepth(j, dt);
+            Xnode.converged[p] = TRUE;
+            if ( fabs(yOld - Xnode.newDepth[p]) > HeadTol )
+            {
+                Xnode.converged[p] = FALSE;
+                domainConverged = FALSE;
+            }
         }
     }
-}
 
-   // --- return FALSE if any non-Outfall node failed to converge
-    for (i = 0; i < Nobjects[NODE]; i++)
+    // --- return FALSE if any non-Outfall node failed to converge
+    if ( !domainConverged )
     {
-        if ( Node[i].type == OUTFALL ) continue;
-        if (Xnode[i].converged == FALSE) return FALSE;
+        #pragma omp atomic write
+        Converged = FALSE;
     }
-    return TRUE;
+    #pragma omp barrier
+    return Converged;
 }
 
 //=============================================================================
@@ -641,13 +1513,13 @@ void setNodeDepth(int i, double dt)
 //  Purpose: sets depth at non-outfall node after current time step.
 //
 {
+    int     p = NodePos[i];            // node position
     int     canPond;                   // TRUE if node can pond overflows
     int     isPonded;                  // TRUE if node is currently ponded 
-    int     isSurcharged = FALSE;      // TRUE if node is surcharged
+    int     isSurcharged;              // TRUE if node is surcharged
     double  dQ;                        // inflow minus outflow at node (cfs)
     double  dV;                        // change in node volume (ft3)
     double  dy;                        // change in node depth (ft)
-    double  yMax;                      // max. depth at node (ft)
     double  yOld;                      // node depth at previous time step (ft)
     double  yLast;                     // previous node depth (ft)
     double  yNew;                      // new node depth (ft)
@@ -659,36 +1531,22 @@ void setNodeDepth(int i, double dt)
 
     // --- see if node can pond water above it
     canPond = (AllowPonding && Node[i].pondedArea > 0.0);
-    isPonded = (canPond && Node[i].newDepth > Node[i].fullDepth);
+    isPonded = (canPond && Xnode.newDepth[p] > Node[i].fullDepth);
 
     // --- initialize values
     yCrown = Node[i].crownElev - Node[i].invertElev;
-    yOld = Node[i].oldDepth;
-    yLast = Node[i].newDepth;
+    yOld = Xnode.oldDepth[p];
+    yLast = Xnode.newDepth[p];
     Node[i].overflow = 0.0;
-    surfArea = Xnode[i].newSurfArea;
+    surfArea = Xnode.newSurfArea[p];
     surfArea = MAX(surfArea, MinSurfArea);
     
     // --- determine average net flow volume into node over the time step
-    dQ = Node[i].inflow - Node[i].outflow;
-    dV = 0.5 * (Node[i].oldNetInflow + dQ) * dt;
+    dQ = Xnode.inflow[p] - Xnode.outflow[p];
+    dV = 0.5 * (Xnode.oldNetInflow[p] + dQ) * dt;
 
     // --- determine if node is EXTRAN surcharged
-    if (SurchargeMethod == EXTRAN)
-    {
-        // --- ponded nodes don't surcharge
-        if (isPonded) isSurcharged = FALSE;
-
-        // --- closed storage units that are full are in surcharge
-        else if (Node[i].type == STORAGE)
-        {
-            isSurcharged = (Node[i].surDepth > 0.0 &&
-                            yLast > Node[i].fullDepth);
-        }
-
-        // --- surcharge occurs when node depth exceeds top of its highest link
-        else isSurcharged = (yCrown > 0.0 && yLast > yCrown);
-    }
+    isSurcharged = isNodeSurcharged(i, isPonded, yLast);
 
     // --- if node not surcharged, base depth change on surface area        
     if (!isSurcharged)
@@ -697,7 +1555,7 @@ void setNodeDepth(int i, double dt)
         yNew = yOld + dy;
 
         // --- save non-ponded surface area for use in surcharge algorithm
-        if ( !isPonded ) Xnode[i].oldSurfArea = surfArea;
+        if ( !isPonded ) Xnode.oldSurfArea[p] = surfArea;
 
         // --- apply under-relaxation to new depth estimate
         if ( Steps > 0 )
@@ -721,12 +1579,12 @@ void setNodeDepth(int i, double dt)
 
         // --- allow surface area from last non-surcharged condition
         //     to influence dqdh if depth close to crown depth
-        denom = Xnode[i].sumdqdh;
+        denom = Xnode.sumdqdh[p];
         if ( yLast < 1.25 * yCrown )
         {
             f = (yLast - yCrown) / yCrown;
-            denom += (Xnode[i].oldSurfArea/dt -
-                      Xnode[i].sumdqdh) * exp(-15.0 * f);
+            denom += (Xnode.oldSurfArea[p]/dt -
+                      Xnode.sumdqdh[p]) * exp(-15.0 * f);
         }
 
         // --- compute new estimate of node depth
@@ -740,6 +1598,55 @@ void setNodeDepth(int i, double dt)
             yNew = Node[i].fullDepth + FUDGE;
     }
 
+    saveNodeDepth(i, canPond, dV, yNew, dt);
+}
+
+//=============================================================================
+
+int isNodeSurcharged(int i, int isPonded, double y)
+//
+//  Input:   i  = node index
+//           isPonded = TRUE if water is currently ponded at node
+//           y = current node depth (ft)
+//  Output:  returns TRUE if node is surcharged under the EXTRAN method
+//  Purpose: determines if a node's depth change should be based on the
+//           balance of its inflow and outflow rather than its surface area.
+//
+{
+    double yCrown;                     // depth to node crown (ft)
+
+    if (SurchargeMethod != EXTRAN) return FALSE;
+
+    // --- ponded nodes don't surcharge
+    if (isPonded) return FALSE;
+
+    // --- closed storage units that are full are in surcharge
+    if (Node[i].type == STORAGE)
+    {
+        return (Node[i].surDepth > 0.0 && y > Node[i].fullDepth);
+    }
+
+    // --- surcharge occurs when node depth exceeds top of its highest link
+    yCrown = Node[i].crownElev - Node[i].invertElev;
+    return (yCrown > 0.0 && y > yCrown);
+}
+
+//=============================================================================
+
+void saveNodeDepth(int i, int canPond, double dV, double yNew, double dt)
+//
+//  Input:   i  = node index
+//           canPond = TRUE if water can pond over node
+//           dV = change in volume over time step (ft3)
+//           yNew = new depth at node (ft)
+//           dt = time step (sec)
+//  Output:  none
+//  Purpose: saves the new depth, volume & overflow of a non-outfall node.
+//
+{
+    int     p = NodePos[i];            // node position
+    double  yMax;                      // max. depth at node (ft)
+
     // --- depth cannot be negative
     if ( yNew < 0 ) yNew = 0.0;
 
@@ -755,9 +1662,11 @@ void setNodeDepth(int i, double dt)
     else Node[i].newVolume = node_getVolume(i, yNew);
 
     // --- compute change in depth w.r.t. time
-    Xnode[i].dYdT = fabs(yNew - yOld) / dt;
+    Xnode.dYdT[p] = fabs(yNew - Xnode.oldDepth[p]) / dt;
 
     // --- save new depth for node
+    //     (Node[].newDepth is kept current for the link & node routines)
+    Xnode.newDepth[p] = yNew;
     Node[i].newDepth = yNew;
 }
 
@@ -796,6 +1705,206 @@ double getFloodedDepth(int i, int canPond, double dV, double yNew,
 
 //=============================================================================
 
+int findNodeHeads(double dt)
+//
+//  Input:   dt = time step (sec)
+//  Output:  returns TRUE if depth change at all non-Outfall nodes is 
+//           within the convergence tolerance and FALSE otherwise
+//  Purpose: finds new depth at all nodes with a Newton iteration on the
+//           continuity equations of all non-outfall nodes and checks if
+//           convergence achieved.
+//
+//  Each iteration updates the conduit flows without under-relaxation and
+//  solves for the change in all heads at once (see solveHeadChanges()).
+//  Conduit momentum is still updated explicitly, so time steps keep a
+//  Courant limit, relaxed by a factor of NEWTON_COURANT.
+//
+{
+    int    d, j, p;
+    int    domainConverged = TRUE;
+    double y;                          // previous node depth (ft)
+
+    // --- solve for the change in head at each node
+    //     (use a Picard iteration if the system can't be solved)
+    #pragma omp master
+    {
+        HeadSolved = solveHeadChanges(dt);
+        Converged = TRUE;
+    }
+    #pragma omp barrier
+    if ( !HeadSolved ) return findNodeDepths(dt);
+
+    // --- update depth at all non-outfall nodes and determine if
+    //     depth change from previous iteration is below tolerance
+    for (d = omp_get_thread_num(); d < DomainCount; d += omp_get_num_threads())
+    {
+        for (p = DomainNodeStart[d]; p < DomainNodeStart[d+1]; p++)
+        {
+            j = NodeOrder[p];
+            if ( Node[j].type == OUTFALL ) continue;
+            y = Xnode.newDepth[p];
+            setNodeHead(j, y + HeadRhs[j], dt);
+            Xnode.converged[p] = TRUE;
+            if ( fabs(y - Xnode.newDepth[p]) > HeadTol )
+            {
+                Xnode.converged[p] = FALSE;
+                domainConverged = FALSE;
+            }
+        }
+    }
+
+    // --- return FALSE if any non-Outfall node failed to converge
+    if ( !domainConverged )
+    {
+        #pragma omp atomic write
+        Converged = FALSE;
+    }
+    #pragma omp barrier
+    return Converged;
+}
+
+//=============================================================================
+
+int solveHeadChanges(double dt)
+//
+//  Input:   dt = time step (sec)
+//  Output:  returns TRUE if the change in head at each node was found
+//  Purpose: builds and solves the linearized continuity equations of all
+//           non-outfall nodes for the change in their heads (left in
+//           HeadRhs).
+//
+//  The continuity residual of node i is
+//      R(i) = A(i) * (y(i) - yOld(i)) - 0.5 * (netInflowOld(i) +
+//             netInflow(i)) * dt
+//  where A is the node's surface area, or R(i) = -0.5 * netInflow(i) * dt
+//  for a node surcharged under the EXTRAN method. Since a conduit's flow
+//  changes by dqdh per unit change in (h1 - h2), its coefficients in the
+//  Jacobian of R are 0.5*dt*dqdh on the diagonal of each end node and
+//  -0.5*dt*dqdh between them (scaled by the under-relaxation applied to
+//  conduit flows). Other types of links only add their dqdh to the
+//  diagonal.
+//
+{
+    int    i, k, p;
+    int    canPond;                    // TRUE if node can pond overflows
+    int    isPonded;                   // TRUE if node is currently ponded
+    double surfArea;                   // node surface area (ft2)
+    double storage;                    // storage term of Jacobian (ft2)
+    double dQ;                         // inflow minus outflow at node (cfs)
+    double dV;                         // change in node volume (ft3)
+    double residual;                   // continuity residual (ft3)
+    double sumdqdh;                    // sum of dqdh from node's conduits
+    double yCrown;                     // depth to node crown (ft)
+    double yLast = 0.0;                // previous node depth (ft)
+    double w = (Steps > 0) ? Omega : 1.0;
+
+    // --- compute outfall depths based on flow in connecting link
+    for ( i = 0; i < Nobjects[LINK]; i++ ) link_setOutfallDepth(i);
+
+    // --- find each node's residual & diagonal coefficient
+    for ( i = 0; i < Nobjects[NODE]; i++ )
+    {
+        // --- outfall heads are fixed
+        p = NodePos[i];
+        HeadFixed[i] = TRUE;
+        HeadDiag[i] = 1.0;
+        HeadRhs[i] = 0.0;
+        if ( Node[i].type == OUTFALL )
+        {
+            Xnode.newDepth[p] = Node[i].newDepth;
+            continue;
+        }
+
+        yLast = Xnode.newDepth[p];
+        canPond = (AllowPonding && Node[i].pondedArea > 0.0);
+        isPonded = (canPond && yLast > Node[i].fullDepth);
+        surfArea = MAX(Xnode.newSurfArea[p], MinSurfArea);
+        dQ = Xnode.inflow[p] - Xnode.outflow[p];
+        dV = 0.5 * (Xnode.oldNetInflow[p] + dQ) * dt;
+
+        // --- a surcharged node has no storage, so its inflow must match
+        //     its outflow (surface area from its last non-surcharged state
+        //     only damps the change in head close to its crown)
+        if ( isNodeSurcharged(i, isPonded, yLast) )
+        {
+            residual = -0.5 * dQ * dt;
+            storage = MinSurfArea;
+            yCrown = Node[i].crownElev - Node[i].invertElev;
+            if ( yLast < 1.25 * yCrown )
+            {
+                storage = MAX(storage, Xnode.oldSurfArea[p] *
+                              exp(-15.0 * (yLast - yCrown) / yCrown));
+            }
+        }
+
+        // --- otherwise the change in its volume must match its net inflow
+        else
+        {
+            residual = surfArea * (yLast - Xnode.oldDepth[p]) - dV;
+            storage = surfArea;
+            if ( !isPonded ) Xnode.oldSurfArea[p] = surfArea;
+        }
+
+        // --- a flooded node that is still filling is cut off from its
+        //     neighbors, so its new depth is based on its own volume
+        //     balance and exceeds its max. depth, as with Picard iterations
+        if ( !canPond && residual < 0.0 &&
+             yLast >= Node[i].fullDepth + Node[i].surDepth )
+        {
+            HeadDiag[i] = storage;
+            HeadRhs[i] = -residual;
+            continue;
+        }
+
+        // --- diagonal must dominate the node's conduit coefficients
+        sumdqdh = 0.0;
+        for (k = NodeLinkStart[p]; k < NodeLinkStart[p+1]; k++)
+        {
+            sumdqdh += Xlink.dqdh[NodeLinks[k] >> 1];
+        }
+        HeadFixed[i] = FALSE;
+        HeadDiag[i] = storage + 0.5 * dt * w * MAX(Xnode.sumdqdh[p], sumdqdh);
+        HeadRhs[i] = -residual;
+    }
+
+    // --- find off-diagonal coefficient of each conduit between
+    //     nodes whose heads can change
+    for ( i = 0; i < Nobjects[LINK]; i++ )
+    {
+        HeadOffdiag[i] = 0.0;
+        if ( !isTrueConduit(i) ) continue;
+        if ( HeadFixed[Link[i].node1] || HeadFixed[Link[i].node2] ) continue;
+        HeadOffdiag[i] = -0.5 * dt * w * Xlink.dqdh[LinkPos[i]];
+    }
+
+    // --- solve for the change in head at each node
+    return sparse_solve(HeadSolver, HeadDiag, HeadOffdiag, HeadRhs);
+}
+
+//=============================================================================
+
+void setNodeHead(int i, double yNew, double dt)
+//
+//  Input:   i  = node index
+//           yNew = new depth at node from Newton iteration (ft)
+//           dt = time step (sec)
+//  Output:  none
+//  Purpose: sets depth at non-outfall node found by a Newton iteration.
+//
+{
+    int     p = NodePos[i];            // node position
+    int     canPond;                   // TRUE if node can pond overflows
+    double  dV;                        // change in node volume (ft3)
+
+    canPond = (AllowPonding && Node[i].pondedArea > 0.0);
+    Node[i].overflow = 0.0;
+    dV = 0.5 * (Xnode.oldNetInflow[p] + Xnode.inflow[p] - Xnode.outflow[p]) *
+         dt;
+    saveNodeDepth(i, canPond, dV, yNew, dt);
+}
+
+//=============================================================================
+
 double getVariableStep(double maxStep)
 //
 //  Input:   maxStep = user-supplied max. time step (sec)
@@ -809,10 +1918,25 @@ double getVariableStep(double maxStep)
     double tMin;                        // allowable time step (sec)
     double tMinLink;                    // allowable time step for links (sec)
     double tMinNode;                    // allowable time step for nodes (sec)
+    double f;                           // number of finest local steps
 
     // --- find stable time step for links & then nodes
+    //     (Newton iterations solve node heads implicitly but conduit
+    //     momentum explicitly, so they get a relaxed Courant limit)
+    //     (links in the finest local step class take 2^LocalStepClasses
+    //     steps of their own within the routing step)
     tMin = maxStep;
-    tMinLink = getLinkStep(tMin, &minLink);
+    if ( DynwaveSolver == NEWTON_SOLVER )
+    {
+        f = NEWTON_COURANT;
+        tMinLink = f * getLinkStep(tMin / f, &minLink);
+    }
+    else if ( LocalStepClasses > 0 )
+    {
+        f = (double)(1 << LocalStepClasses);
+        tMinLink = f * getLinkStep(tMin / f, &minLink);
+    }
+    else tMinLink = getLinkStep(tMin, &minLink);
     tMinNode = getNodeStep(tMinLink, &minNode);
 
     // --- use smaller of the link and node time step
@@ -842,35 +1966,18 @@ double getLinkStep(double tMin, int *minLink)
 //
 {
     int    i;                           // link index
-    int    k;                           // conduit index
-    double q;                           // conduit flow (cfs)
     double t;                           // time step (sec)
     double tLink = tMin;                // critical link time step (sec)
 
     // --- examine each conduit link
     for ( i = 0; i < Nobjects[LINK]; i++ )
     {
-        if ( Link[i].type == CONDUIT )
+        // --- update critical link time step
+        t = getCourantStep(i, CourantFactor);
+        if ( t < tLink )
         {
-            // --- skip conduits with negligible flow, area or Fr
-            k = Link[i].subIndex;
-            q = fabs(Link[i].newFlow) / Conduit[k].barrels;
-            if ( q <= FUDGE 
-            ||   Conduit[k].a1 <= FUDGE
-            ||   Link[i].froude <= 0.01 
-               ) continue;
-
-            // --- compute time step to satisfy Courant condition
-            t = Link[i].newVolume / Conduit[k].barrels / q;
-            t = t * Conduit[k].modLength / link_getLength(i);
-            t = t * Link[i].froude / (1.0 + Link[i].froude) * CourantFactor;
-
-            // --- update critical link time step
-            if ( t < tLink )
-            {
-                tLink = t;
-                *minLink = i;
-            }
+            tLink = t;
+            *minLink = i;
         }
     }
     return tLink;
@@ -878,6 +1985,38 @@ double getLinkStep(double tMin, int *minLink)
 
 //=============================================================================
 
+double getCourantStep(int i, double factor)
+//
+//  Input:   i = link index
+//           factor = safety factor applied to the Courant time step
+//  Output:  returns time step that satisfies the Courant condition for a
+//           conduit (sec), or BIG if the condition does not apply
+//  Purpose: finds the Courant time step of a conduit.
+//
+{
+    int    k;                           // conduit index
+    double q;                           // conduit flow (cfs)
+    double t;                           // time step (sec)
+
+    if ( Link[i].type != CONDUIT ) return BIG;
+
+    // --- skip conduits with negligible flow, area or Fr
+    k = Link[i].subIndex;
+    q = fabs(Link[i].newFlow) / Conduit[k].barrels;
+    if ( q <= FUDGE 
+    ||   Conduit[k].a1 <= FUDGE
+    ||   Link[i].froude <= 0.01 
+       ) return BIG;
+
+    // --- compute time step to satisfy Courant condition
+    t = Link[i].newVolume / Conduit[k].barrels / q;
+    t = t * Conduit[k].modLength / link_getLength(i);
+    t = t * Link[i].froude / (1.0 + Link[i].froude) * factor;
+    return t;
+}
+
+//=============================================================================
+
 double getNodeStep(double tMin, int *minNode)
 //
 //  Input:   tMin = critical time step found so far (sec)
@@ -906,7 +2045,7 @@ double getNodeStep(double tMin, int *minNode)
         // --- define max. allowable depth change using crown elevation
         maxDepth = (Node[i].crownElev - Node[i].invertElev) * 0.25;
         if ( maxDepth < FUDGE ) continue;
-        dYdT = Xnode[i].dYdT;
+        dYdT = Xnode.dYdT[NodePos[i]];
         if (dYdT < FUDGE ) continue;
 
         // --- compute time to reach max. depth & compare with critical time
@@ -919,3 +2058,285 @@ double getNodeStep(double tMin, int *minNode)
     }
     return tNode;
 }
+
+//=============================================================================
+
+void findStepClasses(double tStep)
+//
+//  Input:   tStep = routing time step (sec)
+//  Output:  none
+//  Purpose: assigns each node & link to a local time step class and saves
+//           their state at the start of the routing step.
+//
+//  A conduit's class is the number of times the routing step must be
+//  halved to meet its Courant condition (up to LocalStepClasses). A node's
+//  class is the finest class of its conduits, while a non-conduit link
+//  and its two end nodes all take the finer class of the two nodes.
+//
+{
+    int    i, c, n1, n2;
+    int    changed;
+    double t;
+    double factor = (CourantFactor > 0.0) ? CourantFactor : 1.0;
+
+    // --- find class of each conduit & raise its end nodes to it
+    for (i = 0; i < Nobjects[NODE]; i++) Xclass.nodeClass[i] = 0;
+    for (i = 0; i < Nobjects[LINK]; i++)
+    {
+        c = 0;
+        if ( isTrueConduit(i) )
+        {
+            t = getCourantStep(i, factor);
+            while ( c < LocalStepClasses && t * (double)(1 << c) < tStep ) c++;
+        }
+        Xclass.linkClass[i] = (char)c;
+        n1 = Link[i].node1;
+        n2 = Link[i].node2;
+        Xclass.nodeClass[n1] = (char)MAX(Xclass.nodeClass[n1], c);
+        Xclass.nodeClass[n2] = (char)MAX(Xclass.nodeClass[n2], c);
+    }
+
+    // --- give non-conduit links the same class as their end nodes
+    do
+    {
+        changed = FALSE;
+        for (i = 0; i < Nobjects[LINK]; i++)
+        {
+            if ( isTrueConduit(i) ) continue;
+            n1 = Link[i].node1;
+            n2 = Link[i].node2;
+            c = MAX(Xclass.nodeClass[n1], Xclass.nodeClass[n2]);
+            Xclass.linkClass[i] = (char)c;
+            if ( Xclass.nodeClass[n1] != c || Xclass.nodeClass[n2] != c )
+            {
+                Xclass.nodeClass[n1] = (char)c;
+                Xclass.nodeClass[n2] = (char)c;
+                changed = TRUE;
+            }
+        }
+    } while ( changed );
+
+    // --- save node & link state at start of step
+    MaxClass = 0;
+    for (i = 0; i < Nobjects[NODE]; i++)
+    {
+        MaxClass = MAX(MaxClass, Xclass.nodeClass[i]);
+        Xclass.oldDepth[i] = Node[i].oldDepth;
+        Xclass.oldVolume[i] = Node[i].oldVolume;
+        Xclass.oldNetInflow[i] = Node[i].oldNetInflow;
+        Xclass.inflowVol[i] = 0.0;
+        Xclass.outflowVol[i] = 0.0;
+        Xclass.overflowVol[i] = 0.0;
+    }
+    for (i = 0; i < Nobjects[LINK]; i++) Xclass.oldFlow[i] = Link[i].oldFlow;
+}
+
+//=============================================================================
+
+void refineStepClass(int stepClass, double dt)
+//
+//  Input:   stepClass = local time step class
+//           dt = local time step of the class (sec)
+//  Output:  none
+//  Purpose: solves for the nodes & links of a step class and all finer
+//           classes over two local time steps that span the time step of
+//           the next coarser class.
+//
+//  After the whole network is solved over the routing step, the nodes &
+//  links of class 1 and finer are solved again over two half steps, those
+//  of class 2 and finer over two quarter steps within each half step, and
+//  so on. Links of a coarser class are not solved again; their flows vary
+//  linearly over their own step (see setActiveClass()), so both end nodes
+//  of such a link see the same volume pass through it.
+//
+{
+    int k;
+
+    for (k = 0; k < 2; k++)
+    {
+        ClassTime[stepClass] = ClassTime[stepClass-1] + k * dt;
+        setActiveClass(stepClass, k == 0, dt);
+        StepClass = stepClass;
+        findRoutingSolution(dt);
+        addClassFlows(stepClass, dt);
+        if ( stepClass < MaxClass ) refineStepClass(stepClass + 1, dt / 2.0);
+    }
+}
+
+//=============================================================================
+
+void setActiveClass(int stepClass, int restart, double dt)
+//
+//  Input:   stepClass = local time step class
+//           restart = TRUE if solution starts over from the beginning of
+//                     the coarser class's time step
+//           dt = local time step of the class (sec)
+//  Output:  none
+//  Purpose: makes the nodes & links of a step class and all finer classes
+//           the active ones and sets their state at the start of their
+//           next local time step.
+//
+{
+    int    i, j, k, c, p;
+    double barrels;
+    double f;                          // fraction of coarser link's step
+
+    // --- list the active nodes & conduits
+    ActiveNodeCount = 0;
+    for (p = 0; p < Nobjects[NODE]; p++)
+    {
+        i = NodeOrder[p];
+        Xnode.active[p] = (Xclass.nodeClass[i] >= stepClass);
+        if ( Xnode.active[p] ) ActiveNodes[ActiveNodeCount++] = p;
+    }
+    ActiveLinkCount = 0;
+    for (j = 0; j < Nobjects[LINK]; j++)
+    {
+        i = LinkOrder[j];
+        if ( Xclass.linkClass[i] < stepClass ) continue;
+        if ( isTrueConduit(i) ) ActiveLinks[ActiveLinkCount++] = j;
+        Link[i].bypassed = FALSE;
+
+        // --- restart from, or advance, the link's old flow & area
+        if ( Link[i].type == CONDUIT ) k = Link[i].subIndex;
+        else k = -1;
+        if ( restart )
+        {
+            Link[i].newFlow = Link[i].oldFlow;
+            if ( k >= 0 )
+            {
+                barrels = Conduit[k].barrels;
+                Conduit[k].q1 = Link[i].oldFlow / barrels;
+                Conduit[k].q2 = Conduit[k].q1;
+                Conduit[k].a1 = Conduit[k].a2;
+            }
+        }
+        else
+        {
+            Link[i].oldFlow = Link[i].newFlow;
+            if ( k >= 0 ) Conduit[k].a2 = Conduit[k].a1;
+        }
+    }
+    findActiveRanges();
+
+    // --- restart from, or advance, each active node's old state
+    for (k = 0; k < ActiveNodeCount; k++)
+    {
+        p = ActiveNodes[k];
+        i = NodeOrder[p];
+        if ( restart )
+        {
+            Node[i].newDepth = Node[i].oldDepth;
+            Node[i].newVolume = Node[i].oldVolume;
+        }
+        else
+        {
+            Node[i].oldDepth = Node[i].newDepth;
+            Node[i].oldVolume = Node[i].newVolume;
+            Node[i].oldNetInflow = Xnode.inflow[p] - Xnode.outflow[p];
+        }
+        Xnode.newDepth[p] = Node[i].newDepth;
+        Xnode.oldDepth[p] = Node[i].oldDepth;
+        Xnode.oldNetInflow[p] = Node[i].oldNetInflow;
+        Xnode.converged[p] = FALSE;
+
+        // --- set overflow to any excess stored volume
+        //     (as is done at the start of each routing step)
+        Node[i].overflow = 0.0;
+        if ( Node[i].type != STORAGE &&
+             Node[i].newVolume > Node[i].fullVolume )
+        {
+            Node[i].overflow = (Node[i].newVolume - Node[i].fullVolume) / dt;
+        }
+    }
+
+    // --- active nodes see the flow in a conduit of a coarser class at the
+    //     end of the local step interpolated between the flows at the
+    //     start & end of the conduit's own step
+    for (i = 0; i < Nobjects[LINK]; i++)
+    {
+        c = Xclass.linkClass[i];
+        if ( c >= stepClass || !isTrueConduit(i) ) continue;
+        if ( !Xnode.active[NodePos[Link[i].node1]] &&
+             !Xnode.active[NodePos[Link[i].node2]] ) continue;
+        f = (ClassTime[stepClass] + dt - ClassTime[c]) /
+            (dt * (double)(1 << (stepClass - c)));
+        Xlink.flow[LinkPos[i]] = Link[i].oldFlow +
+                                 f * (Link[i].newFlow - Link[i].oldFlow);
+    }
+}
+
+//=============================================================================
+
+void addClassFlows(int stepClass, double dt)
+//
+//  Input:   stepClass = local time step class
+//           dt = local time step of the class (sec)
+//  Output:  none
+//  Purpose: adds the flow volumes over a local time step of the nodes
+//           whose solution is found with that step to their totals over
+//           the routing step.
+//
+{
+    int i, k, p;
+
+    for (k = 0; k < ActiveNodeCount; k++)
+    {
+        p = ActiveNodes[k];
+        i = NodeOrder[p];
+        if ( Xclass.nodeClass[i] != stepClass ) continue;
+        Xclass.inflowVol[i] += Xnode.inflow[p] * dt;
+        Xclass.outflowVol[i] += Xnode.outflow[p] * dt;
+
+        // --- overflow from a ponded node stays in its ponded volume
+        if ( Node[i].newVolume <= Node[i].fullVolume )
+            Xclass.overflowVol[i] += Node[i].overflow * dt;
+    }
+}
+
+//=============================================================================
+
+void endLocalSteps(double tStep)
+//
+//  Input:   tStep = routing time step (sec)
+//  Output:  none
+//  Purpose: restores the state at the start of the routing step of nodes &
+//           links solved with local time steps and replaces the flows that
+//           leave the system at those nodes with their average values.
+//
+{
+    int    i;
+    double q;
+
+    for (i = 0; i < Nobjects[NODE]; i++)
+    {
+        if ( Xclass.nodeClass[i] == 0 ) continue;
+        Node[i].oldDepth = Xclass.oldDepth[i];
+        Node[i].oldVolume = Xclass.oldVolume[i];
+        Node[i].oldNetInflow = Xclass.oldNetInflow[i];
+
+        // --- a node ponded at the end of the step overflows at the rate its
+        //     ponded volume rose (as in getFloodedDepth()), any other node
+        //     at the rate of the volume it lost over all its local steps
+        if ( Node[i].newVolume > Node[i].fullVolume )
+        {
+            Node[i].overflow = (Node[i].newVolume -
+                MAX(Node[i].oldVolume, Node[i].fullVolume)) / tStep;
+            if ( Node[i].overflow < FUDGE ) Node[i].overflow = 0.0;
+        }
+        else Node[i].overflow = Xclass.overflowVol[i] / tStep;
+
+        // --- an outfall passes the net volume it received (flow through
+        //     it can reverse from one local step to the next)
+        if ( Node[i].type == OUTFALL )
+        {
+            q = (Xclass.inflowVol[i] - Xclass.outflowVol[i]) / tStep;
+            Node[i].inflow = MAX(q, 0.0);
+            Node[i].outflow = MAX(-q, 0.0);
+        }
+    }
+    for (i = 0; i < Nobjects[LINK]; i++)
+    {
+        if ( Xclass.linkClass[i] > 0 ) Link[i].oldFlow = Xclass.oldFlow[i];
+    }
+}
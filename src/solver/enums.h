@@ -33,6 +33,14 @@
 //   - Support added for analytical storage shapes.
 //   Build 5.2.1:
 //   - Adds a NEITHER option to the NormalFlowType enumeration. 
+//   Build 5.2.4+:
+//   - OUTPUT_LAYOUT option and OutputLayoutType enumeration added.
+//   - COMPRESSED_LAYOUT added to OutputLayoutType.
+//   - PROFILE_FILE option added.
+//   - DYNWAVE_SOLVER option and DynwaveSolverType enumeration added.
+//   - ACTIVE_SET option added.
+//   - LOCAL_STEP_CLASSES option added.
+//   - NETWORK_ORDERING option and NetworkOrderingType enumeration added.
 //-----------------------------------------------------------------------------
 
 #ifndef ENUMS_H
@@ -371,6 +379,22 @@ enum  CompatibilityType {
       EXTRAN,                          // original EXTRAN method
       SLOT};                           // Preissmann slot method
 
+ enum  DynwaveSolverType {
+      PICARD_SOLVER,                   // successive approximations of
+                                       // node depths
+      NEWTON_SOLVER};                  // Newton iterations on all node
+                                       // heads at once
+
+ enum  NetworkOrderingType {
+      INPUT_ORDERING,                  // nodes & links in input order
+      RCM_ORDERING};                   // reverse Cuthill-McKee order
+
+ enum  OutputLayoutType {
+      STANDARD_LAYOUT,                 // all results of a period together
+      COLUMNAR_LAYOUT,                 // each element's results over a chunk
+                                       // of periods together
+      COMPRESSED_LAYOUT};              // columnar results packed losslessly
+
  enum InflowType {
       EXTERNAL_INFLOW,                 // user-supplied external inflow
       DRY_WEATHER_INFLOW,              // user-supplied dry weather inflow
@@ -486,7 +510,9 @@ enum  CompatibilityType {
     IGNORE_SNOWMELT, IGNORE_GWATER, IGNORE_ROUTING,
     IGNORE_QUALITY, MAX_TRIALS, HEAD_TOL,
     SYS_FLOW_TOL, LAT_FLOW_TOL, IGNORE_RDII,
-    MIN_ROUTE_STEP, NUM_THREADS, SURCHARGE_METHOD};
+    MIN_ROUTE_STEP, NUM_THREADS, SURCHARGE_METHOD,
+    OUTPUT_LAYOUT, PROFILE_FILE, DYNWAVE_SOLVER,
+    ACTIVE_SET, LOCAL_STEP_CLASSES, NETWORK_ORDERING};
 
 enum  NoYesType {
       NO,
@@ -19,13 +19,16 @@
 //   Build 5.2.0:
 //   - Re-designed error message system.
 //   - Added new Error 235 for invalid infiltration parameters.
+//   Build 5.2.4+:
+//   - ErrString made per-thread so input lines can be parsed in parallel.
 //-----------------------------------------------------------------------------
 #define _CRT_SECURE_NO_DEPRECATE
 
 #include <string.h>
+#include "macros.h"
 #include "error.h"
 
-char  ErrString[256];
+WORKERLOCAL char  ErrString[256];
 
 char* error_getMsg(int errCode, char* msg)
 {
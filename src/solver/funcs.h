@@ -31,6 +31,8 @@
 //   - Refactored external inflow code.
 //   Build 5.2.4:
 //   - Additional arguments added to function link_getLossRate.
+//   Build 5.2.4+:
+//   - stats_updateLocalStepTime() added.
 //-----------------------------------------------------------------------------
 
 #ifndef FUNCS_H
@@ -43,6 +45,7 @@ void     project_open(const char *f1, const char *f2, const char *f3);
 void     project_close(void);
 
 void     project_readInput(void);
+int      project_readSnapshot(const char *f);
 int      project_readOption(char* s1, char* s2);
 void     project_validate(void);
 int      project_init(void);
@@ -60,6 +63,15 @@ void     project_freeMatrix(double** m);
 int     input_countObjects(void);
 int     input_readData(void);
 
+//-----------------------------------------------------------------------------
+//   Snapshot Methods
+//-----------------------------------------------------------------------------
+int     snapshot_save(const char* f, long rptStart);
+int     snapshot_open(const char* f);
+int     snapshot_readCounts(void);
+int     snapshot_readObjects(void);
+void    snapshot_close(void);
+
 //-----------------------------------------------------------------------------
 //   Report Writer Methods
 //-----------------------------------------------------------------------------
@@ -165,6 +177,9 @@ void    output_readDateTime(long period, DateTime *aDate);
 void    output_readSubcatchResults(long period, int index);
 void    output_readNodeResults(int long, int index);
 void    output_readLinkResults(int long, int index);
+int     output_getResultCount(int objType);
+int     output_readBatch(int objType, int first, int count, long period,
+        long nPeriods, DateTime* days, float* x);
 
 //-----------------------------------------------------------------------------
 //   Groundwater Methods
@@ -224,6 +239,7 @@ double  flowrout_getRoutingStep(int routingModel, double fixedStep);
 int     flowrout_execute(int links[], int routingModel, double tStep);
 
 void    toposort_sortLinks(int links[]);
+void    toposort_getNodeLinks(int startPos[], int nodeLinks[]);
 int     kinwave_execute(int link, double* qin, double* qout, double tStep);
 
 void    dynwave_validate(void);
@@ -243,8 +259,10 @@ int     treatmnt_open(void);
 void    treatmnt_close(void);
 int     treatmnt_readExpression(char* tok[], int ntoks);
 void    treatmnt_delete(int node);
+void    treatmnt_deleteExpressions(void);
 void    treatmnt_treat(int node, double q, double v, double tStep);
-void    treatmnt_setInflow(double qIn, double wIn[]);
+void    treatmnt_setInflow(int node, double qIn, double wIn[]);
+void    treatmnt_findRemovals(double tStep);
 
 //-----------------------------------------------------------------------------
 //   Mass Balance Methods
@@ -257,6 +275,9 @@ void    massbal_updateRunoffTotals(int type, double v);
 void    massbal_updateLoadingTotals(int type, int pollut, double w);
 void    massbal_updateGwaterTotals(double vInfil, double vUpperEvap,
         double vLowerEvap, double vLowerPerc, double vGwater);
+void    massbal_beginPartialTotals(int thread);
+void    massbal_endPartialTotals(void);
+void    massbal_mergePartialTotals(void);
 void    massbal_updateRoutingTotals(double tStep);
 
 
@@ -284,6 +305,7 @@ void    stats_report(void);
 void    stats_updateCriticalTimeCount(int node, int link);
 void    stats_updateFlowStats(double tStep, DateTime aDate);
 void    stats_updateTimeStepStats(double tStep, int trialsCount, int steadyState);
+void    stats_updateLocalStepTime(double routingTime, double localTime);
 
 void    stats_updateSubcatchStats(int subcatch, double rainVol, 
         double runonVol, double evapVol, double infilVol,
@@ -382,8 +404,9 @@ void    inflow_initDwfPattern(int pattern);
 double  inflow_getExtInflow(TExtInflow* inflow, DateTime aDate);
 double  inflow_getDwfInflow(TDwfInflow* inflow, int m, int d, int h);
 
-void    inflow_deleteExtInflows(int node);
-void    inflow_deleteDwfInflows(int node);
+TExtInflow* inflow_createExtInflow(void);
+TDwfInflow* inflow_createDwfInflow(void);
+void    inflow_delete(void);
 
 //-----------------------------------------------------------------------------
 //   Routing Interface File Methods
@@ -396,6 +419,8 @@ int     iface_getIfaceNode(int index);
 double  iface_getIfaceFlow(int index);
 double  iface_getIfaceQual(int index, int pollut);
 void    iface_saveOutletResults(DateTime reportDate, FILE* file);
+void    iface_printOutletResults(DateTime reportDate, char** text, size_t* len,
+                                 size_t* size);
 
 //-----------------------------------------------------------------------------
 //   Hot Start File Methods
@@ -450,6 +475,10 @@ double  xsect_getdSdA(TXsect* xsect, double area);
 double  xsect_getAofY(TXsect* xsect, double y);
 double  xsect_getRofY(TXsect* xsect, double y);
 double  xsect_getWofY(TXsect* xsect, double y);
+void    xsect_getAofYBatch(TXsect* xsect[], double y[], double a[], int n);
+void    xsect_getWofYBatch(TXsect* xsect[], double y[], double w[], int n);
+void    xsect_getRofYBatch(TXsect* xsect[], double y[], double r[], int n);
+void    xsect_getSofABatch(TXsect* xsect[], double a[], double s[], int n);
 double  xsect_getYcrit(TXsect* xsect, double q);
 
 //-----------------------------------------------------------------------------
@@ -527,6 +556,7 @@ double  table_getStorageDepth(TTable* table, double v);
 
 void    table_tseriesInit(TTable *table);
 double  table_tseriesLookup(TTable* table, double t, char extend);
+double  table_tseriesValue(TTable* table, int* cursor, double t, char extend);
 
 //-----------------------------------------------------------------------------
 //   Utility Methods
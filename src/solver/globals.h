@@ -30,13 +30,20 @@
 //   - Fixes bug in summary statistics when Report Start date > Start Date.
 //   Build 5.2.0:
 //   - Support for relative file names added.
+//   Build 5.2.4+:
+//   - OutputLayout option added.
+//   - ProfileFile option added.
+//   - DynwaveSolver option added.
+//   - ActiveSet option added.
+//   - LocalStepClasses option added.
+//   - NetworkOrdering option added.
 //-----------------------------------------------------------------------------
 
 #ifndef GLOBALS_H
 #define GLOBALS_H
 
 
-EXTERN TFile
+EXTERN THREADLOCAL TFile
                   Finp,                     // Input file
                   Fout,                     // Output file
                   Frpt,                     // Report file
@@ -49,23 +56,24 @@ EXTERN TFile
                   Finflows,                 // Inflows routing file
                   Foutflows;                // Outflows routing file
 
-EXTERN long
+EXTERN THREADLOCAL long
                   Nperiods,                 // Number of reporting periods
                   TotalStepCount,           // Total routing steps used 
                   ReportStepCount,          // Reporting routing steps used
                   NonConvergeCount;         // Number of non-converging steps
 
-EXTERN char
+EXTERN THREADLOCAL char
                   Msg[MAXMSG+1],            // Text of output message
                   ErrorMsg[MAXMSG+1],       // Text of error message
                   Title[MAXTITLE][MAXMSG+1],// Project title
                   TempDir[MAXFNAME+1],      // Temporary file directory
+                  ProfileFile[MAXFNAME+1],  // Run time profile file
                   InpDir[MAXFNAME+1];       // Input file directory
 
-EXTERN TRptFlags
+EXTERN THREADLOCAL TRptFlags
                   RptFlags;                 // Reporting options
 
-EXTERN int
+EXTERN THREADLOCAL int
                   Nobjects[MAX_OBJ_TYPES],  // Number of each object type
                   Nnodes[MAX_NODE_TYPES],   // Number of each node sub-type
                   Nlinks[MAX_LINK_TYPES],   // Number of each link sub-type
@@ -76,6 +84,11 @@ EXTERN int
                   ForceMainEqn,             // Flow equation for force mains
                   LinkOffsets,              // Link offset convention
                   SurchargeMethod,          // EXTRAN or SLOT method 
+                  DynwaveSolver,            // PICARD or NEWTON solver
+                  ActiveSet,                // Re-solve only unconverged nodes
+                  LocalStepClasses,         // Max. DW local time step classes
+                  NetworkOrdering,          // INPUT or RCM DW solver ordering
+                  OutputLayout,             // Layout of results in output file
                   AllowPonding,             // Allow water to pond at nodes
                   InertDamping,             // Degree of inertial damping
                   NormalFlowLtd,            // Normal flow limited
@@ -101,7 +114,7 @@ EXTERN int
                   ExtPollutFlag,            // OWA EDIT - toolkit API for set external pollutant injection
                   NumEvents;                // Number of detailed events
 
-EXTERN double
+EXTERN THREADLOCAL double
                   RouteStep,                // Routing time step (sec)
                   MinRouteStep,             // Minimum variable time step (sec)
                   LengtheningStep,          // Time step for lengthening (sec)
@@ -118,7 +131,7 @@ EXTERN double
                   LatFlowTol,               // Tolerance for steady nodal inflow
                   CrownCutoff;              // Fractional pipe crown cutoff
 
-EXTERN DateTime
+EXTERN THREADLOCAL DateTime
                   StartDate,                // Starting date
                   StartTime,                // Starting time
                   StartDateTime,            // Starting Date+Time
@@ -129,7 +142,7 @@ EXTERN DateTime
                   ReportStartTime,          // Report start time
                   ReportStart;              // Report start Date+Time
 
-EXTERN double
+EXTERN THREADLOCAL double
                   ReportTime,               // Current reporting time (msec)
                   OldRunoffTime,            // Previous runoff time (msec)
                   NewRunoffTime,            // Current runoff time (msec)
@@ -138,36 +151,36 @@ EXTERN double
                   TotalDuration,            // Simulation duration (msec)
                   ElapsedTime;              // Current elapsed time (days)
 
-EXTERN TTemp      Temp;                     // Temperature data
-EXTERN TEvap      Evap;                     // Evaporation data
-EXTERN TWind      Wind;                     // Wind speed data
-EXTERN TSnow      Snow;                     // Snow melt data
-EXTERN TAdjust    Adjust;                   // Climate adjustments
+EXTERN THREADLOCAL TTemp      Temp;                     // Temperature data
+EXTERN THREADLOCAL TEvap      Evap;                     // Evaporation data
+EXTERN THREADLOCAL TWind      Wind;                     // Wind speed data
+EXTERN THREADLOCAL TSnow      Snow;                     // Snow melt data
+EXTERN THREADLOCAL TAdjust    Adjust;                   // Climate adjustments
 
-EXTERN TSnowmelt* Snowmelt;                 // Array of snow melt objects
-EXTERN TGage*     Gage;                     // Array of rain gages
-EXTERN TSubcatch* Subcatch;                 // Array of subcatchments
-EXTERN TAquifer*  Aquifer;                  // Array of groundwater aquifers
-EXTERN TUnitHyd*  UnitHyd;                  // Array of unit hydrographs
-EXTERN TNode*     Node;                     // Array of nodes
-EXTERN TOutfall*  Outfall;                  // Array of outfall nodes
-EXTERN TDivider*  Divider;                  // Array of divider nodes
-EXTERN TStorage*  Storage;                  // Array of storage nodes
-EXTERN TLink*     Link;                     // Array of links
-EXTERN TConduit*  Conduit;                  // Array of conduit links
-EXTERN TPump*     Pump;                     // Array of pump links
-EXTERN TOrifice*  Orifice;                  // Array of orifice links
-EXTERN TWeir*     Weir;                     // Array of weir links
-EXTERN TOutlet*   Outlet;                   // Array of outlet device links
-EXTERN TPollut*   Pollut;                   // Array of pollutants
-EXTERN TLanduse*  Landuse;                  // Array of landuses
-EXTERN TPattern*  Pattern;                  // Array of time patterns
-EXTERN TTable*    Curve;                    // Array of curve tables
-EXTERN TTable*    Tseries;                  // Array of time series tables
-EXTERN TTransect* Transect;                 // Array of transect data
-EXTERN TStreet*   Street;                   // Array of defined Street cross-sections
-EXTERN TShape*    Shape;                    // Array of custom conduit shapes
-EXTERN TEvent*    Event;                    // Array of routing events
+EXTERN THREADLOCAL TSnowmelt* Snowmelt;                 // Array of snow melt objects
+EXTERN THREADLOCAL TGage*     Gage;                     // Array of rain gages
+EXTERN THREADLOCAL TSubcatch* Subcatch;                 // Array of subcatchments
+EXTERN THREADLOCAL TAquifer*  Aquifer;                  // Array of groundwater aquifers
+EXTERN THREADLOCAL TUnitHyd*  UnitHyd;                  // Array of unit hydrographs
+EXTERN THREADLOCAL TNode*     Node;                     // Array of nodes
+EXTERN THREADLOCAL TOutfall*  Outfall;                  // Array of outfall nodes
+EXTERN THREADLOCAL TDivider*  Divider;                  // Array of divider nodes
+EXTERN THREADLOCAL TStorage*  Storage;                  // Array of storage nodes
+EXTERN THREADLOCAL TLink*     Link;                     // Array of links
+EXTERN THREADLOCAL TConduit*  Conduit;                  // Array of conduit links
+EXTERN THREADLOCAL TPump*     Pump;                     // Array of pump links
+EXTERN THREADLOCAL TOrifice*  Orifice;                  // Array of orifice links
+EXTERN THREADLOCAL TWeir*     Weir;                     // Array of weir links
+EXTERN THREADLOCAL TOutlet*   Outlet;                   // Array of outlet device links
+EXTERN THREADLOCAL TPollut*   Pollut;                   // Array of pollutants
+EXTERN THREADLOCAL TLanduse*  Landuse;                  // Array of landuses
+EXTERN THREADLOCAL TPattern*  Pattern;                  // Array of time patterns
+EXTERN THREADLOCAL TTable*    Curve;                    // Array of curve tables
+EXTERN THREADLOCAL TTable*    Tseries;                  // Array of time series tables
+EXTERN THREADLOCAL TTransect* Transect;                 // Array of transect data
+EXTERN THREADLOCAL TStreet*   Street;                   // Array of defined Street cross-sections
+EXTERN THREADLOCAL TShape*    Shape;                    // Array of custom conduit shapes
+EXTERN THREADLOCAL TEvent*    Event;                    // Array of routing events
 
 
 #endif //GLOBALS_H
@@ -60,30 +60,30 @@ static char* GWVarWords[] = {"HGW", "HSW", "HCB", "HGS", "KS", "K",
 //  Shared variables
 //-----------------------------------------------------------------------------
 //  NOTE: all flux rates are in ft/sec, all depths are in ft.
-static double    Area;            // subcatchment area (ft2)
-static double    Infil;           // infiltration rate from surface
-static double    MaxEvap;         // max. evaporation rate
-static double    AvailEvap;       // available evaporation rate
-static double    UpperEvap;       // evaporation rate from upper GW zone
-static double    LowerEvap;       // evaporation rate from lower GW zone
-static double    UpperPerc;       // percolation rate from upper to lower zone
-static double    LowerLoss;       // loss rate from lower GW zone
-static double    GWFlow;          // flow rate from lower zone to conveyance node
-static double    MaxUpperPerc;    // upper limit on UpperPerc
-static double    MaxGWFlowPos;    // upper limit on GWFlow when its positve
-static double    MaxGWFlowNeg;    // upper limit on GWFlow when its negative
-static double    FracPerv;        // fraction of surface that is pervious
-static double    TotalDepth;      // total depth of GW aquifer
-static double    Theta;           // moisture content of upper zone
-static double    HydCon;          // unsaturated hydraulic conductivity (ft/s)
-static double    Hgw;             // ht. of saturated zone
-static double    Hstar;           // ht. from aquifer bottom to node invert
-static double    Hsw;             // ht. from aquifer bottom to water surface
-static double    Tstep;           // current time step (sec)
-static TAquifer  A;               // aquifer being analyzed
-static TGroundwater* GW;          // groundwater object being analyzed
-static MathExpr* LatFlowExpr;     // user-supplied lateral GW flow expression
-static MathExpr* DeepFlowExpr;    // user-supplied deep GW flow expression
+static WORKERLOCAL double    Area;            // subcatchment area (ft2)
+static WORKERLOCAL double    Infil;           // infiltration rate from surface
+static WORKERLOCAL double    MaxEvap;         // max. evaporation rate
+static WORKERLOCAL double    AvailEvap;       // available evaporation rate
+static WORKERLOCAL double    UpperEvap;       // evaporation rate from upper GW zone
+static WORKERLOCAL double    LowerEvap;       // evaporation rate from lower GW zone
+static WORKERLOCAL double    UpperPerc;       // percolation rate from upper to lower zone
+static WORKERLOCAL double    LowerLoss;       // loss rate from lower GW zone
+static WORKERLOCAL double    GWFlow;          // flow rate from lower zone to conveyance node
+static WORKERLOCAL double    MaxUpperPerc;    // upper limit on UpperPerc
+static WORKERLOCAL double    MaxGWFlowPos;    // upper limit on GWFlow when its positve
+static WORKERLOCAL double    MaxGWFlowNeg;    // upper limit on GWFlow when its negative
+static WORKERLOCAL double    FracPerv;        // fraction of surface that is pervious
+static WORKERLOCAL double    TotalDepth;      // total depth of GW aquifer
+static WORKERLOCAL double    Theta;           // moisture content of upper zone
+static WORKERLOCAL double    HydCon;          // unsaturated hydraulic conductivity (ft/s)
+static WORKERLOCAL double    Hgw;             // ht. of saturated zone
+static WORKERLOCAL double    Hstar;           // ht. from aquifer bottom to node invert
+static WORKERLOCAL double    Hsw;             // ht. from aquifer bottom to water surface
+static WORKERLOCAL double    Tstep;           // current time step (sec)
+static WORKERLOCAL TAquifer  A;               // aquifer being analyzed
+static WORKERLOCAL TGroundwater* GW;          // groundwater object being analyzed
+static WORKERLOCAL MathExpr* LatFlowExpr;     // user-supplied lateral GW flow expression
+static WORKERLOCAL MathExpr* DeepFlowExpr;    // user-supplied deep GW flow expression
 
 //-----------------------------------------------------------------------------
 //  External Functions (declared in funcs.h)
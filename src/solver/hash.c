@@ -5,7 +5,7 @@
 //   CASE INSENSITIVE
 //
 //   Written by L. Rossman
-//   Last Updated on 6/19/03
+//   Last Updated on 10/16/26
 //
 //   The hash table data structure (HTable) is defined in "hash.h".
 //   Interface Functions:
@@ -13,6 +13,10 @@
 //      HTinsert() - inserts a string & its index value into a hash table
 //      HTfind()   - retrieves the index value of a string from a table
 //      HTfree()   - frees a hash table
+//
+//   The table uses open addressing with linear probing. Its number of
+//   slots is a power of 2 that is doubled whenever the table becomes half
+//   full, so lookups stay short however many objects a project has.
 //-----------------------------------------------------------------------------
 
 #include <stdlib.h>
@@ -29,89 +33,97 @@ int  samestr(const char *s1, const char *s2)
    return(0);
 }                                       /*  End of samestr  */
 
-/* Use Fletcher's checksum to compute 2-byte hash of string */
+/* Use the FNV-1a hash of the string's upper case characters */
 unsigned int hash(const char *str)
 {
-    unsigned int sum1= 0, check1;
-    unsigned long sum2= 0L;
-	while(  '\0' != *str  )
+    unsigned int h = 2166136261u;
+    while ( '\0' != *str )
     {
-        sum1 += UCHAR(*str);
+        h ^= (unsigned char)UCHAR(*str);
+        h *= 16777619u;
         str++;
-        if (  255 <= sum1  ) sum1 -= 255;
-        sum2 += sum1;
     }
-    check1= sum2;
-    check1 %= 255;
-    check1= 255 - (sum1+check1) % 255;
-    sum1= 255 - (sum1+check1) % 255;
-    return( ( ( check1 << 8 )  |  sum1  ) % HTMAXSIZE);
+    return h;
+}
+
+/* Finds the slot holding key or else the empty slot where it belongs */
+static struct HTentry *findslot(HTtable *ht, const char *key, unsigned int h)
+{
+        unsigned int mask = ht->size - 1;
+        unsigned int i = h & mask;
+        struct HTentry *entry = &ht->entries[i];
+        while (entry->key != NULL)
+        {
+            if ( entry->hash == h && samestr(entry->key,key) ) break;
+            i = (i + 1) & mask;
+            entry = &ht->entries[i];
+        }
+        return(entry);
+}
+
+/* Doubles the number of slots in a table, returning 0 if out of memory */
+static int grow(HTtable *ht)
+{
+        unsigned int i, j, mask = 2*ht->size - 1;
+        struct HTentry *entries =
+            (struct HTentry *) calloc(2*ht->size, sizeof(struct HTentry));
+        if (entries == NULL) return(0);
+        for (i=0; i<ht->size; i++)
+        {
+            if (ht->entries[i].key == NULL) continue;
+            j = ht->entries[i].hash & mask;
+            while (entries[j].key != NULL) j = (j + 1) & mask;
+            entries[j] = ht->entries[i];
+        }
+        free(ht->entries);
+        ht->entries = entries;
+        ht->size *= 2;
+        return(1);
 }
 
 HTtable *HTcreate()
 {
-        int i;
-        HTtable *ht = (HTtable *) calloc(HTMAXSIZE, sizeof(HTtable));
-        if (ht != NULL) for (i=0; i<HTMAXSIZE; i++) ht[i] = NULL;
+        HTtable *ht = (HTtable *) malloc(sizeof(HTtable));
+        if (ht == NULL) return(NULL);
+        ht->size = HTMINSIZE;
+        ht->count = 0;
+        ht->entries = (struct HTentry *) calloc(HTMINSIZE, sizeof(struct HTentry));
+        if (ht->entries == NULL)
+        {
+            free(ht);
+            return(NULL);
+        }
         return(ht);
 }
 
 int     HTinsert(HTtable *ht, char *key, int data)
 {
-        unsigned int i = hash(key);
+        unsigned int h = hash(key);
         struct HTentry *entry;
-        if ( i >= HTMAXSIZE ) return(0);
-        entry = (struct HTentry *) malloc(sizeof(struct HTentry));
-        if (entry == NULL) return(0);
+        if ( 2*(ht->count + 1) > ht->size && !grow(ht) ) return(0);
+        entry = findslot(ht, key, h);
+        if (entry->key == NULL) ht->count++;
         entry->key = key;
         entry->data = data;
-        entry->next = ht[i];
-        ht[i] = entry;
+        entry->hash = h;
         return(1);
 }
 
 int     HTfind(HTtable *ht, const char *key)
 {
-        unsigned int i = hash(key);
-        struct HTentry *entry;
-        if ( i >= HTMAXSIZE ) return(NOTFOUND);
-        entry = ht[i];
-        while (entry != NULL)
-        {
-            if ( samestr(entry->key,key) ) return(entry->data);
-            entry = entry->next;
-        }
-        return(NOTFOUND);
+        struct HTentry *entry = findslot(ht, key, hash(key));
+        if (entry->key == NULL) return(NOTFOUND);
+        return(entry->data);
 }
 
 char    *HTfindKey(HTtable *ht, const char *key)
 {
-        unsigned int i = hash(key);
-        struct HTentry *entry;
-        if ( i >= HTMAXSIZE ) return(NULL);
-        entry = ht[i];
-        while (entry != NULL)
-        {
-            if ( samestr(entry->key,key) ) return(entry->key);
-            entry = entry->next;
-        }
-        return(NULL);
+        struct HTentry *entry = findslot(ht, key, hash(key));
+        return(entry->key);
 }
 
 void    HTfree(HTtable *ht)
 {
-        struct HTentry *entry,
-                       *nextentry;
-        int i;
-        for (i=0; i<HTMAXSIZE; i++)
-        {
-            entry = ht[i];
-            while (entry != NULL)
-            {
-                nextentry = entry->next;
-                free(entry);
-                entry = nextentry;
-            }
-        }
+        free(ht->entries);
         free(ht);
 }
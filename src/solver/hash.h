@@ -8,17 +8,22 @@
 #define HASH_H
 
 
-#define HTMAXSIZE 1999
+#define HTMINSIZE 64                   // initial number of slots (power of 2)
 #define NOTFOUND  -1
 
 struct HTentry
 {
-    char   *key;
+    char   *key;                       // NULL if slot is empty
     int    data;
-    struct HTentry *next;
+    unsigned int hash;                 // hash value of key
 };
 
-typedef struct HTentry *HTtable;
+typedef struct
+{
+    struct HTentry *entries;
+    unsigned int   size;               // number of slots
+    unsigned int   count;              // number of slots in use
+} HTtable;
 
 HTtable* HTcreate(void);
 int      HTinsert(HTtable *, char *, int);
@@ -47,7 +47,7 @@
 //-----------------------------------------------------------------------------
 //  Local Variables
 //-----------------------------------------------------------------------------
-static int fileVersion;
+static THREADLOCAL int fileVersion;
 
 //-----------------------------------------------------------------------------
 //  External functions (declared in funcs.h)
@@ -10,11 +10,15 @@
 //
 //   Build 5.2.0:
 //   - Support added for relative file names.
+//   Build 5.2.4+:
+//   - Outlet results can be printed to a text buffer so that they are
+//     written to file along with the binary output results.
 //-----------------------------------------------------------------------------
 #define _CRT_SECURE_NO_DEPRECATE
 
 #include <stdlib.h>
 #include <string.h>
+#include <stdarg.h>
 #include "headers.h"
 
 //-----------------------------------------------------------------------------
@@ -26,17 +30,17 @@ extern double Qcf[];                   // flow units conversion factors
 //-----------------------------------------------------------------------------                  
 //  Shared variables
 //-----------------------------------------------------------------------------                  
-static int      IfaceFlowUnits;        // flow units for routing interface file
-static int      IfaceStep;             // interface file time step (sec)
-static int      NumIfacePolluts;       // number of pollutants in interface file
-static int*     IfacePolluts;          // indexes of interface file pollutants
-static int      NumIfaceNodes;         // number of nodes on interface file
-static int*     IfaceNodes;            // indexes of nodes on interface file
-static double** OldIfaceValues;        // interface flows & WQ at previous time
-static double** NewIfaceValues;        // interface flows & WQ at next time
-static double   IfaceFrac;             // fraction of interface file time step
-static DateTime OldIfaceDate;          // previous date of interface values
-static DateTime NewIfaceDate;          // next date of interface values
+static THREADLOCAL int      IfaceFlowUnits;        // flow units for routing interface file
+static THREADLOCAL int      IfaceStep;             // interface file time step (sec)
+static THREADLOCAL int      NumIfacePolluts;       // number of pollutants in interface file
+static THREADLOCAL int*     IfacePolluts;          // indexes of interface file pollutants
+static THREADLOCAL int      NumIfaceNodes;         // number of nodes on interface file
+static THREADLOCAL int*     IfaceNodes;            // indexes of nodes on interface file
+static THREADLOCAL double** OldIfaceValues;        // interface flows & WQ at previous time
+static THREADLOCAL double** NewIfaceValues;        // interface flows & WQ at next time
+static THREADLOCAL double   IfaceFrac;             // fraction of interface file time step
+static THREADLOCAL DateTime OldIfaceDate;          // previous date of interface values
+static THREADLOCAL DateTime NewIfaceDate;          // next date of interface values
 
 //-----------------------------------------------------------------------------
 //  External Functions (declared in funcs.h)
@@ -48,7 +52,8 @@ static DateTime NewIfaceDate;          // next date of interface values
 //  iface_getIfaceNode       (called by addIfaceInflows in routing.c)
 //  iface_getIfaceFlow       (called by addIfaceInflows in routing.c)
 //  iface_getIfaceQual       (called by addIfaceInflows in routing.c)
-//  iface_saveOutletResults  (called by output_saveResults)
+//  iface_saveOutletResults  (called by openFileForOutput)
+//  iface_printOutletResults (called by output_saveResults)
 
 //-----------------------------------------------------------------------------
 //  Local functions
@@ -60,6 +65,8 @@ static int   getIfaceFileNodes(void);
 static void  setOldIfaceValues(void);
 static void  readNewIfaceValues(void);
 static int   isOutletNode(int node);
+static int   appendText(char** text, size_t* len, size_t* size,
+                        const char* format, ...);
 
 //=============================================================================
 
@@ -285,6 +292,29 @@ void iface_saveOutletResults(DateTime reportDate, FILE* file)
 //  Output:  none
 //  Purpose: saves system outflows to routing interface file.
 //
+{
+    char*  text = NULL;
+    size_t len = 0;
+    size_t size = 0;
+
+    iface_printOutletResults(reportDate, &text, &len, &size);
+    if ( len > 0 ) fwrite(text, 1, len, file);
+    FREE(text);
+}
+
+//=============================================================================
+
+void iface_printOutletResults(DateTime reportDate, char** text, size_t* len,
+                              size_t* size)
+//
+//  Input:   reportDate = reporting date/time
+//           text = text buffer (can be reallocated)
+//           len = length of text in buffer
+//           size = allocated size of buffer
+//  Output:  none
+//  Purpose: appends system outflows, as they are saved to the routing
+//           interface file, to a text buffer.
+//
 {
     int i, p, yr, mon, day, hr, min, sec;
     char theDate[26];
@@ -297,13 +327,13 @@ void iface_saveOutletResults(DateTime reportDate, FILE* file)
         // --- check that node is an outlet node
         if ( !isOutletNode(i) ) continue;
 
-        // --- write node ID, date, flow, and quality to file
-        fprintf(file, "\n%-16s", Node[i].ID);
-        fprintf(file, "%s", theDate);
-        fprintf(file, " %-10f", Node[i].inflow * UCF(FLOW));
+        // --- print node ID, date, flow, and quality
+        if ( !appendText(text, len, size, "\n%-16s%s %-10f", Node[i].ID,
+                         theDate, Node[i].inflow * UCF(FLOW)) ) return;
         for ( p = 0; p < Nobjects[POLLUT]; p++ )
         {
-            fprintf(file, " %-10f", Node[i].newQual[p]);
+            if ( !appendText(text, len, size, " %-10f",
+                             Node[i].newQual[p]) ) return;
         }
     }
 }
@@ -556,6 +586,7 @@ void readNewIfaceValues()
 {
     int    i, j;
     char*  s;
+    char*  pos;                        // tokenizer position
     int    yr = 0, mon = 0, day = 0,
 		   hr = 0, min = 0, sec = 0;   // year, month, day, hour, minute, second
     char   line[MAXLINE+1];            // line from interface file
@@ -568,35 +599,35 @@ void readNewIfaceValues()
         fgets(line, MAXLINE, Finflows.file);
 
         // --- parse date & time from line
-        if ( strtok(line, SEPSTR) == NULL ) return;
-        s = strtok(NULL, SEPSTR);
+        if ( strtok_r(line, SEPSTR, &pos) == NULL ) return;
+        s = strtok_r(NULL, SEPSTR, &pos);
         if ( s == NULL ) return;
         yr  = atoi(s);
-        s = strtok(NULL, SEPSTR);
+        s = strtok_r(NULL, SEPSTR, &pos);
         if ( s == NULL ) return;
         mon = atoi(s);
-        s = strtok(NULL, SEPSTR);
+        s = strtok_r(NULL, SEPSTR, &pos);
         if ( s == NULL ) return;
         day = atoi(s);
-        s = strtok(NULL, SEPSTR);
+        s = strtok_r(NULL, SEPSTR, &pos);
         if ( s == NULL ) return;
         hr  = atoi(s);
-        s = strtok(NULL, SEPSTR);
+        s = strtok_r(NULL, SEPSTR, &pos);
         if ( s == NULL ) return;
         min = atoi(s);
-        s = strtok(NULL, SEPSTR);
+        s = strtok_r(NULL, SEPSTR, &pos);
         if ( s == NULL ) return;
         sec = atoi(s);
 
         // --- parse flow value
-        s = strtok(NULL, SEPSTR);
+        s = strtok_r(NULL, SEPSTR, &pos);
         if ( s == NULL ) return;
         NewIfaceValues[i][0] = atof(s) / Qcf[IfaceFlowUnits]; 
 
         // --- parse pollutant values
         for (j=1; j<=NumIfacePolluts; j++)
         {
-            s = strtok(NULL, SEPSTR);
+            s = strtok_r(NULL, SEPSTR, &pos);
             if ( s == NULL ) return;
             NewIfaceValues[i][j] = atof(s);
         }
@@ -646,3 +677,46 @@ int  isOutletNode(int i)
     // --- otherwise outlets are nodes with no outflow links (degree is 0)
     else return (Node[i].degree == 0);
 }
+
+//=============================================================================
+
+int appendText(char** text, size_t* len, size_t* size, const char* format, ...)
+//
+//  Input:   text = text buffer (can be reallocated)
+//           len = length of text in buffer
+//           size = allocated size of buffer
+//           format = printf-style format of text to append
+//  Output:  returns FALSE if buffer can't be enlarged
+//  Purpose: appends formatted text to a growable text buffer.
+//
+{
+    va_list args;
+    char*   newText;
+    size_t  newSize;
+    int     n;
+
+    va_start(args, format);
+    n = vsnprintf(NULL, 0, format, args);
+    va_end(args);
+    if ( n < 0 ) return TRUE;
+
+    // --- enlarge buffer to hold text and its null terminator
+    if ( *len + n + 1 > *size )
+    {
+        newSize = 2 * (*size) + n + 256;
+        newText = (char *) realloc(*text, newSize);
+        if ( newText == NULL )
+        {
+            report_writeErrorMsg(ERR_MEMORY, "");
+            return FALSE;
+        }
+        *text = newText;
+        *size = newSize;
+    }
+
+    va_start(args, format);
+    vsnprintf(*text + *len, *size - *len, format, args);
+    va_end(args);
+    *len += n;
+    return TRUE;
+}
@@ -8,6 +8,20 @@
 //
 //   Prototypes for SWMM5 API functions.
 //
+//   A library built with the BUILD_REENTRANT option (SWMM_REENTRANT)
+//   keeps a separate project for each calling thread, so different
+//   threads can run their own projects at the same time. Each of these
+//   projects runs on its calling thread alone, since OpenMP worker
+//   threads cannot see the calling thread's project. A THREADS option or
+//   SM_THREADS toolkit setting above 1 is replaced by 1 with a warning
+//   in the report file. This disables:
+//   - parallel runoff computation for subcatchments;
+//   - parallel gathering of conduit flows at nodes in dynamic wave routing;
+//   - parallel parsing of large input file sections;
+//   - dynamic wave sub-domains solved by separate threads;
+//   - the thread team kept for all dynamic wave iterations of a step.
+//   Results are written on a background thread in either build.
+//
 //-----------------------------------------------------------------------------
 
 #ifndef SWMM5_H
@@ -39,13 +53,6 @@
 //#endif
 
 
-//-----------------------------------------------------------------------------
-//  Shared variables
-//-----------------------------------------------------------------------------
-static int IsOpenFlag;           // TRUE if a project has been opened
-static int IsStartedFlag;        // TRUE if a simulation has been started
-static int SaveResultsFlag;      // TRUE if output to be saved to binary file
-
 int swmm_IsOpenFlag(void);
 int swmm_IsStartedFlag(void);
 
@@ -163,6 +170,18 @@ int DLLEXPORT swmm_run(const char *f1, const char *f2, const char *f3);
 */
 int DLLEXPORT swmm_open(const char *f1, const char *f2, const char *f3);
 
+/**
+ @brief Opens SWMM input file using a snapshot of its validated data
+ @param f1 pointer to name of input file (must exist)
+ @param f2 pointer to name of report file (to be created)
+ @param f3 pointer to name of binary output file (to be created)
+ @param f4 pointer to name of snapshot file (created if it does not exist
+        or was not made from the current contents of the input file)
+ @return error code
+*/
+int DLLEXPORT swmm_openSnapshot(const char *f1, const char *f2, const char *f3,
+    const char *f4);
+
 /**
  @brief Start SWMM simulation
  @param saveFlag TRUE or FALSE to save timeseries to report file
@@ -593,6 +593,15 @@ EXPORT_TOOLKIT int swmm_getSystemRoutingTotals(SM_RoutingTotals *routingTotals);
 */
 EXPORT_TOOLKIT int swmm_getSystemRunoffTotals(SM_RunoffTotals *runoffTotals);
 
+/**
+ @brief Get the run time profile of the current project, i.e. the time spent
+ in each phase of the run and counts of the steps taken so far.
+ @param[out] profile The run time profile struct (see @ref SM_Profile).
+ pre-allocated by the caller.
+ @return Error code
+*/
+EXPORT_TOOLKIT int swmm_getProfile(SM_Profile *profile);
+
 /**
  @brief Set a link setting (pump, orifice, or weir). Setting for an orifice
  and a weir should be [0, 1]. A setting for a pump can range from [0, inf).
@@ -348,5 +348,60 @@ typedef struct
    double        pctError;
 }  SM_RunoffTotals;
 
+/// Run time profile structure
+
+/** @struct SM_Profile
+ *  @brief Run Time Profile
+ *
+ * @var SM_Profile::input
+ *   time spent reading & validating input data (sec)
+ * @var SM_Profile::start
+ *   time spent initializing the simulation (sec)
+ * @var SM_Profile::runoff
+ *   time spent computing runoff (sec)
+ * @var SM_Profile::routing
+ *   time spent routing flow (sec)
+ * @var SM_Profile::quality
+ *   time spent routing water quality (sec)
+ * @var SM_Profile::controls
+ *   time spent evaluating control rules (sec)
+ * @var SM_Profile::stats
+ *   time spent updating summary statistics (sec)
+ * @var SM_Profile::output
+ *   time spent saving results to the output file (sec)
+ * @var SM_Profile::report
+ *   time spent writing the report file (sec)
+ * @var SM_Profile::runoffSteps
+ *   number of runoff time steps
+ * @var SM_Profile::routingSteps
+ *   number of routing time steps
+ * @var SM_Profile::routingTrials
+ *   number of flow routing trials (iterations)
+ * @var SM_Profile::odeSteps
+ *   number of Runge-Kutta integration steps
+ * @var SM_Profile::tableLookups
+ *   number of curve & time series lookups
+ * @var SM_Profile::routingDomains
+ *   number of sub-domains the dynamic wave network is split into for threads
+ */
+typedef struct
+{
+   double        input;
+   double        start;
+   double        runoff;
+   double        routing;
+   double        quality;
+   double        controls;
+   double        stats;
+   double        output;
+   double        report;
+   double        runoffSteps;
+   double        routingSteps;
+   double        routingTrials;
+   double        odeSteps;
+   double        tableLookups;
+   double        routingDomains;
+}  SM_Profile;
+
 
 #endif /* TOOLKIT_STRUCTS_H_ */
\ No newline at end of file
@@ -32,6 +32,8 @@
 //   - Additional validity check for G-A initial deficit added.
 //   - New error message 235 added for invalid infiltration parameters.
 //   - Conversion of runon to ponded depth fixed for Curve Number infiltration.
+//   Build 5.2.4+:
+//   - New function infil_getData() added for project snapshots.
 //-----------------------------------------------------------------------------
 #define _CRT_SECURE_NO_DEPRECATE
 
@@ -48,16 +50,17 @@ typedef union TInfil {
     TGrnAmpt  grnAmpt;
     TCurveNum curveNum;
 } TInfil;
-TInfil *Infil;
+THREADLOCAL TInfil *Infil;
 
-static double Fumax;   // saturated water volume in upper soil zone (ft)
-static double InfilFactor;
+static WORKERLOCAL double Fumax;   // saturated water volume in upper soil zone (ft)
+static WORKERLOCAL double InfilFactor;
 
 //-----------------------------------------------------------------------------
 //  External Functions (declared in infil.h)
 //-----------------------------------------------------------------------------
 //  infil_create     (called by createObjects in project.c)
 //  infil_delete     (called by deleteObjects in project.c)
+//  infil_getData    (called by transferInfil in snapshot.c)
 //  infil_readParams (called by input_readLine)
 //  infil_initState  (called by subcatch_initState)
 //  infil_getState   (called by writeRunoffFile in hotstart.c)
@@ -125,6 +128,20 @@ void infil_delete()
 
 //=============================================================================
 
+char* infil_getData(size_t* size)
+//
+//  Purpose: retrieves the infiltration objects of all subcatchments.
+//  Input:   none
+//  Output:  size = number of bytes of data;
+//           returns a pointer to the infiltration objects
+//
+{
+    *size = Nobjects[SUBCATCH] * sizeof(TInfil);
+    return (char *)Infil;
+}
+
+//=============================================================================
+
 int infil_readParams(int m, char* tok[], int ntoks)
 //
 //  Input:   m = default infiltration model
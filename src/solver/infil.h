@@ -16,6 +16,8 @@
 //   - New function infil_setInfilFactor() added.
 //   Build 5.1.015:
 //   - Support added for multiple infiltration methods within a project.
+//   Build 5.2.4+:
+//   - New function infil_getData() added.
 //-----------------------------------------------------------------------------
 
 #ifndef INFIL_H
@@ -95,6 +97,7 @@ extern TCurveNum* CNInfil;
 //-----------------------------------------------------------------------------
 void    infil_create(int n);
 void    infil_delete(void);
+char*   infil_getData(size_t* size);
 int     infil_readParams(int m, char* tok[], int ntoks);
 void    infil_initState(int j);
 void    infil_getState(int j, double x[]);
@@ -13,12 +13,20 @@
 //   ==============
 //   Build 5.2.0:
 //   - Removed references to unused extIfaceInflow member of ExtInflow struct. 
+//   Build 5.2.4+:
+//   - Inflow objects are allocated from a memory pool that is freed at once.
 //-----------------------------------------------------------------------------
 #define _CRT_SECURE_NO_DEPRECATE
 
 #include <stdlib.h>
 #include <string.h>
 #include "headers.h"
+#include "mempool.h"
+
+//-----------------------------------------------------------------------------
+//  Shared variables
+//-----------------------------------------------------------------------------
+static THREADLOCAL alloc_handle_t* InflowPool; // memory pool for inflow objects
 
 //-----------------------------------------------------------------------------
 //  External Functions (declared in funcs.h)
@@ -26,8 +34,9 @@
 //  inflow_initDwfPattern   (called createObjects in project.c)
 //  inflow_readExtInflow    (called by input_readLine)
 //  inflow_readDwfInflow    (called by input_readLine)
-//  inflow_deleteExtInflows (called by deleteObjects in project.c)
-//  inflow_deleteDwfInflows (called by deleteObjects in project.c)
+//  inflow_createExtInflow  (called by readNode in snapshot.c)
+//  inflow_createDwfInflow  (called by readNode in snapshot.c)
+//  inflow_delete           (called by deleteObjects in project.c)
 //  inflow_getExtInflow     (called by addExternalInflows in routing.c)
 //  inflow_setExtInflow     (called by setNodeInflow in swmm5.c)
 //  inflow_getDwfInflow     (called by addDryWeatherInflows in routing.c)
@@ -36,6 +45,7 @@
 //  Local Functions
 //-----------------------------------------------------------------------------
 double getPatternFactor(int p, int month, int day, int hour);
+static char* allocInflow(long size);
 
 
 int inflow_readExtInflow(char* tok[], int ntoks)
@@ -226,7 +236,7 @@ int inflow_setExtInflow(int j, int param, int type, int tseries, int basePat,
         // --- if it doesn't exist, then create it
         if ( inflow == NULL )
         {
-            inflow = (TExtInflow *) malloc(sizeof(TExtInflow));
+            inflow = inflow_createExtInflow();
             if ( inflow == NULL ) 
             {
                 return error_setInpError(ERR_MEMORY, "");
@@ -250,22 +260,39 @@ int inflow_setExtInflow(int j, int param, int type, int tseries, int basePat,
 
 //=============================================================================
 
-void inflow_deleteExtInflows(int j)
+TExtInflow* inflow_createExtInflow()
+//
+//  Input:   none
+//  Output:  returns a new external inflow object (or NULL if out of memory)
+//  Purpose: allocates an external inflow object from the inflow memory pool.
+//
+{
+    return (TExtInflow *) allocInflow(sizeof(TExtInflow));
+}
+
+//=============================================================================
+
+TDwfInflow* inflow_createDwfInflow()
+//
+//  Input:   none
+//  Output:  returns a new dry weather inflow object (or NULL if out of memory)
+//  Purpose: allocates a dry weather inflow object from the inflow memory pool.
 //
-//  Input:   j = node index
+{
+    return (TDwfInflow *) allocInflow(sizeof(TDwfInflow));
+}
+
+//=============================================================================
+
+void inflow_delete()
+//
+//  Input:   none
 //  Output:  none
-//  Purpose: deletes all time series inflow data for a node.
+//  Purpose: deletes all external and dry weather inflow data.
 //
 {
-    TExtInflow* inflow1;
-    TExtInflow* inflow2;
-    inflow1 = Node[j].extInflow;
-    while ( inflow1 )
-    {
-        inflow2 = inflow1->next;
-        free(inflow1);
-        inflow1 = inflow2; 
-    }
+    AllocDeletePool(InflowPool);
+    InflowPool = NULL;
 }
 
 //=============================================================================
@@ -364,7 +391,7 @@ int inflow_readDwfInflow(char* tok[], int ntoks)
     // --- if it doesn't exist, then create it
     if ( inflow == NULL )
     {
-        inflow = (TDwfInflow *) malloc(sizeof(TDwfInflow));
+        inflow = inflow_createDwfInflow();
         if ( inflow == NULL ) return error_setInpError(ERR_MEMORY, "");
         inflow->next = Node[j].dwfInflow;
         Node[j].dwfInflow = inflow;
@@ -379,26 +406,6 @@ int inflow_readDwfInflow(char* tok[], int ntoks)
 
 //=============================================================================
 
-void inflow_deleteDwfInflows(int j)
-//
-//  Input:   j = node index
-//  Output:  none
-//  Purpose: deletes all dry weather inflow data for a node.
-//
-{
-    TDwfInflow* inflow1;
-    TDwfInflow* inflow2;
-    inflow1 = Node[j].dwfInflow;
-    while ( inflow1 )
-    {
-        inflow2 = inflow1->next;
-        free(inflow1);
-        inflow1 = inflow2; 
-    }
-}
-
-//=============================================================================
-
 void   inflow_initDwfInflow(TDwfInflow* inflow)
 //
 //  Input:   inflow = dry weather inflow data structure
@@ -553,3 +560,18 @@ double getPatternFactor(int p, int month, int day, int hour)
     }
     return 1.0;
 }
+
+//=============================================================================
+
+char* allocInflow(long size)
+//
+//  Input:   size = size of an inflow object (bytes)
+//  Output:  returns memory for the object (or NULL if out of memory)
+//  Purpose: allocates memory for an inflow object, creating the inflow
+//           memory pool when first needed.
+//
+{
+    if ( InflowPool == NULL ) InflowPool = AllocNewPool();
+    if ( InflowPool == NULL ) return NULL;
+    return AllocFromPool(InflowPool, size);
+}
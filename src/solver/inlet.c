@@ -77,9 +77,9 @@ typedef struct
 // OWA EDIT - TInlet and TInletStats struct defs moved to inlet.h to be shared by toolkit.c
 
 // Shared inlet variables
-TInletDesign * InletDesigns;      // array of available inlet designs
-int            InletDesignCount;  // number of inlet designs
-int            UsesInlets;        // TRUE if project uses inlets
+THREADLOCAL TInletDesign * InletDesigns;      // array of available inlet designs
+THREADLOCAL int            InletDesignCount;  // number of inlet designs
+THREADLOCAL int            UsesInlets;        // TRUE if project uses inlets
 
 //-----------------------------------------------------------------------------
 //  Enumerations
@@ -141,29 +141,29 @@ static const double GrateOpeningRatios[] = {
 //-----------------------------------------------------------------------------
 //  Imported Variables
 //-----------------------------------------------------------------------------
-extern TLinkStats*     LinkStats;      // defined in STATS.C
-extern TNodeStats*     NodeStats;      // defined in STATS.C
+extern THREADLOCAL TLinkStats*     LinkStats;      // defined in STATS.C
+extern THREADLOCAL TNodeStats*     NodeStats;      // defined in STATS.C
 
 //-----------------------------------------------------------------------------
 //  Local Shared Variables
 //-----------------------------------------------------------------------------
 // Variables as named in the HEC-22 manual.
-static double Sx;            // street cross slope
-static double SL;            // conduit longitudinal slope
-static double Sw;            // gutter + cross slope
-static double a;             // street gutter depression (ft)
-static double W;             // street gutter width (ft)
-static double T;             // top width of flow spread (ft)
-static double n;             // Manning's roughness coeff.
+static THREADLOCAL double Sx;            // street cross slope
+static THREADLOCAL double SL;            // conduit longitudinal slope
+static THREADLOCAL double Sw;            // gutter + cross slope
+static THREADLOCAL double a;             // street gutter depression (ft)
+static THREADLOCAL double W;             // street gutter width (ft)
+static THREADLOCAL double T;             // top width of flow spread (ft)
+static THREADLOCAL double n;             // Manning's roughness coeff.
 
 // Additional variables
-static int     Nsides;       // 1- or 2-sided street
-static double  Tcrown;       // distance from street curb to crown (ft)
-static double  Beta;         // = 1.486 * sqrt(SL) / n
-static double  Qfactor;      // factor f in Izzard's eqn. Q = f*T^2.67
-static TXsect* xsect;        // cross-section data of inlet's conduit
-static double* InletFlow;    // captured inlet flow received by each node
-static TInlet* FirstInlet;   // head of list of deployed inlets
+static THREADLOCAL int     Nsides;       // 1- or 2-sided street
+static THREADLOCAL double  Tcrown;       // distance from street curb to crown (ft)
+static THREADLOCAL double  Beta;         // = 1.486 * sqrt(SL) / n
+static THREADLOCAL double  Qfactor;      // factor f in Izzard's eqn. Q = f*T^2.67
+static THREADLOCAL TXsect* xsect;        // cross-section data of inlet's conduit
+static THREADLOCAL double* InletFlow;    // captured inlet flow received by each node
+static THREADLOCAL TInlet* FirstInlet;   // head of list of deployed inlets
 
 //-----------------------------------------------------------------------------
 //  External functions (declared in inlet.h)
@@ -686,8 +686,8 @@ void inlet_adjustQualOutflows()
 
     // --- these variables, declared in massbal.c, accumulate system-wide flow and
     //     pollutant mass fluxes over a time step to use in mass balances
-    extern TRoutingTotals StepFlowTotals;
-    extern TRoutingTotals*  StepQualTotals;
+    extern THREADLOCAL TRoutingTotals StepFlowTotals;
+    extern THREADLOCAL TRoutingTotals*  StepQualTotals;
 
     // --- examine each node
     for (j = 0; j < Nobjects[NODE]; j++)
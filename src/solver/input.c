@@ -21,6 +21,10 @@
 //   - Support added for named variables & math expressions in control rules.
 //   Build 5.2.1:
 //   - Possible integer underflow avoided in getTokens() function.
+//   Build 5.2.4+:
+//   - Input file read into memory once and shared by both input passes.
+//   - Map sections skipped without tokenizing their lines.
+//   - Lines of [CONDUITS], [XSECTIONS] & [TIMESERIES] parsed in parallel.
 //-----------------------------------------------------------------------------
 #define _CRT_SECURE_NO_DEPRECATE
 
@@ -30,20 +34,48 @@
 #include "headers.h"
 #include "lid.h"
 
+// Protect against lack of compiler support for OpenMP
+#if defined(_OPENMP)
+  #include <omp.h>
+#endif
+
 //-----------------------------------------------------------------------------
 //  Constants
 //-----------------------------------------------------------------------------
 static const int MAXERRS = 100;        // Max. input errors reported
 
+enum LineType {BLANK_LINE, HEADING_LINE, DATA_LINE};
+
+//-----------------------------------------------------------------------------
+//  Data Structures
+//-----------------------------------------------------------------------------
+typedef struct                         // line of a section parsed in parallel
+{
+    char*  text;                       // start of line in input file text
+    int    len;                        // number of characters in line
+    long   lineCount;                  // line number in input file
+    int    err;                        // error code from parsing the line
+    char*  errString;                  // error message text (if err > 0)
+} TInpLine;
+
 //-----------------------------------------------------------------------------
 //  Shared variables
 //-----------------------------------------------------------------------------
-static char *Tok[MAXTOKS];             // String tokens from line of input
-static int  Ntokens;                   // Number of tokens in line of input
-static int  Mobjects[MAX_OBJ_TYPES];   // Working number of objects of each type
-static int  Mnodes[MAX_NODE_TYPES];    // Working number of node objects
-static int  Mlinks[MAX_LINK_TYPES];    // Working number of link objects
-static int  Mevents;                   // Working number of event periods
+static THREADLOCAL char *Tok[MAXTOKS];             // String tokens from line of input
+static THREADLOCAL int  Ntokens;                   // Number of tokens in line of input
+static THREADLOCAL int  Mobjects[MAX_OBJ_TYPES];   // Working number of objects of each type
+static THREADLOCAL int  Mnodes[MAX_NODE_TYPES];    // Working number of node objects
+static THREADLOCAL int  Mlinks[MAX_LINK_TYPES];    // Working number of link objects
+static THREADLOCAL int  Mevents;                   // Working number of event periods
+static THREADLOCAL char *NextTok;                  // Position of next token in counted line
+static THREADLOCAL char *InpText;                  // Contents of input file
+static THREADLOCAL size_t InpSize;                 // Number of characters in InpText
+static THREADLOCAL size_t InpPos;                  // Position of next line in InpText
+
+//-----------------------------------------------------------------------------
+//  Imported variables
+//-----------------------------------------------------------------------------
+extern WORKERLOCAL char ErrString[256];            // defined in ERROR.C
 
 //-----------------------------------------------------------------------------
 //  External Functions (declared in funcs.h)
@@ -56,6 +88,17 @@ static int  Mevents;                   // Working number of event periods
 //-----------------------------------------------------------------------------
 static int  addObject(int objType, char* id);
 static int  getTokens(char *s);
+static int  tokenize(char *s, char *tok[]);
+static int  readFile(void);
+static void freeFile(void);
+static char* nextLine(int* len);
+static int  getLine(char* line);
+static int  getLineType(char* s, int len);
+static int  getThreadCount(void);
+static int  readSection(int sect, long* lineCount, int errsum);
+static int  groupLines(int sect, TInpLine* lines, int n, int* order,
+            int* first);
+static int  parseSectionLine(int sect, TInpLine* line, int j, int k);
 static int  parseLine(int sect, char* line);
 static int  readOption(char* line);
 static int  readTitle(char* line);
@@ -90,13 +133,20 @@ int input_countObjects()
     for (i = 0; i < MAX_LINK_TYPES; i++) Nlinks[i] = 0;
     controls_init();
 
+    // --- read input file into memory
+    if ( !readFile() ) return ErrorCode;
+
     // --- make pass through data file counting number of each object
-    while ( fgets(line, MAXLINE, Finp.file) != NULL )
+    while ( getLine(line) )
     {
-        // --- skip blank lines & those beginning with a comment
+        // --- skip lines of map sections that don't begin a new section
         lineCount++;
+        if ( sect >= s_COORDINATE && sect <= s_MAP &&
+             getLineType(line, (int)strlen(line)) != HEADING_LINE ) continue;
+
+        // --- skip blank lines & those beginning with a comment
         sstrncpy(wLine, line, MAXLINE);     // make working copy of line
-        tok = strtok(wLine, SEPSTR);        // get first text token on line
+        tok = strtok_r(wLine, SEPSTR, &NextTok); // get first text token on line
         if ( tok == NULL ) continue;
         if ( *tok == ';' ) continue;
 
@@ -152,12 +202,17 @@ int input_readData()
     int   inperr, errsum;         // error code & total error count
     int   lineLength;             // number of characters in input line
     int   i;
+    int   nThreads;               // number of threads used to parse lines
     long  lineCount = 0;
 
     // --- initialize working item count arrays
     //     (final counts in Mobjects, Mnodes & Mlinks should
     //      match those in Nobjects, Nnodes and Nlinks).
-    if ( ErrorCode ) return ErrorCode;
+    if ( ErrorCode )
+    {
+        freeFile();
+        return ErrorCode;
+    }
     error_setInpError(0, "");
     for (i = 0; i < MAX_OBJ_TYPES; i++)  Mobjects[i] = 0;
     for (i = 0; i < MAX_NODE_TYPES; i++) Mnodes[i] = 0;
@@ -173,11 +228,16 @@ int input_readData()
     // --- read each line from input file
     sect = 0;
     errsum = 0;
-    rewind(Finp.file);
-    while ( fgets(line, MAXLINE, Finp.file) != NULL )
+    nThreads = getThreadCount();
+    InpPos = 0;
+    while ( getLine(line) )
     {
-        // --- make copy of line and scan for tokens
+        // --- skip lines of map sections that don't begin a new section
         lineCount++;
+        if ( sect >= s_COORDINATE && sect <= s_MAP &&
+             getLineType(line, (int)strlen(line)) != HEADING_LINE ) continue;
+
+        // --- make copy of line and scan for tokens
         sstrncpy(wLine, line, MAXLINE);
         Ntokens = getTokens(wLine);
 
@@ -214,6 +274,14 @@ int input_readData()
 
                 // --- begin a new input section
                 sect = newsect;
+
+                // --- read all lines of some sections at once using
+                //     several threads
+                if ( nThreads > 1 )
+                {
+                    errsum = readSection(sect, &lineCount, errsum);
+                    if ( errsum > MAXERRS ) break;
+                }
                 continue;
             }
             else
@@ -242,6 +310,7 @@ int input_readData()
     }   /* End of while */
 
     // --- check for errors
+    freeFile();
     if (errsum > 0)  ErrorCode = ERR_INPUT;
     return ErrorCode;
 }
@@ -391,7 +460,7 @@ int  addObject(int objType, char* id)
             Nobjects[CURVE]++;
 
             // --- check for a conduit shape curve
-            id = strtok(NULL, SEPSTR);
+            id = strtok_r(NULL, SEPSTR, &NextTok);
             if ( findmatch(id, CurveTypeWords) == SHAPE_CURVE )
                 Nobjects[SHAPE]++;
         }
@@ -416,7 +485,7 @@ int  addObject(int objType, char* id)
         // --- for TRANSECTS, ID name appears as second entry on X1 line
         if ( match(id, "X1") )
         {
-            id = strtok(NULL, SEPSTR);
+            id = strtok_r(NULL, SEPSTR, &NextTok);
             if ( id ) 
             {
                 if ( !project_addObject(TRANSECT, id, Nobjects[TRANSECT]) )
@@ -886,6 +955,19 @@ int  getTokens(char *s)
 //  Purpose: scans a string for tokens, saving pointers to them
 //           in shared variable Tok[].
 //
+{
+    return tokenize(s, Tok);
+}
+
+//=============================================================================
+
+int  tokenize(char *s, char *tok[])
+//
+//  Input:   s = a character string
+//  Output:  tok[] = pointers to the tokens found in s
+//           returns number of tokens found in s
+//  Purpose: scans a string for tokens.
+//
 //  Notes:   Tokens can be separated by the characters listed in SEPSTR
 //           (spaces, tabs, newline, carriage return) which is defined
 //           in CONSTS.H. Text between quotes is treated as a single token.
@@ -896,7 +978,7 @@ int  getTokens(char *s)
     char *c;
 
     // --- begin with no tokens
-    for (n = 0; n < MAXTOKS; n++) Tok[n] = NULL;
+    for (n = 0; n < MAXTOKS; n++) tok[n] = NULL;
     n = 0;
 
     // --- truncate s at start of comment 
@@ -918,7 +1000,7 @@ int  getTokens(char *s)
                 m = (int)strcspn(s,"\"\n"); // find end quote or new line
             }
             s[m] = '\0';                    // null-terminate the token
-            Tok[n] = s;                     // save pointer to token 
+            tok[n] = s;                     // save pointer to token 
             n++;                            // update token count
             s += m+1;                       // begin next token
         }
@@ -928,3 +1010,394 @@ int  getTokens(char *s)
 }
 
 //=============================================================================
+
+int  readFile()
+//
+//  Input:   none
+//  Output:  returns TRUE if successful, FALSE if not
+//  Purpose: reads the entire input file into memory.
+//
+//  Note:    the file is read through its stream (rather than mapped into
+//           memory) so that line endings are translated just as they are
+//           when it is read line by line.
+//
+{
+    size_t size = 65536;
+    size_t n;
+    char*  text;
+
+    // --- start with a buffer the size of the file
+    if ( fseek(Finp.file, 0, SEEK_END) == 0 && ftell(Finp.file) > 0 )
+        size = (size_t)ftell(Finp.file) + 1;
+    rewind(Finp.file);
+    InpText = (char *) malloc(size);
+    InpSize = 0;
+    InpPos = 0;
+
+    // --- read the file, enlarging the buffer if it fills up
+    while ( InpText )
+    {
+        n = fread(InpText + InpSize, 1, size - InpSize - 1, Finp.file);
+        InpSize += n;
+        if ( InpSize < size - 1 ) break;
+        text = (char *) realloc(InpText, 2 * size);
+        if ( text == NULL ) FREE(InpText);
+        InpText = text;
+        size *= 2;
+    }
+    if ( InpText == NULL )
+    {
+        report_writeErrorMsg(ERR_MEMORY, "");
+        return FALSE;
+    }
+    InpText[InpSize] = '\0';
+    return TRUE;
+}
+
+//=============================================================================
+
+void  freeFile()
+//
+//  Input:   none
+//  Output:  none
+//  Purpose: frees the memory holding the input file's contents.
+//
+{
+    FREE(InpText);
+    InpSize = 0;
+    InpPos = 0;
+}
+
+//=============================================================================
+
+char*  nextLine(int* len)
+//
+//  Input:   none
+//  Output:  len = number of characters in line
+//           returns start of next line of input file (or NULL at end of file)
+//  Purpose: finds the next line of the input file's contents.
+//
+//  Note:    lines longer than MAXLINE-1 characters are split in the same
+//           way that fgets(line, MAXLINE, file) would split them.
+//
+{
+    char*  text = InpText + InpPos;
+    char*  eol;
+    size_t n = InpSize - InpPos;
+
+    if ( n == 0 ) return NULL;
+    if ( n > MAXLINE - 1 ) n = MAXLINE - 1;
+    eol = (char *) memchr(text, '\n', n);
+    if ( eol ) n = eol - text + 1;
+    InpPos += n;
+    *len = (int)n;
+    return text;
+}
+
+//=============================================================================
+
+int  getLine(char* line)
+//
+//  Input:   none
+//  Output:  line = next line of input file
+//           returns FALSE if at end of file, TRUE otherwise
+//  Purpose: copies the next line of the input file's contents into line
+//           (which must hold at least MAXLINE characters).
+//
+{
+    int   len;
+    char* text = nextLine(&len);
+
+    if ( text == NULL ) return FALSE;
+    memcpy(line, text, len);
+    line[len] = '\0';
+    return TRUE;
+}
+
+//=============================================================================
+
+int  getLineType(char* s, int len)
+//
+//  Input:   s = a line of input
+//           len = number of characters in s
+//  Output:  returns BLANK_LINE, HEADING_LINE or DATA_LINE
+//  Purpose: determines if a line is blank (or a comment), begins a new
+//           section or holds data, without tokenizing it.
+//
+{
+    int i = 0;
+
+    // --- find first character of first token (see tokenize)
+    while ( i < len && s[i] && strchr(SEPSTR, s[i]) ) i++;
+    if ( i == len || s[i] == '\0' || s[i] == ';' ) return BLANK_LINE;
+    if ( s[i] == '"' ) i++;
+    if ( i < len && s[i] == '[' ) return HEADING_LINE;
+    return DATA_LINE;
+}
+
+//=============================================================================
+
+int  getThreadCount()
+//
+//  Input:   none
+//  Output:  returns number of threads used to parse sections of input
+//  Purpose: finds how many threads can parse an input section in parallel.
+//
+{
+#if defined(_OPENMP) && !defined(SWMM_REENTRANT)
+    int n = omp_get_max_threads();
+    if ( NumThreads > 0 ) n = MIN(n, NumThreads);
+    return n;
+#else
+    return 1;
+#endif
+}
+
+//=============================================================================
+
+int  readSection(int sect, long* lineCount, int errsum)
+//
+//  Input:   sect = current section of input file
+//           lineCount = number of lines of input file read so far
+//           errsum = number of input errors found so far
+//  Output:  lineCount = updated number of lines read
+//           returns updated number of input errors
+//  Purpose: parses the lines of a [CONDUITS], [XSECTIONS] or [TIMESERIES]
+//           section of the input file using several threads.
+//
+//  Notes:   Each thread parses whole groups of lines, where the lines
+//           of a group update the same object and the lines of different
+//           groups update different objects. Lines of a group are parsed
+//           in the order they appear in the file, as are the error
+//           messages written for them. If memory runs short the section
+//           is left for input_readData to parse one line at a time.
+//
+{
+    TInpLine* lines = NULL;
+    TInpLine* more;
+    int*      order = NULL;
+    int*      first = NULL;
+    int       i, n = 0, maxLines = 0, nGroups;
+    int       len, type = BLANK_LINE;
+    int       nThreads = getThreadCount();
+    long      count = *lineCount;
+    size_t    startPos = InpPos, pos;
+    char*     text;
+    char      line[MAXLINE+1];
+
+    if ( sect != s_CONDUIT && sect != s_XSECTION && sect != s_TIMESERIES )
+        return errsum;
+
+    // --- collect the section's data lines up to the next section heading
+    for (;;)
+    {
+        pos = InpPos;
+        text = nextLine(&len);
+        if ( text == NULL ) break;
+        type = getLineType(text, len);
+        if ( type == HEADING_LINE )
+        {
+            InpPos = pos;
+            break;
+        }
+        count++;
+        if ( type == BLANK_LINE ) continue;
+        if ( n == maxLines )
+        {
+            maxLines = (maxLines == 0) ? 1024 : 2 * maxLines;
+            more = (TInpLine *) realloc(lines, maxLines * sizeof(TInpLine));
+            if ( more == NULL ) break;
+            lines = more;
+        }
+        lines[n].text = text;
+        lines[n].len = len;
+        lines[n].lineCount = count;
+        lines[n].err = 0;
+        lines[n].errString = NULL;
+        n++;
+    }
+
+    // --- arrange lines in groups that can be parsed independently
+    if ( text != NULL && type != HEADING_LINE ) nGroups = -1;
+    else
+    {
+        order = (int *) malloc((n + 1) * sizeof(int));
+        first = (int *) malloc((n + 1) * sizeof(int));
+        nGroups = groupLines(sect, lines, n, order, first);
+    }
+
+    // --- if out of memory, leave the section to be read line by line
+    if ( nGroups < 0 )
+    {
+        FREE(lines);
+        FREE(order);
+        FREE(first);
+        InpPos = startPos;
+        return errsum;
+    }
+
+    // --- parse each group of lines
+    #pragma omp parallel for num_threads(nThreads) schedule(dynamic, 64) \
+        if(nGroups >= 4 * nThreads)
+    for (i = 0; i < nGroups; i++)
+    {
+        int k, m;
+        for (k = first[i]; k < first[i+1]; k++)
+        {
+            m = order[k];
+            parseSectionLine(sect, &lines[m], Mobjects[LINK] + m,
+                             Mlinks[CONDUIT] + m);
+        }
+    }
+    if ( sect == s_CONDUIT )
+    {
+        Mobjects[LINK] += n;
+        Mlinks[CONDUIT] += n;
+    }
+
+    // --- report errors in the order their lines appear in the file
+    for (i = 0; i < n; i++)
+    {
+        if ( lines[i].err > 0 )
+        {
+            errsum++;
+            if ( errsum > MAXERRS ) report_writeLine(FMT19);
+            else
+            {
+                error_setInpError(0, lines[i].errString ?
+                                     lines[i].errString : "");
+                memcpy(line, lines[i].text, lines[i].len);
+                line[lines[i].len] = '\0';
+                report_writeInputErrorMsg(lines[i].err, sect, line,
+                                          lines[i].lineCount);
+            }
+            if ( errsum > MAXERRS ) break;
+        }
+    }
+    for (i = 0; i < n; i++) FREE(lines[i].errString);
+    FREE(lines);
+    FREE(order);
+    FREE(first);
+    *lineCount = count;
+    return errsum;
+}
+
+//=============================================================================
+
+int  groupLines(int sect, TInpLine* lines, int n, int* order, int* first)
+//
+//  Input:   sect = current section of input file
+//           lines = data lines of the section
+//           n = number of data lines
+//  Output:  order = indexes of the lines arranged group by group
+//           first = position in order of each group's first line
+//           returns number of groups (or -1 if out of memory)
+//  Purpose: arranges the lines of a section into groups of lines that
+//           update the same object.
+//
+//  Note:    Each line of [CONDUITS] is its own group while the lines of
+//           [XSECTIONS] & [TIMESERIES] are grouped by their link or time
+//           series ID (with lines of unknown IDs placed in one group).
+//
+{
+    int  i, j, nObjects, type;
+    int  nThreads = getThreadCount();
+    int* key;
+    int* count;
+
+    if ( order == NULL || first == NULL ) return -1;
+    if ( sect == s_CONDUIT )
+    {
+        for (i = 0; i < n; i++)
+        {
+            order[i] = i;
+            first[i] = i;
+        }
+        first[n] = n;
+        return n;
+    }
+
+    // --- find the index of the object each line refers to
+    type = (sect == s_XSECTION) ? LINK : TSERIES;
+    nObjects = Nobjects[type];
+    key = (int *) malloc((n + 1) * sizeof(int));
+    count = (int *) calloc(nObjects + 2, sizeof(int));
+    if ( key == NULL || count == NULL )
+    {
+        FREE(key);
+        FREE(count);
+        return -1;
+    }
+    #pragma omp parallel for num_threads(nThreads) if(n >= 4 * nThreads)
+    for (i = 0; i < n; i++)
+    {
+        char  wLine[MAXLINE+1];
+        char* tok[MAXTOKS];
+        memcpy(wLine, lines[i].text, lines[i].len);
+        wLine[lines[i].len] = '\0';
+        key[i] = 0;
+        if ( tokenize(wLine, tok) > 0 )
+            key[i] = project_findObject(type, tok[0]) + 1;
+    }
+
+    // --- sort lines by object, keeping lines of each object in file order
+    for (i = 0; i < n; i++) count[key[i] + 1]++;
+    for (j = 1; j <= nObjects + 1; j++) count[j] += count[j-1];
+    for (i = 0; i < n; i++) order[count[key[i]]++] = i;
+
+    // --- each group holds the lines of one object
+    j = 0;
+    for (i = 0; i < n; i++)
+    {
+        if ( i == 0 || key[order[i]] != key[order[i-1]] ) first[j++] = i;
+    }
+    first[j] = n;
+    FREE(key);
+    FREE(count);
+    return j;
+}
+
+//=============================================================================
+
+int  parseSectionLine(int sect, TInpLine* line, int j, int k)
+//
+//  Input:   sect = current section of input file
+//           line = line of input
+//           j = index of link on line of [CONDUITS]
+//           k = index of conduit on line of [CONDUITS]
+//  Output:  returns error code or 0 if no error found
+//  Purpose: parses a line of a section read by several threads, saving
+//           any error found with the line.
+//
+{
+    char  wLine[MAXLINE+1];
+    char* tok[MAXTOKS];
+    int   ntoks, err = 0;
+
+    memcpy(wLine, line->text, line->len);
+    wLine[line->len] = '\0';
+    ntoks = tokenize(wLine, tok);
+    switch (sect)
+    {
+      case s_CONDUIT:
+        err = link_readParams(j, CONDUIT, k, tok, ntoks);
+        break;
+      case s_XSECTION:
+        err = link_readXsectParams(tok, ntoks);
+        break;
+      case s_TIMESERIES:
+        err = table_readTimeseries(tok, ntoks);
+        break;
+    }
+
+    // --- save the error message set by the parsing function
+    if ( err > 0 )
+    {
+        line->err = err;
+        line->errString = (char *) malloc(strlen(ErrString) + 1);
+        if ( line->errString ) strcpy(line->errString, ErrString);
+    }
+    return err;
+}
+
+//=============================================================================
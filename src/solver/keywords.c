@@ -36,6 +36,14 @@
 //   - Support added for RptFlags.disabled option.
 //   Build 5.2.1:
 //   - Adds NONE to the list of NormalFlowWords.
+//   Build 5.2.4+:
+//   - New option keyword w_OUTPUT_LAYOUT and OutputLayoutWords added.
+//   - w_COMPRESSED added to OutputLayoutWords.
+//   - New option keyword w_PROFILE_FILE added.
+//   - New option keyword w_DYNWAVE_SOLVER and DynwaveSolverWords added.
+//   - New option keyword w_ACTIVE_SET added.
+//   - New option keyword w_LOCAL_STEP_CLASSES added.
+//   - New option keyword w_NETWORK_ORDERING and NetworkOrderingWords added.
 //-----------------------------------------------------------------------------
 #define _CRT_SECURE_NO_DEPRECATE
 
@@ -48,6 +56,7 @@ char* CurveTypeWords[]     = { w_STORAGE, w_DIVERSION, w_TIDAL, w_RATING,
                                w_PUMP1, w_PUMP2, w_PUMP3, w_PUMP4, 
                                w_PUMP5, NULL};
 char* DividerTypeWords[]   = { w_CUTOFF, w_TABULAR, w_WEIR, w_OVERFLOW, NULL};
+char* DynwaveSolverWords[] = { w_PICARD, w_NEWTON, NULL};
 char* EvapTypeWords[]      = { w_CONSTANT, w_MONTHLY, w_TIMESERIES,
                                w_TEMPERATURE, w_FILE, w_RECOVERY,
                                w_DRYONLY, NULL};
@@ -66,6 +75,7 @@ char* LinkTypeWords[]      = { w_CONDUIT, w_PUMP, w_ORIFICE,
 char* LoadUnitsWords[]     = { w_LBS, w_KG, w_LOGN };
 char* NodeTypeWords[]      = { w_JUNCTION, w_OUTFALL,
                                w_STORAGE, w_DIVIDER };
+char* NetworkOrderingWords[] = { w_INPUT, w_RCM, NULL};
 char* NoneAllWords[]       = { w_NONE, w_ALL, NULL};
 char* NormalFlowWords[]    = { w_SLOPE, w_FROUDE, w_BOTH, w_NONE, NULL};
 char* NormalizerWords[]    = { w_PER_AREA, w_PER_CURB, NULL};
@@ -94,8 +104,13 @@ char* OptionWords[]        = { w_FLOW_UNITS,        w_INFIL_MODEL,
                                w_SYS_FLOW_TOL,      w_LAT_FLOW_TOL,
                                w_IGNORE_RDII,       w_MIN_ROUTE_STEP,
                                w_NUM_THREADS,       w_SURCHARGE_METHOD,
+                               w_OUTPUT_LAYOUT,     w_PROFILE_FILE,
+                               w_DYNWAVE_SOLVER,    w_ACTIVE_SET,
+                               w_LOCAL_STEP_CLASSES, w_NETWORK_ORDERING,
                                NULL };
 char* OrificeTypeWords[]   = { w_SIDE, w_BOTTOM, NULL};
+char* OutputLayoutWords[]  = { w_STANDARD, w_COLUMNAR, w_COMPRESSED,
+                               NULL};
 char* OutfallTypeWords[]   = { w_FREE, w_NORMAL, w_FIXED, w_TIDAL,
                                w_TIMESERIES, NULL};
 char* PatternTypeWords[]   = { w_MONTHLY, w_DAILY, w_HOURLY, w_WEEKEND, NULL};
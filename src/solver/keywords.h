@@ -24,6 +24,7 @@ extern char* BuildupTypeWords[];
 extern char* CurveTypeWords[];
 extern char* DividerTypeWords[];
 extern char* DynWaveMethodWords[];
+extern char* DynwaveSolverWords[];
 extern char* EvapTypeWords[];
 extern char* FileModeWords[];
 extern char* FileTypeWords[];
@@ -35,6 +36,7 @@ extern char* InfilModelWords[];
 extern char* LinkOffsetWords[];
 extern char* LinkTypeWords[];
 extern char* LoadUnitsWords[];
+extern char* NetworkOrderingWords[];
 extern char* NodeTypeWords[];
 extern char* NoneAllWords[];
 extern char* NormalFlowWords[];
@@ -44,6 +46,7 @@ extern char* OldRouteModelWords[];
 extern char* OffOnWords[];
 extern char* OptionWords[];
 extern char* OrificeTypeWords[];
+extern char* OutputLayoutWords[];
 extern char* OutfallTypeWords[];
 extern char* PatternTypeWords[];
 extern char* PondingUnitsWords[];
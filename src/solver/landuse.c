@@ -15,6 +15,9 @@
 //     modified to return concentration instead of mass load.
 //   - landuse_getRunoffLoad() re-named to landuse_getWashoffLoad() and
 //     modified to work with landuse_getWashoffQual().
+//   Build 5.2.4+:
+//   - External buildup time series held in memory is looked up without a
+//     shared cursor so that subcatchments can be analyzed in parallel.
 //-----------------------------------------------------------------------------
 #define _CRT_SECURE_NO_DEPRECATE
 
@@ -710,10 +713,19 @@ double landuse_getExternalBuildup(int i, int p, double buildup, double tStep)
     if (NewRunoffTime == 0.0) return 0.0;
 
     // --- get buildup rate (mass/unit/day) over the interval
+    //     (subcatchments may be analyzed in parallel, so a time series
+    //     held in memory is searched without a cursor while one read
+    //     from a file, whose position is shared, is locked)
     if ( ts >= 0 )
     {        
-        rate = sf * table_tseriesLookup(&Tseries[ts],
-               getDateTime(NewRunoffTime), FALSE);
+        if ( Tseries[ts].file.mode == USE_FILE )
+        {
+            #pragma omp critical (landuse_tseries)
+            rate = sf * table_tseriesLookup(&Tseries[ts],
+                   getDateTime(NewRunoffTime), FALSE);
+        }
+        else rate = sf * table_tseriesValue(&Tseries[ts], NULL,
+                         getDateTime(NewRunoffTime), FALSE);
     }
 
     // --- compute buildup at end of time interval
@@ -126,29 +126,29 @@ char* LidTypeWords[] =
 //-----------------------------------------------------------------------------
 //  Shared Variables
 //-----------------------------------------------------------------------------
-static TLidProc*  LidProcs;            // array of LID processes
-static int        LidCount;            // number of LID processes
-static TLidGroup* LidGroups;           // array of LID process groups
-static int        GroupCount;          // number of LID groups (subcatchments)
+static THREADLOCAL TLidProc*  LidProcs;            // array of LID processes
+static THREADLOCAL int        LidCount;            // number of LID processes
+static THREADLOCAL TLidGroup* LidGroups;           // array of LID process groups
+static THREADLOCAL int        GroupCount;          // number of LID groups (subcatchments)
 
-static double     EvapRate;            // evaporation rate (ft/s)
-static double     NativeInfil;         // native soil infil. rate (ft/s)
-static double     MaxNativeInfil;      // native soil infil. rate limit (ft/s)
+static WORKERLOCAL double     EvapRate;            // evaporation rate (ft/s)
+static WORKERLOCAL double     NativeInfil;         // native soil infil. rate (ft/s)
+static WORKERLOCAL double     MaxNativeInfil;      // native soil infil. rate limit (ft/s)
 
 //-----------------------------------------------------------------------------
 //  Imported Variables (from SUBCATCH.C)
 //-----------------------------------------------------------------------------
 // Volumes (ft3) for a subcatchment over a time step 
-extern double     Vevap;               // evaporation
-extern double     Vpevap;              // pervious area evaporation
-extern double     Vinfil;              // non-LID infiltration
-extern double     VlidInfil;           // infiltration from LID units
-extern double     VlidIn;              // impervious area flow to LID units
-extern double     VlidOut;             // surface outflow from LID units
-extern double     VlidDrain;           // drain outflow from LID units
-extern double     VlidReturn;          // LID outflow returned to pervious area
-extern char       HasWetLids;          // TRUE if any LIDs are wet
-                                       // (from RUNOFF.C)
+extern WORKERLOCAL double     Vevap;               // evaporation
+extern WORKERLOCAL double     Vpevap;              // pervious area evaporation
+extern WORKERLOCAL double     Vinfil;              // non-LID infiltration
+extern WORKERLOCAL double     VlidInfil;           // infiltration from LID units
+extern WORKERLOCAL double     VlidIn;              // impervious area flow to LID units
+extern WORKERLOCAL double     VlidOut;             // surface outflow from LID units
+extern WORKERLOCAL double     VlidDrain;           // drain outflow from LID units
+extern WORKERLOCAL double     VlidReturn;          // LID outflow returned to pervious area
+extern THREADLOCAL char       HasWetLids;          // TRUE if any LIDs are wet
+                                                   // (from RUNOFF.C)
 
 //-----------------------------------------------------------------------------
 //  External Functions (prototyped in lid.h)
@@ -101,39 +101,39 @@ enum LidRptVars {
 //-----------------------------------------------------------------------------
 //  Imported variables 
 //-----------------------------------------------------------------------------
-extern char HasWetLids;      // TRUE if any LIDs are wet (declared in runoff.c)
+extern THREADLOCAL char HasWetLids;      // TRUE if any LIDs are wet (declared in runoff.c)
 
 //-----------------------------------------------------------------------------
 //  Local Variables
 //-----------------------------------------------------------------------------
-static TLidUnit*  theLidUnit;     // ptr. to a subcatchment's LID unit
-static TLidProc*  theLidProc;     // ptr. to a LID process
+static WORKERLOCAL TLidUnit*  theLidUnit;     // ptr. to a subcatchment's LID unit
+static WORKERLOCAL TLidProc*  theLidProc;     // ptr. to a LID process
 
-static double     Tstep;          // current time step (sec)
-static double     EvapRate;       // evaporation rate (ft/s)
-static double     MaxNativeInfil; // native soil infil. rate limit (ft/s)
+static WORKERLOCAL double     Tstep;          // current time step (sec)
+static WORKERLOCAL double     EvapRate;       // evaporation rate (ft/s)
+static WORKERLOCAL double     MaxNativeInfil; // native soil infil. rate limit (ft/s)
 
-static double     SurfaceInflow;  // precip. + runon to LID unit (ft/s)
-static double     SurfaceInfil;   // infil. rate from surface layer (ft/s)
-static double     SurfaceEvap;    // evap. rate from surface layer (ft/s)
-static double     SurfaceOutflow; // outflow from surface layer (ft/s)
-static double     SurfaceVolume;  // volume in surface storage (ft)
+static WORKERLOCAL double     SurfaceInflow;  // precip. + runon to LID unit (ft/s)
+static WORKERLOCAL double     SurfaceInfil;   // infil. rate from surface layer (ft/s)
+static WORKERLOCAL double     SurfaceEvap;    // evap. rate from surface layer (ft/s)
+static WORKERLOCAL double     SurfaceOutflow; // outflow from surface layer (ft/s)
+static WORKERLOCAL double     SurfaceVolume;  // volume in surface storage (ft)
 
-static double     PaveEvap;       // evap. from pavement layer (ft/s)
-static double     PavePerc;       // percolation from pavement layer (ft/s)
-static double     PaveVolume;     // volume stored in pavement layer  (ft)
+static WORKERLOCAL double     PaveEvap;       // evap. from pavement layer (ft/s)
+static WORKERLOCAL double     PavePerc;       // percolation from pavement layer (ft/s)
+static WORKERLOCAL double     PaveVolume;     // volume stored in pavement layer  (ft)
 
-static double     SoilEvap;       // evap. from soil layer (ft/s)
-static double     SoilPerc;       // percolation from soil layer (ft/s)
-static double     SoilVolume;     // volume in soil/pavement storage (ft)
+static WORKERLOCAL double     SoilEvap;       // evap. from soil layer (ft/s)
+static WORKERLOCAL double     SoilPerc;       // percolation from soil layer (ft/s)
+static WORKERLOCAL double     SoilVolume;     // volume in soil/pavement storage (ft)
 
-static double     StorageInflow;  // inflow rate to storage layer (ft/s)
-static double     StorageExfil;   // exfil. rate from storage layer (ft/s)
-static double     StorageEvap;    // evap.rate from storage layer (ft/s)
-static double     StorageDrain;   // underdrain flow rate layer (ft/s)
-static double     StorageVolume;  // volume in storage layer (ft)
+static WORKERLOCAL double     StorageInflow;  // inflow rate to storage layer (ft/s)
+static WORKERLOCAL double     StorageExfil;   // exfil. rate from storage layer (ft/s)
+static WORKERLOCAL double     StorageEvap;    // evap.rate from storage layer (ft/s)
+static WORKERLOCAL double     StorageDrain;   // underdrain flow rate layer (ft/s)
+static WORKERLOCAL double     StorageVolume;  // volume in storage layer (ft)
 
-static double     Xold[MAX_LAYERS];  // previous moisture level in LID layers
+static WORKERLOCAL double     Xold[MAX_LAYERS];  // previous moisture level in LID layers
 
 //-----------------------------------------------------------------------------
 //  External Functions (declared in lid.h)
@@ -437,8 +437,12 @@ void lidproc_saveResults(TLidUnit* lidUnit, double ucfRainfall, double ucfRainDe
          totalEvap      < MINFLOW
        ) isDry = TRUE;
 
-    //... update status of HasWetLids
-    if ( !isDry ) HasWetLids = TRUE;
+    //... update status of HasWetLids (units may be evaluated in parallel)
+    if ( !isDry )
+    {
+        #pragma omp atomic write
+        HasWetLids = TRUE;
+    }
 
     //... write results to LID report file
     if ( lidUnit->rptFile )
@@ -41,5 +41,40 @@
 //-------------------------------------------------
 #define CALL(x) (ErrorCode = ((ErrorCode>0) ? (ErrorCode) : (x)))
 
+//-------------------------------------------------------------
+// Storage class of project state (global & file-scope data).
+// A reentrant build (SWMM_REENTRANT) gives each thread its own
+// copy so that independent projects can run concurrently.
+//-------------------------------------------------------------
+#ifdef _MSC_VER
+  #define THREAD_STORAGE __declspec(thread)
+#else
+  #define THREAD_STORAGE __thread
+#endif
+
+#ifdef SWMM_REENTRANT
+  #define THREADLOCAL THREAD_STORAGE
+#else
+  #define THREADLOCAL
+#endif
+
+//-------------------------------------------------------------
+// Storage class of scratch data used while analyzing a single
+// object (e.g., a subcatchment). It is per-thread whenever the
+// objects can be analyzed in parallel by OpenMP worker threads.
+//-------------------------------------------------------------
+#if defined(SWMM_REENTRANT) || defined(_OPENMP)
+  #define WORKERLOCAL THREAD_STORAGE
+#else
+  #define WORKERLOCAL
+#endif
+
+//---------------------------------------------------
+// Reentrant string tokenizer (MSVC names it strtok_s)
+//---------------------------------------------------
+#ifdef _MSC_VER
+  #define strtok_r strtok_s
+#endif
+
 
 #endif //MACROS_H
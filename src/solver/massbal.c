@@ -28,6 +28,9 @@
 //     nodes are when updating total outflow volume.
 //   Build 5.1.013:
 //   - Volume from MinSurfArea no longer included in initial & final storage.
+//   Build 5.2.4+:
+//   - Per-thread partial runoff, loading & groundwater totals added for
+//     subcatchments analyzed in parallel.
 //-----------------------------------------------------------------------------
 #define _CRT_SECURE_NO_DEPRECATE
 
@@ -42,24 +45,39 @@
 static const double MAX_RUNOFF_BALANCE_ERR = 10.0;
 static const double MAX_FLOW_BALANCE_ERR   = 10.0;
 
+//-----------------------------------------------------------------------------
+//  Data Structures
+//-----------------------------------------------------------------------------
+// Partial sums of the totals that subcatchments contribute to
+typedef struct
+{
+    TRunoffTotals   runoff;
+    TGwaterTotals   gwater;
+    TLoadingTotals* loading;
+}  TPartialTotals;
+
 //-----------------------------------------------------------------------------
 //  Shared variables   
 //-----------------------------------------------------------------------------
-TRunoffTotals    RunoffTotals;    // overall surface runoff continuity totals
-TLoadingTotals*  LoadingTotals;   // overall WQ washoff continuity totals
-TGwaterTotals    GwaterTotals;    // overall groundwater continuity totals 
-TRoutingTotals   FlowTotals;      // overall routed flow continuity totals 
-TRoutingTotals*  QualTotals;      // overall routed WQ continuity totals 
-TRoutingTotals   StepFlowTotals;  // routed flow totals over time step
-TRoutingTotals   OldStepFlowTotals;
-TRoutingTotals*  StepQualTotals;  // routed WQ totals over time step
+THREADLOCAL TRunoffTotals    RunoffTotals;    // overall surface runoff continuity totals
+THREADLOCAL TLoadingTotals*  LoadingTotals;   // overall WQ washoff continuity totals
+THREADLOCAL TGwaterTotals    GwaterTotals;    // overall groundwater continuity totals 
+THREADLOCAL TRoutingTotals   FlowTotals;      // overall routed flow continuity totals 
+THREADLOCAL TRoutingTotals*  QualTotals;      // overall routed WQ continuity totals 
+THREADLOCAL TRoutingTotals   StepFlowTotals;  // routed flow totals over time step
+THREADLOCAL TRoutingTotals   OldStepFlowTotals;
+THREADLOCAL TRoutingTotals*  StepQualTotals;  // routed WQ totals over time step
+
+static THREADLOCAL TPartialTotals* PartialTotals; // partial totals for each thread
+static THREADLOCAL int             NumPartials;   // number of partial totals
+static WORKERLOCAL TPartialTotals* ThePartial;    // calling thread's partial totals
 
 //-----------------------------------------------------------------------------
 //  Exportable variables
 //-----------------------------------------------------------------------------
-double*  NodeInflow;              // total inflow volume to each node (ft3)
-double*  NodeOutflow;             // total outflow volume from each node (ft3)
-double   TotalArea;               // total drainage area (ft2)
+THREADLOCAL double*  NodeInflow;              // total inflow volume to each node (ft3)
+THREADLOCAL double*  NodeOutflow;             // total outflow volume from each node (ft3)
+THREADLOCAL double   TotalArea;               // total drainage area (ft2)
 
 //-----------------------------------------------------------------------------
 //  External functions (declared in funcs.h)
@@ -71,6 +89,9 @@ double   TotalArea;               // total drainage area (ft2)
 //  massbal_updateDrainTotals   (called from evalLidUnit in lid.c)
 //  massbal_updateLoadingTotals (called from subcatch_getBuildup)
 //  massbal_updateGwaterTotals  (called from updateMassBal in gwater.c)
+//  massbal_beginPartialTotals  (called from runoff_execute)
+//  massbal_endPartialTotals    (called from runoff_execute)
+//  massbal_mergePartialTotals  (called from runoff_execute)
 //  massbal_updateRoutingTotals (called from routing_execute)
 //  massbal_initTimeStepTotals  (called from routing_execute)
 //  massbal_addInflowFlow       (called from routing.c)
@@ -93,6 +114,8 @@ double massbal_getStoredMass(int pollut);
 double massbal_getLoadingError(void);
 double massbal_getGwaterError(void);
 double massbal_getQualError(void);
+static int  openPartialTotals(int n);
+static void closePartialTotals(void);
 
 
 //=============================================================================
@@ -191,6 +214,13 @@ int massbal_open()
         }
     }
 
+    // --- allocate partial totals for subcatchments analyzed in parallel
+    if ( !openPartialTotals(NumThreads) )
+    {
+        report_writeErrorMsg(ERR_MEMORY, "");
+        return ErrorCode;
+    }
+
     // --- allocate memory for nodal WQ continuity totals
     if ( n > 0 )
     {
@@ -255,6 +285,7 @@ void massbal_close()
     FREE(StepQualTotals);
     FREE(NodeInflow);
     FREE(NodeOutflow);
+    closePartialTotals();
 }
 
 //=============================================================================
@@ -344,14 +375,17 @@ void massbal_updateRunoffTotals(int flowType, double v)
 //  Purpose: updates runoff totals after current time step.
 //
 {
+    TRunoffTotals* totals = &RunoffTotals;
+
+    if ( ThePartial ) totals = &ThePartial->runoff;
     switch(flowType)
     {
-    case RUNOFF_RAINFALL: RunoffTotals.rainfall += v; break;
-    case RUNOFF_EVAP:     RunoffTotals.evap     += v; break;
-    case RUNOFF_INFIL:    RunoffTotals.infil    += v; break;
-    case RUNOFF_RUNOFF:   RunoffTotals.runoff   += v; break;
-    case RUNOFF_DRAINS:   RunoffTotals.drains   += v; break;
-    case RUNOFF_RUNON:    RunoffTotals.runon    += v; break;
+    case RUNOFF_RAINFALL: totals->rainfall += v; break;
+    case RUNOFF_EVAP:     totals->evap     += v; break;
+    case RUNOFF_INFIL:    totals->infil    += v; break;
+    case RUNOFF_RUNOFF:   totals->runoff   += v; break;
+    case RUNOFF_DRAINS:   totals->drains   += v; break;
+    case RUNOFF_RUNON:    totals->runon    += v; break;
     }
 }
 
@@ -369,11 +403,87 @@ void massbal_updateGwaterTotals(double vInfil, double vUpperEvap, double vLowerE
 //  Purpose: updates groundwater totals after current time step.
 //
 {
-    GwaterTotals.infil     += vInfil;
-    GwaterTotals.upperEvap += vUpperEvap;
-    GwaterTotals.lowerEvap += vLowerEvap;
-    GwaterTotals.lowerPerc += vLowerPerc;
-    GwaterTotals.gwater    += vGwater;
+    TGwaterTotals* totals = &GwaterTotals;
+
+    if ( ThePartial ) totals = &ThePartial->gwater;
+    totals->infil     += vInfil;
+    totals->upperEvap += vUpperEvap;
+    totals->lowerEvap += vLowerEvap;
+    totals->lowerPerc += vLowerPerc;
+    totals->gwater    += vGwater;
+}
+
+//=============================================================================
+
+void massbal_beginPartialTotals(int t)
+//
+//  Input:   t = index of the calling thread
+//  Output:  none
+//  Purpose: directs the runoff, loading & groundwater totals contributed by
+//           the calling thread into its own set of partial totals.
+//
+{
+    if ( t >= 0 && t < NumPartials ) ThePartial = &PartialTotals[t];
+}
+
+//=============================================================================
+
+void massbal_endPartialTotals()
+//
+//  Input:   none
+//  Output:  none
+//  Purpose: directs the calling thread's totals back to the overall totals.
+//
+{
+    ThePartial = NULL;
+}
+
+//=============================================================================
+
+void massbal_mergePartialTotals()
+//
+//  Input:   none
+//  Output:  none
+//  Purpose: adds the partial totals of each thread, in thread order, to the
+//           overall runoff, loading & groundwater totals and then clears them.
+//
+//  Note: partial totals are always merged in the same order so that results
+//        are reproducible for a given number of threads.
+//
+{
+    int t, p;
+    TPartialTotals* partial;
+
+    for (t = 0; t < NumPartials; t++)
+    {
+        partial = &PartialTotals[t];
+        RunoffTotals.rainfall += partial->runoff.rainfall;
+        RunoffTotals.evap     += partial->runoff.evap;
+        RunoffTotals.infil    += partial->runoff.infil;
+        RunoffTotals.runoff   += partial->runoff.runoff;
+        RunoffTotals.drains   += partial->runoff.drains;
+        RunoffTotals.runon    += partial->runoff.runon;
+        memset(&partial->runoff, 0, sizeof(TRunoffTotals));
+
+        GwaterTotals.infil     += partial->gwater.infil;
+        GwaterTotals.upperEvap += partial->gwater.upperEvap;
+        GwaterTotals.lowerEvap += partial->gwater.lowerEvap;
+        GwaterTotals.lowerPerc += partial->gwater.lowerPerc;
+        GwaterTotals.gwater    += partial->gwater.gwater;
+        memset(&partial->gwater, 0, sizeof(TGwaterTotals));
+
+        for (p = 0; p < Nobjects[POLLUT]; p++)
+        {
+            LoadingTotals[p].buildup    += partial->loading[p].buildup;
+            LoadingTotals[p].deposition += partial->loading[p].deposition;
+            LoadingTotals[p].sweeping   += partial->loading[p].sweeping;
+            LoadingTotals[p].infil      += partial->loading[p].infil;
+            LoadingTotals[p].bmpRemoval += partial->loading[p].bmpRemoval;
+            LoadingTotals[p].runoff     += partial->loading[p].runoff;
+            LoadingTotals[p].finalLoad  += partial->loading[p].finalLoad;
+            memset(&partial->loading[p], 0, sizeof(TLoadingTotals));
+        }
+    }
 }
 
 //=============================================================================
@@ -444,15 +554,18 @@ void massbal_updateLoadingTotals(int type, int p, double w)
 //  Purpose: adds inflow mass loading to loading totals for current time step.
 //
 {
+    TLoadingTotals* totals = &LoadingTotals[p];
+
+    if ( ThePartial ) totals = &ThePartial->loading[p];
     switch (type)
     {
-      case BUILDUP_LOAD:     LoadingTotals[p].buildup    += w; break;
-      case DEPOSITION_LOAD:  LoadingTotals[p].deposition += w; break;
-      case SWEEPING_LOAD:    LoadingTotals[p].sweeping   += w; break;
-      case INFIL_LOAD:       LoadingTotals[p].infil      += w; break;
-      case BMP_REMOVAL_LOAD: LoadingTotals[p].bmpRemoval += w; break;
-      case RUNOFF_LOAD:      LoadingTotals[p].runoff     += w; break;
-      case FINAL_LOAD:       LoadingTotals[p].finalLoad  += w; break;
+      case BUILDUP_LOAD:     totals->buildup    += w; break;
+      case DEPOSITION_LOAD:  totals->deposition += w; break;
+      case SWEEPING_LOAD:    totals->sweeping   += w; break;
+      case INFIL_LOAD:       totals->infil      += w; break;
+      case BMP_REMOVAL_LOAD: totals->bmpRemoval += w; break;
+      case RUNOFF_LOAD:      totals->runoff     += w; break;
+      case FINAL_LOAD:       totals->finalLoad  += w; break;
     }
 }
 
@@ -1045,6 +1158,53 @@ double massbal_getStoredMass(int p)
     return storedMass;
 }
 
+//=============================================================================
+
+int openPartialTotals(int n)
+//
+//  Input:   n = number of threads used to analyze subcatchments
+//  Output:  returns TRUE if successful, FALSE if out of memory
+//  Purpose: allocates a set of partial totals for each thread.
+//
+{
+    int t;
+
+    PartialTotals = NULL;
+    NumPartials = 0;
+    ThePartial = NULL;
+    if ( n <= 1 ) return TRUE;
+
+    PartialTotals = (TPartialTotals *) calloc(n, sizeof(TPartialTotals));
+    if ( PartialTotals == NULL ) return FALSE;
+    NumPartials = n;
+    if ( Nobjects[POLLUT] > 0 ) for (t = 0; t < n; t++)
+    {
+        PartialTotals[t].loading =
+            (TLoadingTotals *) calloc(Nobjects[POLLUT], sizeof(TLoadingTotals));
+        if ( PartialTotals[t].loading == NULL ) return FALSE;
+    }
+    return TRUE;
+}
+
+//=============================================================================
+
+void closePartialTotals()
+//
+//  Input:   none
+//  Output:  none
+//  Purpose: frees memory used by per-thread partial totals.
+//
+{
+    int t;
+
+    if ( PartialTotals ) for (t = 0; t < NumPartials; t++)
+    {
+        FREE(PartialTotals[t].loading);
+    }
+    FREE(PartialTotals);
+    NumPartials = 0;
+}
+
 // OWA EDIT ##########################################################################
 // function to return the model routing, runoff, and inflow mass balence during a simulation. 
 // EPA SWMM computes these values after the simulation is over.
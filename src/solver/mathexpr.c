@@ -6,9 +6,12 @@
 **                 operators.
 **  AUTHORS:       L. Rossman, US EPA - NRMRL
 **                 F. Shang, University of Cincinnati
-**  VERSION:       5.2.2
-**  LAST UPDATE:   09/02/2022
+**  VERSION:       5.2.4+
+**  LAST UPDATE:   10/16/2026
 **  BUG FIXES:     Problems related to '^' operator (F. Shang, 09/02/2022)
+**  UPDATES:       Expressions are compiled into an array of stack machine
+**                 instructions, with constant terms folded and repeated
+**                 subexpressions evaluated only once (10/16/2026)
 ******************************************************************************/
 /*
 **   Operand codes:
@@ -41,6 +44,8 @@
 **	  27 = log10
 **        28 = step (x<=0 ? 0 : 1)
 **	  31 = ^
+**	  32 = save value on top of stack for reuse
+**	  33 = push a saved value onto the stack
 ******************************************************************************/
 #define _CRT_SECURE_NO_DEPRECATE
 
@@ -49,9 +54,13 @@
 #include <string.h>
 #include <stdlib.h>
 #include <math.h>
+#include "macros.h"
 #include "mathexpr.h"
 
 #define MAX_STACK_SIZE  1024
+#define BATCH_SIZE      64        // items evaluated together in a batch
+#define SAVE_CODE       32        // opcode that saves a subexpression value
+#define LOAD_CODE       33        // opcode that reuses a subexpression value
 
 //  Local declarations
 //--------------------
@@ -66,16 +75,41 @@ struct TreeNode
 };
 typedef struct TreeNode ExprTree;
 
+//  Structure for a distinct subexpression of a math expression
+struct DagNode
+{
+    int    opcode;                // operator code
+    int    ivar;                  // variable index
+    double fvalue;                // numerical value
+    int    left;                  // index of left operand (-1 if none)
+    int    right;                 // index of right operand (-1 if none)
+    int    uses;                  // number of times subexpression appears
+    int    slot;                  // slot where value is saved (-1 if none)
+};
+
+//  Structure used to compile an expression tree into instructions
+typedef struct
+{
+    struct DagNode  *nodes;       // distinct subexpressions
+    int             nodeCount;    // number of distinct subexpressions
+    struct ExprCode *code;        // compiled instructions
+    int             count;        // number of compiled instructions
+    int             depth;        // current number of values on stack
+    int             stackSize;    // largest number of values on stack
+    int             saveCount;    // number of saved subexpression values
+    int             err;          // TRUE if expression is malformed
+} ExprCompiler;
+
 // Local variables
 //----------------
-static int    Err;
-static int    Bc;
-static int    PrevLex, CurLex;
-static int    Len, Pos;
-static char   *S;
-static char   Token[255];
-static int    Ivar;
-static double Fvalue;
+static THREADLOCAL int    Err;
+static THREADLOCAL int    Bc;
+static THREADLOCAL int    PrevLex, CurLex;
+static THREADLOCAL int    Len, Pos;
+static THREADLOCAL char   *S;
+static THREADLOCAL char   Token[255];
+static THREADLOCAL int    Ivar;
+static THREADLOCAL double Fvalue;
 
 // math function names
 char *MathFunc[] =  {"COS", "SIN", "TAN", "COT", "ABS", "SGN",
@@ -98,11 +132,19 @@ static ExprTree * newNode(void);
 static ExprTree * getSingleOp(int *);
 static ExprTree * getOp(int *);
 static ExprTree * getTree(void);
-static void       traverseTree(ExprTree *, MathExpr **);
 static void       deleteTree(ExprTree *);
+static int        countNodes(ExprTree *);
+static void       foldConstants(ExprTree *);
+static int        addDagNode(ExprCompiler *, ExprTree *);
+static void       countUses(ExprCompiler *, int);
+static void       emitCode(ExprCompiler *, int);
+static MathExpr * compileTree(ExprTree *);
+static int        isBinaryOp(int);
+static double     evalUnaryOp(int, double);
+static double     evalBinaryOp(int, double, double);
 
 // Callback functions
-static int    (*getVariableIndex) (char *); // return index of named variable
+static THREADLOCAL int (*getVariableIndex) (char *); // return index of named variable
 
 //=============================================================================
 
@@ -476,36 +518,191 @@ ExprTree * getTree()
 
 //=============================================================================
 
-void traverseTree(ExprTree *tree, MathExpr **expr)
-// Converts binary tree to linked list (postfix format)
+void deleteTree(ExprTree *tree)
 {
-    MathExpr *node;
-    if ( tree == NULL) return;
-    traverseTree(tree->left,  expr);
-    traverseTree(tree->right, expr);
-    node = (MathExpr *) malloc(sizeof(MathExpr));
-    if (node)
+    if (tree)
     {
-        node->fvalue = tree->fvalue;
-        node->opcode = tree->opcode;
-        node->ivar = tree->ivar;
-        node->next = NULL;
-        node->prev = (*expr);
+        if (tree->left)  deleteTree(tree->left);
+        if (tree->right) deleteTree(tree->right);
+        free(tree);
     }
-    if (*expr) (*expr)->next = node;
-    (*expr) = node;
 }
 
 //=============================================================================
 
-void deleteTree(ExprTree *tree)
+int countNodes(ExprTree *tree)
 {
-    if (tree)
+    if (tree == NULL) return 0;
+    return 1 + countNodes(tree->left) + countNodes(tree->right);
+}
+
+//=============================================================================
+
+int isBinaryOp(int opcode)
+{
+    return (opcode >= 3 && opcode <= 6) || opcode == 31;
+}
+
+//=============================================================================
+
+void foldConstants(ExprTree *tree)
+// Replaces operations whose operands are all numbers with their value
+{
+    if (tree == NULL) return;
+    foldConstants(tree->left);
+    foldConstants(tree->right);
+    if (tree->left == NULL || tree->left->opcode != 7) return;
+    if (isBinaryOp(tree->opcode))
     {
-        if (tree->left)  deleteTree(tree->left);
-        if (tree->right) deleteTree(tree->right);
-        free(tree);
+        if (tree->right == NULL || tree->right->opcode != 7) return;
+        tree->fvalue = evalBinaryOp(tree->opcode, tree->left->fvalue,
+                                    tree->right->fvalue);
+    }
+    else if (tree->opcode >= 9 && tree->opcode <= 28 && tree->right == NULL)
+    {
+        tree->fvalue = evalUnaryOp(tree->opcode, tree->left->fvalue);
+    }
+    else return;
+    tree->opcode = 7;
+    deleteTree(tree->left);
+    deleteTree(tree->right);
+    tree->left = NULL;
+    tree->right = NULL;
+}
+
+//=============================================================================
+
+int addDagNode(ExprCompiler *c, ExprTree *tree)
+// Returns the index of the distinct subexpression matching a tree node
+{
+    int i, left, right;
+    struct DagNode *node;
+
+    left = (tree->left) ? addDagNode(c, tree->left) : -1;
+    right = (tree->right) ? addDagNode(c, tree->right) : -1;
+
+    // --- look for an identical subexpression already added
+    for (i = 0; i < c->nodeCount; i++)
+    {
+        node = &c->nodes[i];
+        if (node->opcode == tree->opcode && node->ivar == tree->ivar &&
+            node->left == left && node->right == right &&
+            memcmp(&node->fvalue, &tree->fvalue, sizeof(double)) == 0)
+        {
+            return i;
+        }
+    }
+
+    // --- otherwise add a new one
+    node = &c->nodes[c->nodeCount];
+    node->opcode = tree->opcode;
+    node->ivar = tree->ivar;
+    node->fvalue = tree->fvalue;
+    node->left = left;
+    node->right = right;
+    node->uses = 0;
+    node->slot = -1;
+    return c->nodeCount++;
+}
+
+//=============================================================================
+
+void countUses(ExprCompiler *c, int i)
+// Counts the number of times a subexpression's value is needed
+{
+    struct DagNode *node = &c->nodes[i];
+
+    // --- operands of a repeated subexpression are needed only once
+    node->uses++;
+    if (node->uses > 1) return;
+    if (node->left >= 0)  countUses(c, node->left);
+    if (node->right >= 0) countUses(c, node->right);
+}
+
+//=============================================================================
+
+void emitCode(ExprCompiler *c, int i)
+// Appends the instructions that evaluate a subexpression to compiled code
+{
+    struct DagNode  *node = &c->nodes[i];
+    struct ExprCode *code;
+
+    // --- subexpression already evaluated, so reuse its value
+    if (node->slot >= 0)
+    {
+        code = &c->code[c->count++];
+        code->opcode = LOAD_CODE;
+        code->ivar = node->slot;
+        code->fvalue = 0.0;
+        c->depth++;
+    }
+
+    // --- evaluate operands, then the subexpression's operator
+    else
+    {
+        if (node->left >= 0)  emitCode(c, node->left);
+        if (node->right >= 0) emitCode(c, node->right);
+        code = &c->code[c->count++];
+        code->opcode = node->opcode;
+        code->ivar = node->ivar;
+        code->fvalue = node->fvalue;
+        if (node->opcode == 7 || node->opcode == 8) c->depth++;
+        else if (isBinaryOp(node->opcode))
+        {
+            c->depth--;
+            if (c->depth < 1) c->err = 1;
+        }
+        else if (c->depth < 1) c->err = 1;
+
+        // --- save value of a repeated subexpression (numbers are
+        //     cheaper to push again than to save and reuse)
+        if (node->uses > 1 && node->opcode != 7)
+        {
+            node->slot = c->saveCount++;
+            code = &c->code[c->count++];
+            code->opcode = SAVE_CODE;
+            code->ivar = node->slot;
+            code->fvalue = 0.0;
+        }
+    }
+    if (c->depth > c->stackSize) c->stackSize = c->depth;
+}
+
+//=============================================================================
+
+MathExpr * compileTree(ExprTree *tree)
+// Compiles an expression tree into an array of stack machine instructions
+{
+    ExprCompiler c;
+    MathExpr *expr = NULL;
+    int n;
+
+    foldConstants(tree);
+    n = countNodes(tree);
+    memset(&c, 0, sizeof(c));
+    c.nodes = (struct DagNode *) calloc(n, sizeof(struct DagNode));
+    c.code = (struct ExprCode *) calloc(2*n, sizeof(struct ExprCode));
+    if (c.nodes && c.code)
+    {
+        n = addDagNode(&c, tree);
+        countUses(&c, n);
+        emitCode(&c, n);
+        if (c.err == 0 && c.depth == 1 &&
+            c.stackSize + c.saveCount < MAX_STACK_SIZE)
+        {
+            expr = (MathExpr *) malloc(sizeof(MathExpr));
+        }
+    }
+    if (expr)
+    {
+        expr->count = c.count;
+        expr->stackSize = c.stackSize;
+        expr->saveCount = c.saveCount;
+        expr->code = c.code;
     }
+    else FREE(c.code);
+    FREE(c.nodes);
+    return expr;
 }
 
 //=============================================================================
@@ -513,6 +710,61 @@ void deleteTree(ExprTree *tree)
 // Turn on "precise" floating point option
 #pragma float_control(precise, on, push)
 
+double evalUnaryOp(int opcode, double r1)
+// Applies a function or negation to a value
+{
+    switch (opcode)
+    {
+        case 9:  return -r1;
+        case 10: return cos(r1);
+        case 11: return sin(r1);
+        case 12: return tan(r1);
+        case 13: if (r1 == 0.0) return 0.0;
+                 return 1.0/tan( r1 );
+        case 14: return fabs( r1 );
+        case 15: if (r1 < 0.0) return -1.0;
+                 if (r1 > 0.0) return 1.0;
+                 return 0.0;
+        case 16: if (r1 < 0.0) return 0.0;
+                 return sqrt( r1 );
+        case 17: if (r1 <= 0) return 0.0;
+                 return log(r1);
+        case 18: return exp(r1);
+        case 19: return asin( r1 );
+        case 20: return acos( r1 );
+        case 21: return atan( r1 );
+        case 22: return 1.57079632679489661923 - atan(r1);
+        case 23: return (exp(r1)-exp(-r1))/2.0;
+        case 24: return (exp(r1)+exp(-r1))/2.0;
+        case 25: return (exp(r1)-exp(-r1))/(exp(r1)+exp(-r1));
+        case 26: return (exp(r1)+exp(-r1))/(exp(r1)-exp(-r1));
+        case 27: if (r1 == 0.0) return 0.0;
+                 return log10( r1 );
+        case 28: if (r1 <= 0.0) return 0.0;
+                 return 1.0;
+    }
+    return r1;
+}
+
+//=============================================================================
+
+double evalBinaryOp(int opcode, double r2, double r1)
+// Applies an arithmetic operator to values r2 and r1 (as in r2 op r1)
+{
+    switch (opcode)
+    {
+        case 3:  return r2 + r1;
+        case 4:  return r2 - r1;
+        case 5:  return r2 * r1;
+        case 6:  return r2 / r1;
+        case 31: if (r2 <= 0.0) return 0.0;
+                 return pow(r2, r1);
+    }
+    return r2;
+}
+
+//=============================================================================
+
 double mathexpr_eval(MathExpr *expr, double (*getVariableValue) (int))
 //  Mathematica expression evaluation using a stack
 {
@@ -521,205 +773,73 @@ double mathexpr_eval(MathExpr *expr, double (*getVariableValue) (int))
 //     since this function can be called recursively.
 
     double ExprStack[MAX_STACK_SIZE];
-    MathExpr *node = expr;
-    double r1, r2;
+    double *saved;
+    struct ExprCode *code;
+    double r1;
+    int i;
     int stackindex = 0;
-    
+
+    if (expr == NULL) return 0.0;
+    saved = ExprStack + expr->stackSize + 1;
+    code = expr->code;
     ExprStack[0] = 0.0;
-    while(node != NULL && stackindex >= 0)
+    for (i = 0; i < expr->count; i++)
     {
-	switch (node->opcode)
-	{
-	    case 3:
- 		r1 = ExprStack[stackindex];
-		stackindex--;
-                if (stackindex < 0) break;
-		r2 = ExprStack[stackindex];
-		ExprStack[stackindex] = r2 + r1;
-		break;
-
-            case 4:  
-                r1 = ExprStack[stackindex];
-		stackindex--;
-                if (stackindex < 0) break;
-		r2 = ExprStack[stackindex];
-		ExprStack[stackindex] = r2 - r1;
-		break;
-
-            case 5:  
-                r1 = ExprStack[stackindex];
-		stackindex--;
-                if (stackindex < 0) break;
-		r2 = ExprStack[stackindex];
-		ExprStack[stackindex] = r2 * r1;
-		break;
-
-            case 6:  
-		r1 = ExprStack[stackindex];
-		stackindex--;
-                if (stackindex < 0) break;
-                r2 = ExprStack[stackindex];
-		ExprStack[stackindex] = r2 / r1;
-		break;				
-
-            case 7:  
-		stackindex++;
-                if (stackindex >= MAX_STACK_SIZE) break;
-		ExprStack[stackindex] = node->fvalue;
-		break;
+        switch (code[i].opcode)
+        {
+            case 3:
+                stackindex--;
+                ExprStack[stackindex] += ExprStack[stackindex+1];
+                break;
+
+            case 4:
+                stackindex--;
+                ExprStack[stackindex] -= ExprStack[stackindex+1];
+                break;
+
+            case 5:
+                stackindex--;
+                ExprStack[stackindex] *= ExprStack[stackindex+1];
+                break;
+
+            case 6:
+                stackindex--;
+                ExprStack[stackindex] /= ExprStack[stackindex+1];
+                break;
+
+            case 7:
+                ExprStack[++stackindex] = code[i].fvalue;
+                break;
 
             case 8:
                 if (getVariableValue != NULL)
                 {
-                    r1 = getVariableValue(node->ivar);
+                    r1 = getVariableValue(code[i].ivar);
                 }
                 else r1 = 0.0;
-		stackindex++;
-                if (stackindex >= MAX_STACK_SIZE) break;
-                ExprStack[stackindex] = r1;
-		break;
-
-            case 9: 
-		ExprStack[stackindex] = -ExprStack[stackindex];
-		break;
-
-            case 10: 
-		r1 = ExprStack[stackindex];
-		r2 = cos(r1);
-		ExprStack[stackindex] = r2;
-		break;
-
-            case 11: 
-		r1 = ExprStack[stackindex];
-		r2 = sin(r1);
-		ExprStack[stackindex] = r2;
-		break;
-
-            case 12: 
-		r1 = ExprStack[stackindex];
-		r2 = tan(r1);
-		ExprStack[stackindex] = r2;
-		break;
-
-            case 13: 
-		r1 = ExprStack[stackindex];
-		if (r1 == 0.0) r2 = 0.0;
-		else r2 = 1.0/tan( r1 );    
-		ExprStack[stackindex] = r2;
-		break;
-
-            case 14: 
-		r1 = ExprStack[stackindex];
-		r2 = fabs( r1 );       
-		ExprStack[stackindex] = r2;
-		break;
-
-            case 15: 
-		r1 = ExprStack[stackindex];
-		if (r1 < 0.0) r2 = -1.0;
-		else if (r1 > 0.0) r2 = 1.0;
-		else r2 = 0.0;
-		ExprStack[stackindex] = r2;
-		break;
-
-            case 16: 
-		r1 = ExprStack[stackindex];
-		if (r1 < 0.0) r2 = 0.0;
-		else r2 = sqrt( r1 );     
-		ExprStack[stackindex] = r2;
-		break;
-
-            case 17: 
-		r1 = ExprStack[stackindex];
-		if (r1 <= 0) r2 = 0.0;
-		else r2 = log(r1);
-		ExprStack[stackindex] = r2;
-		break;
-
-            case 18: 
-		r1 = ExprStack[stackindex];
-		r2 = exp(r1);
-		ExprStack[stackindex] = r2;
-		break;
-
-            case 19: 
-		r1 = ExprStack[stackindex];
-		r2 = asin( r1 );
-		ExprStack[stackindex] = r2;
-		break;
-
-            case 20: 
-		r1 = ExprStack[stackindex];
-		r2 = acos( r1 );      
-		ExprStack[stackindex] = r2;
-		break;
-
-            case 21: 
-		r1 = ExprStack[stackindex];
-		r2 = atan( r1 );      
-		ExprStack[stackindex] = r2;
-		break;
-
-            case 22: 
-		r1 = ExprStack[stackindex];
-		r2 = 1.57079632679489661923 - atan(r1);  
-		ExprStack[stackindex] = r2;
-		break;
-
-            case 23:
-		r1 = ExprStack[stackindex];
-		r2 = (exp(r1)-exp(-r1))/2.0;
-		ExprStack[stackindex] = r2;
-		break;
-
-            case 24: 
-		r1 = ExprStack[stackindex];
-		r2 = (exp(r1)+exp(-r1))/2.0;
-		ExprStack[stackindex] = r2;
-		break;
-
-            case 25: 
-		r1 = ExprStack[stackindex];
-		r2 = (exp(r1)-exp(-r1))/(exp(r1)+exp(-r1));
-		ExprStack[stackindex] = r2;
-		break;
-
-            case 26: 
-		r1 = ExprStack[stackindex];
-		r2 = (exp(r1)+exp(-r1))/(exp(r1)-exp(-r1));
-		ExprStack[stackindex] = r2;
-		break;
-
-            case 27: 
-		r1 = ExprStack[stackindex];
-		if (r1 == 0.0) r2 = 0.0;
-		else r2 = log10( r1 );     
-		ExprStack[stackindex] = r2;
-		break;
-
-            case 28:
- 		r1 = ExprStack[stackindex];
-		if (r1 <= 0.0) r2 = 0.0;
-		else           r2 = 1.0;
-		ExprStack[stackindex] = r2;
-		break;
-               
-            case 31: 
-		r1 = ExprStack[stackindex];
+                ExprStack[++stackindex] = r1;
+                break;
+
+            case 31:
                 stackindex--;
-                if (stackindex < 0) break;
-                r2 = ExprStack[stackindex];
-		if (r2 <= 0.0) r2 = 0.0;
-		else r2 = pow(r2, r1);
-		ExprStack[stackindex] = r2;
-		break;
+                ExprStack[stackindex] = evalBinaryOp(31,
+                    ExprStack[stackindex], ExprStack[stackindex+1]);
+                break;
+
+            case SAVE_CODE:
+                saved[code[i].ivar] = ExprStack[stackindex];
+                break;
+
+            case LOAD_CODE:
+                ExprStack[++stackindex] = saved[code[i].ivar];
+                break;
+
+            default:
+                ExprStack[stackindex] = evalUnaryOp(code[i].opcode,
+                    ExprStack[stackindex]);
         }
-        node = node->next;
     }
-    if (stackindex >= 0)
-        r1 = ExprStack[stackindex];
-    else
-        r1 = 0.0;
+    r1 = ExprStack[stackindex];
 
     // Set result to 0 if it is NaN due to an illegal math op
     if ( r1 != r1 ) r1 = 0.0;
@@ -727,6 +847,117 @@ double mathexpr_eval(MathExpr *expr, double (*getVariableValue) (int))
     return r1;
 }
 
+//=============================================================================
+
+void mathexpr_evalBatch(MathExpr *expr, int n,
+                        double (*getVariableValue) (int, int), double *result)
+//  Evaluates an expression for items 0 to n-1, where getVariableValue(v, j)
+//  returns the value of variable v for item j, placing the value for each
+//  item in result. Each instruction is applied to a block of items at a
+//  time, so that the arithmetic runs over contiguous arrays.
+{
+    double buffer[16*BATCH_SIZE];
+    double *values = buffer;
+    double *x, *y;
+    struct ExprCode *code;
+    int first, m, i, j, k, op, size;
+
+    if (n <= 0) return;
+    if (expr == NULL)
+    {
+        for (j = 0; j < n; j++) result[j] = 0.0;
+        return;
+    }
+
+    // --- each stack entry and saved value holds a block of item values
+    size = expr->stackSize + expr->saveCount + 1;
+    if (size > 16)
+    {
+        values = (double *) malloc(size * BATCH_SIZE * sizeof(double));
+        if (values == NULL)
+        {
+            for (j = 0; j < n; j++) result[j] = 0.0;
+            return;
+        }
+    }
+    code = expr->code;
+
+    for (first = 0; first < n; first += BATCH_SIZE)
+    {
+        m = MIN(BATCH_SIZE, n - first);
+        k = 0;
+        for (j = 0; j < m; j++) values[j] = 0.0;
+        for (i = 0; i < expr->count; i++)
+        {
+            op = code[i].opcode;
+            if (isBinaryOp(op)) k--;
+            else if (op == 7 || op == 8 || op == LOAD_CODE) k++;
+            x = values + k*BATCH_SIZE;
+            y = x + BATCH_SIZE;
+            switch (op)
+            {
+                case 3:
+                    for (j = 0; j < m; j++) x[j] += y[j];
+                    break;
+
+                case 4:
+                    for (j = 0; j < m; j++) x[j] -= y[j];
+                    break;
+
+                case 5:
+                    for (j = 0; j < m; j++) x[j] *= y[j];
+                    break;
+
+                case 6:
+                    for (j = 0; j < m; j++) x[j] /= y[j];
+                    break;
+
+                case 7:
+                    for (j = 0; j < m; j++) x[j] = code[i].fvalue;
+                    break;
+
+                case 8:
+                    if (getVariableValue != NULL)
+                        for (j = 0; j < m; j++)
+                            x[j] = getVariableValue(code[i].ivar, first+j);
+                    else
+                        for (j = 0; j < m; j++) x[j] = 0.0;
+                    break;
+
+                case 9:
+                    for (j = 0; j < m; j++) x[j] = -x[j];
+                    break;
+
+                case 31:
+                    for (j = 0; j < m; j++) x[j] = evalBinaryOp(31, x[j], y[j]);
+                    break;
+
+                case SAVE_CODE:
+                    y = values + (expr->stackSize + 1 + code[i].ivar)*BATCH_SIZE;
+                    memcpy(y, x, m * sizeof(double));
+                    break;
+
+                case LOAD_CODE:
+                    y = values + (expr->stackSize + 1 + code[i].ivar)*BATCH_SIZE;
+                    memcpy(x, y, m * sizeof(double));
+                    break;
+
+                default:
+                    for (j = 0; j < m; j++) x[j] = evalUnaryOp(op, x[j]);
+            }
+        }
+
+        // Set results to 0 if they are NaN due to an illegal math op
+        x = values + k*BATCH_SIZE;
+        for (j = 0; j < m; j++)
+        {
+            if (x[j] != x[j]) result[first+j] = 0.0;
+            else              result[first+j] = x[j];
+        }
+    }
+    if (values != buffer) free(values);
+}
+
 // Turn off "precise" floating point option
 #pragma float_control(pop)
 
@@ -734,7 +965,7 @@ double mathexpr_eval(MathExpr *expr, double (*getVariableValue) (int))
 
 void mathexpr_delete(MathExpr *expr)
 {
-    if (expr) mathexpr_delete(expr->next);
+    if (expr) free(expr->code);
     free(expr);
 }
 
@@ -743,7 +974,6 @@ void mathexpr_delete(MathExpr *expr)
 MathExpr * mathexpr_create(char *formula, int (*getVar) (char *))
 {
     ExprTree *tree;
-    MathExpr *expr = NULL;
     MathExpr *result = NULL;
     getVariableIndex = getVar;
     Err = 0;
@@ -754,15 +984,7 @@ MathExpr * mathexpr_create(char *formula, int (*getVar) (char *))
     Pos = 0;
     Bc = 0;
     tree = getTree();
-    if (Bc == 0 && Err == 0)
-    {
-        traverseTree(tree, &expr);
-        while (expr)
-        {
-            result = expr;
-            expr = expr->prev;
-        }
-    }
+    if (Bc == 0 && Err == 0 && tree != NULL) result = compileTree(tree);
     deleteTree(tree);
     return result;
 }
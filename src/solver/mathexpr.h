@@ -4,32 +4,43 @@
 **  DESCRIPTION:   header file for the math expression parser in mathexpr.c.
 **  AUTHORS:       L. Rossman, US EPA - NRMRL
 **                 F. Shang, University of Cincinnati
-**  VERSION:       5.1.001
-**  LAST UPDATE:   03/20/14
+**  VERSION:       5.2.4+
+**  LAST UPDATE:   10/16/26
 ******************************************************************************/
 
 #ifndef MATHEXPR_H
 #define MATHEXPR_H
 
 
-//  Node in a tokenized math expression list
-struct ExprNode
+//  Instruction of a compiled math expression
+struct ExprCode
 {
     int    opcode;                // operator code
-    int    ivar;                  // variable index
+    int    ivar;                  // variable index or saved value slot
     double fvalue;                // numerical value
-	struct ExprNode *prev;        // previous node
-    struct ExprNode *next;        // next node
 };
-typedef struct ExprNode MathExpr;
 
-//  Creates a tokenized math expression from a string
+//  Math expression compiled into an array of stack machine instructions
+struct ExprProgram
+{
+    int    count;                 // number of instructions
+    int    stackSize;             // largest number of values on the stack
+    int    saveCount;             // number of saved subexpression values
+    struct ExprCode *code;        // array of instructions
+};
+typedef struct ExprProgram MathExpr;
+
+//  Creates a compiled math expression from a string
 MathExpr* mathexpr_create(char* s, int (*getVar) (char *));
 
-//  Evaluates a tokenized math expression
+//  Evaluates a compiled math expression
 double mathexpr_eval(MathExpr* expr, double (*getVal) (int));
 
-//  Deletes a tokenized math expression
+//  Evaluates a compiled math expression for each of n items
+void  mathexpr_evalBatch(MathExpr* expr, int n, double (*getVal) (int, int),
+                         double* result);
+
+//  Deletes a compiled math expression
 void  mathexpr_delete(MathExpr* expr);
 
 
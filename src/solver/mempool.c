@@ -13,10 +13,18 @@
 //  AllocReset()    - reset the current pool
 //  AllocSetPool()  - set the current pool
 //  AllocFree()     - free the memory used by the current pool.
+//
+//  Modified 10/16/26 (Build 5.2.4+) so that separate pools can hold
+//  different kinds of objects without changing the current pool:
+//
+//  AllocNewPool()    - create an alloc pool
+//  AllocFromPool()   - allocate memory from a pool
+//  AllocDeletePool() - free the memory used by a pool
 //-----------------------------------------------------------------------------
 
 
 #include <stdlib.h>
+#include "macros.h"
 #include "mempool.h"
 
 /*
@@ -26,6 +34,13 @@
 
 #define ALLOC_BLOCK_SIZE   64000       /*(62*1024)*/
 
+/*
+**  ALLOC_ALIGN - alignment of allocated memory, suitable for doubles
+**  and pointers (must be a power of 2).
+*/
+
+#define ALLOC_ALIGN        8
+
 /*
 **  alloc_hdr_t - Header for each block of memory.
 */
@@ -52,7 +67,7 @@ typedef struct alloc_root_s
 **  root - Pointer to the current pool.
 */
 
-static alloc_root_t *root;
+static THREADLOCAL alloc_root_t *root;
 
 
 /*
@@ -81,6 +96,29 @@ static alloc_hdr_t * AllocHdr()
 }
 
 
+/*
+**  AllocNewPool()
+**
+**  Create a new memory pool with one block without making it
+**  the current pool. Returns pointer to the new pool.
+*/
+
+alloc_handle_t * AllocNewPool()
+{
+    alloc_root_t *pool;
+
+    pool = (alloc_root_t *) malloc(sizeof(alloc_root_t));
+    if (pool == NULL) return(NULL);
+    if ( (pool->first = AllocHdr()) == NULL)
+    {
+        free((char *) pool);
+        return(NULL);
+    }
+    pool->current = pool->first;
+    return((alloc_handle_t *) pool);
+}
+
+
 /*
 **  AllocInit()
 **
@@ -90,34 +128,26 @@ static alloc_hdr_t * AllocHdr()
 
 alloc_handle_t * AllocInit()
 {
-    alloc_handle_t *newpool;
-
-    root = (alloc_root_t *) malloc(sizeof(alloc_root_t));
-    if (root == NULL) return(NULL);
-    if ( (root->first = AllocHdr()) == NULL) return(NULL);
-    root->current = root->first;
-    newpool = (alloc_handle_t *) root;
-    return(newpool);
+    root = (alloc_root_t *) AllocNewPool();
+    return((alloc_handle_t *) root);
 }
 
 
 /*
-**  Alloc()
+**  AllocFromPool()
 **
-**  Use as a direct replacement for malloc().  Allocates
-**  memory from the current pool.
+**  Allocates memory from a given pool. Sizes larger than a
+**  block are not supported.
 */
 
-char * Alloc(long size)
+char * AllocFromPool(alloc_handle_t *handle, long size)
 {
-    alloc_hdr_t  *hdr = root->current;
+    alloc_root_t *pool = (alloc_root_t *) handle;
+    alloc_hdr_t  *hdr = pool->current;
     char         *ptr;
 
-    /*
-    **  Align to 4 byte boundary - should be ok for most machines.
-    **  Change this if your machine has weird alignment requirements.
-    */
-    size = (size + 3) & 0xfffffffc;
+    /* Align to ALLOC_ALIGN byte boundary. */
+    size = (size + ALLOC_ALIGN - 1) & ~((long)ALLOC_ALIGN - 1);
 
     ptr = hdr->free;
     hdr->free += size;
@@ -132,18 +162,18 @@ char * Alloc(long size)
         {
             /* re-use block */
             hdr->next->free = hdr->next->block;
-            root->current = hdr->next;
+            pool->current = hdr->next;
         }
         else
         {
             /* extend the pool with a new block */
             if ( (hdr->next = AllocHdr()) == NULL) return(NULL);
-            root->current = hdr->next;
+            pool->current = hdr->next;
         }
 
         /* set ptr to the first location in the next block */
-        ptr = root->current->free;
-        root->current->free += size;
+        ptr = pool->current->free;
+        pool->current->free += size;
     }
 
     /* Return pointer to allocated memory. */
@@ -152,6 +182,19 @@ char * Alloc(long size)
 }
 
 
+/*
+**  Alloc()
+**
+**  Use as a direct replacement for malloc().  Allocates
+**  memory from the current pool.
+*/
+
+char * Alloc(long size)
+{
+    return(AllocFromPool((alloc_handle_t *) root, size));
+}
+
+
 /*
 **  AllocSetPool()
 **
@@ -181,17 +224,19 @@ void  AllocReset()
 
 
 /*
-**  AllocFreePool()
+**  AllocDeletePool()
 **
-**  Free the memory used by the current pool.
-**  Don't use where AllocReset() could be used.
+**  Free the memory used by a given pool.
 */
 
-void  AllocFreePool()
+void  AllocDeletePool(alloc_handle_t *handle)
 {
+    alloc_root_t *pool = (alloc_root_t *) handle;
     alloc_hdr_t  *tmp,
-                 *hdr = root->first;
+                 *hdr;
 
+    if (pool == NULL) return;
+    hdr = pool->first;
     while (hdr != NULL)
     {
         tmp = hdr->next;
@@ -199,6 +244,19 @@ void  AllocFreePool()
         free((char *) hdr);
         hdr = tmp;
     }
-    free((char *) root);
+    free((char *) pool);
+}
+
+
+/*
+**  AllocFreePool()
+**
+**  Free the memory used by the current pool.
+**  Don't use where AllocReset() could be used.
+*/
+
+void  AllocFreePool()
+{
+    AllocDeletePool((alloc_handle_t *) root);
     root = NULL;
 }
@@ -22,5 +22,9 @@ alloc_handle_t *AllocSetPool(alloc_handle_t *);
 void            AllocReset(void);
 void            AllocFreePool(void);
 
+alloc_handle_t *AllocNewPool(void);
+char           *AllocFromPool(alloc_handle_t *, long);
+void            AllocDeletePool(alloc_handle_t *);
+
 
 #endif //MEMPOOL_H
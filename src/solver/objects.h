@@ -56,6 +56,10 @@
 //  - Support added for tracking a gage's prior n-hour rainfall total.
 //  - Removed extIfaceInflow member from ExtInflow struct.
 //  - Refactored TRptFlags struct.
+//  Build 5.2.4+:
+//  - Curve data points also stored in arrays for faster lookups.
+//  - Table data points stored in arrays instead of a linked list.
+//  - Work done with local time steps added to time step statistics.
 //-----------------------------------------------------------------------------
 
 #ifndef OBJECTS_H
@@ -83,17 +87,6 @@ typedef struct
    FILE*         file;                 // FILE structure pointer
 }  TFile;
 
-//-----------------------------------------
-// LINKED LIST ENTRY FOR TABLES/TIME SERIES
-//-----------------------------------------
-struct  TableEntry
-{
-   double  x;
-   double  y;
-   struct  TableEntry* next;
-};
-typedef struct TableEntry TTableEntry;
-
 //-------------------------
 // CURVE/TIME SERIES OBJECT
 //-------------------------
@@ -106,10 +99,19 @@ typedef struct
    double        lastDate;        // last input date for time series
    double        x1, x2;          // current bracket on x-values
    double        y1, y2;          // current bracket on y-values
-   TTableEntry*  firstEntry;      // first data point
-   TTableEntry*  lastEntry;       // last data point
-   TTableEntry*  thisEntry;       // current data point
+   int           nPoints;         // number of data points
+   int           maxPoints;       // number of data points allocated for
+   int           thisPoint;       // index of current data point
+   int           cursor;          // index of end of time series lookup bracket
+   double*       xData;           // x-values of data points
+   double*       yData;           // y-values of data points
    TFile         file;            // external data file
+   //-----------------------------
+   double        dxGrid;          // interval of evenly spaced x-values (or 0)
+   char          yRising;         // TRUE if y-values never decrease
+   char          vRising;         // TRUE if storage volumes never decrease
+   double*       vData;           // storage volume from first x-value up to x
+   double*       v0Data;          // storage volume from 0 up to x
 }  TTable;
 
 //-----------------
@@ -489,6 +491,7 @@ typedef struct
 {
     int          treatType;       // treatment equation type: REMOVAL/CONCEN
     MathExpr*    equation;        // treatment eqn. as tokenized math terms
+    int          exprIndex;       // index of eqn. shared with other nodes
 } TTreatment;
 
 //------------
@@ -973,6 +976,10 @@ typedef struct
    int           timeStepCount;        // number of routing time steps
    double        trialsCount;          // total routing trials used
    double        steadyStateTime;      // total time in steady state (sec)
+   double        routingWallTime;      // wall clock time of flow routing
+                                       // with local time steps (sec)
+   double        localStepWallTime;    // part of it spent on local time
+                                       // steps (sec)
    double        timeStepIntervals[TIMELEVELS];  // time step intervals (sec)
    int           timeStepCounts[TIMELEVELS];     // count of steps in interval
 }  TTimeStepStats;
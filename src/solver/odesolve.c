@@ -7,13 +7,21 @@
 //
 //   Date:     11/15/06
 //   Author:   L. Rossman
+//
+//   Update History
+//   ==============
+//   Build 5.2.4+:
+//   - Integration steps are counted in the run time profile.
 //-----------------------------------------------------------------------------
 
 #include <stdlib.h>
 #include <math.h>
+#include "macros.h"
 #include "odesolve.h"
+#include "profile.h"
 
 #define MAXSTP 10000
+#define NMAX   4          // max. number of equations (MAXODES in consts.h)
 #define TINY   1.0e-30
 #define SAFETY 0.9
 #define PGROW  -0.2
@@ -24,13 +32,13 @@
 //-----------------------------------------------------------------------------
 //    Local declarations
 //-----------------------------------------------------------------------------
-int      nmax;      // max. number of equations
-double*  y;         // dependent variable
-double*  yscal;     // scaling factors
-double*  yerr;      // integration errors
-double*  ytemp;     // temporary values of y
-double*  dydx;      // derivatives of y
-double*  ak;        // derivatives at intermediate points
+// (fixed-size arrays so that each worker thread has its own copy)
+static WORKERLOCAL double  y[NMAX];        // dependent variable
+static WORKERLOCAL double  yscal[NMAX];    // scaling factors
+static WORKERLOCAL double  yerr[NMAX];     // integration errors
+static WORKERLOCAL double  ytemp[NMAX];    // temporary values of y
+static WORKERLOCAL double  dydx[NMAX];     // derivatives of y
+static WORKERLOCAL double  ak[5*NMAX];     // derivatives at intermediate points
 
 
 // function that integrates over an error-controlled stepsize
@@ -47,17 +55,7 @@ void rkck(double x, int n, double h, void (*derivs)(double, double*, double*));
 //-----------------------------------------------------------------------------
 int odesolve_open(int n)
 {
-    int n5 = n*5;
-    nmax  = 0;
-    y     = (double *) calloc(n, sizeof(double));
-    yscal = (double *) calloc(n, sizeof(double));
-    dydx  = (double *) calloc(n, sizeof(double));
-    yerr  = (double *) calloc(n, sizeof(double));
-    ytemp = (double *) calloc(n, sizeof(double));
-    ak    = (double *) calloc(n5, sizeof(double));
-    if ( !y || !yscal || !dydx || !yerr || !ytemp || !ak ) return 0;
-    nmax = n;
-    return 1;
+    return (n <= NMAX);
 }
 
 
@@ -66,19 +64,6 @@ int odesolve_open(int n)
 //-----------------------------------------------------------------------------
 void odesolve_close()
 {
-    if ( y ) free(y);
-    y = NULL;
-    if ( yscal ) free(yscal);
-    yscal = NULL;
-    if ( dydx ) free(dydx);
-    dydx = NULL;
-    if ( yerr ) free(yerr);
-    yerr = NULL;
-    if ( ytemp ) free(ytemp);
-    ytemp = NULL;
-    if ( ak ) free(ak);
-    ak = NULL;
-    nmax = 0;
 }
 
 
@@ -97,7 +82,7 @@ int odesolve_integrate(double ystart[], int n, double x1, double x2,
     double hdid, hnext;
     double x = x1;
     double h = h1;
-    if (nmax < n) return 1;
+    if (n > NMAX) return 1;
     for (i=0; i<n; i++) y[i] = ystart[i];
     for (nstp=1; nstp<=MAXSTP; nstp++)
     {
@@ -107,6 +92,7 @@ int odesolve_integrate(double ystart[], int n, double x1, double x2,
         if ((x+h-x2)*(x+h-x1) > 0.0) h = x2 - x;
         errcode = rkqs(&x,n,h,eps,&hdid,&hnext,derivs);
         if (errcode) break;
+        profile_count(PROFILE_ODE_STEPS);
         if ((x-x2)*(x2-x1) >= 0.0)
         {
             for (i=0; i<n; i++) ystart[i] = y[i];
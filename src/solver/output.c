@@ -28,6 +28,17 @@
 //   - Large file support added.
 //   Build5.2.1:
 //   - Corrects the definition of F_OFF for non-Microsoft C/C++ compilers.
+//   Build 5.2.4+:
+//   - Optional columnar layout added that buffers the results of a chunk
+//     of reporting periods and saves each result variable's values over
+//     the chunk contiguously.
+//   - Optional compressed layout added that packs each block of series in
+//     a chunk with a lossless codec.
+//   - Results are buffered for several reporting periods and written to
+//     file, along with outfall results saved to a routing interface file,
+//     by a background thread.
+//   - output_readBatch added to read the results of several objects over
+//     a range of reporting periods in one pass through the file.
 //-----------------------------------------------------------------------------
 #define _CRT_SECURE_NO_DEPRECATE
 
@@ -44,48 +55,110 @@
 #include <string.h>
 #include <math.h>
 #include "headers.h"
+#include "shared/outcodec.h"
+#include "bgtask.h"
 #include "version.h" // OWA manages model version differently from EPA SWMM
 
 // Definition of 4-byte integer, 4-byte real and 8-byte real types
 #define INT4  int
+#define INT8  long long
 #define REAL4 float
 #define REAL8 double
 
 enum InputDataType {INPUT_TYPE_CODE, INPUT_AREA, INPUT_INVERT, INPUT_MAX_DEPTH,
                     INPUT_OFFSET, INPUT_LENGTH};
 
+// Memory used to read whole reporting periods at a time in a batch read
+#define READ_BYTES        1048576
+
+// Memory used by each of the two buffers of reporting periods
+#define BUFFER_BYTES      4194304     // standard layout
+#define CHUNK_BYTES       33554432    // a chunk of the columnar layouts
+#define MAX_CHUNK_PERIODS 1024
+#define BLOCK_SERIES      256         // series transposed (and packed) at a time
+
 typedef struct
 {
     REAL4* xAvg;
 }   TAvgResults;
 
+// --- state of the writer that saves buffered reporting periods to file
+//     (it is used by a background thread so can't refer to project data)
+typedef struct
+{
+    FILE*  file;                  // binary output file
+    int    layout;                // layout of results in file
+    int    chunkPeriods;          // periods per chunk (0 if not chunked)
+    F_OFF  numResults;            // number of values saved per period
+    F_OFF  startPos;              // file position where results start
+    int    numBlocks;             // blocks of series per chunk
+    REAL4* series;                // block of series being written or read
+    INT4*  blockSizes;            // packed size of each block of a chunk
+    unsigned char* packed;        // a packed block of series
+    unsigned char* work;          // work space used for packing
+    F_OFF* chunkPos;              // file position of each chunk
+    int    numChunks;             // number of chunks written
+    int    maxChunks;             // capacity of chunkPos
+}   TOutWriter;
+
+// --- buffer of reporting periods waiting to be written to file
+typedef struct
+{
+    TOutWriter* writer;           // writer that saves the buffer
+    int    count;                 // number of periods held
+    REAL8* dates;                 // dates of the periods
+    REAL4* results;               // values saved in each period
+    FILE*  ifaceFile;             // routing interface file (or NULL)
+    char*  ifaceText;             // outfall results for interface file
+    size_t ifaceLen;              // length of ifaceText
+    size_t ifaceSize;             // capacity of ifaceText
+    int    error;                 // error code from writing the buffer
+}   TOutBuffer;
+
 //-----------------------------------------------------------------------------
 //  Shared variables    
 //-----------------------------------------------------------------------------
-static F_OFF     IDStartPos;           // starting file position of ID names
-static F_OFF     InputStartPos;        // starting file position of input data
-static F_OFF     OutputStartPos;       // starting file position of output data
-static F_OFF     BytesPerPeriod;       // bytes saved per simulation time period
-static INT4      NumSubcatchVars;      // number of subcatchment output variables
-static INT4      NumNodeVars;          // number of node output variables
-static INT4      NumLinkVars;          // number of link output variables
-static INT4      NumSubcatch;          // number of subcatchments reported on
-static INT4      NumNodes;             // number of nodes reported on
-static INT4      NumLinks;             // number of links reported on
-static INT4      NumPolluts;           // number of pollutants reported on
-
-static REAL4     SysResults[MAX_SYS_RESULTS];    // values of system output vars.
-
-static TAvgResults* AvgLinkResults;
-static TAvgResults* AvgNodeResults;
-static int          Nsteps;
+static THREADLOCAL F_OFF     IDStartPos;           // starting file position of ID names
+static THREADLOCAL F_OFF     InputStartPos;        // starting file position of input data
+static THREADLOCAL F_OFF     OutputStartPos;       // starting file position of output data
+static THREADLOCAL F_OFF     BytesPerPeriod;       // bytes saved per simulation time period
+static THREADLOCAL INT4      NumSubcatchVars;      // number of subcatchment output variables
+static THREADLOCAL INT4      NumNodeVars;          // number of node output variables
+static THREADLOCAL INT4      NumLinkVars;          // number of link output variables
+static THREADLOCAL INT4      NumSubcatch;          // number of subcatchments reported on
+static THREADLOCAL INT4      NumNodes;             // number of nodes reported on
+static THREADLOCAL INT4      NumLinks;             // number of links reported on
+static THREADLOCAL INT4      NumPolluts;           // number of pollutants reported on
+static THREADLOCAL F_OFF     NumResults;           // number of values saved per period
+
+// --- a chunk of reporting periods is saved as the dates of its periods
+//     followed by the values of each result variable over the chunk (in
+//     the same order that variables are saved in a period); in compressed
+//     layout each block of BLOCK_SERIES series in a chunk is packed
+//     separately and the chunk ends with the packed size of each block;
+//     the file position of each chunk is listed after the last one
+static THREADLOCAL TOutWriter Writer;              // output file writer
+static THREADLOCAL TOutBuffer Buffer[2];           // buffers of reporting periods
+static THREADLOCAL int       CurBuffer;            // buffer being filled
+static THREADLOCAL int       BufferPeriods;        // periods held by a buffer
+static THREADLOCAL F_OFF     BufferSlot;           // index of next value saved in a period
+static THREADLOCAL TBgTask*  WriterTask;           // thread writing buffers to file
+static THREADLOCAL int       SizesChunk;           // chunk whose block sizes are read
+static THREADLOCAL int       CachedChunk;          // chunk of block read into
+static THREADLOCAL int       CachedBlock;          //   Writer.series
+
+static THREADLOCAL REAL4     SysResults[MAX_SYS_RESULTS];    // values of system output vars.
+
+static THREADLOCAL TAvgResults* AvgLinkResults;
+static THREADLOCAL TAvgResults* AvgNodeResults;
+static THREADLOCAL int          Nsteps;
 
 //-----------------------------------------------------------------------------
 //  Exportable variables (shared with report.c)
 //-----------------------------------------------------------------------------
-REAL4*           SubcatchResults;
-REAL4*           NodeResults;
-REAL4*           LinkResults;
+THREADLOCAL REAL4*           SubcatchResults;
+THREADLOCAL REAL4*           NodeResults;
+THREADLOCAL REAL4*           LinkResults;
 
 
 //-----------------------------------------------------------------------------
@@ -93,14 +166,30 @@ REAL4*           LinkResults;
 //-----------------------------------------------------------------------------
 static void output_openOutFile(void);
 static void output_saveID(char* id, FILE* file);
-static void output_saveSubcatchResults(double reportTime, FILE* file);
-static void output_saveNodeResults(double reportTime, FILE* file);
-static void output_saveLinkResults(double reportTime, FILE* file);
+static void output_saveSubcatchResults(double reportTime);
+static void output_saveNodeResults(double reportTime);
+static void output_saveLinkResults(double reportTime);
+static void output_saveValues(REAL4* x, int n);
+
+static int  output_openBuffers(void);
+static void output_closeBuffers(void);
+static void output_flushBuffer(void);
+static void output_checkBuffer(TOutBuffer* buf);
+static void output_writeBuffer(void* arg);
+static int  output_writeChunk(TOutWriter* w, TOutBuffer* buf);
+static F_OFF output_getChunkPos(int chunk);
+static int  output_readBlock(int chunk, int block, int m);
+static void output_readValues(long period, F_OFF slot, int n, REAL4* x);
+static F_OFF output_getFirstSlot(int objType, int index);
+static int  output_readStandardBatch(F_OFF slot, int n, F_OFF p1,
+            F_OFF nPeriods, DateTime* days, REAL4* x);
+static int  output_readChunkBatch(F_OFF slot, int n, F_OFF p1,
+            F_OFF nPeriods, DateTime* days, REAL4* x);
 
 static int  output_openAvgResults(void);
 static void output_closeAvgResults(void);
 static void output_initAvgResults(void);
-static void output_saveAvgResults(FILE* file);
+static void output_saveAvgResults(void);
 
 //-----------------------------------------------------------------------------
 //  External functions (declared in funcs.h)
@@ -111,10 +200,12 @@ static void output_saveAvgResults(FILE* file);
 //  output_updateAvgResults       (called by swmm_step in swmm5.c)
 //  output_saveResults            (called by swmm_step in swmm5.c)
 //  output_checkFileSize          (called by swmm_report)
-//  output_readDateTime           (called by routines in report.c)
-//  output_readSubcatchResults    (called by report_Subcatchments)
-//  output_readNodeResults        (called by report_Nodes)
-//  output_readLinkResults        (called by report_Links)
+//  output_readDateTime           (called by getSavedDate in swmm5.c)
+//  output_readSubcatchResults    (called by getSavedSubcatchValue)
+//  output_readNodeResults        (called by getSavedNodeValue)
+//  output_readLinkResults        (called by getSavedLinkValue)
+//  output_getResultCount         (called by report_TimeSeries)
+//  output_readBatch              (called by report_TimeSeries)
 
 
 //=============================================================================
@@ -166,6 +257,7 @@ int output_open()
         + ((F_OFF)NumNodes * (F_OFF)NumNodeVars)
         + ((F_OFF)NumLinks * (F_OFF)NumLinkVars) + MAX_SYS_RESULTS;
     BytesPerPeriod = sizeof(REAL8) + (numResults * sizeof(REAL4));
+    NumResults = numResults;
     Nperiods = 0;
 
     SubcatchResults = NULL;
@@ -189,6 +281,13 @@ int output_open()
         return ErrorCode;
     }
 
+    // --- allocate memory to buffer reporting periods of results
+    if ( !output_openBuffers() )
+    {
+        report_writeErrorMsg(ERR_MEMORY, "");
+        return ErrorCode;
+    }
+
     F_SEEK(Fout.file, 0, SEEK_SET);
     k = MAGICNUMBER;
     fwrite(&k, sizeof(INT4), 1, Fout.file);   // Magic number
@@ -402,6 +501,7 @@ int output_open()
         return ErrorCode;
     }
     OutputStartPos = ftell(Fout.file);
+    Writer.startPos = OutputStartPos;
     return ErrorCode;
 }
 
@@ -469,32 +569,32 @@ void output_saveResults(double reportTime)
 //
 {
     int i;
-    extern TRoutingTotals StepFlowTotals;  // defined in massbal.c
+    extern THREADLOCAL TRoutingTotals StepFlowTotals;  // defined in massbal.c
     DateTime reportDate = getDateTime(reportTime);
-    REAL8 date;
+    TOutBuffer* buf = &Buffer[CurBuffer];
 
     // --- initialize system-wide results
     if ( reportDate < ReportStart ) return;
     for (i=0; i<MAX_SYS_RESULTS; i++) SysResults[i] = 0.0f;
 
     // --- save date corresponding to this elapsed reporting time
-    date = reportDate;
-    fwrite(&date, sizeof(REAL8), 1, Fout.file);
+    buf->dates[buf->count] = reportDate;
+    BufferSlot = 0;
 
     // --- save subcatchment results
     if (Nobjects[SUBCATCH] > 0)
-        output_saveSubcatchResults(reportTime, Fout.file);
+        output_saveSubcatchResults(reportTime);
 
     // --- save average routing results over reporting period if called for
-    if ( RptFlags.averages ) output_saveAvgResults(Fout.file);
+    if ( RptFlags.averages ) output_saveAvgResults();
 
     // --- otherwise save interpolated point routing results
     else
     {
         if (Nobjects[NODE] > 0)
-            output_saveNodeResults(reportTime, Fout.file);
+            output_saveNodeResults(reportTime);
         if (Nobjects[LINK] > 0)
-            output_saveLinkResults(reportTime, Fout.file);
+            output_saveLinkResults(reportTime);
     }
 
     // --- update & save system-wide flows 
@@ -509,12 +609,19 @@ void output_saveResults(double reportTime)
                              SysResults[SYS_GWFLOW] +
                              SysResults[SYS_IIFLOW] +
                              SysResults[SYS_EXFLOW];
-    fwrite(SysResults, sizeof(REAL4), MAX_SYS_RESULTS, Fout.file);
+    output_saveValues(SysResults, MAX_SYS_RESULTS);
 
     // --- save outfall flows to interface file if called for
-    if ( Foutflows.mode == SAVE_FILE && !IgnoreRouting ) 
-        iface_saveOutletResults(reportDate, Foutflows.file);
+    if ( Foutflows.mode == SAVE_FILE && !IgnoreRouting )
+    {
+        buf->ifaceFile = Foutflows.file;
+        iface_printOutletResults(reportDate, &buf->ifaceText, &buf->ifaceLen,
+                                 &buf->ifaceSize);
+    }
     Nperiods++;
+
+    // --- hand the buffer over to be written to file once it is full
+    if ( ++buf->count == BufferPeriods ) output_flushBuffer();
 }
 
 //=============================================================================
@@ -527,6 +634,35 @@ void output_end()
 //
 {
     INT4 k;
+
+    // --- write out the final (partial) buffer of results and wait
+    //     for the writer to finish with it
+    if ( Buffer[CurBuffer].count > 0 ) output_flushBuffer();
+    bgtask_wait(WriterTask);
+    output_checkBuffer(&Buffer[0]);
+    output_checkBuffer(&Buffer[1]);
+
+    // --- chunked results are followed by the layout code and number
+    //     of periods per chunk
+    if ( Writer.chunkPeriods > 0 )
+    {
+        if ( OutputLayout == COMPRESSED_LAYOUT )
+        {
+            for (k = 0; k <= Writer.numChunks; k++)
+            {
+                INT8 pos = (Writer.numChunks > 0) ? Writer.chunkPos[k] :
+                                                    OutputStartPos;
+                fwrite(&pos, sizeof(INT8), 1, Fout.file);
+            }
+            k = BLOCK_SERIES;
+            fwrite(&k, sizeof(INT4), 1, Fout.file);
+        }
+        k = OutputLayout;
+        fwrite(&k, sizeof(INT4), 1, Fout.file);
+        k = Writer.chunkPeriods;
+        fwrite(&k, sizeof(INT4), 1, Fout.file);
+    }
+
     fwrite(&IDStartPos, sizeof(INT4), 1, Fout.file);
     fwrite(&InputStartPos, sizeof(INT4), 1, Fout.file);
     fwrite(&OutputStartPos, sizeof(INT4), 1, Fout.file);
@@ -534,7 +670,8 @@ void output_end()
     fwrite(&k, sizeof(INT4), 1, Fout.file);
     k = (INT4)ErrorCode;
     fwrite(&k, sizeof(INT4), 1, Fout.file);
-    k = MAGICNUMBER;
+    if ( Writer.chunkPeriods > 0 ) k = CHUNKMAGICNUMBER;
+    else k = MAGICNUMBER;
     if (fwrite(&k, sizeof(INT4), 1, Fout.file) < 1)
     {
         report_writeErrorMsg(ERR_OUT_WRITE, "");
@@ -553,6 +690,7 @@ void output_close()
     FREE(SubcatchResults);
     FREE(NodeResults);
     FREE(LinkResults);
+    output_closeBuffers();
     output_closeAvgResults();
 }
 
@@ -573,12 +711,11 @@ void output_saveID(char* id, FILE* file)
 
 //=============================================================================
 
-void output_saveSubcatchResults(double reportTime, FILE* file)
+void output_saveSubcatchResults(double reportTime)
 //
 //  Input:   reportTime = elapsed simulation time (millisec)
-//           file = ptr. to binary output file
 //  Output:  none
-//  Purpose: writes computed subcatchment results to binary file.
+//  Purpose: saves computed subcatchment results to the output buffer.
 //
 {
     int      j;
@@ -602,7 +739,7 @@ void output_saveSubcatchResults(double reportTime, FILE* file)
         // --- retrieve interpolated results for reporting time & write to file
         subcatch_getResults(j, f, SubcatchResults);
         if ( Subcatch[j].rptFlag )
-            fwrite(SubcatchResults, sizeof(REAL4), NumSubcatchVars, file);
+            output_saveValues(SubcatchResults, NumSubcatchVars);
 
         // --- update system-wide results
         area = Subcatch[j].area * UCF(LANDAREA);
@@ -640,12 +777,11 @@ void output_saveSubcatchResults(double reportTime, FILE* file)
 
 //=============================================================================
 
-void output_saveNodeResults(double reportTime, FILE* file)
+void output_saveNodeResults(double reportTime)
 //
 //  Input:   reportTime = elapsed simulation time (millisec)
-//           file = ptr. to binary output file
 //  Output:  none
-//  Purpose: writes computed node results to binary file.
+//  Purpose: saves computed node results to the output buffer.
 //
 {
     int j;
@@ -660,7 +796,7 @@ void output_saveNodeResults(double reportTime, FILE* file)
         // --- retrieve interpolated results for reporting time & write to file
         node_getResults(j, f, NodeResults);
         if ( Node[j].rptFlag )
-            fwrite(NodeResults, sizeof(REAL4), NumNodeVars, file);
+            output_saveValues(NodeResults, NumNodeVars);
         stats_updateMaxNodeDepth(j, NodeResults[NODE_DEPTH]);
 
         // --- update system-wide storage volume 
@@ -670,12 +806,11 @@ void output_saveNodeResults(double reportTime, FILE* file)
 
 //=============================================================================
 
-void output_saveLinkResults(double reportTime, FILE* file)
+void output_saveLinkResults(double reportTime)
 //
 //  Input:   reportTime = elapsed simulation time (millisec)
-//           file = ptr. to binary output file
 //  Output:  none
-//  Purpose: writes computed link results to binary file.
+//  Purpose: saves computed link results to the output buffer.
 //
 {
     int j;
@@ -692,7 +827,7 @@ void output_saveLinkResults(double reportTime, FILE* file)
         if (Link[j].rptFlag )
         {
             link_getResults(j, f, LinkResults);
-            fwrite(LinkResults, sizeof(REAL4), NumLinkVars, file);
+            output_saveValues(LinkResults, NumLinkVars);
         }
 
         // --- update system-wide results
@@ -703,6 +838,25 @@ void output_saveLinkResults(double reportTime, FILE* file)
 
 //=============================================================================
 
+void output_saveValues(REAL4* x, int n)
+//
+//  Input:   x = array of result values
+//           n = number of values
+//  Output:  none
+//  Purpose: saves the next n result values of the current reporting period
+//           to the buffer of periods waiting to be written to file.
+//
+{
+    TOutBuffer* buf = &Buffer[CurBuffer];
+    REAL4* y = buf->results + buf->count*NumResults + BufferSlot;
+    int    k;
+
+    for (k = 0; k < n; k++) y[k] = x[k];
+    BufferSlot += n;
+}
+
+//=============================================================================
+
 void output_readDateTime(long period, DateTime* days)
 //
 //  Input:   period = index of reporting time period
@@ -711,8 +865,16 @@ void output_readDateTime(long period, DateTime* days)
 //           from the binary output file.
 //
 {
-    F_OFF p = period;
-    F_OFF bytePos = OutputStartPos + (p-1)*BytesPerPeriod;
+    F_OFF p = period - 1;
+    F_OFF bytePos;
+
+    // --- dates of a chunk of columnar results are listed at its start
+    if ( Writer.chunkPeriods > 0 )
+    {
+        bytePos = output_getChunkPos((int)(p / Writer.chunkPeriods)) +
+                  (p % Writer.chunkPeriods) * sizeof(REAL8);
+    }
+    else bytePos = OutputStartPos + p*BytesPerPeriod;
     F_SEEK(Fout.file, bytePos, SEEK_SET);
     *days = NO_DATE;
     fread(days, sizeof(REAL8), 1, Fout.file);
@@ -729,12 +891,8 @@ void output_readSubcatchResults(long period, int index)
 //           period.
 //
 {
-    long offset = index*NumSubcatchVars;
-    F_OFF p = period;
-    F_OFF bytePos = OutputStartPos + (p-1)*BytesPerPeriod +
-        sizeof(REAL8) + (F_OFF)offset * sizeof(REAL4);
-    F_SEEK(Fout.file, bytePos, SEEK_SET);
-    fread(SubcatchResults, sizeof(REAL4), NumSubcatchVars, Fout.file);
+    F_OFF offset = (F_OFF)index*NumSubcatchVars;
+    output_readValues(period, offset, NumSubcatchVars, SubcatchResults);
 }
 
 //=============================================================================
@@ -747,12 +905,9 @@ void output_readNodeResults(long period, int index)
 //  Purpose: reads computed results for a node at a specific time period.
 //
 {
-    long offset = NumSubcatch*NumSubcatchVars + index*NumNodeVars;
-    F_OFF p = period;
-    F_OFF bytePos = OutputStartPos + (p-1)*BytesPerPeriod +
-        sizeof(REAL8) + (F_OFF)offset * sizeof(REAL4);
-    F_SEEK(Fout.file, bytePos, SEEK_SET);
-    fread(NodeResults, sizeof(REAL4), NumNodeVars, Fout.file);
+    F_OFF offset = (F_OFF)NumSubcatch*NumSubcatchVars +
+                   (F_OFF)index*NumNodeVars;
+    output_readValues(period, offset, NumNodeVars, NodeResults);
 }
 
 //=============================================================================
@@ -765,13 +920,253 @@ void output_readLinkResults(long period, int index)
 //  Purpose: reads computed results for a link at a specific time period.
 //
 {
-    long offset = (NumSubcatch*NumSubcatchVars + NumNodes*NumNodeVars + index*NumLinkVars);
-    F_OFF p = period;
-    F_OFF bytePos = OutputStartPos + (p-1)*BytesPerPeriod +
-        sizeof(REAL8) + (F_OFF)offset * sizeof(REAL4);
-    F_SEEK(Fout.file, bytePos, SEEK_SET);
-    fread(LinkResults, sizeof(REAL4), NumLinkVars, Fout.file);
-    fread(SysResults, sizeof(REAL4), MAX_SYS_RESULTS, Fout.file);
+    F_OFF offset = (F_OFF)NumSubcatch*NumSubcatchVars +
+                   (F_OFF)NumNodes*NumNodeVars + (F_OFF)index*NumLinkVars;
+    output_readValues(period, offset, NumLinkVars, LinkResults);
+    output_readValues(period, NumResults - MAX_SYS_RESULTS, MAX_SYS_RESULTS,
+                      SysResults);
+}
+
+//=============================================================================
+
+void output_readValues(long period, F_OFF slot, int n, REAL4* x)
+//
+//  Input:   period = index of reporting time period
+//           slot = index of first value to read within the period's results
+//           n = number of values to read
+//  Output:  x = values read from file
+//  Purpose: reads consecutive values saved for a specific time period from
+//           the binary output file.
+//
+{
+    F_OFF p = period - 1;
+    F_OFF chunkPos, s;
+    int   i, m, k, c, b;
+    int   chunkPeriods = Writer.chunkPeriods;
+
+    if ( chunkPeriods == 0 )
+    {
+        F_SEEK(Fout.file, OutputStartPos + p*BytesPerPeriod + sizeof(REAL8) +
+               slot*sizeof(REAL4), SEEK_SET);
+        fread(x, sizeof(REAL4), n, Fout.file);
+        return;
+    }
+
+    // --- locate the period within its chunk (only the last chunk
+    //     can hold fewer than chunkPeriods periods)
+    i = (int)(p % chunkPeriods);
+    m = (int)MIN(chunkPeriods, Nperiods - (p - i));
+    c = (int)(p / chunkPeriods);
+
+    // --- unpack the block of series holding each value
+    if ( OutputLayout == COMPRESSED_LAYOUT )
+    {
+        for (k = 0; k < n; k++)
+        {
+            s = slot + k;
+            b = (int)(s / BLOCK_SERIES);
+            if ( output_readBlock(c, b, m) )
+                x[k] = Writer.series[(s - (F_OFF)b*BLOCK_SERIES)*m + i];
+            else x[k] = 0.0f;
+        }
+        return;
+    }
+
+    // --- each value lies in the series of its variable over the chunk
+    chunkPos = output_getChunkPos(c) + m*sizeof(REAL8);
+    for (k = 0; k < n; k++)
+    {
+        F_SEEK(Fout.file, chunkPos + ((slot+k)*m + i)*sizeof(REAL4), SEEK_SET);
+        fread(&x[k], sizeof(REAL4), 1, Fout.file);
+    }
+}
+
+//=============================================================================
+
+int output_getResultCount(int objType)
+//
+//  Input:   objType = SUBCATCH, NODE or LINK
+//  Output:  returns number of result variables saved for each object
+//  Purpose: retrieves how many result variables are saved per object of
+//           a given type.
+//
+{
+    switch ( objType )
+    {
+      case SUBCATCH: return NumSubcatchVars;
+      case NODE:     return NumNodeVars;
+      case LINK:     return NumLinkVars;
+      default:       return 0;
+    }
+}
+
+//=============================================================================
+
+F_OFF output_getFirstSlot(int objType, int index)
+//
+//  Input:   objType = SUBCATCH, NODE or LINK
+//           index = object's index in binary output file
+//  Output:  returns index of object's first value in a period's results
+//  Purpose: locates an object's results within a reporting period.
+//
+{
+    F_OFF slot = (F_OFF)index * output_getResultCount(objType);
+
+    if ( objType == LINK ) slot += (F_OFF)NumNodes*NumNodeVars;
+    if ( objType != SUBCATCH ) slot += (F_OFF)NumSubcatch*NumSubcatchVars;
+    return slot;
+}
+
+//=============================================================================
+
+int output_readBatch(int objType, int first, int count, long period,
+                     long nPeriods, DateTime* days, REAL4* x)
+//
+//  Input:   objType = SUBCATCH, NODE or LINK
+//           first = index of first object in binary output file
+//           count = number of consecutive objects to read
+//           period = index of first reporting period to read
+//           nPeriods = number of reporting periods to read
+//  Output:  days = date/time of each reporting period read
+//           x = results of the objects in each period read (with the
+//               results of the i-th period starting at x[i*count*nVars],
+//               where nVars = output_getResultCount(objType))
+//           returns FALSE if the results can't be read
+//  Purpose: reads the results of several objects over a range of reporting
+//           periods in a single pass through the binary output file.
+//
+{
+    F_OFF slot = output_getFirstSlot(objType, first);
+    int   n = count * output_getResultCount(objType);
+
+    if ( nPeriods <= 0 || n == 0 ) return TRUE;
+    if ( Writer.chunkPeriods == 0 )
+        return output_readStandardBatch(slot, n, period-1, nPeriods, days, x);
+    return output_readChunkBatch(slot, n, period-1, nPeriods, days, x);
+}
+
+//=============================================================================
+
+int output_readStandardBatch(F_OFF slot, int n, F_OFF p1, F_OFF nPeriods,
+                             DateTime* days, REAL4* x)
+//
+//  Input:   slot = index of first value to read within a period's results
+//           n = number of values to read in each period
+//           p1 = index (starting from 0) of first period to read
+//           nPeriods = number of periods to read
+//  Output:  days = date/time of each period read
+//           x = values read in each period
+//           returns FALSE if the values can't be read
+//  Purpose: reads values saved in a range of periods of a standard layout
+//           file by reading several whole periods at a time.
+//
+{
+    F_OFF  i, i2, group;
+    char*  buf;
+    char*  period;
+    int    ok = TRUE;
+
+    group = MAX(1, READ_BYTES / BytesPerPeriod);
+    group = MIN(group, nPeriods);
+    buf = (char *)malloc((size_t)(group * BytesPerPeriod));
+    if ( buf == NULL ) return FALSE;
+
+    F_SEEK(Fout.file, OutputStartPos + p1*BytesPerPeriod, SEEK_SET);
+    for (i = 0; i < nPeriods && ok; i = i2)
+    {
+        i2 = MIN(i + group, nPeriods);
+        if ( fread(buf, (size_t)BytesPerPeriod, (size_t)(i2 - i), Fout.file) <
+             (size_t)(i2 - i) ) ok = FALSE;
+        else for (period = buf; i < i2; i++, period += BytesPerPeriod)
+        {
+            memcpy(&days[i], period, sizeof(REAL8));
+            memcpy(x + i*n, period + sizeof(REAL8) + slot*sizeof(REAL4),
+                   n * sizeof(REAL4));
+        }
+    }
+    free(buf);
+    return ok;
+}
+
+//=============================================================================
+
+int output_readChunkBatch(F_OFF slot, int n, F_OFF p1, F_OFF nPeriods,
+                          DateTime* days, REAL4* x)
+//
+//  Input:   slot = index of first value to read within a period's results
+//           n = number of values to read in each period
+//           p1 = index (starting from 0) of first period to read
+//           nPeriods = number of periods to read
+//  Output:  days = date/time of each period read
+//           x = values read in each period
+//           returns FALSE if the values can't be read
+//  Purpose: reads values saved in a range of periods of a columnar layout
+//           file, where each value's series over a chunk of periods is
+//           stored contiguously, chunk by chunk.
+//
+{
+    int    c, i, i1, i2, k, m, b, b1, b2;
+    F_OFF  p, p2 = p1 + nPeriods, s, s1, s2;
+    REAL4* series = NULL;
+    REAL4* y;
+    REAL4* z;
+    int    chunkPeriods = Writer.chunkPeriods;
+    int    packed = (OutputLayout == COMPRESSED_LAYOUT);
+
+    // --- series of uncompressed chunks are read all at once
+    if ( !packed )
+    {
+        series = (REAL4 *)malloc((size_t)n * MIN(chunkPeriods, Nperiods) *
+                                 sizeof(REAL4));
+        if ( series == NULL ) return FALSE;
+    }
+
+    // --- periods i1 to i2 of chunk c lie in the range being read
+    c = (int)(p1 / chunkPeriods);
+    for (p = (F_OFF)c * chunkPeriods; p < p2; c++, p += m)
+    {
+        m = (int)MIN(chunkPeriods, Nperiods - p);
+        i1 = (int)MAX(p1 - p, 0);
+        i2 = (int)MIN(p2 - p, m);
+        z = x + (p + i1 - p1) * n;
+        F_SEEK(Fout.file, output_getChunkPos(c) + i1*sizeof(REAL8), SEEK_SET);
+        if ( fread(&days[p + i1 - p1], sizeof(REAL8), i2 - i1, Fout.file) <
+             (size_t)(i2 - i1) ) break;
+
+        // --- copy each value's series into the periods read
+        if ( packed )
+        {
+            b1 = (int)(slot / BLOCK_SERIES);
+            b2 = (int)((slot + n - 1) / BLOCK_SERIES);
+            for (b = b1; b <= b2; b++)
+            {
+                if ( !output_readBlock(c, b, m) ) break;
+                s1 = MAX(slot, (F_OFF)b * BLOCK_SERIES);
+                s2 = MIN(slot + n, (F_OFF)(b + 1) * BLOCK_SERIES);
+                for (s = s1; s < s2; s++)
+                {
+                    y = Writer.series + (s - (F_OFF)b * BLOCK_SERIES) * m;
+                    k = (int)(s - slot);
+                    for (i = i1; i < i2; i++) z[(i - i1)*n + k] = y[i];
+                }
+            }
+            if ( b <= b2 ) break;
+        }
+        else
+        {
+            F_SEEK(Fout.file, output_getChunkPos(c) + m*sizeof(REAL8) +
+                   slot*m*sizeof(REAL4), SEEK_SET);
+            if ( fread(series, sizeof(REAL4), (size_t)n * m, Fout.file) <
+                 (size_t)n * m ) break;
+            for (k = 0; k < n; k++)
+            {
+                y = series + (size_t)k * m;
+                for (i = i1; i < i2; i++) z[(i - i1)*n + k] = y[i];
+            }
+        }
+    }
+    free(series);
+    return p >= p2;
 }
 
 //=============================================================================
@@ -915,7 +1310,7 @@ void output_updateAvgResults()
 
 //=============================================================================
 
-void output_saveAvgResults(FILE* file)
+void output_saveAvgResults(void)
 {
     int i, j;
 
@@ -929,7 +1324,7 @@ void output_saveAvgResults(FILE* file)
         }
 
         // --- save average results to file
-        fwrite(NodeResults, sizeof(REAL4), NumNodeVars, file);
+        output_saveValues(NodeResults, NumNodeVars);
     }
 
     // --- update each node's max depth and contribution to system storage
@@ -949,7 +1344,7 @@ void output_saveAvgResults(FILE* file)
         }
 
         // --- save average results to file
-        fwrite(LinkResults, sizeof(REAL4), NumLinkVars, file);
+        output_saveValues(LinkResults, NumLinkVars);
     }
  
     // --- add each link's volume to total system storage
@@ -961,3 +1356,266 @@ void output_saveAvgResults(FILE* file)
     // --- re-initialize average results for all nodes and links
     output_initAvgResults();
 }
+
+//=============================================================================
+//  Functions for buffering results and writing them to file.
+//=============================================================================
+
+int output_openBuffers()
+//
+//  Allocates memory for the two buffers of reporting periods (and for
+//  writing chunks of columnar results) and starts the thread that writes
+//  the buffers to file.
+{
+    int    i;
+    size_t n;
+
+    memset(&Writer, 0, sizeof(TOutWriter));
+    memset(Buffer, 0, sizeof(Buffer));
+    CurBuffer = 0;
+    WriterTask = NULL;
+    SizesChunk = -1;
+    CachedChunk = -1;
+    CachedBlock = -1;
+    Writer.file = Fout.file;
+    Writer.layout = OutputLayout;
+    Writer.numResults = NumResults;
+
+    // --- size a buffer (or a chunk) to fit within a fixed amount of memory
+    if ( OutputLayout == STANDARD_LAYOUT )
+        BufferPeriods = (int)MIN(MAX_CHUNK_PERIODS, BUFFER_BYTES / BytesPerPeriod);
+    else
+        BufferPeriods = (int)MIN(MAX_CHUNK_PERIODS, CHUNK_BYTES / BytesPerPeriod);
+    BufferPeriods = MAX(BufferPeriods, 1);
+    for (i = 0; i < 2; i++)
+    {
+        Buffer[i].writer = &Writer;
+        Buffer[i].dates = (REAL8*)calloc(BufferPeriods, sizeof(REAL8));
+        Buffer[i].results = (REAL4*)calloc((size_t)(NumResults * BufferPeriods),
+                                           sizeof(REAL4));
+        if ( !Buffer[i].dates || !Buffer[i].results ) return FALSE;
+    }
+
+    // --- allocate space for transposing (and packing) a block of series
+    if ( OutputLayout != STANDARD_LAYOUT )
+    {
+        Writer.chunkPeriods = BufferPeriods;
+        n = (size_t)BLOCK_SERIES * BufferPeriods;
+        Writer.series = (REAL4*)calloc(n, sizeof(REAL4));
+        if ( !Writer.series ) return FALSE;
+    }
+    if ( OutputLayout == COMPRESSED_LAYOUT )
+    {
+        Writer.numBlocks = (int)((NumResults + BLOCK_SERIES - 1) / BLOCK_SERIES);
+        Writer.blockSizes = (INT4*)calloc(Writer.numBlocks, sizeof(INT4));
+        Writer.packed = (unsigned char*)malloc(outcodec_bound(n));
+        Writer.work = (unsigned char*)malloc(n * sizeof(REAL4));
+        if ( !Writer.blockSizes || !Writer.packed || !Writer.work ) return FALSE;
+    }
+
+    // --- buffers are written on the calling thread if none can be started
+    WriterTask = bgtask_create();
+    return TRUE;
+}
+
+//=============================================================================
+
+void output_closeBuffers()
+//
+//  Stops the writer thread and frees the buffers of reporting periods.
+{
+    int i;
+
+    bgtask_delete(WriterTask);
+    WriterTask = NULL;
+    for (i = 0; i < 2; i++)
+    {
+        FREE(Buffer[i].dates);
+        FREE(Buffer[i].results);
+        FREE(Buffer[i].ifaceText);
+    }
+    FREE(Writer.series);
+    FREE(Writer.blockSizes);
+    FREE(Writer.packed);
+    FREE(Writer.work);
+    FREE(Writer.chunkPos);
+    Writer.chunkPeriods = 0;
+}
+
+//=============================================================================
+
+void output_flushBuffer()
+//
+//  Hands the buffer being filled over to the writer thread, once it has
+//  finished writing the other buffer, and starts filling the other buffer.
+{
+    TOutBuffer* other = &Buffer[1 - CurBuffer];
+
+    bgtask_run(WriterTask, output_writeBuffer, &Buffer[CurBuffer]);
+    output_checkBuffer(other);
+    CurBuffer = 1 - CurBuffer;
+    other->count = 0;
+    other->ifaceLen = 0;
+}
+
+//=============================================================================
+
+void output_checkBuffer(TOutBuffer* buf)
+//
+//  Reports any error that occurred while a buffer was written to file.
+{
+    if ( buf->error )
+    {
+        report_writeErrorMsg(buf->error, "");
+        buf->error = 0;
+    }
+}
+
+//=============================================================================
+
+void output_writeBuffer(void* arg)
+//
+//  Writes a buffer of reporting periods to file (runs on the writer thread,
+//  so it must only use the buffer and its writer).
+{
+    TOutBuffer* buf = (TOutBuffer*)arg;
+    TOutWriter* w = buf->writer;
+    size_t n = (size_t)w->numResults;
+    int    i;
+
+    // --- periods are written one after the other in standard layout
+    if ( w->layout == STANDARD_LAYOUT )
+    {
+        for (i = 0; i < buf->count; i++)
+        {
+            fwrite(&buf->dates[i], sizeof(REAL8), 1, w->file);
+            if ( fwrite(buf->results + i*n, sizeof(REAL4), n, w->file) < n )
+            {
+                buf->error = ERR_OUT_WRITE;
+                break;
+            }
+        }
+    }
+    else buf->error = output_writeChunk(w, buf);
+
+    // --- save outfall flows to interface file
+    if ( buf->ifaceLen > 0 && buf->ifaceFile )
+        fwrite(buf->ifaceText, 1, buf->ifaceLen, buf->ifaceFile);
+}
+
+//=============================================================================
+
+int output_writeChunk(TOutWriter* w, TOutBuffer* buf)
+//
+//  Writes a buffer of reporting periods to file as a chunk of columnar
+//  results: the dates of the periods followed by each value's series over
+//  them. Returns an error code.
+{
+    int    i, b, n = buf->count;
+    int    packed = (w->layout == COMPRESSED_LAYOUT);
+    F_OFF  slot, slot1, slot2, bytes;
+    size_t size, written;
+    REAL4* x;
+    F_OFF* p;
+
+    // --- extend the list of chunk positions
+    if ( packed && w->numChunks + 1 >= w->maxChunks )
+    {
+        p = (F_OFF*)realloc(w->chunkPos, 2 * (w->maxChunks + 32) * sizeof(F_OFF));
+        if ( p == NULL ) return ERR_MEMORY;
+        w->chunkPos = p;
+        w->maxChunks = 2 * (w->maxChunks + 32);
+        if ( w->numChunks == 0 ) w->chunkPos[0] = w->startPos;
+    }
+
+    bytes = n * sizeof(REAL8);
+    fwrite(buf->dates, sizeof(REAL8), n, w->file);
+
+    // --- transpose a block of series at a time into contiguous form
+    for (b = 0, slot1 = 0; slot1 < w->numResults; b++, slot1 = slot2)
+    {
+        slot2 = MIN(slot1 + BLOCK_SERIES, w->numResults);
+        for (i = 0; i < n; i++)
+        {
+            x = buf->results + i*w->numResults;
+            for (slot = slot1; slot < slot2; slot++)
+                w->series[(slot - slot1)*n + i] = x[slot];
+        }
+
+        // --- pack the block or write it as is
+        if ( packed )
+        {
+            size = outcodec_pack(w->series, (size_t)(slot2 - slot1), n,
+                                 w->work, w->packed);
+            if ( size == 0 ) return ERR_MEMORY;
+            w->blockSizes[b] = (INT4)size;
+            written = fwrite(w->packed, 1, size, w->file);
+        }
+        else
+        {
+            size = (size_t)((slot2 - slot1) * n) * sizeof(REAL4);
+            written = fwrite(w->series, 1, size, w->file);
+        }
+        if ( written < size ) return ERR_OUT_WRITE;
+        bytes += size;
+    }
+
+    // --- save size of each packed block & position of next chunk
+    if ( packed )
+    {
+        fwrite(w->blockSizes, sizeof(INT4), w->numBlocks, w->file);
+        bytes += w->numBlocks * sizeof(INT4);
+        w->chunkPos[w->numChunks+1] = w->chunkPos[w->numChunks] + bytes;
+        w->numChunks++;
+    }
+    return 0;
+}
+
+//=============================================================================
+
+F_OFF output_getChunkPos(int chunk)
+//
+//  Returns the file position where a chunk of columnar results starts.
+{
+    if ( OutputLayout == COMPRESSED_LAYOUT ) return Writer.chunkPos[chunk];
+    return OutputStartPos + (F_OFF)chunk * Writer.chunkPeriods * BytesPerPeriod;
+}
+
+//=============================================================================
+
+int output_readBlock(int chunk, int block, int m)
+//
+//  Reads and unpacks a block of series of a compressed chunk of m periods
+//  into Writer.series. Returns FALSE if the block can't be read.
+{
+    int   b;
+    F_OFF pos;
+    INT4  size;
+
+    if ( chunk == CachedChunk && block == CachedBlock ) return TRUE;
+    CachedChunk = -1;
+
+    // --- read the packed size of each block in the chunk
+    if ( chunk != SizesChunk )
+    {
+        SizesChunk = -1;
+        F_SEEK(Fout.file, Writer.chunkPos[chunk+1] -
+               Writer.numBlocks * sizeof(INT4), SEEK_SET);
+        if ( fread(Writer.blockSizes, sizeof(INT4), Writer.numBlocks,
+                   Fout.file) < (size_t)Writer.numBlocks ) return FALSE;
+        SizesChunk = chunk;
+    }
+
+    // --- read the block & unpack its series
+    pos = Writer.chunkPos[chunk] + m * sizeof(REAL8);
+    for (b = 0; b < block; b++) pos += Writer.blockSizes[b];
+    size = Writer.blockSizes[block];
+    F_SEEK(Fout.file, pos, SEEK_SET);
+    if ( fread(Writer.packed, 1, size, Fout.file) < (size_t)size ) return FALSE;
+    if ( outcodec_unpack(Writer.packed, size,
+             (size_t)MIN(BLOCK_SERIES, NumResults - (F_OFF)block*BLOCK_SERIES),
+             m, Writer.work, Writer.series) < 0 ) return FALSE;
+    CachedChunk = chunk;
+    CachedBlock = block;
+    return TRUE;
+}
@@ -0,0 +1,521 @@
+//-----------------------------------------------------------------------------
+//   partition.c
+//
+//   Project:  EPA SWMM5
+//   Version:  5.2
+//   Date:     10/16/26 (Build 5.2.4+)
+//
+//   Graph partitioner that splits the nodes of a graph into parts of
+//   nearly equal weight with few edges cut between them.
+//
+//   The nodes are split by recursive bisection. Each bisection grows one
+//   half outward from a node at the edge of the graph (found by repeated
+//   breadth-first searches) in breadth-first order until it holds its
+//   share of the weight, so that both halves tend to be connected and
+//   meet along a short front. The front is then smoothed by moving nodes
+//   that have more neighbors on the other side across to it, as long as
+//   the two halves stay balanced. A graph that is not connected is grown
+//   one connected piece after another.
+//
+//   The nodes of each part can also be put in reverse Cuthill-McKee order,
+//   which numbers them by breadth-first search from a node at the edge of
+//   the part (taking the neighbors of each node in order of increasing
+//   degree) and then reverses the numbering. Nodes joined by an edge then
+//   get numbers that are close together.
+//-----------------------------------------------------------------------------
+
+#include <stdlib.h>
+#include "consts.h"
+#include "macros.h"
+#include "partition.h"
+
+//-----------------------------------------------------------------------------
+//  Constants
+//-----------------------------------------------------------------------------
+static const int    MAXPASSES = 4;     // max. passes made to smooth a front
+static const double IMBALANCE = 0.01;  // allowed imbalance between halves
+
+// Graph being partitioned
+typedef struct
+{
+    int* adjStart;                     // start of each node's neighbors
+    int* adj;                          // neighbors of each node
+    int* weight;                       // weight of each node
+    int* set;                          // set of nodes a node belongs to
+    int* side;                         // half of a set a node is put in
+    int* seen;                         // search a node was last reached by
+    int* queue;                        // work array: nodes in search order
+    int  search;                       // number of current search
+    int  sets;                         // number of sets split so far
+} TGraph;
+
+//-----------------------------------------------------------------------------
+//  Local functions
+//-----------------------------------------------------------------------------
+static int  buildGraph(TGraph* g, int n, int m, int node1[], int node2[],
+            int weight[]);
+static void freeGraph(TGraph* g);
+static void splitNodes(TGraph* g, int nodes[], int first, int last,
+            int nParts, int firstPart, int part[]);
+static int  bisectNodes(TGraph* g, int nodes[], int first, int last,
+            int target);
+static int  findPeripheralNode(TGraph* g, int start);
+static int  growHalf(TGraph* g, int nodes[], int first, int last,
+            int target);
+static int  smoothFront(TGraph* g, int nodes[], int first, int last,
+            int target, int weightA);
+static int  orderPiece(TGraph* g, int start, int order[], int next);
+
+//=============================================================================
+
+int partition_create(int n, int m, int node1[], int node2[], int weight[],
+    int nParts, int part[])
+//
+//  Input:   n = number of nodes
+//           m = number of graph edges
+//           node1[], node2[] = nodes joined by each edge
+//           weight[] = weight of each node (or NULL if all are 1)
+//           nParts = number of parts
+//  Output:  part[] = part (0 to nParts-1) that each node is put in;
+//           returns number of edges cut (or -1 if out of memory)
+//  Purpose: splits the nodes of a graph into parts of nearly equal weight.
+//
+//  Note: edges with a negative node index or the same node at both ends
+//        are ignored. A part is left empty if there are fewer nodes than
+//        parts.
+//
+{
+    int    i, cut;
+    int*   nodes;
+    TGraph g;
+
+    nodes = (int *)calloc(n + 1, sizeof(int));
+    if ( !buildGraph(&g, n, m, node1, node2, weight) || nodes == NULL )
+    {
+        FREE(nodes);
+        freeGraph(&g);
+        return -1;
+    }
+    for (i = 0; i < n; i++) nodes[i] = i;
+    if ( nParts < 1 ) nParts = 1;
+    splitNodes(&g, nodes, 0, n, nParts, 0, part);
+
+    // --- count the edges cut between parts
+    cut = 0;
+    for (i = 0; i < m; i++)
+    {
+        if ( node1[i] < 0 || node2[i] < 0 ) continue;
+        if ( part[node1[i]] != part[node2[i]] ) cut++;
+    }
+    FREE(nodes);
+    freeGraph(&g);
+    return cut;
+}
+
+//=============================================================================
+
+int buildGraph(TGraph* g, int n, int m, int node1[], int node2[],
+    int weight[])
+//
+//  Input:   g = graph being built
+//           n = number of nodes
+//           m = number of edges
+//           node1[], node2[] = nodes joined by each edge
+//           weight[] = weight of each node (or NULL)
+//  Output:  returns TRUE if successful, FALSE if out of memory
+//  Purpose: lists the neighbors of each node of a graph.
+//
+{
+    int i, j, k;
+
+    g->adjStart = (int *)calloc(n + 1, sizeof(int));
+    g->adj = (int *)calloc(2 * m + 1, sizeof(int));
+    g->weight = (int *)calloc(n + 1, sizeof(int));
+    g->set = (int *)calloc(n + 1, sizeof(int));
+    g->side = (int *)calloc(n + 1, sizeof(int));
+    g->seen = (int *)calloc(n + 1, sizeof(int));
+    g->queue = (int *)calloc(n + 1, sizeof(int));
+    g->search = 0;
+    g->sets = 0;
+    if ( !g->adjStart || !g->adj || !g->weight || !g->set || !g->side ||
+         !g->seen || !g->queue ) return FALSE;
+
+    // --- count each node's neighbors & convert counts to start positions
+    for (k = 0; k < m; k++)
+    {
+        i = node1[k];
+        j = node2[k];
+        if ( i < 0 || j < 0 || i == j ) continue;
+        g->adjStart[i+1]++;
+        g->adjStart[j+1]++;
+    }
+    for (i = 0; i < n; i++) g->adjStart[i+1] += g->adjStart[i];
+
+    // --- add each edge to the lists of its two nodes, using adjStart[i]
+    //     as the next open position of node i's list
+    for (k = 0; k < m; k++)
+    {
+        i = node1[k];
+        j = node2[k];
+        if ( i < 0 || j < 0 || i == j ) continue;
+        g->adj[ g->adjStart[i]++ ] = j;
+        g->adj[ g->adjStart[j]++ ] = i;
+    }
+
+    // --- shift the start positions back into place
+    for (i = n; i > 0; i--) g->adjStart[i] = g->adjStart[i-1];
+    g->adjStart[0] = 0;
+    for (i = 0; i < n; i++) g->weight[i] = (weight) ? MAX(weight[i], 0) : 1;
+    return TRUE;
+}
+
+//=============================================================================
+
+void freeGraph(TGraph* g)
+//
+//  Input:   g = a graph
+//  Output:  none
+//  Purpose: frees the memory used by a graph.
+//
+{
+    FREE(g->adjStart);
+    FREE(g->adj);
+    FREE(g->weight);
+    FREE(g->set);
+    FREE(g->side);
+    FREE(g->seen);
+    FREE(g->queue);
+}
+
+//=============================================================================
+
+void splitNodes(TGraph* g, int nodes[], int first, int last, int nParts,
+    int firstPart, int part[])
+//
+//  Input:   g = graph being partitioned
+//           nodes[first] to nodes[last-1] = nodes being split
+//           nParts = number of parts to split them into
+//           firstPart = number of the first of these parts
+//  Output:  part[] = part that each of the nodes is put in
+//  Purpose: splits a set of nodes into parts by recursive bisection.
+//
+{
+    int k, nA, weight, target;
+
+    if ( nParts == 1 || last - first <= 1 )
+    {
+        for (k = first; k < last; k++) part[nodes[k]] = firstPart;
+        return;
+    }
+
+    // --- the first half gets nA of the parts & their share of the weight
+    nA = nParts / 2;
+    weight = 0;
+    g->sets++;
+    for (k = first; k < last; k++)
+    {
+        g->set[nodes[k]] = g->sets;
+        weight += g->weight[nodes[k]];
+    }
+    target = (int)((double)weight * (double)nA / (double)nParts + 0.5);
+
+    // --- split the nodes in two & then split each half
+    k = bisectNodes(g, nodes, first, last, target);
+    splitNodes(g, nodes, first, k, nA, firstPart, part);
+    splitNodes(g, nodes, k, last, nParts - nA, firstPart + nA, part);
+}
+
+//=============================================================================
+
+int bisectNodes(TGraph* g, int nodes[], int first, int last, int target)
+//
+//  Input:   g = graph being partitioned
+//           nodes[first] to nodes[last-1] = nodes of the set being split
+//           target = weight of the first half
+//  Output:  nodes[] = the set's nodes with those of the first half first;
+//           returns position of the first node of the second half
+//  Purpose: splits a set of nodes into two halves.
+//
+{
+    int k, v, mid, weightA;
+
+    weightA = growHalf(g, nodes, first, last, target);
+    smoothFront(g, nodes, first, last, target, weightA);
+
+    // --- move the nodes of the first half ahead of the others
+    //     (keeping the original order within each half)
+    mid = first;
+    for (k = first; k < last; k++)
+    {
+        if ( g->side[nodes[k]] == 0 ) g->queue[mid++] = nodes[k];
+    }
+    v = mid;
+    for (k = first; k < last; k++)
+    {
+        if ( g->side[nodes[k]] == 1 ) g->queue[v++] = nodes[k];
+    }
+    for (k = first; k < last; k++) nodes[k] = g->queue[k];
+    return mid;
+}
+
+//=============================================================================
+
+int findPeripheralNode(TGraph* g, int start)
+//
+//  Input:   g = graph being partitioned
+//           start = a node of the set being split
+//  Output:  returns a node far from the center of the set
+//  Purpose: finds a node at the edge of the piece of a set that contains
+//           a given node.
+//
+//  Note: each search starts from the last node reached by the previous
+//        one, which is the farthest node from it.
+//
+{
+    int pass, head, tail, v, u, k;
+    int set = g->set[start];
+
+    for (pass = 0; pass < 2; pass++)
+    {
+        g->search++;
+        head = 0;
+        tail = 0;
+        g->queue[tail++] = start;
+        g->seen[start] = g->search;
+        while ( head < tail )
+        {
+            v = g->queue[head++];
+            for (k = g->adjStart[v]; k < g->adjStart[v+1]; k++)
+            {
+                u = g->adj[k];
+                if ( g->set[u] != set || g->seen[u] == g->search ) continue;
+                g->seen[u] = g->search;
+                g->queue[tail++] = u;
+            }
+        }
+        start = g->queue[tail-1];
+    }
+    return start;
+}
+
+//=============================================================================
+
+int growHalf(TGraph* g, int nodes[], int first, int last, int target)
+//
+//  Input:   g = graph being partitioned
+//           nodes[first] to nodes[last-1] = nodes of the set being split
+//           target = weight of the first half
+//  Output:  returns weight of the first half
+//  Purpose: puts the nodes reached by a breadth-first search from the
+//           edge of a set in its first half until it holds its weight.
+//
+//  Note: while the search runs, side is 0 for nodes in the first half,
+//        2 for nodes waiting in the queue and 1 for all others.
+//
+{
+    int head, tail, next, v, u, k;
+    int set = g->set[nodes[first]];
+    int weightA = 0;
+
+    for (k = first; k < last; k++) g->side[nodes[k]] = 1;
+    head = 0;
+    tail = 0;
+    next = first;
+    while ( weightA < target )
+    {
+        // --- start a new search from the edge of an unreached piece
+        //     (findPeripheralNode uses the queue, which is empty here)
+        if ( head == tail )
+        {
+            while ( next < last && g->side[nodes[next]] != 1 ) next++;
+            if ( next == last ) break;
+            v = findPeripheralNode(g, nodes[next]);
+            head = 0;
+            tail = 0;
+            g->side[v] = 2;
+            g->queue[tail++] = v;
+        }
+
+        // --- put next node reached in the first half
+        v = g->queue[head++];
+        g->side[v] = 0;
+        weightA += g->weight[v];
+        for (k = g->adjStart[v]; k < g->adjStart[v+1]; k++)
+        {
+            u = g->adj[k];
+            if ( g->set[u] != set || g->side[u] != 1 ) continue;
+            g->side[u] = 2;
+            g->queue[tail++] = u;
+        }
+    }
+
+    // --- nodes still waiting in the queue stay in the second half
+    while ( head < tail ) g->side[g->queue[head++]] = 1;
+    return weightA;
+}
+
+//=============================================================================
+
+int smoothFront(TGraph* g, int nodes[], int first, int last, int target,
+    int weightA)
+//
+//  Input:   g = graph being partitioned
+//           nodes[first] to nodes[last-1] = nodes of the set being split
+//           target = weight of the first half
+//           weightA = current weight of the first half
+//  Output:  returns weight of the first half
+//  Purpose: moves nodes with more neighbors in the other half of a set
+//           than in their own across to the other half.
+//
+{
+    int pass, k, j, v, u, w, gain, moved;
+    int set = g->set[nodes[first]];
+    int maxWeight = 0;
+    int tol;
+
+    // --- a move may leave the first half off its target by the larger
+    //     of the heaviest node and a small fraction of the total weight
+    for (k = first; k < last; k++) maxWeight = MAX(maxWeight,
+        g->weight[nodes[k]]);
+    tol = MAX(maxWeight, (int)(IMBALANCE * (double)target));
+
+    for (pass = 0; pass < MAXPASSES; pass++)
+    {
+        moved = 0;
+        for (k = first; k < last; k++)
+        {
+            v = nodes[k];
+            gain = 0;
+            for (j = g->adjStart[v]; j < g->adjStart[v+1]; j++)
+            {
+                u = g->adj[j];
+                if ( g->set[u] != set ) continue;
+                if ( g->side[u] == g->side[v] ) gain--;
+                else gain++;
+            }
+            if ( gain <= 0 ) continue;
+
+            // --- move node if halves stay balanced
+            w = (g->side[v] == 0) ? -g->weight[v] : g->weight[v];
+            if ( abs(weightA + w - target) > tol ) continue;
+            weightA += w;
+            g->side[v] = 1 - g->side[v];
+            moved++;
+        }
+        if ( moved == 0 ) break;
+    }
+    return weightA;
+}
+
+//=============================================================================
+
+int partition_order(int n, int m, int node1[], int node2[], int part[],
+    int order[])
+//
+//  Input:   n = number of nodes
+//           m = number of graph edges
+//           node1[], node2[] = nodes joined by each edge
+//           part[] = part that each node is in (or NULL if all in one)
+//  Output:  order[] = node at each position of the new order;
+//           returns FALSE if out of memory
+//  Purpose: lists the nodes of a graph part by part, with the nodes of each
+//           part in reverse Cuthill-McKee order.
+//
+{
+    int    i, k, p, first, last, v, nParts;
+    int*   nodes;
+    TGraph g;
+
+    nodes = (int *)calloc(n + 1, sizeof(int));
+    if ( !buildGraph(&g, n, m, node1, node2, NULL) || nodes == NULL )
+    {
+        FREE(nodes);
+        freeGraph(&g);
+        return FALSE;
+    }
+
+    // --- list the nodes by part in index order (using the queue to count
+    //     the nodes in each part & then as the next open positions)
+    nParts = 0;
+    for (i = 0; i < n; i++)
+    {
+        g.set[i] = (part) ? part[i] : 0;
+        nParts = MAX(nParts, g.set[i] + 1);
+        g.side[i] = 0;
+    }
+    for (p = 0; p <= nParts; p++) g.queue[p] = 0;
+    for (i = 0; i < n; i++) g.queue[g.set[i] + 1]++;
+    for (p = 0; p < nParts; p++) g.queue[p+1] += g.queue[p];
+    for (i = 0; i < n; i++) nodes[ g.queue[g.set[i]]++ ] = i;
+
+    // --- order the connected pieces of each part & reverse the part
+    first = 0;
+    for (p = 0; p < nParts; p++)
+    {
+        last = first;
+        while ( last < n && g.set[nodes[last]] == p ) last++;
+        k = first;
+        for (i = first; i < last; i++)
+        {
+            if ( g.side[nodes[i]] ) continue;
+            k = orderPiece(&g, findPeripheralNode(&g, nodes[i]), order, k);
+        }
+        for (i = first, k = last - 1; i < k; i++, k--)
+        {
+            v = order[i];
+            order[i] = order[k];
+            order[k] = v;
+        }
+        first = last;
+    }
+    FREE(nodes);
+    freeGraph(&g);
+    return TRUE;
+}
+
+//=============================================================================
+
+int orderPiece(TGraph* g, int start, int order[], int next)
+//
+//  Input:   g = graph being ordered
+//           start = node at the edge of a connected piece of a part
+//           order[] = nodes already ordered
+//           next = next open position in order[]
+//  Output:  order[] = the piece's nodes added in Cuthill-McKee order;
+//           returns next open position in order[]
+//  Purpose: orders the nodes of a piece of a part by breadth-first search,
+//           taking the unordered neighbors of each node in order of
+//           increasing degree.
+//
+//  Note: side is TRUE for nodes already ordered.
+//
+{
+    int head, first, j, k, u, v, w, degree;
+    int set = g->set[start];
+
+    head = next;
+    order[next++] = start;
+    g->side[start] = TRUE;
+    while ( head < next )
+    {
+        v = order[head++];
+        first = next;
+        for (k = g->adjStart[v]; k < g->adjStart[v+1]; k++)
+        {
+            u = g->adj[k];
+            if ( g->set[u] != set || g->side[u] ) continue;
+            g->side[u] = TRUE;
+
+            // --- insert u among v's neighbors listed so far by degree
+            degree = g->adjStart[u+1] - g->adjStart[u];
+            for (j = next++; j > first; j--)
+            {
+                w = order[j-1];
+                if ( g->adjStart[w+1] - g->adjStart[w] <= degree ) break;
+                order[j] = w;
+            }
+            order[j] = u;
+        }
+    }
+    return next;
+}
@@ -0,0 +1,21 @@
+//-----------------------------------------------------------------------------
+//   partition.h
+//
+//   Header file for the graph partitioner (partition.c).
+//
+//   The partitioner splits the nodes of a graph (such as the node-link
+//   graph of a drainage network) into a given number of parts of nearly
+//   equal weight that are each connected where possible, while keeping
+//   the number of edges cut between parts small, and can number the nodes
+//   of each part so that neighboring nodes have nearby numbers.
+//-----------------------------------------------------------------------------
+
+#ifndef PARTITION_H
+#define PARTITION_H
+
+int partition_create(int n, int m, int node1[], int node2[], int weight[],
+    int nParts, int part[]);
+int partition_order(int n, int m, int node1[], int node2[], int part[],
+    int order[]);
+
+#endif //PARTITION_H
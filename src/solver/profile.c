@@ -0,0 +1,231 @@
+//-----------------------------------------------------------------------------
+//   profile.c
+//
+//   Project:  EPA SWMM5
+//   Version:  5.2
+//   Date:     10/16/26 (Build 5.2.4+)
+//
+//   Run time profile of a simulation.
+//
+//   The wall clock time spent in each phase of a run (reading input,
+//   computing runoff, routing flow, routing quality, evaluating controls,
+//   updating statistics, saving and reporting results) is accumulated with
+//   a monotonic clock. Only one phase is timed at a time: entering a phase
+//   charges the time since the last change to the phase being left, so a
+//   phase entered from within another one (e.g., controls evaluated while
+//   routing flow) is not also charged to the outer phase.
+//
+//   Counts of time steps, routing trials, ODE integration steps, table
+//   lookups and the thread sub-domains of dynamic wave routing are also
+//   kept. Since lookups and ODE steps are made by OpenMP worker threads,
+//   each thread counts into its own set of counters which are added to
+//   the project's totals when the thread ends a parallel region or when
+//   the totals are retrieved.
+//
+//   The profile can be retrieved through the toolkit API and is written to
+//   the file named by the PROFILE_FILE option when a project is closed.
+//-----------------------------------------------------------------------------
+#define _CRT_SECURE_NO_DEPRECATE
+
+#include <stdio.h>
+#include <string.h>
+#include "headers.h"
+#include "profile.h"
+#include "version.h"
+
+#ifdef _WIN32
+  #include <windows.h>
+#else
+  #include <time.h>
+#endif
+
+//-----------------------------------------------------------------------------
+//  Local variables
+//-----------------------------------------------------------------------------
+static THREADLOCAL double PhaseTime[MAX_PROFILE_PHASES]; // time in each phase (sec)
+static THREADLOCAL double Counts[MAX_PROFILE_COUNTS];    // project's totals
+static THREADLOCAL int    Phase = PROFILE_NONE;          // phase being timed
+static THREADLOCAL double PhaseStart;                    // time phase entered
+static WORKERLOCAL double WorkerCounts[MAX_PROFILE_COUNTS]; // calling thread's
+                                                            // unmerged counts
+
+static const char* PhaseNames[] = {"input", "start", "runoff", "routing",
+    "quality", "controls", "stats", "output", "report"};
+static const char* CountNames[] = {"runoff_steps", "routing_steps",
+    "routing_trials", "ode_steps", "table_lookups", "routing_domains"};
+
+//-----------------------------------------------------------------------------
+//  External functions (declared in profile.h)
+//-----------------------------------------------------------------------------
+//  profile_open         (called from openProject in swmm5.c)
+//  profile_setPhase     (called from swmm5.c & routing.c)
+//  profile_count        (called from odesolve.c & table.c)
+//  profile_addCount     (called from swmm5.c, routing.c & dynwave.c)
+//  profile_mergeCounts  (called at end of parallel regions)
+//  profile_getTotals    (called from swmm_getProfile in toolkit.c)
+//  profile_write        (called from swmm_close)
+//  profile_getClock     (called from dynwave_execute in dynwave.c)
+
+//=============================================================================
+
+void profile_open()
+//
+//  Input:   none
+//  Output:  none
+//  Purpose: clears the profile of the previous project.
+//
+{
+    int i;
+    for (i = 0; i < MAX_PROFILE_PHASES; i++) PhaseTime[i] = 0.0;
+    for (i = 0; i < MAX_PROFILE_COUNTS; i++)
+    {
+        Counts[i] = 0.0;
+        WorkerCounts[i] = 0.0;
+    }
+    Phase = PROFILE_NONE;
+}
+
+//=============================================================================
+
+int profile_setPhase(int phase)
+//
+//  Input:   phase = phase of the run being entered (or PROFILE_NONE)
+//  Output:  returns the phase being left
+//  Purpose: charges the time since the last change of phase to the phase
+//           being left and starts timing a new phase.
+//
+{
+    int    oldPhase = Phase;
+    double now = profile_getClock();
+
+    if ( oldPhase != PROFILE_NONE ) PhaseTime[oldPhase] += now - PhaseStart;
+    PhaseStart = now;
+    Phase = phase;
+    return oldPhase;
+}
+
+//=============================================================================
+
+void profile_count(int counter)
+//
+//  Input:   counter = type of event counted
+//  Output:  none
+//  Purpose: counts an event made by the calling thread.
+//
+{
+    WorkerCounts[counter] += 1.0;
+}
+
+//=============================================================================
+
+void profile_addCount(int counter, double n)
+//
+//  Input:   counter = type of event counted
+//           n = number of events
+//  Output:  none
+//  Purpose: counts a number of events made by the calling thread.
+//
+{
+    WorkerCounts[counter] += n;
+}
+
+//=============================================================================
+
+void profile_mergeCounts()
+//
+//  Input:   none
+//  Output:  none
+//  Purpose: adds the counts made by the calling thread to the project's
+//           totals.
+//
+{
+    int i;
+
+    #pragma omp critical(profile)
+    for (i = 0; i < MAX_PROFILE_COUNTS; i++)
+    {
+        Counts[i] += WorkerCounts[i];
+        WorkerCounts[i] = 0.0;
+    }
+}
+
+//=============================================================================
+
+void profile_getTotals(double times[], double counts[])
+//
+//  Input:   none
+//  Output:  times = time spent in each phase (sec)
+//           counts = number of events of each type
+//  Purpose: retrieves the profile of the current project.
+//
+{
+    int i;
+
+    // --- bring the time of the current phase up to date
+    profile_setPhase(Phase);
+    profile_mergeCounts();
+    for (i = 0; i < MAX_PROFILE_PHASES; i++) times[i] = PhaseTime[i];
+    for (i = 0; i < MAX_PROFILE_COUNTS; i++) counts[i] = Counts[i];
+}
+
+//=============================================================================
+
+void profile_write()
+//
+//  Input:   none
+//  Output:  none
+//  Purpose: writes the profile to the file named by the PROFILE_FILE option
+//           as a JSON object.
+//
+{
+    int    i;
+    double times[MAX_PROFILE_PHASES];
+    double counts[MAX_PROFILE_COUNTS];
+    double total = 0.0;
+    FILE*  f;
+
+    if ( strlen(ProfileFile) == 0 ) return;
+    f = fopen(ProfileFile, "wt");
+    if ( f == NULL ) return;
+    profile_getTotals(times, counts);
+
+    fprintf(f, "{\n  \"version\": \"%s\",\n", VERSION);
+    fprintf(f, "  \"threads\": %d,\n", NumThreads);
+    fprintf(f, "  \"seconds\": {\n");
+    for (i = 0; i < MAX_PROFILE_PHASES; i++)
+    {
+        fprintf(f, "    \"%s\": %.6f,\n", PhaseNames[i], times[i]);
+        total += times[i];
+    }
+    fprintf(f, "    \"total\": %.6f\n  },\n", total);
+    fprintf(f, "  \"counts\": {\n");
+    for (i = 0; i < MAX_PROFILE_COUNTS; i++)
+    {
+        fprintf(f, "    \"%s\": %.0f%s\n", CountNames[i], counts[i],
+                i < MAX_PROFILE_COUNTS - 1 ? "," : "");
+    }
+    fprintf(f, "  }\n}\n");
+    fclose(f);
+}
+
+//=============================================================================
+
+double profile_getClock()
+//
+//  Input:   none
+//  Output:  returns the time of a monotonic clock (sec)
+//  Purpose: reads a clock that is not affected by changes to the system time.
+//
+{
+#ifdef _WIN32
+    static LARGE_INTEGER frequency;
+    LARGE_INTEGER count;
+    if ( frequency.QuadPart == 0 ) QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&count);
+    return (double)count.QuadPart / (double)frequency.QuadPart;
+#else
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double)t.tv_sec + 1.0e-9 * (double)t.tv_nsec;
+#endif
+}
@@ -0,0 +1,51 @@
+//-----------------------------------------------------------------------------
+//  profile.h
+//
+//  Header file for the run time profile contained in profile.c
+//
+//-----------------------------------------------------------------------------
+
+#ifndef PROFILE_H
+#define PROFILE_H
+
+
+//-------------------------------------
+// Phases of a run
+//-------------------------------------
+#define MAX_PROFILE_PHASES 9
+enum ProfilePhaseType {
+     PROFILE_NONE = -1,                // time not charged to any phase
+     PROFILE_INPUT,                    // reading & validating input data
+     PROFILE_START,                    // initializing a simulation
+     PROFILE_RUNOFF,                   // computing runoff
+     PROFILE_ROUTING,                  // routing flow
+     PROFILE_QUALITY,                  // routing water quality
+     PROFILE_CONTROLS,                 // evaluating control rules
+     PROFILE_STATS,                    // updating summary statistics
+     PROFILE_OUTPUT,                   // saving results to output file
+     PROFILE_REPORT};                  // writing results to report file
+
+//-------------------------------------
+// Events counted
+//-------------------------------------
+#define MAX_PROFILE_COUNTS 6
+enum ProfileCountType {
+     PROFILE_RUNOFF_STEPS,             // runoff time steps taken
+     PROFILE_ROUTING_STEPS,            // routing time steps taken
+     PROFILE_TRIALS,                   // flow routing trials (iterations)
+     PROFILE_ODE_STEPS,                // Runge-Kutta integration steps
+     PROFILE_LOOKUPS,                  // curve & time series lookups
+     PROFILE_DOMAINS};                 // dynamic wave thread sub-domains
+
+// functions that time the phases of a run and count its events
+void profile_open(void);
+int  profile_setPhase(int phase);
+void profile_count(int counter);
+void profile_addCount(int counter, double n);
+void profile_mergeCounts(void);
+void profile_getTotals(double times[], double counts[]);
+void profile_write(void);
+double profile_getClock(void);
+
+
+#endif //PROFILE_H
@@ -56,6 +56,16 @@
 //   - Default Inertial Damping changed from SOME to PARTIAL_DAMPING.
 //   - Default CourantFactor changed from 0 (fixed routing time step)
 //   - to 0.75 (variable time step)
+//   Build 5.2.4+:
+//   - Support added for the OutputLayout option.
+//   - Support added for the ProfileFile option.
+//   - Support added for the DynwaveSolver option.
+//   - Support added for the ActiveSet option.
+//   - Support added for the LocalStepClasses option.
+//   - Support added for the NetworkOrdering option.
+//   - New function project_readSnapshot() added.
+//   - Number of threads no longer reduced for projects with few links
+//     (dynamic wave routing sizes its own thread use).
 //-----------------------------------------------------------------------------
 #define _CRT_SECURE_NO_DEPRECATE
 
@@ -78,17 +88,18 @@
 //-----------------------------------------------------------------------------
 //  Shared variables
 //-----------------------------------------------------------------------------
-static HTtable* Htable[MAX_OBJ_TYPES]; // Hash tables for object ID names
-static char     MemPoolAllocated;      // TRUE if memory pool allocated 
+static THREADLOCAL HTtable* Htable[MAX_OBJ_TYPES]; // Hash tables for object ID names
+static THREADLOCAL char     MemPoolAllocated;      // TRUE if memory pool allocated 
 
 //-----------------------------------------------------------------------------
 //  External Functions (declared in funcs.h)
 //-----------------------------------------------------------------------------
-//  project_open           (called from swmm_open in swmm5.c)
+//  project_open           (called from openProject in swmm5.c)
 //  project_close          (called from swmm_close in swmm5.c)
-//  project_readInput      (called from swmm_open in swmm5.c)
+//  project_readInput      (called from openProject in swmm5.c)
+//  project_readSnapshot   (called from openProject in swmm5.c)
 //  project_readOption     (called from readOption in input.c)
-//  project_validate       (called from swmm_open in swmm5.c)
+//  project_validate       (called from openProject in swmm5.c)
 //  project_init           (called from swmm_start in swmm5.c)
 //  project_addObject      (called from addObject in input.c)
 //  project_createMatrix   (called from openFileForInput in iface.c)
@@ -191,6 +202,45 @@ void project_readInput()
 
 //=============================================================================
 
+int project_readSnapshot(const char *f)
+//
+//  Input:   f = name of snapshot file
+//  Output:  returns TRUE if project was read from the snapshot file
+//  Purpose: retrieves validated project data from a snapshot file made
+//           from the project's input file.
+//
+{
+    int result = FALSE;
+    int warnings = Warnings;
+
+    // --- check that snapshot was made from current input file
+    if ( ErrorCode || !snapshot_open(f) ) return FALSE;
+
+    // --- create project's objects and read their data from snapshot
+    createHashTables();
+    controls_init();
+    if ( !ErrorCode && snapshot_readCounts() )
+    {
+        createObjects();
+        if ( !ErrorCode ) result = snapshot_readObjects();
+    }
+    snapshot_close();
+
+    // --- restore an empty project if snapshot could not be read
+    if ( !result )
+    {
+        deleteObjects();
+        deleteHashTables();
+        initPointers();
+        setDefaults();
+        ErrorCode = 0;
+        Warnings = warnings;
+    }
+    return result;
+}
+
+//=============================================================================
+
 void project_validate()
 //
 //  Input:   none
@@ -206,7 +256,8 @@ void project_validate()
     for ( i=0; i<Nobjects[CURVE]; i++ )
     {
          err = table_validate(&Curve[i]);
-         if ( err ) report_writeErrorMsg(ERR_CURVE_SEQUENCE, Curve[i].ID);
+         if ( err == ERR_MEMORY ) report_writeErrorMsg(ERR_MEMORY, "");
+         else if ( err ) report_writeErrorMsg(ERR_CURVE_SEQUENCE, Curve[i].ID);
     }
     for ( i=0; i<Nobjects[TSERIES]; i++ )
     {
@@ -272,9 +323,15 @@ void project_validate()
     inlet_validate();
 
     // --- adjust number of parallel threads to be used
+    //     (OpenMP worker threads cannot see the thread-local project
+    //     state of a reentrant build)
+#ifdef SWMM_REENTRANT
+    if ( NumThreads != 1 ) report_writeWarningMsg(WARN13, "");
+    NumThreads = 1;
+#else
     if ( NumThreads == 0 ) NumThreads = omp_get_max_threads();
     else NumThreads = MIN(NumThreads, omp_get_max_threads());
-    if ( Nobjects[LINK] < 4 * NumThreads ) NumThreads = 1;
+#endif
 }
 
 //=============================================================================
@@ -611,6 +668,7 @@ int project_readOption(char* s1, char* s2)
       case ALLOW_PONDING:
       case SLOPE_WEIGHTING:
       case SKIP_STEADY_STATE:
+      case ACTIVE_SET:
       case IGNORE_RAINFALL:
       case IGNORE_SNOWMELT:
       case IGNORE_GWATER:
@@ -624,6 +682,7 @@ int project_readOption(char* s1, char* s2)
           case ALLOW_PONDING:     AllowPonding    = m;  break;
           case SLOPE_WEIGHTING:   SlopeWeighting  = m;  break;
           case SKIP_STEADY_STATE: SkipSteadyState = m;  break;
+          case ACTIVE_SET:        ActiveSet       = m;  break;
           case IGNORE_RAINFALL:   IgnoreRainfall  = m;  break;
           case IGNORE_SNOWMELT:   IgnoreSnowmelt  = m;  break;
           case IGNORE_GWATER:     IgnoreGwater    = m;  break;
@@ -735,6 +794,15 @@ int project_readOption(char* s1, char* s2)
         MaxTrials = m;
         break;
 
+      // --- number of power-of-two classes of local time steps finer
+      //     than the dynamic wave routing time step
+      case LOCAL_STEP_CLASSES:
+        m = atoi(s2);
+        if ( m < 0 || m > MAXSTEPCLASSES )
+            return error_setInpError(ERR_NUMBER, s2);
+        LocalStepClasses = m;
+        break;
+
       // --- head convergence tolerance for dynamic wave routing
       case HEAD_TOL:
         if ( !getDouble(s2, &HeadTol) )
@@ -768,10 +836,36 @@ int project_readOption(char* s1, char* s2)
           SurchargeMethod = m;
           break;
 
+      // --- solver used for dynamic wave flow routing
+      case DYNWAVE_SOLVER:
+        m = findmatch(s2, DynwaveSolverWords);
+        if ( m < 0 ) return error_setInpError(ERR_KEYWORD, s2);
+        DynwaveSolver = m;
+        break;
+
+      // --- order of nodes & links in dynamic wave solver's state
+      case NETWORK_ORDERING:
+        m = findmatch(s2, NetworkOrderingWords);
+        if ( m < 0 ) return error_setInpError(ERR_KEYWORD, s2);
+        NetworkOrdering = m;
+        break;
+
+      // --- layout of computed results in binary output file
+      case OUTPUT_LAYOUT:
+        m = findmatch(s2, OutputLayoutWords);
+        if ( m < 0 ) return error_setInpError(ERR_KEYWORD, s2);
+        OutputLayout = m;
+        break;
+
       case TEMPDIR: // Temporary Directory
         sstrncpy(TempDir, s2, MAXFNAME);
         break;
 
+      // --- file to which run time profile is written
+      case PROFILE_FILE:
+        sstrncpy(ProfileFile, addAbsolutePath(s2), MAXFNAME);
+        break;
+
     }
     return 0;
 }
@@ -822,9 +916,10 @@ void setDefaults()
 {
    int i, j;
 
-   // Project title & temp. file path
+   // Project title, temp. file path & profile file
    for (i = 0; i < MAXTITLE; i++) sstrncpy(Title[i], "", 0);
    sstrncpy(TempDir, "", 0);
+   sstrncpy(ProfileFile, "", 0);
 
    // Interface files
    Frain.mode      = SCRATCH_FILE;     // Use scratch rainfall file
@@ -852,6 +947,7 @@ void setDefaults()
    InfilModel      = HORTON;           // Horton infiltration method
    RouteModel      = DW;               // Dynamic wave flow routing method
    SurchargeMethod = EXTRAN;           // Use EXTRAN method for surcharging
+   DynwaveSolver   = PICARD_SOLVER;    // Use Picard iterations for DW routing
    CrownCutoff     = 0.96;             // Fractional pipe crown cutoff 
    AllowPonding    = FALSE;            // No ponding at nodes
    InertDamping    = PARTIAL_DAMPING;  // Partial inertial damping
@@ -863,6 +959,9 @@ void setDefaults()
    MinSurfArea     = 0.0;              // Force use of default min. surface area
    MinSlope        = 0.0;              // No user supplied minimum conduit slope
    SkipSteadyState = FALSE;            // Do flow routing in steady state periods 
+   ActiveSet       = FALSE;            // Re-solve all nodes in each DW trial
+   LocalStepClasses = 0;               // No local DW time steps
+   NetworkOrdering = INPUT_ORDERING;   // DW solver keeps input order
    IgnoreRainfall  = FALSE;            // Analyze rainfall/runoff
    IgnoreRDII      = FALSE;            // Analyze RDII
    IgnoreSnowmelt  = FALSE;            // Analyze snowmelt 
@@ -882,6 +981,7 @@ void setDefaults()
    LatFlowTol      = 0.05;             // Lateral flow tolerance for steady state
    NumThreads      = 1;                // Number of parallel threads to use
    NumEvents       = 0;                // Number of detailed routing events
+   OutputLayout    = STANDARD_LAYOUT;  // Save results period by period
 
    // Deprecated options
    SlopeWeighting  = TRUE;             // Use slope weighting 
@@ -1264,13 +1364,13 @@ void deleteObjects()
         FREE(Outfall[j].wRouted);
 
     // --- free memory used for nodal inflows & treatment functions
+    inflow_delete();
     if ( Node ) for (j = 0; j < Nobjects[NODE]; j++)
     {
-        inflow_deleteExtInflows(j);
-        inflow_deleteDwfInflows(j);
         rdii_deleteRdiiInflow(j);
         treatmnt_delete(j);
     }
+    treatmnt_deleteExpressions();
 
     // --- delete table entries for curves and time series
     if ( Tseries ) for (j = 0; j < Nobjects[TSERIES]; j++)
@@ -26,6 +26,10 @@
 //   Build 5.2.1:
 //   - Dry non-storage nodes now have quality determined by inflow.   
 //   - Wet non-storage nodes with no inflow now have no change in quality.
+//   Build 5.2.4+:
+//   - Treatment is applied once new quality is known at every node, so
+//     that shared treatment expressions can be evaluated for all nodes
+//     at once.
 //-----------------------------------------------------------------------------
 #define _CRT_SECURE_NO_DEPRECATE
 
@@ -123,7 +127,7 @@ void qualrout_execute(double tStep)
         if ( Node[j].treatment || ExtPollutFlag == 1)  // (OWA EDIT: call treatmnt_setInflow when using toolkit API )
         {
             if ( qIn < ZERO ) qIn = 0.0;
-            treatmnt_setInflow(qIn, Node[j].newQual);
+            treatmnt_setInflow(j, qIn, Node[j].newQual);
         }
        
         // --- find new quality at the node 
@@ -132,9 +136,22 @@ void qualrout_execute(double tStep)
             findStorageQual(j, tStep);
         }
         else findNodeQual(j);
+    }
+
+    // --- evaluate treatment expressions shared by several nodes
+    //     (treatment at a node does not affect new quality at others)
+    treatmnt_findRemovals(tStep);
 
-        // --- apply treatment to new quality values
-        if ( Node[j].treatment || ExtPollutFlag == 1) treatmnt_treat(j, qIn, vAvg, tStep);  // (OWA EDIT: call treatmnt_treat when using toolkit API )
+    // --- apply treatment to new quality values
+    for (j = 0; j < Nobjects[NODE]; j++)
+    {
+        if ( Node[j].treatment || ExtPollutFlag == 1)  // (OWA EDIT: call treatmnt_treat when using toolkit API )
+        {
+            qIn = Node[j].qualInflow;
+            if ( qIn < ZERO ) qIn = 0.0;
+            vAvg = (Node[j].oldVolume + Node[j].newVolume) / 2.0;
+            treatmnt_treat(j, qIn, vAvg, tStep);
+        }
     }
 
     // --- find new water quality in each link
@@ -66,20 +66,20 @@ enum ConditionCodes {NO_CONDITION, ACCUMULATED_PERIOD, DELETED_PERIOD,
 //-----------------------------------------------------------------------------
 //  Shared variables
 //-----------------------------------------------------------------------------
-TRainStats RainStats;                  // see objects.h for definition
-int        Condition;                  // rainfall condition code
-int        TimeOffset;                 // time offset of rainfall reading (sec)
-int        DataOffset;                 // start of data on line of input
-int        ValueOffset;                // start of rain value on input line
-int        RainType;                   // rain measurement type code
-int        Interval;                   // rain measurement interval (sec)
-double     UnitsFactor;                // units conversion factor
-float      RainAccum;                  // rainfall depth accumulation
-char       *StationID;                 // station ID appearing in rain file
-DateTime   AccumStartDate;             // date when accumulation begins
-DateTime   PreviousDate;               // date of previous rainfall record
-int        GageIndex;                  // index of rain gage analyzed
-int        hasStationName;             // true if data contains station name
+THREADLOCAL TRainStats RainStats;                  // see objects.h for definition
+THREADLOCAL int        Condition;                  // rainfall condition code
+THREADLOCAL int        TimeOffset;                 // time offset of rainfall reading (sec)
+THREADLOCAL int        DataOffset;                 // start of data on line of input
+THREADLOCAL int        ValueOffset;                // start of rain value on input line
+THREADLOCAL int        RainType;                   // rain measurement type code
+THREADLOCAL int        Interval;                   // rain measurement interval (sec)
+THREADLOCAL double     UnitsFactor;                // units conversion factor
+THREADLOCAL float      RainAccum;                  // rainfall depth accumulation
+THREADLOCAL char       *StationID;                 // station ID appearing in rain file
+THREADLOCAL DateTime   AccumStartDate;             // date when accumulation begins
+THREADLOCAL DateTime   PreviousDate;               // date of previous rainfall record
+THREADLOCAL int        GageIndex;                  // index of rain gage analyzed
+THREADLOCAL int        hasStationName;             // true if data contains station name
 
 //-----------------------------------------------------------------------------
 //  External functions (declared in funcs.h)
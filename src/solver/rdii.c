@@ -71,17 +71,17 @@ typedef struct                         // Data for a unit hydrograph group
 //-----------------------------------------------------------------------------
 // Shared Variables
 //-----------------------------------------------------------------------------
-static TUHGroup*  UHGroup;             // processing data for each UH group
-static int        RdiiStep;            // RDII time step (sec)
-static int        NumRdiiNodes;        // number of nodes w/ RDII data
-static int*       RdiiNodeIndex;       // indexes of nodes w/ RDII data
-static REAL4*     RdiiNodeFlow;        // inflows for nodes with RDII
-static int        RdiiFlowUnits;       // RDII flow units code
-static DateTime   RdiiStartDate;       // start date of RDII inflow period
-static DateTime   RdiiEndDate;         // end date of RDII inflow period
-static double     TotalRainVol;        // total rainfall volume (ft3)
-static double     TotalRdiiVol;        // total RDII volume (ft3)
-static int        RdiiFileType;        // type (binary/text) of RDII file
+static THREADLOCAL TUHGroup*  UHGroup;             // processing data for each UH group
+static THREADLOCAL int        RdiiStep;            // RDII time step (sec)
+static THREADLOCAL int        NumRdiiNodes;        // number of nodes w/ RDII data
+static THREADLOCAL int*       RdiiNodeIndex;       // indexes of nodes w/ RDII data
+static THREADLOCAL REAL4*     RdiiNodeFlow;        // inflows for nodes with RDII
+static THREADLOCAL int        RdiiFlowUnits;       // RDII flow units code
+static THREADLOCAL DateTime   RdiiStartDate;       // start date of RDII inflow period
+static THREADLOCAL DateTime   RdiiEndDate;         // end date of RDII inflow period
+static THREADLOCAL double     TotalRainVol;        // total rainfall volume (ft3)
+static THREADLOCAL double     TotalRdiiVol;        // total RDII volume (ft3)
+static THREADLOCAL int        RdiiFileType;        // type (binary/text) of RDII file
 
 //-----------------------------------------------------------------------------
 // Imported Variables
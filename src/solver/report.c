@@ -39,6 +39,14 @@
 //   - Support added for reporting most frequent non-converging links.
 //   - Support added for RptFlags.disabled flag.
 //   - Refactored report_readOptions().
+//   Build 5.2.4+:
+//   - Time series tables of subcatchments, nodes & links written from
+//     results read in batches of objects rather than period by period.
+//   - Dynamic wave solver written to the analysis options when it is NEWTON.
+//   - Active set iterations noted in the analysis options when used.
+//   - Wall clock time of routing with local time steps added to time
+//     step summary.
+//   - Network ordering written to the analysis options when it is RCM.
 //-----------------------------------------------------------------------------
 #define _CRT_SECURE_NO_DEPRECATE
 
@@ -58,23 +66,23 @@
 #define LINE_64 \
 "----------------------------------------------------------------"
 
+// Memory used to hold a batch of objects' time series results
+#define MAX_BATCH_BYTES 16777216
+
 
 //-----------------------------------------------------------------------------
 //  Shared variables
 //-----------------------------------------------------------------------------
-static time_t SysTime;
+static THREADLOCAL time_t SysTime;
 
 //-----------------------------------------------------------------------------
 //  Imported variables
 //-----------------------------------------------------------------------------
 #define REAL4 float
-extern REAL4* SubcatchResults;         // Results vectors defined in OUTPUT.C
-extern REAL4* NodeResults;             //  "
-extern REAL4* LinkResults;             //  "
-extern char   ErrString[81];           // defined in ERROR.C
+extern WORKERLOCAL char   ErrString[81];           // defined in ERROR.C
 
 
-extern TNodeStats*     NodeStats;
+extern THREADLOCAL TNodeStats*     NodeStats;
 
 
 //-----------------------------------------------------------------------------
@@ -84,10 +92,16 @@ static void report_LoadingErrors(int p1, int p2, TLoadingTotals* totals);
 static void report_QualErrors(int p1, int p2, TRoutingTotals* totals);
 static void report_Subcatchments(void);
 static void report_SubcatchHeader(char *id);
+static void report_SubcatchResults(REAL4* x);
 static void report_Nodes(void);
 static void report_NodeHeader(char *id);
+static void report_NodeResults(REAL4* x);
 static void report_Links(void);
 static void report_LinkHeader(char *id);
+static void report_LinkResults(REAL4* x);
+static void report_TimeSeries(int type, void (*writeHeader)(char *id),
+            void (*writeResults)(REAL4* x));
+static int  report_GetRptFlag(int type, int j, char** id);
 static void report_RouteStepFreq(TTimeStepStats* timeStepStats);
 
 //=============================================================================
@@ -317,6 +331,16 @@ void report_writeOptions()
     if (RouteModel == DW)
     fprintf(Frpt.file, "\n  Surcharge Method ......... %s",
         SurchargeWords[SurchargeMethod]);
+    if (RouteModel == DW && DynwaveSolver == NEWTON_SOLVER)
+    fprintf(Frpt.file, "\n  Dynamic Wave Solver ...... %s",
+        DynwaveSolverWords[DynwaveSolver]);
+    if (RouteModel == DW && ActiveSet)
+    fprintf(Frpt.file, "\n  Active Set Iterations .... YES");
+    if (RouteModel == DW && LocalStepClasses > 0)
+    fprintf(Frpt.file, "\n  Local Time Step Classes .. %d", LocalStepClasses);
+    if (RouteModel == DW && NetworkOrdering == RCM_ORDERING)
+    fprintf(Frpt.file, "\n  Network Ordering ......... %s",
+        NetworkOrderingWords[NetworkOrdering]);
 
     datetime_dateToStr(StartDate, str);
     fprintf(Frpt.file, "\n  Starting Date ............ %s", str);
@@ -1081,6 +1105,15 @@ void report_writeTimeStepStats(TTimeStepStats* timeStepStats)
     fprintf(Frpt.file,
         "\n  %% of Steps Not Converging   :  %7.2f",
         100.0 * (double)NonConvergeCount / timeStepCount);
+    if (timeStepStats->routingWallTime > 0.0)
+    {
+        fprintf(Frpt.file,
+            "\n  Routing Wall Clock Time     :  %7.2f sec",
+            timeStepStats->routingWallTime);
+        fprintf(Frpt.file,
+            "\n  Local Time Step Wall Time   :  %7.2f sec",
+            timeStepStats->localStepWallTime);
+    }
 
     // --- write grouped frequency table of variable routing time steps
     if (RouteModel == DW && CourantFactor > 0.0)
@@ -1147,52 +1180,40 @@ void report_Subcatchments()
 //  Purpose: writes results for selected subcatchments to report file.
 //
 {
-    int      j, p, k;
-    int      period;
-    DateTime days;
-    char     theDate[DATE_STR_SIZE];
-    char     theTime[TIME_STR_SIZE];
-    int      hasSnowmelt = (Nobjects[SNOWMELT] > 0 && !IgnoreSnowmelt);
-    int      hasGwater   = (Nobjects[AQUIFER] > 0  && !IgnoreGwater);
-    int      hasQuality  = (Nobjects[POLLUT] > 0 && !IgnoreQuality);
-
     if ( Nobjects[SUBCATCH] == 0 ) return;
     WRITE("");
     WRITE("********************************");
     WRITE("Subcatchment Time Series Results");
     WRITE("********************************");
-    for (j = 0; j < Nobjects[SUBCATCH]; j++)
-    {
-        k = Subcatch[j].rptFlag - 1;
-        if ( k >= 0 )
-        {
-            report_SubcatchHeader(Subcatch[j].ID);
-            for ( period = 1; period <= Nperiods; period++ )
-            {
-                output_readDateTime(period, &days);
-                datetime_dateToStr(days, theDate);
-                datetime_timeToStr(days, theTime);
-                output_readSubcatchResults(period, k);
-                fprintf(Frpt.file, "\n  %11s %8s %10.3f%10.3f%10.4f",
-                    theDate, theTime, SubcatchResults[SUBCATCH_RAINFALL],
-                    SubcatchResults[SUBCATCH_EVAP]/24.0 +
-                    SubcatchResults[SUBCATCH_INFIL],
-                    SubcatchResults[SUBCATCH_RUNOFF]);
-                if ( hasSnowmelt )
-                    fprintf(Frpt.file, "  %10.3f",
-                        SubcatchResults[SUBCATCH_SNOWDEPTH]);
-                if ( hasGwater )
-                    fprintf(Frpt.file, "%10.3f%10.4f",
-                        SubcatchResults[SUBCATCH_GW_ELEV],
-                        SubcatchResults[SUBCATCH_GW_FLOW]);
-                if ( hasQuality )
-                    for (p = 0; p < Nobjects[POLLUT]; p++)
-                        fprintf(Frpt.file, "%10.3f",
-                            SubcatchResults[SUBCATCH_WASHOFF+p]);
-            }
-            WRITE("");
-        }
-    }
+    report_TimeSeries(SUBCATCH, report_SubcatchHeader, report_SubcatchResults);
+}
+
+//=============================================================================
+
+void report_SubcatchResults(REAL4* x)
+//
+//  Input:   x = subcatchment's results for a reporting period
+//  Output:  none
+//  Purpose: writes a row of subcatchment results to report file.
+//
+{
+    int p;
+    int hasSnowmelt = (Nobjects[SNOWMELT] > 0 && !IgnoreSnowmelt);
+    int hasGwater   = (Nobjects[AQUIFER] > 0  && !IgnoreGwater);
+    int hasQuality  = (Nobjects[POLLUT] > 0 && !IgnoreQuality);
+
+    fprintf(Frpt.file, " %10.3f%10.3f%10.4f",
+        x[SUBCATCH_RAINFALL],
+        x[SUBCATCH_EVAP]/24.0 + x[SUBCATCH_INFIL],
+        x[SUBCATCH_RUNOFF]);
+    if ( hasSnowmelt )
+        fprintf(Frpt.file, "  %10.3f", x[SUBCATCH_SNOWDEPTH]);
+    if ( hasGwater )
+        fprintf(Frpt.file, "%10.3f%10.4f",
+            x[SUBCATCH_GW_ELEV], x[SUBCATCH_GW_FLOW]);
+    if ( hasQuality )
+        for (p = 0; p < Nobjects[POLLUT]; p++)
+            fprintf(Frpt.file, "%10.3f", x[SUBCATCH_WASHOFF+p]);
 }
 
 //=============================================================================
@@ -1273,39 +1294,29 @@ void report_Nodes()
 //  Purpose: writes results for selected nodes to report file.
 //
 {
-    int      j, p, k;
-    int      period;
-    DateTime days;
-    char     theDate[DATE_STR_SIZE];
-    char     theTime[TIME_STR_SIZE];
-
     if ( Nobjects[NODE] == 0 ) return;
     WRITE("");
     WRITE("************************");
     WRITE("Node Time Series Results");
     WRITE("************************");
-    for (j = 0; j < Nobjects[NODE]; j++)
-    {
-        k = Node[j].rptFlag - 1;
-        if ( k >= 0 )
-        {
-            report_NodeHeader(Node[j].ID);
-            for ( period = 1; period <= Nperiods; period++ )
-            {
-                output_readDateTime(period, &days);
-                datetime_dateToStr(days, theDate);
-                datetime_timeToStr(days, theTime);
-                output_readNodeResults(period, k);
-                fprintf(Frpt.file, "\n  %11s %8s  %9.3f %9.3f %9.3f %9.3f",
-                    theDate, theTime, NodeResults[NODE_INFLOW],
-                    NodeResults[NODE_OVERFLOW], NodeResults[NODE_DEPTH],
-                    NodeResults[NODE_HEAD]);
-                if ( !IgnoreQuality ) for (p = 0; p < Nobjects[POLLUT]; p++)
-                    fprintf(Frpt.file, " %9.3f", NodeResults[NODE_QUAL + p]);
-            }
-            WRITE("");
-        }
-    }
+    report_TimeSeries(NODE, report_NodeHeader, report_NodeResults);
+}
+
+//=============================================================================
+
+void report_NodeResults(REAL4* x)
+//
+//  Input:   x = node's results for a reporting period
+//  Output:  none
+//  Purpose: writes a row of node results to report file.
+//
+{
+    int p;
+
+    fprintf(Frpt.file, "  %9.3f %9.3f %9.3f %9.3f",
+        x[NODE_INFLOW], x[NODE_OVERFLOW], x[NODE_DEPTH], x[NODE_HEAD]);
+    if ( !IgnoreQuality ) for (p = 0; p < Nobjects[POLLUT]; p++)
+        fprintf(Frpt.file, " %9.3f", x[NODE_QUAL + p]);
 }
 
 //=============================================================================
@@ -1351,39 +1362,29 @@ void report_Links()
 //  Purpose: writes results for selected links to report file.
 //
 {
-    int      j, p, k;
-    int      period;
-    DateTime days;
-    char     theDate[DATE_STR_SIZE];
-    char     theTime[TIME_STR_SIZE];
-
     if ( Nobjects[LINK] == 0 ) return;
     WRITE("");
     WRITE("************************");
     WRITE("Link Time Series Results");
     WRITE("************************");
-    for (j = 0; j < Nobjects[LINK]; j++)
-    {
-        k = Link[j].rptFlag - 1;
-        if ( k >= 0 )
-        {
-            report_LinkHeader(Link[j].ID);
-            for ( period = 1; period <= Nperiods; period++ )
-            {
-                output_readDateTime(period, &days);
-                datetime_dateToStr(days, theDate);
-                datetime_timeToStr(days, theTime);
-                output_readLinkResults(period, k);
-                fprintf(Frpt.file, "\n  %11s %8s  %9.3f %9.3f %9.3f %9.3f",
-                    theDate, theTime, LinkResults[LINK_FLOW],
-                    LinkResults[LINK_VELOCITY], LinkResults[LINK_DEPTH],
-                    LinkResults[LINK_CAPACITY]);
-                if ( !IgnoreQuality ) for (p = 0; p < Nobjects[POLLUT]; p++)
-                    fprintf(Frpt.file, " %9.3f", LinkResults[LINK_QUAL + p]);
-            }
-            WRITE("");
-        }
-    }
+    report_TimeSeries(LINK, report_LinkHeader, report_LinkResults);
+}
+
+//=============================================================================
+
+void report_LinkResults(REAL4* x)
+//
+//  Input:   x = link's results for a reporting period
+//  Output:  none
+//  Purpose: writes a row of link results to report file.
+//
+{
+    int p;
+
+    fprintf(Frpt.file, "  %9.3f %9.3f %9.3f %9.3f",
+        x[LINK_FLOW], x[LINK_VELOCITY], x[LINK_DEPTH], x[LINK_CAPACITY]);
+    if ( !IgnoreQuality ) for (p = 0; p < Nobjects[POLLUT]; p++)
+        fprintf(Frpt.file, " %9.3f", x[LINK_QUAL + p]);
 }
 
 //=============================================================================
@@ -1423,6 +1424,118 @@ void  report_LinkHeader(char *id)
 }
 
 
+//=============================================================================
+
+void report_TimeSeries(int type, void (*writeHeader)(char *id),
+                       void (*writeResults)(REAL4* x))
+//
+//  Input:   type = SUBCATCH, NODE or LINK
+//           writeHeader = function that writes an object's table headings
+//           writeResults = function that writes a row of an object's results
+//  Output:  none
+//  Purpose: writes a table of results over all reporting periods for each
+//           selected object of a given type to report file.
+//
+//  The results of as many objects as fit in MAX_BATCH_BYTES are read from
+//  the binary output file in a single pass. An object whose results don't
+//  fit on their own is read over as many periods at a time as do fit.
+//
+{
+    int       j, k, i, count, maxCount;
+    int       nVars = output_getResultCount(type);
+    long      period, nPeriods, maxPeriods;
+    int*      objects;
+    char*     id;
+    DateTime* days;
+    REAL4*    x;
+    char      theDate[DATE_STR_SIZE];
+    char      theTime[TIME_STR_SIZE];
+
+    // --- size batches of objects & periods to fit within MAX_BATCH_BYTES
+    maxPeriods = (long)MAX(1, MAX_BATCH_BYTES / (nVars * sizeof(REAL4)));
+    maxPeriods = MIN(maxPeriods, MAX(Nperiods, 1));
+    maxCount = (int)MAX(1, MAX_BATCH_BYTES /
+                           ((double)maxPeriods * nVars * sizeof(REAL4)));
+    maxCount = MIN(maxCount, Nobjects[type]);
+    objects = (int *)calloc(maxCount, sizeof(int));
+    days = (DateTime *)calloc(maxPeriods, sizeof(DateTime));
+    x = (REAL4 *)calloc((size_t)maxCount * maxPeriods * nVars, sizeof(REAL4));
+    if ( objects == NULL || days == NULL || x == NULL )
+    {
+        report_writeErrorMsg(ERR_MEMORY, "");
+        FREE(objects);
+        FREE(days);
+        FREE(x);
+        return;
+    }
+
+    for (j = 0; j < Nobjects[type]; )
+    {
+        // --- collect the next batch of selected objects (whose indexes
+        //     in the output file are consecutive)
+        for (count = 0; j < Nobjects[type] && count < maxCount; j++)
+        {
+            if ( report_GetRptFlag(type, j, &id) ) objects[count++] = j;
+        }
+        if ( count == 0 ) break;
+
+        // --- read the batch's results over as many periods as fit
+        //     (all of them unless the batch holds a single object)
+        period = 1;
+        do
+        {
+            nPeriods = MIN(maxPeriods, Nperiods - period + 1);
+            if ( !output_readBatch(type,
+                     report_GetRptFlag(type, objects[0], &id) - 1, count,
+                     period, nPeriods, days, x) )
+            {
+                report_writeErrorMsg(ERR_OUT_READ, "");
+                j = Nobjects[type];
+                break;
+            }
+
+            // --- write each object's rows for these periods
+            for (k = 0; k < count; k++)
+            {
+                report_GetRptFlag(type, objects[k], &id);
+                if ( period == 1 ) writeHeader(id);
+                for (i = 0; i < nPeriods; i++)
+                {
+                    datetime_dateToStr(days[i], theDate);
+                    datetime_timeToStr(days[i], theTime);
+                    fprintf(Frpt.file, "\n  %11s %8s", theDate, theTime);
+                    writeResults(x + ((size_t)i * count + k) * nVars);
+                }
+                if ( period + nPeriods > Nperiods ) WRITE("");
+            }
+        } while ( (period += nPeriods) <= Nperiods );
+    }
+    FREE(objects);
+    FREE(days);
+    FREE(x);
+}
+
+//=============================================================================
+
+int report_GetRptFlag(int type, int j, char** id)
+//
+//  Input:   type = SUBCATCH, NODE or LINK
+//           j = object index
+//  Output:  id = object's ID name
+//           returns object's reporting flag (its index in the binary
+//           output file plus 1, or 0 if it isn't reported)
+//  Purpose: retrieves the reporting flag & ID name of an object.
+//
+{
+    switch ( type )
+    {
+      case SUBCATCH: *id = Subcatch[j].ID; return Subcatch[j].rptFlag;
+      case NODE:     *id = Node[j].ID;     return Node[j].rptFlag;
+      case LINK:     *id = Link[j].ID;     return Link[j].rptFlag;
+      default:       *id = NULL;           return 0;
+    }
+}
+
 //=============================================================================
 //      ERROR REPORTING
 //=============================================================================
@@ -37,6 +37,9 @@
 //   Build 5.2.0:
 //   - Support added for street flow capture and sewer backflow thru inlets.
 //   - Shell sort replaces insertion sort for sorting Event array.
+//   Build 5.2.4+:
+//   - Time spent on quality routing, control rules & statistics and the
+//     number of flow routing trials added to the run time profile.
 //-----------------------------------------------------------------------------
 #define _CRT_SECURE_NO_DEPRECATE
 
@@ -46,13 +49,14 @@
 #include <math.h>
 #include "headers.h"
 #include "lid.h"
+#include "profile.h"
 //-----------------------------------------------------------------------------
 // Shared variables
 //-----------------------------------------------------------------------------
-static int* SortedLinks;
-static int  NextEvent;
-static int  BetweenEvents;
-static double NewRuleTime;
+static THREADLOCAL int* SortedLinks;
+static THREADLOCAL int  NextEvent;
+static THREADLOCAL int  BetweenEvents;
+static THREADLOCAL double NewRuleTime;
 
 //-----------------------------------------------------------------------------
 //  External functions (declared in funcs.h)
@@ -210,6 +214,7 @@ void routing_execute(int routingModel, double routingStep)
 {
     int      trialsCount = 1;          // trials required to solve flow routing
     int      actionCount = 0;          // number of control actions taken
+    int      phase;                    // run time profile phase
     int      inSteadyState = TRUE;     // system is in steady state
     DateTime currentDate;              // date at start of routing step
     double   stepFlowError;            // 1 - (system outflow) / (system inflow)
@@ -239,13 +244,18 @@ void routing_execute(int routingModel, double routingStep)
         // --- route flows if system is not in steady state
         inSteadyState = isInSteadyState(actionCount, stepFlowError);
         if (inSteadyState == FALSE)
+        {
             trialsCount = routeFlow(routingModel, routingStep);
+            profile_addCount(PROFILE_TRIALS, trialsCount);
+        }
 
         // --- route water quality constituents
         if (Nobjects[POLLUT] > 0 && !IgnoreQuality)
         {
+            phase = profile_setPhase(PROFILE_QUALITY);
             inlet_adjustQualInflows();
             qualrout_execute(routingStep);
+            profile_setPhase(phase);
         }
 
         // --- update mass balance totals for flows leaving the system
@@ -255,8 +265,10 @@ void routing_execute(int routingModel, double routingStep)
         // --- update time step & flow routing statistics
         if (Nobjects[LINK] > 0)
         {
+            phase = profile_setPhase(PROFILE_STATS);
             stats_updateFlowStats(routingStep, getDateTime(NewRoutingTime));
             stats_updateTimeStepStats(routingStep, trialsCount, inSteadyState);
+            profile_setPhase(phase);
         }
     }
 
@@ -270,6 +282,7 @@ void routing_execute(int routingModel, double routingStep)
 {
     int j;
     int actionCount = 0;
+    int phase;
 
     // --- find new link target settings that are not related to
     // --- control rules (e.g., pump on/off depth limits)
@@ -278,8 +291,10 @@ void routing_execute(int routingModel, double routingStep)
     // --- evaluate control rules if next evaluation time reached
     if (RuleStep == 0 || fabs(NewRoutingTime - NewRuleTime) < 1.0)
     {  
+        phase = profile_setPhase(PROFILE_CONTROLS);
         controls_evaluate(currentDate, currentDate - StartDateTime,
             routingStep / SECperDAY);
+        profile_setPhase(phase);
     }
 
     // --- change each link's actual setting if it differs from its target
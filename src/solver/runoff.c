@@ -30,6 +30,9 @@
 //   - Support added for saving rainfall amounts in previous 48 hours.
 //   Build 5.2.2:
 //   - Fixed possible use of canSweep in runoff_execute() with no assigned value. 
+//   Build 5.2.4+:
+//   - OpenMP used to compute runoff & washoff of subcatchments in parallel.
+//   - Counts made by worker threads merged into the run time profile.
 //-----------------------------------------------------------------------------
 #define _CRT_SECURE_NO_DEPRECATE
 
@@ -38,28 +41,36 @@
 #include <stdlib.h>
 #include "headers.h"
 #include "odesolve.h"
+#include "profile.h"
+
+// Protect against lack of compiler support for OpenMP
+#if defined(_OPENMP)
+  #include <omp.h>
+#endif
 
 //-----------------------------------------------------------------------------
 // Shared variables
 //-----------------------------------------------------------------------------
-static char  IsRaining;                // TRUE if precip. falls on study area
-static char  HasRunoff;                // TRUE if study area generates runoff
-static char  HasSnow;                  // TRUE if any snow cover on study area
-static int   Nsteps;                   // number of runoff time steps taken
-static int   MaxSteps;                 // final number of runoff time steps
-static long  MaxStepsPos;              // position in Runoff interface file
-                                       //    where MaxSteps is saved
+static THREADLOCAL char  IsRaining;                // TRUE if precip. falls on study area
+static THREADLOCAL char  HasRunoff;                // TRUE if study area generates runoff
+static THREADLOCAL char  HasSnow;                  // TRUE if any snow cover on study area
+static THREADLOCAL int   Nsteps;                   // number of runoff time steps taken
+static THREADLOCAL int   MaxSteps;                 // final number of runoff time steps
+static THREADLOCAL long  MaxStepsPos;              // position in Runoff interface file
+                                                   //    where MaxSteps is saved
+static THREADLOCAL int   RunoffThreads;            // number of threads used for subcatchments
+static THREADLOCAL double* OutflowLoads;           // OutflowLoad arrays for all threads
 
 //-----------------------------------------------------------------------------
 //  Exportable variables 
 //-----------------------------------------------------------------------------
-char    HasWetLids;  // TRUE if any LIDs are wet (used in lidproc.c)
-double* OutflowLoad; // exported pollutant mass load (used in surfqual.c)
+THREADLOCAL char    HasWetLids;  // TRUE if any LIDs are wet (used in lidproc.c)
+WORKERLOCAL double* OutflowLoad; // exported pollutant mass load (used in surfqual.c)
 
 //-----------------------------------------------------------------------------
 //  Imported variables
 //-----------------------------------------------------------------------------
-extern float* SubcatchResults;         // Results vector defined in OUTPUT.C
+extern THREADLOCAL float* SubcatchResults;         // Results vector defined in OUTPUT.C
 
 //-----------------------------------------------------------------------------
 //  External functions (declared in funcs.h)
@@ -76,6 +87,10 @@ static void   runoff_initFile(void);
 static void   runoff_readFromFile(void);
 static void   runoff_saveToFile(float tStep);
 static void   runoff_getOutfallRunon(double tStep);
+static double runoff_getSubcatchRunoff(int j, double tStep, DateTime currentDate,
+              char canSweep);
+static void   runoff_getParallelRunoff(double tStep, DateTime currentDate,
+              char canSweep);
 
 //=============================================================================
 
@@ -94,12 +109,20 @@ int runoff_open()
     // --- open the Ordinary Differential Equation solver
     if ( !odesolve_open(MAXODES) ) report_writeErrorMsg(ERR_ODE_SOLVER, "");
 
-    // --- allocate memory for pollutant runoff loads
+    // --- analyze subcatchments with the number of threads requested for
+    //     the project, but only if there are enough subcatchments
+    RunoffThreads = MAX(NumThreads, 1);
+    if ( Nobjects[SUBCATCH] < 4 * RunoffThreads ) RunoffThreads = 1;
+
+    // --- allocate memory for pollutant runoff loads (one array per thread)
+    OutflowLoads = NULL;
     OutflowLoad = NULL;
     if ( Nobjects[POLLUT] > 0 )
     {
-        OutflowLoad = (double *) calloc(Nobjects[POLLUT], sizeof(double));
-        if ( !OutflowLoad ) report_writeErrorMsg(ERR_MEMORY, "");
+        OutflowLoads = (double *) calloc(RunoffThreads * Nobjects[POLLUT],
+                                         sizeof(double));
+        if ( !OutflowLoads ) report_writeErrorMsg(ERR_MEMORY, "");
+        OutflowLoad = OutflowLoads;
     }
 
     // --- see if a runoff interface file should be opened
@@ -132,7 +155,8 @@ void runoff_close()
     odesolve_close();
 
     // --- free memory for pollutant runoff loads
-    FREE(OutflowLoad);
+    FREE(OutflowLoads);
+    OutflowLoad = NULL;
 
     // --- close runoff interface file if in use
     if ( Frunoff.file )
@@ -254,30 +278,23 @@ void runoff_execute()
     HasSnow = FALSE;
     HasRunoff = FALSE;
     HasWetLids = FALSE;
-    for (j = 0; j < Nobjects[SUBCATCH]; j++)
+    if ( RunoffThreads > 1 )
     {
-        // --- find total runoff rate (in ft/sec) over the subcatchment
-        //     (the amount that actually leaves the subcatchment (in cfs)
-        //     is also computed and is stored in Subcatch[j].newRunoff)
-        if ( Subcatch[j].area == 0.0 ) continue;
-        runoff = subcatch_getRunoff(j, runoffStep);
-
-        // --- update state of study area surfaces
-        if ( runoff > 0.0 ) HasRunoff = TRUE;
-        if ( Subcatch[j].newSnowDepth > 0.0 ) HasSnow = TRUE;
-
-        // --- skip pollutant buildup/washoff if quality ignored
-        if ( IgnoreQuality ) continue;
-
-        // --- add to pollutant buildup if runoff is negligible
-        if ( runoff < MIN_RUNOFF ) surfqual_getBuildup(j, runoffStep); 
-
-        // --- reduce buildup by street sweeping
-        if ( canSweep && Subcatch[j].rainfall <= MIN_RUNOFF)
-            surfqual_sweepBuildup(j, currentDate);
+        runoff_getParallelRunoff(runoffStep, currentDate, canSweep);
+    }
+    else
+    {
+        OutflowLoad = OutflowLoads;
+        for (j = 0; j < Nobjects[SUBCATCH]; j++)
+        {
+            if ( Subcatch[j].area == 0.0 ) continue;
+            runoff = runoff_getSubcatchRunoff(j, runoffStep, currentDate,
+                                              canSweep);
 
-        // --- compute pollutant washoff 
-        surfqual_getWashoff(j, runoff, runoffStep);
+            // --- update state of study area surfaces
+            if ( runoff > 0.0 ) HasRunoff = TRUE;
+            if ( Subcatch[j].newSnowDepth > 0.0 ) HasSnow = TRUE;
+        }
     }
 
     // --- update tracking of system-wide max. runoff rate
@@ -296,6 +313,97 @@ void runoff_execute()
 
 //=============================================================================
 
+double runoff_getSubcatchRunoff(int j, double tStep, DateTime currentDate,
+                                char canSweep)
+//
+//  Input:   j = subcatchment index
+//           tStep = runoff time step (sec)
+//           currentDate = current date/time
+//           canSweep = TRUE if street sweeping can occur
+//  Output:  returns total runoff generated by the subcatchment
+//  Purpose: computes runoff and pollutant buildup/washoff for a subcatchment.
+//
+{
+    double runoff;
+
+    // --- find total runoff rate (in ft/sec) over the subcatchment
+    //     (the amount that actually leaves the subcatchment (in cfs)
+    //     is also computed and is stored in Subcatch[j].newRunoff)
+    runoff = subcatch_getRunoff(j, tStep);
+
+    // --- skip pollutant buildup/washoff if quality ignored
+    if ( IgnoreQuality ) return runoff;
+
+    // --- add to pollutant buildup if runoff is negligible
+    if ( runoff < MIN_RUNOFF ) surfqual_getBuildup(j, tStep); 
+
+    // --- reduce buildup by street sweeping
+    if ( canSweep && Subcatch[j].rainfall <= MIN_RUNOFF)
+        surfqual_sweepBuildup(j, currentDate);
+
+    // --- compute pollutant washoff 
+    surfqual_getWashoff(j, runoff, tStep);
+    return runoff;
+}
+
+//=============================================================================
+
+void runoff_getParallelRunoff(double tStep, DateTime currentDate,
+                              char canSweep)
+//
+//  Input:   tStep = runoff time step (sec)
+//           currentDate = current date/time
+//           canSweep = TRUE if street sweeping can occur
+//  Output:  none
+//  Purpose: computes runoff and pollutant buildup/washoff for all
+//           subcatchments using several threads.
+//
+//  Note: each thread works on its own block of subcatchments and adds its
+//        share of the system mass balance totals to a set of partial sums
+//        that are merged in thread order once all threads are done.
+//
+{
+#ifdef _OPENMP
+    int    j;
+    int    lastJ = -1;
+    int    hasRunoff = FALSE;
+    int    hasSnow = FALSE;
+
+    #pragma omp parallel num_threads(RunoffThreads)
+    {
+        int    t = omp_get_thread_num();
+        double runoff;
+
+        // --- give thread its own pollutant load array & mass balance totals
+        if ( OutflowLoads ) OutflowLoad = OutflowLoads + t * Nobjects[POLLUT];
+        massbal_beginPartialTotals(t);
+
+        #pragma omp for schedule(static) reduction(|:hasRunoff,hasSnow)
+        for (j = 0; j < Nobjects[SUBCATCH]; j++)
+        {
+            if ( Subcatch[j].area == 0.0 ) continue;
+            runoff = runoff_getSubcatchRunoff(j, tStep, currentDate, canSweep);
+            if ( runoff > 0.0 ) hasRunoff = TRUE;
+            if ( Subcatch[j].newSnowDepth > 0.0 ) hasSnow = TRUE;
+        }
+        massbal_endPartialTotals();
+        profile_mergeCounts();
+    }
+    massbal_mergePartialTotals();
+    OutflowLoad = OutflowLoads;
+    HasRunoff = (char)hasRunoff;
+    HasSnow = (char)hasSnow;
+
+    // --- leave the infiltration adjustment factor at the value it has
+    //     after a serial pass (it also applies to storage exfiltration)
+    for (j = 0; j < Nobjects[SUBCATCH]; j++)
+        if ( Subcatch[j].area > 0.0 ) lastJ = j;
+    if ( lastJ >= 0 ) infil_setInfilFactor(lastJ);
+#endif
+}
+
+//=============================================================================
+
 double runoff_getTimeStep(DateTime currentDate)
 //
 //  Input:   currentDate = current simulation date/time
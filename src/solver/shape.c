@@ -16,8 +16,8 @@
 //-----------------------------------------------------------------------------
 //  Shared variables
 //-----------------------------------------------------------------------------
-static double Atotal;
-static double Ptotal;
+static THREADLOCAL double Atotal;
+static THREADLOCAL double Ptotal;
 
 //-----------------------------------------------------------------------------
 //  External functions (declared in funcs.h)
@@ -0,0 +1,1267 @@
+//-----------------------------------------------------------------------------
+//   snapshot.c
+//
+//   Project:  EPA SWMM5
+//   Version:  5.2
+//   Date:     10/16/26 (Build 5.2.4+)
+//
+//   Binary snapshots of a validated project.
+//
+//   A snapshot file saves a project's data as they exist after its input
+//   file was read and validated, so that the project can later be re-opened
+//   without parsing its input file again. The file begins with a header
+//   that records the engine version, the sizes of the objects it contains
+//   and a hash of the input file's contents, and is only used when all of
+//   these match the project being opened.
+//
+//   Object arrays are saved as they are laid out in memory, followed by
+//   the data their pointer members refer to, so a snapshot can only be
+//   read by the same build of the engine that wrote it. SNAPSHOT_VERSION
+//   must be increased whenever the contents of a snapshot change.
+//
+//   Projects with control rules, LID controls, street inlets, treatment
+//   functions or user-supplied groundwater flow expressions are not saved
+//   to snapshots; they are always read from their input file.
+//-----------------------------------------------------------------------------
+#define _CRT_SECURE_NO_DEPRECATE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include "headers.h"
+#include "infil.h"
+#include "exfil.h"
+#include "version.h"
+
+#if defined(_OPENMP)
+  #include <omp.h>
+#endif
+
+#define SNAPSHOT_VERSION 6             // version of snapshot file contents
+#define SNAPSHOT_BUFFER  1048576       // size of snapshot file buffer (bytes)
+#define FNV_OFFSET       14695981039346656037ULL
+#define FNV_PRIME        1099511628211ULL
+
+static const char SnapshotMagic[8] = {'S','W','M','M','S','N','A','P'};
+
+#define INT4  int
+typedef unsigned long long THash;
+
+//-----------------------------------------------------------------------------
+//  Shared variables
+//-----------------------------------------------------------------------------
+static THREADLOCAL FILE* Fsnap;        // snapshot file being read or written
+static THREADLOCAL int   Saving;       // TRUE if writing a snapshot
+static THREADLOCAL int   Failed;       // TRUE if a read or write failed
+
+//-----------------------------------------------------------------------------
+//  External functions (declared in funcs.h)
+//-----------------------------------------------------------------------------
+//  snapshot_save         (called from openProject in swmm5.c)
+//  snapshot_open         (called from project_readSnapshot in project.c)
+//  snapshot_readCounts   (called from project_readSnapshot in project.c)
+//  snapshot_readObjects  (called from project_readSnapshot in project.c)
+//  snapshot_close        (called from project_readSnapshot in project.c)
+
+//-----------------------------------------------------------------------------
+//  Local functions
+//-----------------------------------------------------------------------------
+static int    isSupported(void);
+static void   getInputKey(THash key[3]);
+static void   getBuildKey(INT4 key[2]);
+static void   transfer(void* data, size_t size);
+static void   transferHeader(THash inpKey[3], INT4 buildKey[2]);
+static int    hasEndMarker(void);
+static void   transferCounts(void);
+static void   transferOptions(void);
+static void   writeReportText(long rptStart);
+static char*  readReportText(long* len);
+static char** getIDField(int type, int i);
+static void   writeString(char* s);
+static char*  readString(void);
+static int    isNamed(int type);
+static void   writeIDs(void);
+static void   readIDs(void);
+static void   transferNamed(char* a, int n, size_t size, size_t idOffset);
+static void   transferArrays(void);
+static void   transferInfil(void);
+static void   writeTable(TTable* table);
+static void   readTable(TTable* table);
+static void   writeSubcatch(int j);
+static void   readSubcatch(int j);
+static void   writeNode(int j);
+static void   readNode(int j);
+static void   writeLink(int j);
+static void   readLink(int j);
+static void   writeLanduse(int j);
+static void   readLanduse(int j);
+static void   writeOutfall(int k);
+static void   readOutfall(int k);
+static void   writeStorage(int k);
+static void   readStorage(int k);
+static void   reopenFiles(void);
+
+//=============================================================================
+
+int snapshot_save(const char* f, long rptStart)
+//
+//  Input:   f = name of snapshot file
+//           rptStart = position in report file where the project's
+//                      title begins
+//  Output:  returns TRUE if the snapshot file was written
+//  Purpose: saves a project's validated data to a snapshot file.
+//
+{
+    THash inpKey[3];
+    INT4  buildKey[2];
+    int   j;
+    char  end = 1;
+
+    // --- check that project can be saved
+    if ( ErrorCode || !isSupported() ) return FALSE;
+    getInputKey(inpKey);
+    getBuildKey(buildKey);
+
+    // --- open snapshot file
+    Fsnap = fopen(f, "wb");
+    if ( Fsnap == NULL ) return FALSE;
+    setvbuf(Fsnap, NULL, _IOFBF, SNAPSHOT_BUFFER);
+    Saving = TRUE;
+    Failed = FALSE;
+
+    // --- write header, options & ID names
+    transferHeader(inpKey, buildKey);
+    transferCounts();
+    transferOptions();
+    writeIDs();
+
+    // --- write each category of object
+    transferArrays();
+    for (j = 0; j < Nobjects[SUBCATCH]; j++) writeSubcatch(j);
+    transferInfil();
+    for (j = 0; j < Nobjects[NODE]; j++) writeNode(j);
+    for (j = 0; j < Nnodes[OUTFALL]; j++) writeOutfall(j);
+    for (j = 0; j < Nnodes[STORAGE]; j++) writeStorage(j);
+    for (j = 0; j < Nobjects[LINK]; j++) writeLink(j);
+    for (j = 0; j < Nobjects[LANDUSE]; j++) writeLanduse(j);
+    for (j = 0; j < Nobjects[CURVE]; j++) writeTable(&Curve[j]);
+    for (j = 0; j < Nobjects[TSERIES]; j++) writeTable(&Tseries[j]);
+
+    // --- write text written to report file while reading the project
+    //     followed by an end marker
+    writeReportText(rptStart);
+    transfer(&end, 1);
+
+    // --- delete an incomplete snapshot file
+    if ( fclose(Fsnap) != 0 ) Failed = TRUE;
+    Fsnap = NULL;
+    if ( Failed ) remove(f);
+    return !Failed;
+}
+
+//=============================================================================
+
+int snapshot_open(const char* f)
+//
+//  Input:   f = name of snapshot file
+//  Output:  returns TRUE if the snapshot file can be used
+//  Purpose: opens a snapshot file and checks that it was written by this
+//           build of the engine for the current contents of the input file.
+//
+{
+    THash inpKey[3], snapInpKey[3];
+    INT4  buildKey[2], snapBuildKey[2];
+
+    Fsnap = fopen(f, "rb");
+    if ( Fsnap == NULL ) return FALSE;
+    setvbuf(Fsnap, NULL, _IOFBF, SNAPSHOT_BUFFER);
+    Saving = FALSE;
+    Failed = FALSE;
+
+    // --- compare snapshot's header with that of the current project
+    //     and check that the snapshot was written completely
+    transferHeader(snapInpKey, snapBuildKey);
+    if ( !Failed && hasEndMarker() )
+    {
+        getBuildKey(buildKey);
+        getInputKey(inpKey);
+        if ( memcmp(buildKey, snapBuildKey, sizeof(buildKey)) == 0 &&
+             memcmp(inpKey, snapInpKey, sizeof(inpKey)) == 0 ) return TRUE;
+    }
+    snapshot_close();
+    return FALSE;
+}
+
+//=============================================================================
+
+int snapshot_readCounts()
+//
+//  Input:   none
+//  Output:  returns TRUE if successful
+//  Purpose: reads the number of each type of object from a snapshot file.
+//
+{
+    transferCounts();
+    if ( !Failed ) return TRUE;
+    memset(Nobjects, 0, sizeof(Nobjects));
+    memset(Nnodes, 0, sizeof(Nnodes));
+    memset(Nlinks, 0, sizeof(Nlinks));
+    NumEvents = 0;
+    return FALSE;
+}
+
+//=============================================================================
+
+int snapshot_readObjects()
+//
+//  Input:   none
+//  Output:  returns TRUE if successful
+//  Purpose: reads a project's options and objects from a snapshot file
+//           into the objects created for them.
+//
+{
+    int   j;
+    long  len;
+    char* text;
+    char  end = 0;
+
+    // --- read options & ID names
+    transferOptions();
+    readIDs();
+
+    // --- read each category of object
+    transferArrays();
+    for (j = 0; j < Nobjects[SUBCATCH]; j++) readSubcatch(j);
+    transferInfil();
+    for (j = 0; j < Nobjects[NODE]; j++) readNode(j);
+    for (j = 0; j < Nnodes[OUTFALL]; j++) readOutfall(j);
+    for (j = 0; j < Nnodes[STORAGE]; j++) readStorage(j);
+    for (j = 0; j < Nobjects[LINK]; j++) readLink(j);
+    for (j = 0; j < Nobjects[LANDUSE]; j++) readLanduse(j);
+    for (j = 0; j < Nobjects[CURVE]; j++) readTable(&Curve[j]);
+    for (j = 0; j < Nobjects[TSERIES]; j++) readTable(&Tseries[j]);
+
+    // --- check for end marker before copying saved report text to the
+    //     report file
+    text = readReportText(&len);
+    transfer(&end, 1);
+    if ( Failed || end != 1 )
+    {
+        FREE(text);
+        return FALSE;
+    }
+    if ( text ) fwrite(text, 1, len, Frpt.file);
+    FREE(text);
+
+    // --- re-open external files that were opened when validating
+    reopenFiles();
+    return TRUE;
+}
+
+//=============================================================================
+
+void snapshot_close()
+//
+//  Input:   none
+//  Output:  none
+//  Purpose: closes a snapshot file.
+//
+{
+    if ( Fsnap ) fclose(Fsnap);
+    Fsnap = NULL;
+}
+
+//=============================================================================
+
+int isSupported()
+//
+//  Input:   none
+//  Output:  returns TRUE if project's data can be saved to a snapshot
+//  Purpose: checks that a project has no objects whose data are held in
+//           linked structures that snapshots do not save.
+//
+{
+    int j, type;
+
+    if ( Nobjects[CONTROL] > 0 || Nobjects[LID] > 0 || Nobjects[INLET] > 0 )
+        return FALSE;
+    for (j = 0; j < Nobjects[SUBCATCH]; j++)
+    {
+        if ( Subcatch[j].gwLatFlowExpr || Subcatch[j].gwDeepFlowExpr )
+            return FALSE;
+    }
+    for (j = 0; j < Nobjects[NODE]; j++)
+    {
+        if ( Node[j].treatment ) return FALSE;
+    }
+
+    // --- every named object must have its ID assigned
+    for (type = 0; type < MAX_OBJ_TYPES; type++)
+    {
+        if ( !isNamed(type) ) continue;
+        for (j = 0; j < Nobjects[type]; j++)
+        {
+            if ( *getIDField(type, j) == NULL ) return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+//=============================================================================
+
+void getInputKey(THash key[3])
+//
+//  Input:   none
+//  Output:  key = size & hash of input file's contents and hash of the
+//                 input file's directory and thread count
+//  Purpose: identifies the input data a snapshot was made from.
+//
+{
+    unsigned char buf[65536];
+    size_t  i, n;
+    THash   h = FNV_OFFSET;
+    THash   size = 0;
+    char*   s;
+    int     nThreads = 1;
+
+    // --- hash contents of input file
+    rewind(Finp.file);
+    while ( (n = fread(buf, 1, sizeof(buf), Finp.file)) > 0 )
+    {
+        for (i = 0; i < n; i++) h = (h ^ buf[i]) * FNV_PRIME;
+        size += n;
+    }
+    key[0] = size;
+    key[1] = h;
+
+    // --- hash the settings that relative file names and the number of
+    //     threads used are resolved with
+#if defined(_OPENMP)
+    nThreads = omp_get_max_threads();
+#endif
+    h = FNV_OFFSET;
+    for (s = InpDir; *s; s++) h = (h ^ (unsigned char)*s) * FNV_PRIME;
+    key[2] = h ^ (THash)nThreads;
+}
+
+//=============================================================================
+
+void getBuildKey(INT4 key[2])
+//
+//  Input:   none
+//  Output:  key = engine & snapshot versions and a hash of object sizes
+//                 and the engine's build ID
+//  Purpose: identifies the build of the engine that writes a snapshot.
+//
+{
+    size_t sizes[] = {sizeof(void*), sizeof(TGage), sizeof(TSubcatch),
+        sizeof(TNode), sizeof(TOutfall), sizeof(TStorage), sizeof(TDivider),
+        sizeof(TLink), sizeof(TConduit), sizeof(TPump), sizeof(TOrifice),
+        sizeof(TWeir), sizeof(TOutlet), sizeof(TPollut), sizeof(TLanduse),
+        sizeof(TPattern), sizeof(TTable), sizeof(TTransect), sizeof(TStreet),
+        sizeof(TShape), sizeof(TAquifer), sizeof(TUnitHyd),
+        sizeof(TSnowmelt), sizeof(TEvent), sizeof(TLandFactor),
+        sizeof(TGroundwater), sizeof(TSnowpack), sizeof(TExtInflow),
+        sizeof(TDwfInflow), sizeof(TRdiiInflow), sizeof(TBuildup),
+        sizeof(TWashoff), sizeof(TExfil), sizeof(TGrnAmpt), sizeof(TTemp),
+        sizeof(TEvap), sizeof(TWind), sizeof(TSnow), sizeof(TAdjust),
+        sizeof(TRptFlags)};
+    char*  s;
+    size_t i;
+    INT4   h = 0;
+
+    for (i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+    {
+        h = 31 * h + (INT4)sizes[i];
+    }
+    for (s = BUILD_ID; *s; s++) h = 31 * h + *s;
+    key[0] = 100 * (10000 * VERSION_MAJOR + 1000 * VERSION_MINOR +
+             VERSION_PATCH) + SNAPSHOT_VERSION;
+    key[1] = h;
+}
+
+//=============================================================================
+
+void transfer(void* data, size_t size)
+//
+//  Input:   data = pointer to data
+//           size = number of bytes of data
+//  Output:  none
+//  Purpose: writes data to or reads data from the snapshot file.
+//
+{
+    size_t n;
+    if ( size == 0 ) return;
+    if ( Saving ) n = fwrite(data, 1, size, Fsnap);
+    else if ( Failed ) n = 0;
+    else n = fread(data, 1, size, Fsnap);
+    if ( n < size )
+    {
+        Failed = TRUE;
+        if ( !Saving ) memset(data, 0, size);
+    }
+}
+
+//=============================================================================
+
+void transferHeader(THash inpKey[3], INT4 buildKey[2])
+//
+//  Input:   inpKey = key of input file contents
+//           buildKey = key of engine build
+//  Output:  none
+//  Purpose: writes or reads a snapshot file's header.
+//
+{
+    char magic[sizeof(SnapshotMagic)];
+
+    memcpy(magic, SnapshotMagic, sizeof(magic));
+    transfer(magic, sizeof(magic));
+    if ( memcmp(magic, SnapshotMagic, sizeof(magic)) != 0 ) Failed = TRUE;
+    transfer(buildKey, 2 * sizeof(INT4));
+    transfer(inpKey, 3 * sizeof(THash));
+}
+
+//=============================================================================
+
+int hasEndMarker()
+//
+//  Input:   none
+//  Output:  returns TRUE if the snapshot file ends with an end marker
+//  Purpose: checks that a snapshot file being read was written completely,
+//           so that a project's options are not replaced by those of an
+//           incomplete snapshot.
+//
+{
+    long pos = ftell(Fsnap);
+    char end = 0;
+
+    if ( fseek(Fsnap, -1L, SEEK_END) != 0 ) return FALSE;
+    transfer(&end, 1);
+    if ( fseek(Fsnap, pos, SEEK_SET) != 0 ) Failed = TRUE;
+    return !Failed && end == 1;
+}
+
+//=============================================================================
+
+void transferCounts()
+//
+//  Input:   none
+//  Output:  none
+//  Purpose: writes or reads the number of each type of object.
+//
+{
+    transfer(Nobjects, sizeof(Nobjects));
+    transfer(Nnodes, sizeof(Nnodes));
+    transfer(Nlinks, sizeof(Nlinks));
+    transfer(&NumEvents, sizeof(NumEvents));
+}
+
+//=============================================================================
+
+void transferOptions()
+//
+//  Input:   none
+//  Output:  none
+//  Purpose: writes or reads a project's options & other global variables.
+//
+{
+    TFile* files[] = {&Fclimate, &Frain, &Frunoff, &Frdii, &Fhotstart1,
+                      &Fhotstart2, &Finflows, &Foutflows};
+    size_t i;
+
+    // --- interface file names & usage
+    for (i = 0; i < sizeof(files) / sizeof(files[0]); i++)
+    {
+        transfer(files[i]->name, sizeof(files[i]->name));
+        transfer(&files[i]->mode, sizeof(files[i]->mode));
+    }
+
+    // --- title, reporting & analysis options
+    transfer(Title, sizeof(Title));
+    transfer(TempDir, sizeof(TempDir));
+    transfer(ProfileFile, sizeof(ProfileFile));
+    transfer(&RptFlags, sizeof(RptFlags));
+    transfer(&UnitSystem, sizeof(UnitSystem));
+    transfer(&FlowUnits, sizeof(FlowUnits));
+    transfer(&InfilModel, sizeof(InfilModel));
+    transfer(&RouteModel, sizeof(RouteModel));
+    transfer(&ForceMainEqn, sizeof(ForceMainEqn));
+    transfer(&LinkOffsets, sizeof(LinkOffsets));
+    transfer(&SurchargeMethod, sizeof(SurchargeMethod));
+    transfer(&DynwaveSolver, sizeof(DynwaveSolver));
+    transfer(&OutputLayout, sizeof(OutputLayout));
+    transfer(&AllowPonding, sizeof(AllowPonding));
+    transfer(&InertDamping, sizeof(InertDamping));
+    transfer(&NormalFlowLtd, sizeof(NormalFlowLtd));
+    transfer(&SlopeWeighting, sizeof(SlopeWeighting));
+    transfer(&Compatibility, sizeof(Compatibility));
+    transfer(&SkipSteadyState, sizeof(SkipSteadyState));
+    transfer(&ActiveSet, sizeof(ActiveSet));
+    transfer(&LocalStepClasses, sizeof(LocalStepClasses));
+    transfer(&NetworkOrdering, sizeof(NetworkOrdering));
+    transfer(&IgnoreRainfall, sizeof(IgnoreRainfall));
+    transfer(&IgnoreRDII, sizeof(IgnoreRDII));
+    transfer(&IgnoreSnowmelt, sizeof(IgnoreSnowmelt));
+    transfer(&IgnoreGwater, sizeof(IgnoreGwater));
+    transfer(&IgnoreRouting, sizeof(IgnoreRouting));
+    transfer(&IgnoreQuality, sizeof(IgnoreQuality));
+    transfer(&Warnings, sizeof(Warnings));
+    transfer(&WetStep, sizeof(WetStep));
+    transfer(&DryStep, sizeof(DryStep));
+    transfer(&ReportStep, sizeof(ReportStep));
+    transfer(&RuleStep, sizeof(RuleStep));
+    transfer(&SweepStart, sizeof(SweepStart));
+    transfer(&SweepEnd, sizeof(SweepEnd));
+    transfer(&MaxTrials, sizeof(MaxTrials));
+    transfer(&NumThreads, sizeof(NumThreads));
+    transfer(&ExtPollutFlag, sizeof(ExtPollutFlag));
+    transfer(&RouteStep, sizeof(RouteStep));
+    transfer(&MinRouteStep, sizeof(MinRouteStep));
+    transfer(&LengtheningStep, sizeof(LengtheningStep));
+    transfer(&StartDryDays, sizeof(StartDryDays));
+    transfer(&CourantFactor, sizeof(CourantFactor));
+    transfer(&MinSurfArea, sizeof(MinSurfArea));
+    transfer(&MinSlope, sizeof(MinSlope));
+    transfer(&HeadTol, sizeof(HeadTol));
+    transfer(&SysFlowTol, sizeof(SysFlowTol));
+    transfer(&LatFlowTol, sizeof(LatFlowTol));
+    transfer(&CrownCutoff, sizeof(CrownCutoff));
+
+    // --- simulation period
+    transfer(&StartDate, sizeof(StartDate));
+    transfer(&StartTime, sizeof(StartTime));
+    transfer(&StartDateTime, sizeof(StartDateTime));
+    transfer(&EndDate, sizeof(EndDate));
+    transfer(&EndTime, sizeof(EndTime));
+    transfer(&EndDateTime, sizeof(EndDateTime));
+    transfer(&ReportStartDate, sizeof(ReportStartDate));
+    transfer(&ReportStartTime, sizeof(ReportStartTime));
+    transfer(&ReportStart, sizeof(ReportStart));
+    transfer(&TotalDuration, sizeof(TotalDuration));
+
+    // --- climate data
+    transfer(&Temp, sizeof(Temp));
+    transfer(&Evap, sizeof(Evap));
+    transfer(&Wind, sizeof(Wind));
+    transfer(&Snow, sizeof(Snow));
+    transfer(&Adjust, sizeof(Adjust));
+}
+
+//=============================================================================
+
+void writeReportText(long rptStart)
+//
+//  Input:   rptStart = position in report file where the project's title
+//                      begins
+//  Output:  none
+//  Purpose: saves the text written to the report file while a project was
+//           read and validated.
+//
+{
+    FILE* f;
+    char* text = NULL;
+    long  len;
+
+    fflush(Frpt.file);
+    len = ftell(Frpt.file) - rptStart;
+    if ( len > 0 )
+    {
+        f = fopen(Frpt.name, "rt");
+        if ( f && fseek(f, rptStart, SEEK_SET) == 0 )
+            text = (char *) malloc(len);
+        if ( text )
+        {
+            len = (long)fread(text, 1, len, f);
+            if ( ferror(f) ) Failed = TRUE;
+        }
+        else Failed = TRUE;
+        if ( f ) fclose(f);
+    }
+    else len = 0;
+    transfer(&len, sizeof(len));
+    transfer(text, len);
+    FREE(text);
+}
+
+//=============================================================================
+
+char* readReportText(long* len)
+//
+//  Input:   none
+//  Output:  len = number of characters of text;
+//           returns the text saved by writeReportText (or NULL)
+//  Purpose: reads the report file text saved in a snapshot.
+//
+{
+    char* text = NULL;
+
+    *len = 0;
+    transfer(len, sizeof(long));
+    if ( Failed || *len <= 0 ) return NULL;
+    text = (char *) malloc(*len);
+    if ( text == NULL ) Failed = TRUE;
+    else transfer(text, *len);
+    return text;
+}
+
+//=============================================================================
+
+char** getIDField(int type, int i)
+//
+//  Input:   type = object type
+//           i = object index
+//  Output:  returns address of object's ID name (or NULL if objects of the
+//           type are not identified by name)
+//  Purpose: locates the ID name of an object.
+//
+{
+    switch ( type )
+    {
+      case GAGE:        return &Gage[i].ID;
+      case SUBCATCH:    return &Subcatch[i].ID;
+      case NODE:        return &Node[i].ID;
+      case LINK:        return &Link[i].ID;
+      case POLLUT:      return &Pollut[i].ID;
+      case LANDUSE:     return &Landuse[i].ID;
+      case TIMEPATTERN: return &Pattern[i].ID;
+      case CURVE:       return &Curve[i].ID;
+      case TSERIES:     return &Tseries[i].ID;
+      case TRANSECT:    return &Transect[i].ID;
+      case AQUIFER:     return &Aquifer[i].ID;
+      case UNITHYD:     return &UnitHyd[i].ID;
+      case SNOWMELT:    return &Snowmelt[i].ID;
+      case STREET:      return &Street[i].ID;
+      default:          return NULL;
+    }
+}
+
+//=============================================================================
+
+void writeString(char* s)
+//
+//  Input:   s = a string
+//  Output:  none
+//  Purpose: writes a string's length and characters to the snapshot file.
+//
+{
+    INT4 len = (INT4)strlen(s);
+    transfer(&len, sizeof(len));
+    transfer(s, len);
+}
+
+//=============================================================================
+
+char* readString()
+//
+//  Input:   none
+//  Output:  returns a string (or NULL if one could not be read)
+//  Purpose: reads a string written by writeString into a buffer that
+//           remains valid until the next call.
+//
+{
+    static THREADLOCAL char s[MAXLINE+1];
+    INT4 len = 0;
+
+    transfer(&len, sizeof(len));
+    if ( len < 0 || len > MAXLINE ) Failed = TRUE;
+    if ( Failed ) return NULL;
+    transfer(s, len);
+    s[len] = '\0';
+    return s;
+}
+
+//=============================================================================
+
+int isNamed(int type)
+//
+//  Input:   type = object type
+//  Output:  returns TRUE if objects of the type have ID names
+//  Purpose: checks if an object type's ID names are saved in snapshots.
+//
+{
+    return type != CONTROL && type != SHAPE && type != LID && type != INLET;
+}
+
+//=============================================================================
+
+void writeIDs()
+//
+//  Input:   none
+//  Output:  none
+//  Purpose: writes the ID names of all named objects.
+//
+{
+    int type, j;
+    for (type = 0; type < MAX_OBJ_TYPES; type++)
+    {
+        if ( !isNamed(type) ) continue;
+        for (j = 0; j < Nobjects[type]; j++)
+        {
+            writeString(*getIDField(type, j));
+        }
+    }
+}
+
+//=============================================================================
+
+void readIDs()
+//
+//  Input:   none
+//  Output:  none
+//  Purpose: adds the ID names of all named objects to the project's hash
+//           tables and assigns them to the objects.
+//
+{
+    int   type, j;
+    char* id;
+
+    for (type = 0; type < MAX_OBJ_TYPES; type++)
+    {
+        if ( !isNamed(type) ) continue;
+        for (j = 0; j < Nobjects[type]; j++)
+        {
+            id = readString();
+            if ( id == NULL ) return;
+            if ( project_addObject(type, id, j) <= 0 )
+            {
+                Failed = TRUE;
+                return;
+            }
+            *getIDField(type, j) = project_findID(type, id);
+        }
+    }
+}
+
+//=============================================================================
+
+void transferNamed(char* a, int n, size_t size, size_t idOffset)
+//
+//  Input:   a = array of objects
+//           n = number of objects
+//           size = size of an object (bytes)
+//           idOffset = offset of object's ID name pointer (bytes)
+//  Output:  none
+//  Purpose: writes or reads an array of objects whose only pointer member
+//           is their ID name, keeping the names assigned to them.
+//
+{
+    int   i;
+    char* id;
+
+    for (i = 0; i < n; i++, a += size)
+    {
+        memcpy(&id, a + idOffset, sizeof(id));
+        transfer(a, size);
+        memcpy(a + idOffset, &id, sizeof(id));
+    }
+}
+
+//=============================================================================
+
+void transferArrays()
+//
+//  Input:   none
+//  Output:  none
+//  Purpose: writes or reads the arrays of objects that have no pointer
+//           members other than their ID names.
+//
+{
+    transferNamed((char *)Gage, Nobjects[GAGE], sizeof(TGage),
+                  offsetof(TGage, ID));
+    transferNamed((char *)Aquifer, Nobjects[AQUIFER], sizeof(TAquifer),
+                  offsetof(TAquifer, ID));
+    transferNamed((char *)UnitHyd, Nobjects[UNITHYD], sizeof(TUnitHyd),
+                  offsetof(TUnitHyd, ID));
+    transferNamed((char *)Snowmelt, Nobjects[SNOWMELT], sizeof(TSnowmelt),
+                  offsetof(TSnowmelt, ID));
+    transferNamed((char *)Pollut, Nobjects[POLLUT], sizeof(TPollut),
+                  offsetof(TPollut, ID));
+    transferNamed((char *)Pattern, Nobjects[TIMEPATTERN], sizeof(TPattern),
+                  offsetof(TPattern, ID));
+    transferNamed((char *)Transect, Nobjects[TRANSECT], sizeof(TTransect),
+                  offsetof(TTransect, ID));
+    transferNamed((char *)Street, Nobjects[STREET], sizeof(TStreet),
+                  offsetof(TStreet, ID));
+    transfer(Divider, Nnodes[DIVIDER] * sizeof(TDivider));
+    transfer(Conduit, Nlinks[CONDUIT] * sizeof(TConduit));
+    transfer(Pump, Nlinks[PUMP] * sizeof(TPump));
+    transfer(Orifice, Nlinks[ORIFICE] * sizeof(TOrifice));
+    transfer(Weir, Nlinks[WEIR] * sizeof(TWeir));
+    transfer(Outlet, Nlinks[OUTLET] * sizeof(TOutlet));
+    transfer(Shape, Nobjects[SHAPE] * sizeof(TShape));
+    transfer(Event, (NumEvents + 1) * sizeof(TEvent));
+}
+
+//=============================================================================
+
+void transferInfil()
+//
+//  Input:   none
+//  Output:  none
+//  Purpose: writes or reads the infiltration objects of all subcatchments.
+//
+{
+    size_t size;
+    char*  data = infil_getData(&size);
+    INT4   n = (INT4)size;
+
+    transfer(&n, sizeof(n));
+    if ( n != (INT4)size ) Failed = TRUE;
+    else transfer(data, size);
+}
+
+//=============================================================================
+
+void writeTable(TTable* table)
+//
+//  Input:   table = a curve or time series
+//  Output:  none
+//  Purpose: writes a curve or time series and its data.
+//
+{
+    char hasVolumes = (table->vData != NULL);
+
+    transfer(table, sizeof(TTable));
+    transfer(table->xData, table->nPoints * sizeof(double));
+    transfer(table->yData, table->nPoints * sizeof(double));
+    transfer(&hasVolumes, 1);
+    if ( hasVolumes ) transfer(table->vData, 2 * table->nPoints * sizeof(double));
+}
+
+//=============================================================================
+
+void readTable(TTable* table)
+//
+//  Input:   table = a curve or time series
+//  Output:  none
+//  Purpose: reads a curve or time series and its data.
+//
+{
+    char* id = table->ID;
+    char  hasVolumes = FALSE;
+    int   n;
+
+    // --- read table, whose data arrays are re-created below
+    transfer(table, sizeof(TTable));
+    n = table->nPoints;
+    table->ID = id;
+    table->nPoints = 0;
+    table->maxPoints = 0;
+    table->xData = NULL;
+    table->yData = NULL;
+    table->vData = NULL;
+    table->v0Data = NULL;
+    table->file.file = NULL;
+    if ( Failed || n < 0 )
+    {
+        Failed = TRUE;
+        return;
+    }
+
+    // --- read data points
+    if ( n > 0 )
+    {
+        table->xData = (double *) malloc(n * sizeof(double));
+        table->yData = (double *) malloc(n * sizeof(double));
+        if ( table->xData == NULL || table->yData == NULL )
+        {
+            Failed = TRUE;
+            return;
+        }
+        table->nPoints = n;
+        table->maxPoints = n;
+        transfer(table->xData, n * sizeof(double));
+        transfer(table->yData, n * sizeof(double));
+    }
+
+    // --- read storage volumes at each data point
+    transfer(&hasVolumes, 1);
+    if ( hasVolumes && n > 0 )
+    {
+        table->vData = (double *) malloc(2 * n * sizeof(double));
+        if ( table->vData == NULL )
+        {
+            Failed = TRUE;
+            return;
+        }
+        table->v0Data = table->vData + n;
+        transfer(table->vData, 2 * n * sizeof(double));
+    }
+}
+
+//=============================================================================
+
+void writeSubcatch(int j)
+//
+//  Input:   j = subcatchment index
+//  Output:  none
+//  Purpose: writes a subcatchment and its pollutant & land use data,
+//           groundwater and snowpack.
+//
+{
+    TSubcatch* sub = &Subcatch[j];
+    char       hasGwater = (sub->groundwater != NULL);
+    char       hasSnow = (sub->snowpack != NULL);
+
+    transfer(sub, sizeof(TSubcatch));
+    transfer(sub->initBuildup, Nobjects[POLLUT] * sizeof(double));
+    transfer(sub->landFactor, Nobjects[LANDUSE] * sizeof(TLandFactor));
+    transfer(&hasGwater, 1);
+    if ( hasGwater ) transfer(sub->groundwater, sizeof(TGroundwater));
+    transfer(&hasSnow, 1);
+    if ( hasSnow ) transfer(sub->snowpack, sizeof(TSnowpack));
+}
+
+//=============================================================================
+
+void readSubcatch(int j)
+//
+//  Input:   j = subcatchment index
+//  Output:  none
+//  Purpose: reads a subcatchment and its pollutant & land use data,
+//           groundwater and snowpack.
+//
+{
+    TSubcatch* sub = &Subcatch[j];
+    TSubcatch  old = *sub;             // holds arrays made for subcatchment
+    char       hasGwater = FALSE;
+    char       hasSnow = FALSE;
+    double*    buildup;
+    int        k;
+
+    // --- read subcatchment, keeping the arrays created for it
+    transfer(sub, sizeof(TSubcatch));
+    sub->ID = old.ID;
+    sub->initBuildup = old.initBuildup;
+    sub->landFactor = old.landFactor;
+    sub->groundwater = NULL;
+    sub->gwLatFlowExpr = NULL;
+    sub->gwDeepFlowExpr = NULL;
+    sub->snowpack = NULL;
+    sub->oldQual = old.oldQual;
+    sub->newQual = old.newQual;
+    sub->pondedQual = old.pondedQual;
+    sub->concPonded = old.concPonded;
+    sub->totalLoad = old.totalLoad;
+    sub->surfaceBuildup = old.surfaceBuildup;
+
+    // --- read initial buildup & land use factors
+    transfer(sub->initBuildup, Nobjects[POLLUT] * sizeof(double));
+    for (k = 0; k < Nobjects[LANDUSE]; k++)
+    {
+        buildup = sub->landFactor[k].buildup;
+        transfer(&sub->landFactor[k], sizeof(TLandFactor));
+        sub->landFactor[k].buildup = buildup;
+    }
+
+    // --- read groundwater & snowpack objects
+    transfer(&hasGwater, 1);
+    if ( hasGwater )
+    {
+        sub->groundwater = (TGroundwater *) malloc(sizeof(TGroundwater));
+        if ( sub->groundwater == NULL ) Failed = TRUE;
+        else transfer(sub->groundwater, sizeof(TGroundwater));
+    }
+    transfer(&hasSnow, 1);
+    if ( hasSnow )
+    {
+        sub->snowpack = (TSnowpack *) malloc(sizeof(TSnowpack));
+        if ( sub->snowpack == NULL ) Failed = TRUE;
+        else transfer(sub->snowpack, sizeof(TSnowpack));
+    }
+}
+
+//=============================================================================
+
+void writeNode(int j)
+//
+//  Input:   j = node index
+//  Output:  none
+//  Purpose: writes a node and its external, dry weather & RDII inflows.
+//
+{
+    TNode*      node = &Node[j];
+    TExtInflow* ext;
+    TDwfInflow* dwf;
+    INT4        n;
+    char        hasRdii = (node->rdiiInflow != NULL);
+
+    transfer(node, sizeof(TNode));
+    n = 0;
+    for (ext = node->extInflow; ext; ext = ext->next) n++;
+    transfer(&n, sizeof(n));
+    for (ext = node->extInflow; ext; ext = ext->next)
+        transfer(ext, sizeof(TExtInflow));
+    n = 0;
+    for (dwf = node->dwfInflow; dwf; dwf = dwf->next) n++;
+    transfer(&n, sizeof(n));
+    for (dwf = node->dwfInflow; dwf; dwf = dwf->next)
+        transfer(dwf, sizeof(TDwfInflow));
+    transfer(&hasRdii, 1);
+    if ( hasRdii ) transfer(node->rdiiInflow, sizeof(TRdiiInflow));
+}
+
+//=============================================================================
+
+void readNode(int j)
+//
+//  Input:   j = node index
+//  Output:  none
+//  Purpose: reads a node and its external, dry weather & RDII inflows.
+//
+{
+    TNode*       node = &Node[j];
+    TNode        old = *node;          // holds arrays made for node
+    TExtInflow*  ext;
+    TExtInflow** lastExt = &node->extInflow;
+    TDwfInflow*  dwf;
+    TDwfInflow** lastDwf = &node->dwfInflow;
+    INT4         i, n;
+    char         hasRdii = FALSE;
+
+    // --- read node, keeping the arrays created for it
+    transfer(node, sizeof(TNode));
+    node->ID = old.ID;
+    node->extPollutFlag = old.extPollutFlag;
+    node->extInflow = NULL;
+    node->dwfInflow = NULL;
+    node->rdiiInflow = NULL;
+    node->treatment = NULL;
+    node->oldQual = old.oldQual;
+    node->newQual = old.newQual;
+    node->extQual = old.extQual;
+    node->inQual = old.inQual;
+    node->reactorQual = old.reactorQual;
+
+    // --- re-create lists of inflows in their original order
+    n = 0;
+    transfer(&n, sizeof(n));
+    for (i = 0; i < n && !Failed; i++)
+    {
+        ext = inflow_createExtInflow();
+        if ( ext == NULL )
+        {
+            Failed = TRUE;
+            return;
+        }
+        transfer(ext, sizeof(TExtInflow));
+        ext->next = NULL;
+        *lastExt = ext;
+        lastExt = &ext->next;
+    }
+    n = 0;
+    transfer(&n, sizeof(n));
+    for (i = 0; i < n && !Failed; i++)
+    {
+        dwf = inflow_createDwfInflow();
+        if ( dwf == NULL )
+        {
+            Failed = TRUE;
+            return;
+        }
+        transfer(dwf, sizeof(TDwfInflow));
+        dwf->next = NULL;
+        *lastDwf = dwf;
+        lastDwf = &dwf->next;
+    }
+
+    // --- read RDII inflow
+    transfer(&hasRdii, 1);
+    if ( hasRdii )
+    {
+        node->rdiiInflow = (TRdiiInflow *) malloc(sizeof(TRdiiInflow));
+        if ( node->rdiiInflow == NULL ) Failed = TRUE;
+        else transfer(node->rdiiInflow, sizeof(TRdiiInflow));
+    }
+}
+
+//=============================================================================
+
+void writeOutfall(int k)
+//
+//  Input:   k = outfall index
+//  Output:  none
+//  Purpose: writes an outfall node's data.
+//
+{
+    char hasLoads = (Outfall[k].wRouted != NULL);
+    transfer(&Outfall[k], sizeof(TOutfall));
+    transfer(&hasLoads, 1);
+}
+
+//=============================================================================
+
+void readOutfall(int k)
+//
+//  Input:   k = outfall index
+//  Output:  none
+//  Purpose: reads an outfall node's data.
+//
+{
+    char hasLoads = FALSE;
+
+    transfer(&Outfall[k], sizeof(TOutfall));
+    Outfall[k].wRouted = NULL;
+    transfer(&hasLoads, 1);
+    if ( hasLoads )
+    {
+        Outfall[k].wRouted = (double *) calloc(Nobjects[POLLUT], sizeof(double));
+        if ( Outfall[k].wRouted == NULL && Nobjects[POLLUT] > 0 ) Failed = TRUE;
+    }
+}
+
+//=============================================================================
+
+void writeStorage(int k)
+//
+//  Input:   k = storage unit index
+//  Output:  none
+//  Purpose: writes a storage unit node's data and exfiltration object.
+//
+{
+    TExfil* exfil = Storage[k].exfil;
+    char    hasExfil = (exfil != NULL);
+
+    transfer(&Storage[k], sizeof(TStorage));
+    transfer(&hasExfil, 1);
+    if ( hasExfil )
+    {
+        transfer(exfil, sizeof(TExfil));
+        transfer(exfil->btmExfil, sizeof(TGrnAmpt));
+        transfer(exfil->bankExfil, sizeof(TGrnAmpt));
+    }
+}
+
+//=============================================================================
+
+void readStorage(int k)
+//
+//  Input:   k = storage unit index
+//  Output:  none
+//  Purpose: reads a storage unit node's data and exfiltration object.
+//
+{
+    TExfil* exfil;
+    char    hasExfil = FALSE;
+
+    transfer(&Storage[k], sizeof(TStorage));
+    Storage[k].exfil = NULL;
+    transfer(&hasExfil, 1);
+    if ( !hasExfil ) return;
+
+    exfil = (TExfil *) malloc(sizeof(TExfil));
+    if ( exfil == NULL )
+    {
+        Failed = TRUE;
+        return;
+    }
+    transfer(exfil, sizeof(TExfil));
+    Storage[k].exfil = exfil;
+    exfil->btmExfil = (TGrnAmpt *) malloc(sizeof(TGrnAmpt));
+    exfil->bankExfil = (TGrnAmpt *) malloc(sizeof(TGrnAmpt));
+    if ( exfil->btmExfil == NULL || exfil->bankExfil == NULL )
+    {
+        Failed = TRUE;
+        return;
+    }
+    transfer(exfil->btmExfil, sizeof(TGrnAmpt));
+    transfer(exfil->bankExfil, sizeof(TGrnAmpt));
+}
+
+//=============================================================================
+
+void writeLink(int j)
+//
+//  Input:   j = link index
+//  Output:  none
+//  Purpose: writes a link's data.
+//
+{
+    transfer(&Link[j], sizeof(TLink));
+}
+
+//=============================================================================
+
+void readLink(int j)
+//
+//  Input:   j = link index
+//  Output:  none
+//  Purpose: reads a link's data.
+//
+{
+    TLink* link = &Link[j];
+    TLink  old = *link;                // holds arrays made for link
+
+    transfer(link, sizeof(TLink));
+    link->ID = old.ID;
+    link->extPollutFlag = old.extPollutFlag;
+    link->inlet = NULL;
+    link->oldQual = old.oldQual;
+    link->newQual = old.newQual;
+    link->totalLoad = old.totalLoad;
+    link->extQual = old.extQual;
+    link->reactorQual = old.reactorQual;
+}
+
+//=============================================================================
+
+void writeLanduse(int j)
+//
+//  Input:   j = land use index
+//  Output:  none
+//  Purpose: writes a land use and its buildup & washoff functions.
+//
+{
+    transfer(&Landuse[j], sizeof(TLanduse));
+    transfer(Landuse[j].buildupFunc, Nobjects[POLLUT] * sizeof(TBuildup));
+    transfer(Landuse[j].washoffFunc, Nobjects[POLLUT] * sizeof(TWashoff));
+}
+
+//=============================================================================
+
+void readLanduse(int j)
+//
+//  Input:   j = land use index
+//  Output:  none
+//  Purpose: reads a land use and its buildup & washoff functions.
+//
+{
+    TLanduse* landuse = &Landuse[j];
+    TLanduse  old = *landuse;          // holds arrays made for land use
+
+    transfer(landuse, sizeof(TLanduse));
+    landuse->ID = old.ID;
+    landuse->buildupFunc = old.buildupFunc;
+    landuse->washoffFunc = old.washoffFunc;
+    transfer(landuse->buildupFunc, Nobjects[POLLUT] * sizeof(TBuildup));
+    transfer(landuse->washoffFunc, Nobjects[POLLUT] * sizeof(TWashoff));
+}
+
+//=============================================================================
+
+void reopenFiles()
+//
+//  Input:   none
+//  Output:  none
+//  Purpose: opens the external time series files and climate file that
+//           are opened when a project is validated.
+//
+{
+    int     j, err;
+    TTable* table;
+
+    for (j = 0; j < Nobjects[TSERIES]; j++)
+    {
+        table = &Tseries[j];
+        if ( table->file.mode != USE_FILE ) continue;
+        table->lastDate = 0.0;
+        table->x1 = 0.0;
+        table->x2 = 0.0;
+        table->y1 = 0.0;
+        table->y2 = 0.0;
+        err = table_validate(table);
+        if ( err ) report_writeTseriesErrorMsg(err, table);
+    }
+    if ( Fclimate.mode == USE_FILE ) climate_openFile();
+}
@@ -0,0 +1,428 @@
+//-----------------------------------------------------------------------------
+//   sparse.c
+//
+//   Project:  EPA SWMM5
+//   Version:  5.2
+//   Date:     10/16/26 (Build 5.2.4+)
+//
+//   Sparse direct solver for symmetric positive definite linear equations
+//   whose off-diagonal coefficients follow the edges of a graph.
+//
+//   When a solver is created the unknowns are put in minimum degree order
+//   by eliminating, one at a time, the node of the graph with the fewest
+//   remaining neighbors and joining those neighbors to each other. The
+//   neighbors of each node when it is eliminated are the rows of its
+//   column of the factor L of the matrix, so this also gives the
+//   structure of L. A tree-like network (such as a dendritic sewer
+//   system) is eliminated from its leaves inward with no fill-in at all,
+//   and loops add only a few fill-in entries.
+//
+//   Each call to sparse_solve factors the matrix as L*D*L' (with L unit
+//   lower triangular and D diagonal) over this fixed structure and then
+//   solves for the unknowns by forward and back substitution.
+//-----------------------------------------------------------------------------
+
+#include <stdlib.h>
+#include "consts.h"
+#include "macros.h"
+#include "sparse.h"
+
+struct TSparse
+{
+    int     n;                         // number of unknowns
+    int     m;                         // number of graph edges
+    int*    order;                     // unknown eliminated at each position
+    int*    colStart;                  // start of each column of L in rows
+    int*    rows;                      // positions of non-zero rows of L
+    int*    edgeEntry;                 // entry of L for each edge (or -1)
+    int*    map;                       // work array: entry of each row
+    double* L;                         // values of L's off-diagonal entries
+    double* D;                         // values of D
+    double* x;                         // work array: permuted solution
+};
+
+// Graph being eliminated, with each node's list of remaining neighbors
+typedef struct
+{
+    int*  len;                         // number of neighbors
+    int*  cap;                         // capacity of neighbor list
+    int** adj;                         // list of neighbors
+    int*  next;                        // next node with same degree
+    int*  prev;                        // previous node with same degree
+    int*  head;                        // first node with each degree
+} TGraph;
+
+//-----------------------------------------------------------------------------
+//  Local functions
+//-----------------------------------------------------------------------------
+static int  orderUnknowns(TSparse* s, int node1[], int node2[]);
+static int  buildGraph(TGraph* g, int n, int m, int node1[], int node2[]);
+static void freeGraph(TGraph* g, int n);
+static int  addNeighbor(TGraph* g, int v, int u);
+static void removeNeighbor(TGraph* g, int v, int u);
+static void addToBucket(TGraph* g, int v);
+static void removeFromBucket(TGraph* g, int v);
+static int  findEdgeEntries(TSparse* s, int node1[], int node2[]);
+
+//=============================================================================
+
+TSparse* sparse_create(int n, int m, int node1[], int node2[])
+//
+//  Input:   n = number of unknowns
+//           m = number of graph edges
+//           node1[], node2[] = unknowns joined by each edge
+//  Output:  returns a new solver (or NULL if out of memory)
+//  Purpose: orders the unknowns and finds the structure of the factorized
+//           matrix for a graph of n nodes and m edges.
+//
+//  Note: edges with a negative node index or the same node at both ends
+//        are ignored, as are duplicate edges after the first one.
+//
+{
+    TSparse* s = (TSparse *)calloc(1, sizeof(TSparse));
+    if ( s == NULL ) return NULL;
+    s->n = n;
+    s->m = m;
+    s->order = (int *)calloc(n + 1, sizeof(int));
+    s->colStart = (int *)calloc(n + 1, sizeof(int));
+    s->edgeEntry = (int *)calloc(m + 1, sizeof(int));
+    s->map = (int *)calloc(n + 1, sizeof(int));
+    s->D = (double *)calloc(n + 1, sizeof(double));
+    s->x = (double *)calloc(n + 1, sizeof(double));
+    if ( !s->order || !s->colStart || !s->edgeEntry || !s->map || !s->D ||
+         !s->x || !orderUnknowns(s, node1, node2) ||
+         !findEdgeEntries(s, node1, node2) )
+    {
+        sparse_delete(s);
+        return NULL;
+    }
+    s->L = (double *)calloc(s->colStart[n] + 1, sizeof(double));
+    if ( s->L == NULL )
+    {
+        sparse_delete(s);
+        return NULL;
+    }
+    return s;
+}
+
+//=============================================================================
+
+void sparse_delete(TSparse* s)
+//
+//  Input:   s = a solver
+//  Output:  none
+//  Purpose: frees the memory used by a solver.
+//
+{
+    if ( s == NULL ) return;
+    FREE(s->order);
+    FREE(s->colStart);
+    FREE(s->rows);
+    FREE(s->edgeEntry);
+    FREE(s->map);
+    FREE(s->L);
+    FREE(s->D);
+    FREE(s->x);
+    free(s);
+}
+
+//=============================================================================
+
+int sparse_solve(TSparse* s, double diag[], double offdiag[], double b[])
+//
+//  Input:   s = a solver
+//           diag[] = diagonal coefficient of each unknown
+//           offdiag[] = off-diagonal coefficient of each edge
+//           b[] = right hand side of each equation
+//  Output:  b[] = value of each unknown;
+//           returns FALSE if the matrix is not positive definite
+//  Purpose: solves a system of linear equations.
+//
+{
+    int     n = s->n;
+    int*    colStart = s->colStart;
+    int*    rows = s->rows;
+    int*    map = s->map;
+    double* L = s->L;
+    double* D = s->D;
+    double* x = s->x;
+    int     i, j, k, e, p, q;
+    double  d, lik;
+
+    // --- load the matrix in elimination order
+    for (k = 0; k < n; k++) D[k] = diag[s->order[k]];
+    for (p = 0; p < colStart[n]; p++) L[p] = 0.0;
+    for (e = 0; e < s->m; e++)
+    {
+        if ( s->edgeEntry[e] >= 0 ) L[s->edgeEntry[e]] += offdiag[e];
+    }
+
+    // --- factor it column by column, subtracting each column's
+    //     contribution from the columns to its right
+    for (k = 0; k < n; k++)
+    {
+        d = D[k];
+        if ( d <= 0.0 ) return FALSE;
+        for (p = colStart[k]; p < colStart[k+1]; p++) L[p] /= d;
+        for (p = colStart[k]; p < colStart[k+1]; p++)
+        {
+            i = rows[p];
+            lik = L[p];
+            D[i] -= lik * lik * d;
+            for (q = colStart[i]; q < colStart[i+1]; q++) map[rows[q]] = q;
+            for (q = colStart[k]; q < colStart[k+1]; q++)
+            {
+                j = rows[q];
+                if ( j > i ) L[map[j]] -= L[q] * d * lik;
+            }
+        }
+    }
+
+    // --- forward substitution with L, then scaling by D
+    for (k = 0; k < n; k++) x[k] = b[s->order[k]];
+    for (k = 0; k < n; k++)
+    {
+        for (p = colStart[k]; p < colStart[k+1]; p++)
+            x[rows[p]] -= L[p] * x[k];
+    }
+    for (k = 0; k < n; k++) x[k] /= D[k];
+
+    // --- back substitution with L'
+    for (k = n - 1; k >= 0; k--)
+    {
+        for (p = colStart[k]; p < colStart[k+1]; p++)
+            x[k] -= L[p] * x[rows[p]];
+    }
+    for (k = 0; k < n; k++) b[s->order[k]] = x[k];
+    return TRUE;
+}
+
+//=============================================================================
+
+int orderUnknowns(TSparse* s, int node1[], int node2[])
+//
+//  Input:   s = a solver
+//           node1[], node2[] = unknowns joined by each edge
+//  Output:  returns FALSE if out of memory
+//  Purpose: finds a minimum degree elimination order of the unknowns and
+//           the rows of each column of the factorized matrix.
+//
+{
+    int    n = s->n;
+    int    i, j, k, u, v, w;
+    int    minDegree = 0;
+    int    tag = 0;
+    int    nRows = 0;
+    int    maxRows = n + 1;
+    int*   pos = s->map;
+    int*   mark = NULL;
+    TGraph g;
+
+    s->rows = (int *)malloc(maxRows * sizeof(int));
+    mark = (int *)malloc((n + 1) * sizeof(int));
+    if ( s->rows == NULL || mark == NULL ||
+         !buildGraph(&g, n, s->m, node1, node2) )
+    {
+        FREE(mark);
+        return FALSE;
+    }
+    for (i = 0; i < n; i++) mark[i] = -1;
+
+    for (k = 0; k < n; k++)
+    {
+        // --- pick a remaining node with the fewest neighbors
+        while ( g.head[minDegree] < 0 ) minDegree++;
+        v = g.head[minDegree];
+        removeFromBucket(&g, v);
+        s->order[k] = v;
+        pos[v] = k;
+
+        // --- its neighbors are the rows of the k-th column of L
+        s->colStart[k] = nRows;
+        if ( nRows + g.len[v] > maxRows )
+        {
+            int* rows;
+            maxRows = 2 * (nRows + g.len[v]);
+            rows = (int *)realloc(s->rows, maxRows * sizeof(int));
+            if ( rows == NULL ) break;
+            s->rows = rows;
+        }
+        for (i = 0; i < g.len[v]; i++) s->rows[nRows++] = g.adj[v][i];
+
+        // --- remove the node and join its neighbors to each other
+        for (i = 0; i < g.len[v]; i++)
+        {
+            u = g.adj[v][i];
+            removeFromBucket(&g, u);
+            removeNeighbor(&g, u, v);
+            tag++;
+            for (j = 0; j < g.len[u]; j++) mark[g.adj[u][j]] = tag;
+            for (j = 0; j < g.len[v]; j++)
+            {
+                w = g.adj[v][j];
+                if ( w != u && mark[w] != tag && !addNeighbor(&g, u, w) ) break;
+            }
+            if ( j < g.len[v] ) break;
+            addToBucket(&g, u);
+            if ( g.len[u] < minDegree ) minDegree = g.len[u];
+        }
+        if ( i < g.len[v] ) break;
+        g.len[v] = 0;
+    }
+    freeGraph(&g, n);
+    FREE(mark);
+    if ( k < n ) return FALSE;
+    s->colStart[n] = nRows;
+
+    // --- convert the rows of L from unknowns to elimination positions
+    for (i = 0; i < nRows; i++) s->rows[i] = pos[s->rows[i]];
+    return TRUE;
+}
+
+//=============================================================================
+
+int buildGraph(TGraph* g, int n, int m, int node1[], int node2[])
+//
+//  Input:   g = graph to build
+//           n = number of nodes
+//           m = number of edges
+//           node1[], node2[] = nodes joined by each edge
+//  Output:  returns FALSE if out of memory
+//  Purpose: builds the neighbor lists of a graph and places its nodes in
+//           buckets by degree.
+//
+{
+    int i, e, v, u;
+
+    g->len = (int *)calloc(n + 1, sizeof(int));
+    g->cap = (int *)calloc(n + 1, sizeof(int));
+    g->adj = (int **)calloc(n + 1, sizeof(int *));
+    g->next = (int *)calloc(n + 1, sizeof(int));
+    g->prev = (int *)calloc(n + 1, sizeof(int));
+    g->head = (int *)calloc(n + 1, sizeof(int));
+    if ( !g->len || !g->cap || !g->adj || !g->next || !g->prev || !g->head )
+    {
+        freeGraph(g, n);
+        return FALSE;
+    }
+
+    for (e = 0; e < m; e++)
+    {
+        v = node1[e];
+        u = node2[e];
+        if ( v < 0 || u < 0 || v == u ) continue;
+        for (i = 0; i < g->len[v]; i++) if ( g->adj[v][i] == u ) break;
+        if ( i < g->len[v] ) continue;
+        if ( !addNeighbor(g, v, u) || !addNeighbor(g, u, v) )
+        {
+            freeGraph(g, n);
+            return FALSE;
+        }
+    }
+    for (i = 0; i <= n; i++) g->head[i] = -1;
+    for (v = n - 1; v >= 0; v--) addToBucket(g, v);
+    return TRUE;
+}
+
+//=============================================================================
+
+void freeGraph(TGraph* g, int n)
+{
+    int i;
+    if ( g->adj ) for (i = 0; i < n; i++) FREE(g->adj[i]);
+    FREE(g->len);
+    FREE(g->cap);
+    FREE(g->adj);
+    FREE(g->next);
+    FREE(g->prev);
+    FREE(g->head);
+}
+
+//=============================================================================
+
+int addNeighbor(TGraph* g, int v, int u)
+//
+//  Input:   g = a graph
+//           v = a node
+//           u = node to add to v's neighbors
+//  Output:  returns FALSE if out of memory
+//  Purpose: adds a node to another node's list of neighbors.
+//
+{
+    int* adj;
+    if ( g->len[v] == g->cap[v] )
+    {
+        g->cap[v] = (g->cap[v] == 0) ? 4 : 2 * g->cap[v];
+        adj = (int *)realloc(g->adj[v], g->cap[v] * sizeof(int));
+        if ( adj == NULL ) return FALSE;
+        g->adj[v] = adj;
+    }
+    g->adj[v][g->len[v]++] = u;
+    return TRUE;
+}
+
+//=============================================================================
+
+void removeNeighbor(TGraph* g, int v, int u)
+{
+    int i;
+    for (i = 0; i < g->len[v]; i++)
+    {
+        if ( g->adj[v][i] == u )
+        {
+            g->adj[v][i] = g->adj[v][--g->len[v]];
+            return;
+        }
+    }
+}
+
+//=============================================================================
+
+void addToBucket(TGraph* g, int v)
+{
+    int d = g->len[v];
+    g->prev[v] = -1;
+    g->next[v] = g->head[d];
+    if ( g->head[d] >= 0 ) g->prev[g->head[d]] = v;
+    g->head[d] = v;
+}
+
+//=============================================================================
+
+void removeFromBucket(TGraph* g, int v)
+{
+    if ( g->prev[v] >= 0 ) g->next[g->prev[v]] = g->next[v];
+    else g->head[g->len[v]] = g->next[v];
+    if ( g->next[v] >= 0 ) g->prev[g->next[v]] = g->prev[v];
+}
+
+//=============================================================================
+
+int findEdgeEntries(TSparse* s, int node1[], int node2[])
+//
+//  Input:   s = a solver
+//           node1[], node2[] = unknowns joined by each edge
+//  Output:  returns FALSE if an edge's entry is missing from L
+//  Purpose: finds the entry of L that holds each edge's coefficient.
+//
+{
+    int e, p, lo, hi, k1, k2;
+    int* pos = s->map;                 // position of each unknown
+
+    for (e = 0; e < s->m; e++)
+    {
+        s->edgeEntry[e] = -1;
+        if ( node1[e] < 0 || node2[e] < 0 || node1[e] == node2[e] ) continue;
+        k1 = pos[node1[e]];
+        k2 = pos[node2[e]];
+        lo = MIN(k1, k2);
+        hi = MAX(k1, k2);
+        for (p = s->colStart[lo]; p < s->colStart[lo+1]; p++)
+        {
+            if ( s->rows[p] == hi ) break;
+        }
+        if ( p == s->colStart[lo+1] ) return FALSE;
+        s->edgeEntry[e] = p;
+    }
+    return TRUE;
+}
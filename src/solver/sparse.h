@@ -0,0 +1,24 @@
+//-----------------------------------------------------------------------------
+//   sparse.h
+//
+//   Header file for the sparse linear equation solver (sparse.c).
+//
+//   The solver handles symmetric positive definite systems whose non-zero
+//   off-diagonal coefficients are those of the edges of a graph (such as
+//   the node-link graph of a drainage network). sparse_create orders the
+//   unknowns to reduce fill-in and finds the structure of the factorized
+//   matrix once; sparse_solve can then be called repeatedly with new
+//   coefficient values.
+//-----------------------------------------------------------------------------
+
+#ifndef SPARSE_H
+#define SPARSE_H
+
+typedef struct TSparse TSparse;
+
+TSparse* sparse_create(int n, int m, int node1[], int node2[]);
+int      sparse_solve(TSparse* s, double diag[], double offdiag[],
+         double b[]);
+void     sparse_delete(TSparse* s);
+
+#endif //SPARSE_H
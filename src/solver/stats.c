@@ -37,6 +37,8 @@
 //   - Support added for reporting most frequent non-converging nodes.
 //   - Support added for RptFlags.disabled option.
 //   - Fixed display of routing statistics report for RptFlags.flowStats = FALSE.
+//   Build 5.2.4+:
+//   - Support added for the work done with local time steps.
 //-----------------------------------------------------------------------------
 #define _CRT_SECURE_NO_DEPRECATE
 
@@ -49,31 +51,31 @@
 //  Shared variables
 //-----------------------------------------------------------------------------
 #define MAX_STATS 5
-static TTimeStepStats  TimeStepStats;
-static TMaxStats       MaxMassBalErrs[MAX_STATS];
-static TMaxStats       MaxCourantCrit[MAX_STATS];
-static TMaxStats       MaxFlowTurns[MAX_STATS];
-static TMaxStats       MaxNonConverged[MAX_STATS];
-static double          SysOutfallFlow;
+static THREADLOCAL TTimeStepStats  TimeStepStats;
+static THREADLOCAL TMaxStats       MaxMassBalErrs[MAX_STATS];
+static THREADLOCAL TMaxStats       MaxCourantCrit[MAX_STATS];
+static THREADLOCAL TMaxStats       MaxFlowTurns[MAX_STATS];
+static THREADLOCAL TMaxStats       MaxNonConverged[MAX_STATS];
+static THREADLOCAL double          SysOutfallFlow;
 
 //-----------------------------------------------------------------------------
 //  Exportable variables (shared with statsrpt.c)
 //-----------------------------------------------------------------------------
-TSubcatchStats* SubcatchStats;
-TNodeStats*     NodeStats;
-TLinkStats*     LinkStats;
-TStorageStats*  StorageStats;
-TOutfallStats*  OutfallStats;
-TPumpStats*     PumpStats;
-double          MaxOutfallFlow;
-double          MaxRunoffFlow;
-double          RoutingTimeSpan;
+THREADLOCAL TSubcatchStats* SubcatchStats;
+THREADLOCAL TNodeStats*     NodeStats;
+THREADLOCAL TLinkStats*     LinkStats;
+THREADLOCAL TStorageStats*  StorageStats;
+THREADLOCAL TOutfallStats*  OutfallStats;
+THREADLOCAL TPumpStats*     PumpStats;
+THREADLOCAL double          MaxOutfallFlow;
+THREADLOCAL double          MaxRunoffFlow;
+THREADLOCAL double          RoutingTimeSpan;
 
 //-----------------------------------------------------------------------------
 //  Imported variables
 //-----------------------------------------------------------------------------
-extern double*         NodeInflow;     // defined in massbal.c
-extern double*         NodeOutflow;    // defined in massbal.c
+extern THREADLOCAL double*         NodeInflow;     // defined in massbal.c
+extern THREADLOCAL double*         NodeOutflow;    // defined in massbal.c
 
 //-----------------------------------------------------------------------------
 //  External functions (declared in funcs.h)
@@ -86,6 +88,7 @@ extern double*         NodeOutflow;    // defined in massbal.c
 //  stats_updateFlowStats         (called from routing_execute)
 //  stats_updateTimeStepStats     (called from routing_execute)
 //  stats_updateCriticalTimeCount (called from getVariableStep in dynwave.c)
+//  stats_updateLocalStepTime     (called from dynwave_execute)
 //  stats_updateMaxNodeDepth      (called from output_saveNodeResults)
 //  stats_updateConvergenceStats  (called from updateConvergenceStats in dynwave.c)
 
@@ -294,6 +297,8 @@ int  stats_open()
     TimeStepStats.routingTime = 0.0;
     TimeStepStats.trialsCount = 0.0;
     TimeStepStats.steadyStateTime = 0.0;
+    TimeStepStats.routingWallTime = 0.0;
+    TimeStepStats.localStepWallTime = 0.0;
     TimeStepStats.timeStepCount = 0;
 
     // --- divide range between min and max routing time steps into
@@ -517,6 +522,20 @@ void stats_updateTimeStepStats(double tStep, int trialsCount, int steadyState)
     }
 }
 
+//=============================================================================
+
+void stats_updateLocalStepTime(double routingTime, double localTime)
+//
+//  Input:   routingTime = wall clock time to route flow over a time step (sec)
+//           localTime = part of routingTime spent on local time steps (sec)
+//  Output:  none
+//  Purpose: updates the wall clock time of routing with local time steps.
+//
+{
+    TimeStepStats.routingWallTime += routingTime;
+    TimeStepStats.localStepWallTime += localTime;
+}
+
 //=============================================================================
    
 void stats_updateCriticalTimeCount(int node, int link)
@@ -43,18 +43,18 @@
 //-----------------------------------------------------------------------------
 //  Imported variables
 //-----------------------------------------------------------------------------
-extern TSubcatchStats* SubcatchStats;          // defined in STATS.C
-extern TNodeStats*     NodeStats;
-extern TLinkStats*     LinkStats;
-extern TStorageStats*  StorageStats;
-extern TOutfallStats*  OutfallStats;
-extern TPumpStats*     PumpStats;
-extern double          MaxOutfallFlow;
-extern double          MaxRunoffFlow;
-extern double          RoutingTimeSpan;
-
-extern double*         NodeInflow;             // defined in MASSBAL.C
-extern double*         NodeOutflow;
+extern THREADLOCAL TSubcatchStats* SubcatchStats;          // defined in STATS.C
+extern THREADLOCAL TNodeStats*     NodeStats;
+extern THREADLOCAL TLinkStats*     LinkStats;
+extern THREADLOCAL TStorageStats*  StorageStats;
+extern THREADLOCAL TOutfallStats*  OutfallStats;
+extern THREADLOCAL TPumpStats*     PumpStats;
+extern THREADLOCAL double          MaxOutfallFlow;
+extern THREADLOCAL double          MaxRunoffFlow;
+extern THREADLOCAL double          RoutingTimeSpan;
+
+extern THREADLOCAL double*         NodeInflow;             // defined in MASSBAL.C
+extern THREADLOCAL double*         NodeOutflow;
 
 //-----------------------------------------------------------------------------
 //  Local functions
@@ -76,8 +76,8 @@ void    writeLinkLoads(void);
 
 #define WRITE(x) (report_writeLine((x)))
 
-static char   FlowFmt[6];
-static double Vcf;
+static THREADLOCAL char   FlowFmt[6];
+static THREADLOCAL double Vcf;
 
 //=============================================================================
 
@@ -57,23 +57,23 @@ const double ODETOL    = 0.0001;            // acceptable error for ODE solver
 // Globally shared variables   
 //-----------------------------------------------------------------------------
 // Volumes (ft3) for a subcatchment over a time step
-double     Vevap;         // evaporation
-double     Vpevap;        // pervious area evaporation
-double     Vinfil;        // non-LID infiltration
-double     Vinflow;       // non-LID precip + snowmelt + runon + ponded water
-double     Voutflow;      // non-LID runoff to subcatchment's outlet
-double     VlidIn;        // impervious area flow to LID units
-double     VlidInfil;     // infiltration from LID units
-double     VlidOut;       // surface outflow from LID units
-double     VlidDrain;     // drain outflow from LID units
-double     VlidReturn;    // LID outflow returned to pervious area
+WORKERLOCAL double     Vevap;         // evaporation
+WORKERLOCAL double     Vpevap;        // pervious area evaporation
+WORKERLOCAL double     Vinfil;        // non-LID infiltration
+WORKERLOCAL double     Vinflow;       // non-LID precip + snowmelt + runon + ponded water
+WORKERLOCAL double     Voutflow;      // non-LID runoff to subcatchment's outlet
+WORKERLOCAL double     VlidIn;        // impervious area flow to LID units
+WORKERLOCAL double     VlidInfil;     // infiltration from LID units
+WORKERLOCAL double     VlidOut;       // surface outflow from LID units
+WORKERLOCAL double     VlidDrain;     // drain outflow from LID units
+WORKERLOCAL double     VlidReturn;    // LID outflow returned to pervious area
 
 //-----------------------------------------------------------------------------
 // Locally shared variables   
 //-----------------------------------------------------------------------------
-static  TSubarea* theSubarea;     // subarea to which getDdDt() is applied
-static  double    Dstore;         // monthly adjusted depression storage (ft)
-static  double    Alpha;          // monthly adjusted runoff coeff.
+static  WORKERLOCAL TSubarea* theSubarea;     // subarea to which getDdDt() is applied
+static  WORKERLOCAL double    Dstore;         // monthly adjusted depression storage (ft)
+static  WORKERLOCAL double    Alpha;          // monthly adjusted runoff coeff.
 static  char *RunoffRoutingWords[] = { w_OUTLET,  w_IMPERV, w_PERV, NULL};
 
 //-----------------------------------------------------------------------------
@@ -32,17 +32,17 @@
 //  Imported variables 
 //-----------------------------------------------------------------------------
 // Declared in RUNOFF.C
-extern  double*    OutflowLoad;   // exported pollutant mass load
+extern  WORKERLOCAL double*    OutflowLoad;   // exported pollutant mass load
 
 // Volumes (ft3) for a subcatchment over a time step declared in SUBCATCH.C
-extern double      Vinfil;        // non-LID infiltration
-extern double      Vinflow;       // non-LID precip + snowmelt + runon + ponded water
-extern double      Voutflow;      // non-LID runoff to subcatchment's outlet
-extern double      VlidIn;        // inflow to LID units
-extern double      VlidInfil;     // infiltration from LID units
-extern double      VlidOut;       // surface outflow from LID units
-extern double      VlidDrain;     // drain outflow from LID units
-extern double      VlidReturn;    // LID outflow returned to pervious area
+extern WORKERLOCAL double      Vinfil;        // non-LID infiltration
+extern WORKERLOCAL double      Vinflow;       // non-LID precip + snowmelt + runon + ponded water
+extern WORKERLOCAL double      Voutflow;      // non-LID runoff to subcatchment's outlet
+extern WORKERLOCAL double      VlidIn;        // inflow to LID units
+extern WORKERLOCAL double      VlidInfil;     // infiltration from LID units
+extern WORKERLOCAL double      VlidOut;       // surface outflow from LID units
+extern WORKERLOCAL double      VlidDrain;     // drain outflow from LID units
+extern WORKERLOCAL double      VlidReturn;    // LID outflow returned to pervious area
 
 //-----------------------------------------------------------------------------
 //  External functions (declared in funcs.h)   
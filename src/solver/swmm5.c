@@ -42,6 +42,11 @@
 //   - Prevented possible infinite loop if swmm_step() called when ErrorCode > 0.
 //   - Prevented early exit from swmm_end() when ErrorCode > 0.
 //   - Support added for relative file names.
+//   Build 5.2.4+:
+//   - Added swmm_openSnapshot() function that opens a project from a
+//     snapshot of its validated data.
+//   - Time spent in each phase of a run is recorded in a run time profile
+//     which is written to a file when a project is closed.
 //-----------------------------------------------------------------------------
 #define _CRT_SECURE_NO_DEPRECATE
 
@@ -118,6 +123,7 @@
 #include "error.h"                     // error message codes
 #include "text.h"                      // listing of all text strings 
 #include "version.h"                   // OWA Addition
+#include "profile.h"                   // run time profile
 
 #include "swmm5.h"                     // declaration of SWMM's API functions
 
@@ -153,19 +159,20 @@ const double Qcf[6] =                  // Flow Conversion Factors:
 //-----------------------------------------------------------------------------
 //  Shared variables
 //-----------------------------------------------------------------------------
-static int    IsOpenFlag;           // TRUE if a project has been opened
-static int    IsStartedFlag;        // TRUE if a simulation has been started
-static int    SaveResultsFlag;      // TRUE if output to be saved to binary file
-static int    ExceptionCount;       // number of exceptions handled
-static int    DoRunoff;             // TRUE if runoff is computed
-static int    DoRouting;            // TRUE if flow routing is computed
-static double RoutingDuration;      // duration of a set of routing steps (msecs)
+static THREADLOCAL int    IsOpenFlag;           // TRUE if a project has been opened
+static THREADLOCAL int    IsStartedFlag;        // TRUE if a simulation has been started
+static THREADLOCAL int    SaveResultsFlag;      // TRUE if output to be saved to binary file
+static THREADLOCAL int    ExceptionCount;       // number of exceptions handled
+static THREADLOCAL int    DoRunoff;             // TRUE if runoff is computed
+static THREADLOCAL int    DoRouting;            // TRUE if flow routing is computed
+static THREADLOCAL double RoutingDuration;      // duration of a set of routing steps (msecs)
 
 //-----------------------------------------------------------------------------
 //  External API functions (prototyped in swmm5.h)
 //-----------------------------------------------------------------------------
 //  swmm_run
 //  swmm_open
+//  swmm_openSnapshot
 //  swmm_start
 //  swmm_step
 //  swmm_end
@@ -189,6 +196,8 @@ static double RoutingDuration;      // duration of a set of routing steps (msecs
 //-----------------------------------------------------------------------------
 //  Local functions
 //-----------------------------------------------------------------------------
+static int    openProject(const char *f1, const char *f2, const char *f3,
+              const char *f4);
 static void   execRouting(void);
 static void   saveResults(void);
 static double getGageValue(int index, int property);
@@ -299,6 +308,44 @@ int DLLEXPORT swmm_open(const char *f1, const char *f2, const char *f3)
 //  Purpose: opens a SWMM project.
 //
 {
+    return openProject(f1, f2, f3, NULL);
+}
+
+//=============================================================================
+
+int DLLEXPORT swmm_openSnapshot(const char *f1, const char *f2, const char *f3,
+    const char *f4)
+//
+//  Input:   f1 = name of input file
+//           f2 = name of report file
+//           f3 = name of binary output file
+//           f4 = name of snapshot file
+//  Output:  returns error code
+//  Purpose: opens a SWMM project from a snapshot of its validated data,
+//           reading its input file and saving a new snapshot instead if
+//           the snapshot does not exist or was made from other input data.
+//
+{
+    return openProject(f1, f2, f3, f4);
+}
+
+//=============================================================================
+
+int openProject(const char *f1, const char *f2, const char *f3,
+    const char *f4)
+//
+//  Input:   f1 = name of input file
+//           f2 = name of report file
+//           f3 = name of binary output file
+//           f4 = name of snapshot file (NULL if none)
+//  Output:  returns error code
+//  Purpose: opens a SWMM project, reading its validated data from a
+//           snapshot file when one is named and is usable.
+//
+{
+    long rptStart;
+    int  useSnapshot;
+
 // --- to be safe, reset the state of the floating point unit
 #ifdef WINDOWS
     _fpreset();
@@ -319,6 +366,10 @@ int DLLEXPORT swmm_open(const char *f1, const char *f2, const char *f3)
         IsStartedFlag = FALSE;
         ExceptionCount = 0;
 
+        // --- start a new run time profile
+        profile_open();
+        profile_setPhase(PROFILE_INPUT);
+
         // --- open a SWMM project
         strcpy(InpDir, "");
         project_open(f1, f2, f3);
@@ -327,13 +378,22 @@ int DLLEXPORT swmm_open(const char *f1, const char *f2, const char *f3)
         IsOpenFlag = TRUE;
         report_writeLogo();
 
-        // --- retrieve project data from input file
+        // --- retrieve validated project data from snapshot file
+        useSnapshot = f4 != NULL && strlen(f4) > 0 && !strcomp(f4, f1) &&
+                      !strcomp(f4, f2) && !strcomp(f4, f3);
+        if ( useSnapshot && project_readSnapshot(f4) ) return ErrorCode;
+
+        // --- otherwise retrieve project data from input file
+        rptStart = ftell(Frpt.file);
         project_readInput();
         if ( ErrorCode ) return ErrorCode;
 
         // --- write project title to report file & validate data
         report_writeTitle();
         project_validate();
+
+        // --- save validated data to a new snapshot file
+        if ( useSnapshot && !ErrorCode ) snapshot_save(f4, rptStart);
     }
 
 #ifdef EXH
@@ -343,6 +403,7 @@ int DLLEXPORT swmm_open(const char *f1, const char *f2, const char *f3)
         ErrorCode = ERR_SYSTEM;
     }
 #endif
+    profile_setPhase(PROFILE_NONE);
     return ErrorCode;
 }
 
@@ -361,6 +422,7 @@ int DLLEXPORT swmm_start(int saveResults)
         return (ErrorCode = ERR_API_NOT_OPEN);
     if ( IsStartedFlag )
         return (ErrorCode = ERR_API_NOT_ENDED);
+    profile_setPhase(PROFILE_START);
 
     // --- write input summary & project options to report file if requested
     if (!RptFlags.disabled)
@@ -443,6 +505,7 @@ int DLLEXPORT swmm_start(int saveResults)
         ErrorCode = ERR_SYSTEM;
     }
 #endif
+    profile_setPhase(PROFILE_NONE);
     return ErrorCode;
 }
 //=============================================================================
@@ -480,7 +543,10 @@ int DLLEXPORT swmm_step(double *elapsedTime)
 
         // --- if saving results to the binary file
         if ( SaveResultsFlag )
+        {
+            profile_setPhase(PROFILE_OUTPUT);
             saveResults();
+        }
 
         // --- update elapsed time (days)
         if ( NewRoutingTime < RoutingDuration )
@@ -498,6 +564,7 @@ int DLLEXPORT swmm_step(double *elapsedTime)
         ErrorCode = ERR_SYSTEM;
     }
 #endif
+    profile_setPhase(PROFILE_NONE);
     return ErrorCode;
 }
 
@@ -567,6 +634,8 @@ void execRouting()
 #endif
     {
         // --- determine when next routing time occurs
+        profile_setPhase(PROFILE_ROUTING);
+        profile_count(PROFILE_ROUTING_STEPS);
         TotalStepCount++;
         if ( !DoRouting ) routingStep = MIN(WetStep, ReportStep);
         else routingStep = routing_getRoutingStep(RouteModel, RouteStep);
@@ -586,10 +655,16 @@ void execRouting()
         }
 
         // --- compute runoff until next routing time reached or exceeded
-        if ( DoRunoff ) while ( NewRunoffTime < nextRoutingTime)
+        if ( DoRunoff )
         {
-            runoff_execute();
-            if ( ErrorCode ) return;
+            profile_setPhase(PROFILE_RUNOFF);
+            while ( NewRunoffTime < nextRoutingTime )
+            {
+                runoff_execute();
+                profile_count(PROFILE_RUNOFF_STEPS);
+                if ( ErrorCode ) return;
+            }
+            profile_setPhase(PROFILE_ROUTING);
         }
 
         // --- if no runoff analysis, update climate state (for evaporation)
@@ -669,14 +744,17 @@ int DLLEXPORT swmm_end(void)
     if ( IsStartedFlag )
     {
         // --- write ending records to binary output file
+        profile_setPhase(PROFILE_OUTPUT);
         if ( Fout.file ) output_end();
 
         // --- report mass balance results and system statistics
+        profile_setPhase(PROFILE_REPORT);
         if ( !ErrorCode && RptFlags.disabled == 0 )
         {
             massbal_report();
             stats_report();
         }
+        profile_setPhase(PROFILE_NONE);
 
         // --- close all computing systems
         stats_close();
@@ -700,7 +778,11 @@ int DLLEXPORT swmm_report()
 //
 {
     if ( !ErrorCode )
+    {
+        profile_setPhase(PROFILE_REPORT);
         report_writeReport();
+        profile_setPhase(PROFILE_NONE);
+    }
     return ErrorCode;
 }
 
@@ -726,8 +808,15 @@ int DLLEXPORT swmm_close()
 //  Purpose: closes a SWMM project.
 //
 {
+    // --- finish writing results before the run time profile is saved
+    profile_setPhase(PROFILE_OUTPUT);
     if ( Fout.file ) output_close();
-    if ( IsOpenFlag ) project_close();
+    profile_setPhase(PROFILE_NONE);
+    if ( IsOpenFlag )
+    {
+        profile_write();
+        project_close();
+    }
     report_writeSysTime();
     if ( Finp.file != NULL )
         fclose(Finp.file);
@@ -1278,7 +1367,7 @@ double  getSavedSubcatchValue(int property, int index, int period)
 {
     // --- SubcatchResults array is defined in output.c and contains
     //     computed results in user's units
-    extern float* SubcatchResults;
+    extern THREADLOCAL float* SubcatchResults;
 
     // --- order in which subcatchment was saved to output results file
     int outIndex = Subcatch[index].rptFlag - 1;
@@ -1313,7 +1402,7 @@ double  getSavedNodeValue(int property, int index, int period)
 {
     // --- NodeResults array is defined in output.c and contains
     //     computed results in user's units
-    extern float* NodeResults;
+    extern THREADLOCAL float* NodeResults;
 
     // --- order in which node was saved to output results file
     int outIndex = Node[index].rptFlag - 1;
@@ -1354,7 +1443,7 @@ double  getSavedLinkValue(int property, int index, int period)
 
     // --- LinkResults array is defined in output.c and contains
     //     computed results in user's units
-    extern float* LinkResults;
+    extern THREADLOCAL float* LinkResults;
 
     // --- order in which link was saved to output results file
     int    outIndex = Link[index].rptFlag - 1;
@@ -12,7 +12,9 @@
 //   TTable data structures.
 //
 //   The table_getFirstEntry and table_getNextEntry functions, as well as the
-//   Time Series functions that use them, are not thread safe.
+//   Time Series functions that use them, are not thread safe. Looking up a
+//   value in a time series held in memory with table_tseriesValue and a
+//   private (or no) cursor is thread safe.
 //
 //   Update History
 //   ==============
@@ -30,6 +32,15 @@
 //   - Support added for relative file names.
 //   Build 5.2.2:
 //   - Prevent re-reading a time series file from start once end is reached.
+//   Build 5.2.4+:
+//   - A Curve's data points are copied into arrays when it is validated and
+//     the Curve lookup functions locate a point by binary search (or directly
+//     when points are evenly spaced) instead of walking the list of entries.
+//   - Data points of all tables are stored in arrays instead of a linked list.
+//   - Time series lookups in memory move a cursor forward and use a binary
+//     search when the lookup time jumps ahead or moves backward.
+//   - Added table_tseriesValue for lookups with a caller's own cursor.
+//   - Curve and time series lookups are counted in the run time profile.
 //-----------------------------------------------------------------------------
 #define _CRT_SECURE_NO_DEPRECATE
 
@@ -37,6 +48,7 @@
 #include <math.h>
 #include <string.h>
 #include "headers.h"
+#include "profile.h"
 
 //-----------------------------------------------------------------------------
 //  Local functions
@@ -44,6 +56,9 @@
 int    table_getNextFileEntry(TTable* table, double* x, double* y);
 int    table_parseFileLine(char* line, TTable* table, double* x, double* y);
 double table_interpolate(double x, double x1, double y1, double x2, double y2);
+static int    createStorageArrays(TTable *table);
+static int    findPoint(TTable *table, double x);
+static int    findValue(double a[], int n, double v);
 
 
 //=============================================================================
@@ -214,15 +229,25 @@ int table_addEntry(TTable* table, double x, double y)
 //  Purpose: adds a new x/y entry to a table.
 //
 {
-    TTableEntry *entry;
-    entry = (TTableEntry *) malloc(sizeof(TTableEntry));
-    if ( !entry ) return FALSE;
-    entry->x = x;
-    entry->y = y;
-    entry->next = NULL;
-    if ( table->firstEntry == NULL )  table->firstEntry = entry;
-    else table->lastEntry->next = entry;
-    table->lastEntry = entry;
+    int     n = table->maxPoints;
+    double* xData;
+    double* yData;
+
+    // --- enlarge data arrays when full
+    if ( table->nPoints == n )
+    {
+        n = (n == 0) ? 16 : 2 * n;
+        xData = (double *) realloc(table->xData, n * sizeof(double));
+        if ( xData == NULL ) return FALSE;
+        table->xData = xData;
+        yData = (double *) realloc(table->yData, n * sizeof(double));
+        if ( yData == NULL ) return FALSE;
+        table->yData = yData;
+        table->maxPoints = n;
+    }
+    table->xData[table->nPoints] = x;
+    table->yData[table->nPoints] = y;
+    table->nPoints++;
     return TRUE;
 }
 
@@ -235,18 +260,14 @@ void   table_deleteEntries(TTable *table)
 //  Purpose: deletes all x/y entries in a table.
 //
 {
-    TTableEntry *entry;
-    TTableEntry *nextEntry;
-    entry = table->firstEntry;
-    while (entry)
-    {
-        nextEntry = entry->next;
-        free(entry);
-        entry = nextEntry;
-    }
-    table->firstEntry = NULL;
-    table->lastEntry  = NULL;
-    table->thisEntry  = NULL;
+    FREE(table->xData);
+    FREE(table->yData);
+    FREE(table->vData);
+    table->v0Data = NULL;
+    table->nPoints = 0;
+    table->maxPoints = 0;
+    table->thisPoint = 0;
+    table->cursor = 0;
 
     if (table->file.file)
     { 
@@ -266,9 +287,12 @@ void   table_init(TTable *table)
 {
     table->ID = NULL;
     table->refersTo = -1;
-    table->firstEntry = NULL;
-    table->lastEntry = NULL;
-    table->thisEntry = table->firstEntry;
+    table->nPoints = 0;
+    table->maxPoints = 0;
+    table->thisPoint = 0;
+    table->cursor = 0;
+    table->xData = NULL;
+    table->yData = NULL;
     table->lastDate = 0.0;
     table->x1 = 0.0;
     table->x2 = 0.0;
@@ -278,6 +302,11 @@ void   table_init(TTable *table)
     table->file.mode = NO_FILE;
     table->file.file = NULL;
     table->curveType = -1;
+    table->dxGrid = 0.0;
+    table->yRising = FALSE;
+    table->vRising = FALSE;
+    table->vData = NULL;
+    table->v0Data = NULL;
 }
 
 //=============================================================================
@@ -289,9 +318,11 @@ int   table_validate(TTable *table)
 //  Purpose: checks that table's x-values are in ascending order.
 //
 {
-    int    result;
-    double x1, x2, y1, y2;
-    double dx, dxMin = BIG;
+    int     result;
+    double  x1, x2, y1, y2;
+    double  dx, dxMin = BIG;
+    double* xData;
+    double* yData;
 
     // --- open external file if used as the table's data source
     if ( table->file.mode == USE_FILE )
@@ -323,11 +354,128 @@ int   table_validate(TTable *table)
     // --- return error if external file could not be read completely
     if ( table->file.mode == USE_FILE && !feof(table->file.file) )
         return ERR_TABLE_FILE_READ;
+
+    // --- release unused space in data arrays
+    if ( table->nPoints > 0 && table->nPoints < table->maxPoints )
+    {
+        xData = (double *) realloc(table->xData, table->nPoints * sizeof(double));
+        if ( xData ) table->xData = xData;
+        yData = (double *) realloc(table->yData, table->nPoints * sizeof(double));
+        if ( yData ) table->yData = yData;
+        if ( xData && yData ) table->maxPoints = table->nPoints;
+    }
+
+    // --- add storage volumes & other lookup aids for a curve
+    if ( table->curveType >= 0 ) return createStorageArrays(table);
     return 0;
 }
 
 //=============================================================================
 
+int createStorageArrays(TTable *table)
+//
+//  Input:   table = pointer to a TTable structure
+//  Output:  returns error code
+//  Purpose: computes the storage volume at each of a curve's data points
+//           and checks the spacing and ordering of its data.
+//
+{
+    int    i, n = table->nPoints;
+    double dx;
+    double *x = table->xData, *y = table->yData, *v, *v0;
+
+    FREE(table->vData);
+    table->v0Data = NULL;
+    if ( n == 0 ) return 0;
+    v = (double *) malloc(2 * n * sizeof(double));
+    if ( v == NULL ) return ERR_MEMORY;
+    v0 = v + n;
+
+    // --- accumulate storage volume at each point by the end area method
+    //     (both with and without the volume below the first point, as
+    //     required by table_getStorageVolume and table_getStorageDepth)
+    v[0] = 0.0;
+    v0[0] = y[0] * x[0] / 2.0;
+    table->yRising = TRUE;
+    table->vRising = TRUE;
+    for (i = 1; i < n; i++)
+    {
+        dx = x[i] - x[i-1];
+        v[i] = v[i-1] + (y[i-1] + y[i]) / 2.0 * dx;
+        v0[i] = v0[i-1] + (y[i-1] + y[i]) / 2.0 * dx;
+        if ( y[i] < y[i-1] ) table->yRising = FALSE;
+        if ( v0[i] < v0[i-1] ) table->vRising = FALSE;
+    }
+
+    // --- see if x-values are evenly spaced
+    table->dxGrid = 0.0;
+    if ( n > 2 )
+    {
+        dx = (x[n-1] - x[0]) / (n - 1);
+        for (i = 1; i < n; i++)
+        {
+            if ( fabs(x[i] - x[i-1] - dx) > 1.0e-6 * dx ) break;
+        }
+        if ( i == n ) table->dxGrid = dx;
+    }
+
+    table->vData = v;
+    table->v0Data = v0;
+    return 0;
+}
+
+//=============================================================================
+
+int findPoint(TTable *table, double x)
+//
+//  Input:   table = pointer to a TTable structure
+//           x = an x-value
+//  Output:  returns index of first data point whose x-value is >= x
+//           (or the number of data points if there is none)
+//  Purpose: locates the curve segment that contains a given x-value.
+//
+{
+    int     i, n = table->nPoints;
+    double* xData = table->xData;
+    double  f;
+
+    if ( table->dxGrid == 0.0 ) return findValue(xData, n, x);
+
+    // --- for evenly spaced points, compute the position directly and
+    //     then correct it for any roundoff in the x-values
+    f = (x - xData[0]) / table->dxGrid;
+    if ( !(f > 0.0) ) i = 0;
+    else if ( f >= n ) i = n;
+    else i = (int)f;
+    while ( i > 0 && xData[i-1] >= x ) i--;
+    while ( i < n && xData[i] < x ) i++;
+    return i;
+}
+
+//=============================================================================
+
+int findValue(double a[], int n, double v)
+//
+//  Input:   a = array of non-decreasing values
+//           n = number of values
+//           v = value being searched for
+//  Output:  returns index of first element of a that is >= v
+//           (or n if there is none)
+//  Purpose: performs a binary search of an ordered array.
+//
+{
+    int lo = 0, hi = n, mid;
+    while ( lo < hi )
+    {
+        mid = (lo + hi) / 2;
+        if ( a[mid] < v ) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+//=============================================================================
+
 int table_getFirstEntry(TTable *table, double *x, double *y)
 //
 //  Input:   table = pointer to a TTable structure
@@ -336,10 +484,9 @@ int table_getFirstEntry(TTable *table, double *x, double *y)
 //           returns TRUE if successful, FALSE if not
 //  Purpose: retrieves the first x/y entry in a table.
 //
-//  NOTE: also moves the current position pointer (thisEntry) to the 1st entry.
+//  NOTE: also moves the current position (thisPoint) to the 1st entry.
 //
 {
-    TTableEntry *entry;
     *x = 0;
     *y = 0.0;
 
@@ -350,12 +497,11 @@ int table_getFirstEntry(TTable *table, double *x, double *y)
         return table_getNextFileEntry(table, x, y);
     }
 
-    entry = table->firstEntry;
-    if ( entry )
+    if ( table->nPoints > 0 )
     {
-        *x = entry->x;
-        *y = entry->y;
-        table->thisEntry = entry;
+        *x = table->xData[0];
+        *y = table->yData[0];
+        table->thisPoint = 0;
         return TRUE;
     }
     else return FALSE;
@@ -371,20 +517,20 @@ int table_getNextEntry(TTable *table, double *x, double *y)
 //           returns TRUE if successful, FALSE if not
 //  Purpose: retrieves the next x/y entry in a table.
 //
-//  NOTE: also updates the current position pointer (thisEntry).
+//  NOTE: also updates the current position (thisPoint).
 //
 {
-    TTableEntry *entry;
+    int i;
 
     if ( table->file.mode == USE_FILE )
         return table_getNextFileEntry(table, x, y);
     
-    entry = table->thisEntry->next;
-    if ( entry )
+    i = table->thisPoint + 1;
+    if ( i < table->nPoints )
     {
-        *x = entry->x;
-        *y = entry->y;
-        table->thisEntry = entry;
+        *x = table->xData[i];
+        *y = table->yData[i];
+        table->thisPoint = i;
         return TRUE;
     }
     else return FALSE;
@@ -405,24 +551,16 @@ double table_lookup(TTable *table, double x)
 //        returned.
 //
 {
-    double x1,y1,x2,y2;
-    TTableEntry* entry;
-
-    entry = table->firstEntry;
-    if ( entry == NULL ) return 0.0;
-    x1 = entry->x;
-    y1 = entry->y;
-    if ( x <= x1 ) return y1;
-    while ( entry->next )
-    {
-        entry = entry->next;
-        x2 = entry->x;
-        y2 = entry->y;
-        if ( x <= x2 ) return table_interpolate(x, x1, y1, x2, y2);
-        x1 = x2;
-        y1 = y2;
-    }
-    return y1;
+    int     i, n = table->nPoints;
+    double* xData = table->xData;
+    double* yData = table->yData;
+
+    profile_count(PROFILE_LOOKUPS);
+    if ( n == 0 ) return 0.0;
+    if ( x <= xData[0] ) return yData[0];
+    i = findPoint(table, x);
+    if ( i == n ) return yData[n-1];
+    return table_interpolate(x, xData[i-1], yData[i-1], xData[i], yData[i]);
 }
 
 //=============================================================================
@@ -435,28 +573,18 @@ double table_getSlope(TTable *table, double x)
 //  Purpose: retrieves the slope of the curve at the line segment containing x.
 //
 {
-    double x1,y1,x2,y2;
-    double dx;
-    TTableEntry* entry;
-
-    entry = table->firstEntry;
-    if ( entry == NULL ) return 0.0;
-    x1 = entry->x;
-    y1 = entry->y;
-    x2 = x1;
-    y2 = y1;
-    while ( entry->next )
-    {
-        entry = entry->next;
-        x2 = entry->x;
-        y2 = entry->y;
-        if ( x <= x2 ) break;
-        x1 = x2;
-        y1 = y2;
-    }
-    dx = x2 - x1;
+    int     i, n = table->nPoints;
+    double* xData = table->xData;
+    double* yData = table->yData;
+    double  dx;
+
+    if ( n < 2 ) return 0.0;
+    i = findPoint(table, x);
+    if ( i == 0 ) i = 1;
+    if ( i == n ) i = n - 1;
+    dx = xData[i] - xData[i-1];
     if ( dx == 0.0 ) return 0.0;
-    return (y2 - y1) / dx;
+    return (yData[i] - yData[i-1]) / dx;
 }
 
 //=============================================================================
@@ -471,29 +599,28 @@ double table_lookupEx(TTable *table, double x)
 //           extrapolation outside of the table.
 //
 {
-    double x1,y1,x2,y2;
-    double s = 0.0;
-    TTableEntry* entry;
-
-    entry = table->firstEntry;
-    if (entry == NULL ) return 0.0;
-    x1 = entry->x;
-    y1 = entry->y;
+    int     i, n = table->nPoints;
+    double* xData = table->xData;
+    double* yData = table->yData;
+    double  x1, y1, s = 0.0;
+
+    profile_count(PROFILE_LOOKUPS);
+    if ( n == 0 ) return 0.0;
+    x1 = xData[0];
+    y1 = yData[0];
     if ( x <= x1 )
     {
         if (x1 > 0.0 ) return x/x1*y1;
         else return y1;
     }
-    while ( entry->next )
-    {
-        entry = entry->next;
-        x2 = entry->x;
-        y2 = entry->y;
-        if ( x2 != x1 ) s = (y2 - y1) / (x2 - x1);
-        if ( x <= x2 ) return table_interpolate(x, x1, y1, x2, y2);
-        x1 = x2;
-        y1 = y2;
-    }
+    i = findPoint(table, x);
+    if ( i < n )
+        return table_interpolate(x, xData[i-1], yData[i-1], xData[i], yData[i]);
+
+    // --- extrapolate along last segment of the table
+    x1 = xData[n-1];
+    y1 = yData[n-1];
+    if ( n > 1 && x1 != xData[n-2] ) s = (y1 - yData[n-2]) / (x1 - xData[n-2]);
     if ( s < 0.0 ) s = 0.0;
     return y1 + s*(x - x1);
 }
@@ -509,17 +636,14 @@ double table_intervalLookup(TTable *table, double x)
 //           whose x-value is > x.
 //
 {
-    TTableEntry* entry;
-
-    entry = table->firstEntry;
-    if (entry == NULL ) return 0.0;
-    if ( x < entry->x ) return entry->y;
-    while ( entry->next )
-    {
-        entry = entry->next;
-        if ( x < entry->x ) return entry->y;
-    }
-    return entry->y;
+    int i, n = table->nPoints;
+
+    profile_count(PROFILE_LOOKUPS);
+    if ( n == 0 ) return 0.0;
+    i = findPoint(table, x);
+    if ( i < n && table->xData[i] == x ) i++;
+    if ( i == n ) i = n - 1;
+    return table->yData[i];
 }
 
 //=============================================================================
@@ -537,24 +661,20 @@ double table_inverseLookup(TTable *table, double y)
 //        returned.
 //
 {
-    double x1,y1,x2,y2;
-    TTableEntry* entry;
-
-    entry = table->firstEntry;
-    if (entry == NULL ) return 0.0;
-    x1 = entry->x;
-    y1 = entry->y;
-    if ( y <= y1 ) return x1;
-    while ( entry->next )
-    {
-        entry = entry->next;
-        x2 = entry->x;
-        y2 = entry->y;
-        if ( y <= y2 ) return table_interpolate(y, y1, x1, y2, x2);
-        x1 = x2;
-        y1 = y2;
-    }
-    return x1;
+    int     i, n = table->nPoints;
+    double* xData = table->xData;
+    double* yData = table->yData;
+
+    profile_count(PROFILE_LOOKUPS);
+    if ( n == 0 ) return 0.0;
+    if ( y <= yData[0] ) return xData[0];
+
+    // --- find first point whose y-value is >= y
+    //     (binary search only applies to non-decreasing y-values)
+    if ( table->yRising ) i = findValue(yData, n, y);
+    else for (i = 1; i < n && y > yData[i]; i++);
+    if ( i == n ) return xData[n-1];
+    return table_interpolate(y, yData[i-1], xData[i-1], yData[i], xData[i]);
 }
 
 //=============================================================================
@@ -568,16 +688,15 @@ double  table_getMaxY(TTable *table, double x)
 //           portion of a table that appear before value x.
 //
 {
-    double ymax;
-    TTableEntry* entry;
+    int     i, n = table->nPoints;
+    double  ymax;
 
-    entry = table->firstEntry;
-    ymax = entry->y;
-    while ( x > entry->x && entry->next )
+    if ( n == 0 ) return 0.0;
+    ymax = table->yData[0];
+    for (i = 1; i < n && x > table->xData[i-1]; i++)
     {
-        entry = entry->next;
-        if ( entry->y < ymax ) return ymax;
-        ymax = entry->y;
+        if ( table->yData[i] < ymax ) return ymax;
+        ymax = table->yData[i];
     }
     return 0.0;
 }
@@ -592,15 +711,16 @@ double table_getStorageVolume(TTable *table, double x)
 //  Purpose: finds volume for a given depth in a Storage Curve table.
 //
 {
-    double a, a1, x1, v, dx = 0.0, dy = 0.0, s;
-    TTableEntry* entry;
+    int     i, n = table->nPoints;
+    double* xData = table->xData;
+    double* yData = table->yData;
+    double  a, a1, x1, v, dx, s;
 
     // --- get first entry in table
-    v = 0.0;
-    entry = table->firstEntry;
-    if (entry == NULL) return 0.0;
-    x1 = entry->x;
-    a1 = entry->y;
+    profile_count(PROFILE_LOOKUPS);
+    if ( n == 0 ) return 0.0;
+    x1 = xData[0];
+    a1 = yData[0];
 
     // --- target depth is below first tabulated depth
     if (x <= x1)
@@ -609,31 +729,26 @@ double table_getStorageVolume(TTable *table, double x)
         return (a1/x1) * x * x / 2.0;
     }
 
-    // --- otherwise traverse table entries until target depth is bracketed
-    while (entry->next)
+    // --- target is bracketed - apply end area method to interpolated area
+    //     added to volume accumulated up to start of the bracket
+    i = findPoint(table, x);
+    if ( i < n )
     {
-        entry = entry->next;
-        // --- target is bracketed - apply end area method to interpolated area
-        if (entry->x >= x)
-        {
-            a = table_interpolate(x, x1, a1, entry->x, entry->y);
-            return v + (a1 + a) / 2.0 * (x - x1);
-        }
-        // --- target not yet bracketed so update volume using end area method
-        else
-        {
-            dx = entry->x - x1;
-            dy = entry->y - a1;
-            v = v + (a1 + entry->y) / 2.0 * dx;
-            x1 = entry->x;
-            a1 = entry->y;
-        }
+        x1 = xData[i-1];
+        a1 = yData[i-1];
+        a = table_interpolate(x, x1, a1, xData[i], yData[i]);
+        return table->vData[i-1] + (a1 + a) / 2.0 * (x - x1);
     }
 
     // --- extrapolate area if table limit exceeded
+    v = table->vData[n-1];
+    if ( n < 2 ) return v;
+    x1 = xData[n-1];
+    a1 = yData[n-1];
+    dx = x1 - xData[n-2];
     if (dx > 1.0e-6)
     {
-        s = dy / dx;
+        s = (a1 - yData[n-2]) / dx;
         a = a1 + s * (x - x1);
         // --- don't extrapolate below 0 in case s is negative
         if (a < 0.0)
@@ -656,61 +771,69 @@ double table_getStorageDepth(TTable *table, double v)
 //  Purpose: finds depth for a given volume in a Storage Curve table.
 //
 {
-    double a1, a2, d1, d2, dd = 0.0, da = 0.0, v1, v2, s;
-    TTableEntry* entry;
+    int     i, n = table->nPoints;
+    double* xData = table->xData;
+    double* yData = table->yData;
+    double* v0Data = table->v0Data;
+    double  a1, a2, d1, d2, dd = 0.0, da = 0.0, v1, v2, s;
 
     // --- see if target volume is below that of 1st table entry
+    profile_count(PROFILE_LOOKUPS);
     if (v == 0.0) return 0.0;
-    entry = table->firstEntry;
-    if (entry == NULL) return 0.0;
-    d1 = entry->x;
-    a1 = entry->y;
-    v1 = a1 * d1 / 2.0;
+    if (n == 0) return 0.0;
+    d1 = xData[0];
+    a1 = yData[0];
+    v1 = v0Data[0];
     if (v <= v1)
     {
         if (a1 > 0.0) return sqrt(2.0 * v * d1 / a1);
         else return 0.0;
     }
 
-    // --- add next table entry to volume until target volume is bracketed
-    while (entry->next)
+    // --- find first table entry whose volume brackets target volume
+    if ( table->vRising ) i = findValue(v0Data, n, v);
+    else for (i = 1; i < n && v > v0Data[i]; i++);
+
+    // target volume is bracketed
+    if ( i < n )
     {
-        entry = entry->next;
-        d2 = entry->x;
-        a2 = entry->y;
+        d1 = xData[i-1];
+        a1 = yData[i-1];
+        v1 = v0Data[i-1];
+        d2 = xData[i];
+        a2 = yData[i];
+        v2 = v0Data[i];
         dd = d2 - d1;
         da = a2 - a1;
-        v2 = v1 + (a1 + a2) / 2.0 * dd;
 
-        // target volume is bracketed
-        if (v <= v2)
+        // --- target coincides with point on curve
+        if (dd <= 0.0) return d1;
+        if (da == 0.0)
         {
-            // --- target coincides with point on curve
-            if (dd <= 0.0) return d1;
-            if (da == 0.0)
-            {
-                if (fabs(v2 - v1) < 1.e-6) return d1;
-                else return d1 + dd * (v - v1) / (v2 - v1);
-            }
-            // --- if area decreases with depth then replace point 1 with point 2
-            if (da < 0.0)
-            {
-                d1 = d2;
-                a1 = a2;
-                v1 = v2;
-            }
-            // --- interpolate between volumes derived from curve
-            s = da / dd;
-            return d1 + (sqrt(a1*a1 + 2.0*s*(v-v1)) - a1) / s;
+            if (fabs(v2 - v1) < 1.e-6) return d1;
+            else return d1 + dd * (v - v1) / (v2 - v1);
         }
-
-        // --- replace point 1 with point 2
-        d1 = d2;
-        a1 = a2;
-        v1 = v2;
+        // --- if area decreases with depth then replace point 1 with point 2
+        if (da < 0.0)
+        {
+            d1 = d2;
+            a1 = a2;
+            v1 = v2;
+        }
+        // --- interpolate between volumes derived from curve
+        s = da / dd;
+        return d1 + (sqrt(a1*a1 + 2.0*s*(v-v1)) - a1) / s;
     }
 
     // --- extrapolate volume if table limit exceeded
+    d1 = xData[n-1];
+    a1 = yData[n-1];
+    v1 = v0Data[n-1];
+    if (n > 1)
+    {
+        dd = d1 - xData[n-2];
+        da = a1 - yData[n-2];
+    }
     if (dd == 0.0 || da == 0.0)
     {
         if (a1 > 0.0) dd = (v - v1) / a1;
@@ -738,6 +861,7 @@ void   table_tseriesInit(TTable *table)
     table->x2 = table->x1;
     table->y2 = table->y1;
     table_getNextEntry(table, &(table->x2), &(table->y2));
+    table->cursor = 1;
 }
 
 //=============================================================================
@@ -756,6 +880,11 @@ double table_tseriesLookup(TTable *table, double x, char extend)
 //        returned.
 //
 {
+    // --- time series held in memory is searched from the table's cursor
+    if ( table->file.mode != USE_FILE )
+        return table_tseriesValue(table, &(table->cursor), x, extend);
+    profile_count(PROFILE_LOOKUPS);
+
     // --- x lies within current time bracket
     if ( table->x1 <= x
     &&   table->x2 >= x
@@ -805,6 +934,63 @@ double table_tseriesLookup(TTable *table, double x, char extend)
 
 //=============================================================================
 
+double table_tseriesValue(TTable *table, int *cursor, double x, char extend)
+//
+//  Input:   table = pointer to a TTable structure
+//           cursor = index of the end of the caller's last time bracket
+//                    (or NULL if not tracked)
+//           x = a date/time value
+//           extend = TRUE if time series extended on either end
+//  Output:  updates cursor and returns a y-value
+//  Purpose: retrieves the y-value corresponding to a time series date,
+//           using interploation if necessary.
+//
+//  NOTE: a time series read from an external file can only be accessed
+//        through its own shared position, so the cursor is not used.
+//
+{
+    int     i, n = table->nPoints;
+    double* xData = table->xData;
+    double* yData = table->yData;
+
+    if ( table->file.mode == USE_FILE )
+        return table_tseriesLookup(table, x, extend);
+    profile_count(PROFILE_LOOKUPS);
+
+    // --- x lies outside the range of the table
+    if ( n == 0 ) return 0.0;
+    if ( x < xData[0] || x > xData[n-1] || n == 1 )
+    {
+        if ( extend == FALSE ) return 0.0;
+        if ( x > xData[n-1] ) return yData[n-1];
+        return yData[0];
+    }
+
+    // --- start from the cursor's time bracket
+    i = (cursor) ? *cursor : 0;
+    if ( i < 1 || i >= n )
+    {
+        i = findValue(xData, n, x);
+    }
+
+    // --- x lies beyond the bracket: check the next bracket
+    //     before searching the whole table
+    else if ( x > xData[i] )
+    {
+        if ( i + 1 < n && x <= xData[i+1] ) i++;
+        else i = findValue(xData, n, x);
+    }
+
+    // --- x lies before the bracket
+    else if ( x < xData[i-1] ) i = findValue(xData, i, x);
+
+    if ( i == 0 ) i = 1;
+    if ( cursor ) *cursor = i;
+    return table_interpolate(x, xData[i-1], yData[i-1], xData[i], yData[i]);
+}
+
+//=============================================================================
+
 int  table_getNextFileEntry(TTable* table, double* x, double* y)
 //
 //  Input:   table = pointer to a TTable structure
@@ -848,6 +1034,7 @@ int  table_parseFileLine(char* line, TTable* table, double* x, double* y)
           s3[50];
     char* tStr;              // time as string
     char* yStr;              // value as string
+    char* pos;               // tokenizer position
     double yy;               // value as double
     DateTime d;              // day portion of date/time value
     DateTime t;              // time portion of date/time value
@@ -856,7 +1043,7 @@ int  table_parseFileLine(char* line, TTable* table, double* x, double* y)
     n = sscanf(line, "%s %s %s", s1, s2, s3);
 
     // --- return if line is blank or is a comment
-    tStr = strtok(line, SEPSTR);
+    tStr = strtok_r(line, SEPSTR, &pos);
     if ( tStr == NULL || *tStr == ';' ) return -1;
 
     // --- line only has a time and a value
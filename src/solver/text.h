@@ -13,6 +13,13 @@
 //   Build 5.2.0:
 //   - Moved strings used in swmm_run() (in swmm5.c) to that function.
 //   - Added text strings used for storage shapes, streets & inlets.
+//   Build 5.2.4+:
+//   - Added text strings for the output file layout option.
+//   - Added text string for the run time profile file option.
+//   - Added text strings for the dynamic wave solver option.
+//   - Added text string for the active set option.
+//   - Added text string for the local time step classes option.
+//   - Added text strings for the network ordering option.
 //-----------------------------------------------------------------------------
 
 #ifndef TEXT_H
@@ -59,6 +66,8 @@
 #define WARN11 "WARNING 11: non-matching attributes in Control Rule"
 #define WARN12 \
 "WARNING 12: inlet removed due to unsupported shape for Conduit"
+#define WARN13 \
+"WARNING 13: number of threads set to 1 in a reentrant build"
 
 // Analysis Option Keywords
 #define  w_FLOW_UNITS        "FLOW_UNITS"
@@ -104,6 +113,12 @@
 #define  w_MIN_ROUTE_STEP    "MINIMUM_STEP"
 #define  w_NUM_THREADS       "THREADS"
 #define  w_SURCHARGE_METHOD  "SURCHARGE_METHOD"
+#define  w_OUTPUT_LAYOUT     "OUTPUT_LAYOUT"
+#define  w_PROFILE_FILE      "PROFILE_FILE"
+#define  w_DYNWAVE_SOLVER    "DYNWAVE_SOLVER"
+#define  w_ACTIVE_SET        "ACTIVE_SET"
+#define  w_LOCAL_STEP_CLASSES "LOCAL_STEP_CLASSES"
+#define  w_NETWORK_ORDERING  "NETWORK_ORDERING"
 
 // Flow Units
 #define  w_CFS               "CFS"
@@ -128,6 +143,18 @@
 #define  w_EXTRAN            "EXTRAN"
 #define  w_SLOT              "SLOT"
 
+// Dynamic Wave Solvers
+#define  w_PICARD            "PICARD"
+#define  w_NEWTON            "NEWTON"
+
+// Network Orderings (also uses w_INPUT)
+#define  w_RCM               "RCM"
+
+// Output File Layouts
+#define  w_STANDARD          "STANDARD"
+#define  w_COLUMNAR          "COLUMNAR"
+#define  w_COMPRESSED        "COMPRESSED"
+
 // Infiltration Methods
 #define  w_HORTON            "HORTON"
 #define  w_MOD_HORTON        "MODIFIED_HORTON"
@@ -19,13 +19,15 @@
 
 #include "headers.h"
 #include "version.h"
+#include "profile.h"
 #include "shared/cstr_helper.h"
 
 #include "swmm5.h"
 #include "toolkit.h"
 
 // Protect against lack of compiler support for OpenMP
-#if defined(_OPENMP)
+// (a reentrant build keeps each project on its own thread)
+#if defined(_OPENMP) && !defined(SWMM_REENTRANT)
 #include <omp.h>
 int alt_omp_get_max_threads(void)
 {
@@ -89,12 +91,6 @@ EXPORT_TOOLKIT int swmm_run_cb(const char* f1, const char* f2, const char* f3,
     double progress, elapsedTime = 0.0;
 
 
-    // --- initialize flags
-    IsOpenFlag = FALSE;
-    IsStartedFlag = FALSE;
-    SaveResultsFlag = TRUE;
-
-
     // --- open the files & read input data
     ErrorCode = 0;
     swmm_open(f1, f2, f3);
@@ -450,9 +446,13 @@ EXPORT_TOOLKIT int  swmm_setSimulationParam(SM_SimSetting type, double value)
             case SM_THREADS:
             {
                 // --- adjust number of parallel threads to be used
+#ifdef SWMM_REENTRANT
+                if ( (int)value > 1 ) report_writeWarningMsg(WARN13, "");
+                NumThreads = 1;
+#else
                 if ( (int)value <= 0 ) NumThreads = 1;
                 else NumThreads = MIN((int)value, alt_omp_get_max_threads());
-                if ( Nobjects[LINK] < 4 * NumThreads ) NumThreads = 1;
+#endif
                 break;
             }
             default: error_code = ERR_TKAPI_OUTBOUNDS; break;
@@ -2834,6 +2834,45 @@ EXPORT_TOOLKIT int swmm_getSystemRunoffTotals(SM_RunoffTotals *runoffTotals)
     return error_code;
 }
 
+EXPORT_TOOLKIT int swmm_getProfile(SM_Profile *profile)
+///
+/// Output:  Run Time Profile Structure (SM_Profile)
+/// Return:  API Error
+/// Purpose: Gets the time spent in each phase of a run & counts of its steps
+{
+    int    error_code = 0;
+    double times[MAX_PROFILE_PHASES];
+    double counts[MAX_PROFILE_COUNTS];
+
+    // Check if Open
+    if (swmm_IsOpenFlag() == FALSE)
+        error_code = ERR_TKAPI_INPUTNOTOPEN;
+
+    else if (profile == NULL)
+        error_code = ERR_TKAPI_MEMORY;
+
+    else
+    {
+        profile_getTotals(times, counts);
+        profile->input = times[PROFILE_INPUT];
+        profile->start = times[PROFILE_START];
+        profile->runoff = times[PROFILE_RUNOFF];
+        profile->routing = times[PROFILE_ROUTING];
+        profile->quality = times[PROFILE_QUALITY];
+        profile->controls = times[PROFILE_CONTROLS];
+        profile->stats = times[PROFILE_STATS];
+        profile->output = times[PROFILE_OUTPUT];
+        profile->report = times[PROFILE_REPORT];
+        profile->runoffSteps = counts[PROFILE_RUNOFF_STEPS];
+        profile->routingSteps = counts[PROFILE_ROUTING_STEPS];
+        profile->routingTrials = counts[PROFILE_TRIALS];
+        profile->odeSteps = counts[PROFILE_ODE_STEPS];
+        profile->tableLookups = counts[PROFILE_LOOKUPS];
+        profile->routingDomains = counts[PROFILE_DOMAINS];
+    }
+    return error_code;
+}
+
 EXPORT_TOOLKIT int swmm_getLidUFluxRates(int index, int lidIndex, SM_LidLayer layerIndex, double* result)
 //
 // Input:   index = Index of desired subcatchment
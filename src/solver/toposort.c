@@ -7,6 +7,11 @@
 //   Author:   L. Rossman
 //
 //   Topological sorting of conveyance network links
+//
+//   Update History
+//   ==============
+//   Build 5.2.4+:
+//   - toposort_getNodeLinks() added to list the links incident on each node.
 //-----------------------------------------------------------------------------
 #define _CRT_SECURE_NO_DEPRECATE
 
@@ -21,25 +26,26 @@ enum AdjListType {UNDIRECTED, DIRECTED};    // type of nodal adjacency list
 //-----------------------------------------------------------------------------
 //  Shared variables
 //-----------------------------------------------------------------------------
-static int* InDegree;                  // number of incoming links to each node
-static int* StartPos;                  // start of a node's outlinks in AdjList
-static int* AdjList;                   // list of outlink indexes for each node
-static int* Stack;                     // array of nodes "reached" during sorting
-static int  First;                     // position of first node in stack
-static int  Last;                      // position of last node added to stack
-
-static char* Examined;                 // TRUE if node included in spanning tree
-static char* InTree;                   // state of each link in spanning tree:
-                                       // 0 = unexamined,
-                                       // 1 = in spanning tree,
-                                       // 2 = chord of spanning tree
-static int*  LoopLinks;                // list of links which forms a loop
-static int   LoopLinksLast;            // number of links in a loop
+static THREADLOCAL int* InDegree;                  // number of incoming links to each node
+static THREADLOCAL int* StartPos;                  // start of a node's outlinks in AdjList
+static THREADLOCAL int* AdjList;                   // list of outlink indexes for each node
+static THREADLOCAL int* Stack;                     // array of nodes "reached" during sorting
+static THREADLOCAL int  First;                     // position of first node in stack
+static THREADLOCAL int  Last;                      // position of last node added to stack
+
+static THREADLOCAL char* Examined;                 // TRUE if node included in spanning tree
+static THREADLOCAL char* InTree;                   // state of each link in spanning tree:
+                                                   // 0 = unexamined,
+                                                   // 1 = in spanning tree,
+                                                   // 2 = chord of spanning tree
+static THREADLOCAL int*  LoopLinks;                // list of links which forms a loop
+static THREADLOCAL int   LoopLinksLast;            // number of links in a loop
 
 //-----------------------------------------------------------------------------
 //  External functions (declared in funcs.h)   
 //-----------------------------------------------------------------------------
-//  toposort_sortLinks (called by routing_open)
+//  toposort_sortLinks    (called by routing_open)
+//  toposort_getNodeLinks (called by dynwave_init)
 
 //-----------------------------------------------------------------------------
 //  Local functions
@@ -139,6 +145,53 @@ void toposort_sortLinks(int sortedLinks[])
 
 //=============================================================================
 
+void toposort_getNodeLinks(int startPos[], int nodeLinks[])
+//
+//  Input:   none
+//  Output:  startPos = start of each node's links in nodeLinks
+//                      (Nobjects[NODE]+1 entries)
+//           nodeLinks = links incident on each node
+//                       (up to 2*Nobjects[LINK] entries)
+//  Purpose: creates an undirected listing of the links attached to each node.
+//
+//  Note: unlike createAdjList(), Node[].degree is left untouched, a link
+//        whose end nodes are the same is listed only once for that node,
+//        and each node's links appear in order of increasing link index.
+//
+{
+    int i, j;
+
+    // --- count the links attached to each node
+    for (i = 0; i <= Nobjects[NODE]; i++) startPos[i] = 0;
+    for (j = 0; j < Nobjects[LINK]; j++)
+    {
+        startPos[ Link[j].node1 + 1 ]++;
+        if ( Link[j].node2 != Link[j].node1 ) startPos[ Link[j].node2 + 1 ]++;
+    }
+
+    // --- convert the counts into start positions
+    for (i = 0; i < Nobjects[NODE]; i++) startPos[i+1] += startPos[i];
+
+    // --- add each link's index to the lists of its end nodes, using
+    //     startPos[i] as the next open position of node i's list
+    for (j = 0; j < Nobjects[LINK]; j++)
+    {
+        i = Link[j].node1;
+        nodeLinks[ startPos[i]++ ] = j;
+        if ( Link[j].node2 != i )
+        {
+            i = Link[j].node2;
+            nodeLinks[ startPos[i]++ ] = j;
+        }
+    }
+
+    // --- shift the start positions back into place
+    for (i = Nobjects[NODE]; i > 0; i--) startPos[i] = startPos[i-1];
+    startPos[0] = 0;
+}
+
+//=============================================================================
+
 void createAdjList(int listType)
 //
 //  Input:   lsitType = DIRECTED or UNDIRECTED
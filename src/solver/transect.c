@@ -30,18 +30,18 @@
 //-----------------------------------------------------------------------------
 //  Shared variables
 //-----------------------------------------------------------------------------
-static int    Ntransects;              // total number of transects
-static int    Nstations;               // number of stations in current transect
-static double  Station[MAXSTATION+1];  // x-coordinate of each station
-static double  Elev[MAXSTATION+1];     // elevation of each station
-static double  Nleft;                  // Manning's n for left overbank
-static double  Nright;                 // Manning's n for right overbank
-static double  Nchannel;               // Manning's n for main channel
-static double  Xleftbank;              // station where left overbank ends
-static double  Xrightbank;             // station where right overbank begins
-static double  Xfactor;                // multiplier for station spacing
-static double  Yfactor;                // factor added to station elevations
-static double  Lfactor;                // main channel/flood plain length
+static THREADLOCAL int    Ntransects;              // total number of transects
+static THREADLOCAL int    Nstations;               // number of stations in current transect
+static THREADLOCAL double  Station[MAXSTATION+1];  // x-coordinate of each station
+static THREADLOCAL double  Elev[MAXSTATION+1];     // elevation of each station
+static THREADLOCAL double  Nleft;                  // Manning's n for left overbank
+static THREADLOCAL double  Nright;                 // Manning's n for right overbank
+static THREADLOCAL double  Nchannel;               // Manning's n for main channel
+static THREADLOCAL double  Xleftbank;              // station where left overbank ends
+static THREADLOCAL double  Xrightbank;             // station where right overbank begins
+static THREADLOCAL double  Xfactor;                // multiplier for station spacing
+static THREADLOCAL double  Yfactor;                // factor added to station elevations
+static THREADLOCAL double  Lfactor;                // main channel/flood plain length
 
 //-----------------------------------------------------------------------------
 //  External functions (declared in funcs.h)   
@@ -14,12 +14,17 @@
 //   - A bug in evaluating recursive calls to treatment functions was fixed. 
 //   Build 5.2.0:
 //   - Changed enumerated constant used to indicate a math expression error.
+//   Build 5.2.4+:
+//   - Nodes with the same treatment expression share one compiled copy.
+//   - Shared expressions that do not refer to other removals are evaluated
+//     for all nodes at once each time step.
 //-----------------------------------------------------------------------------
 #define _CRT_SECURE_NO_DEPRECATE
 
 #include <stdlib.h>
 #include <string.h>
 #include "headers.h"
+#include "hash.h"
 
 //-----------------------------------------------------------------------------
 //  Constants
@@ -34,13 +39,35 @@ enum   ProcessVarType {pvHRT,          // hydraulic residence time
 //-----------------------------------------------------------------------------
 //  Shared variables
 //-----------------------------------------------------------------------------
-static int     ErrCode;                // treatment error code
-static int     J;                      // index of node being analyzed
-static double  Dt;                     // curent time step (sec)
-static double  Q;                      // node inflow (cfs)
-static double  V;                      // node volume (ft3)
-static double* R;                      // array of pollut. removals
-static double* Cin;                    // node inflow concentrations
+static THREADLOCAL int     ErrCode;                // treatment error code
+static THREADLOCAL int     J;                      // index of node being analyzed
+static THREADLOCAL double  Dt;                     // curent time step (sec)
+static THREADLOCAL double  Q;                      // node inflow (cfs)
+static THREADLOCAL double  V;                      // node volume (ft3)
+static THREADLOCAL double* R;                      // array of pollut. removals
+static THREADLOCAL double* Cin;                    // node inflow concentrations
+static THREADLOCAL double* NodeCin;                // inflow concen. at each node
+static THREADLOCAL double* NodeQin;                // inflow at each node (cfs)
+static THREADLOCAL double* NodeR;                  // batch removals at each node
+static THREADLOCAL int*    Items;                  // node-pollutant pairs batched
+static THREADLOCAL int*    BatchItems;             // pairs of current batch
+static THREADLOCAL double* BatchValues;            // batch expression values
+static THREADLOCAL int     UsesRemoval;            // expression refers to R_
+
+// Treatment expressions shared by all nodes where they appear
+typedef struct
+{
+    char*     text;                // expression text
+    MathExpr* equation;            // compiled expression
+    int       batch;               // TRUE if evaluated for all nodes at once
+    int       count;               // number of pairs batched this time step
+    int       start;               // position of first pair in Items
+}  TTreatExpr;
+
+static THREADLOCAL TTreatExpr* Exprs;              // shared expressions
+static THREADLOCAL int         NumExprs;           // number of expressions
+static THREADLOCAL int         MaxExprs;           // allocated expressions
+static THREADLOCAL HTtable*    ExprTable;          // expression text lookup
 
 //-----------------------------------------------------------------------------
 //  External functions (declared in funcs.h)
@@ -49,16 +76,21 @@ static double* Cin;                    // node inflow concentrations
 //  treatment_close         (called from routing_close)
 //  treatmnt_readExpression (called from parseLine in input.c)
 //  treatmnt_delete         (called from deleteObjects in project.c)
+//  treatmnt_deleteExpressions (called from deleteObjects in project.c)
 //  treatmnt_setInflow      (called from qualrout_execute)
-//  treatmnt_treat          (called from findNodeQual in qualrout.c)
+//  treatmnt_findRemovals   (called from qualrout_execute)
+//  treatmnt_treat          (called from qualrout_execute)
 
 //-----------------------------------------------------------------------------
 //  Local functions
 //-----------------------------------------------------------------------------
 static int    createTreatment(int node);
+static int    findExpression(char* expr);
 static double getRemoval(int pollut);
+static double setRemoval(int pollut, double r);
 static int    getVariableIndex(char* s);
 static double getVariableValue(int varCode);
+static double getBatchValue(int varCode, int item);
 
 
 //=============================================================================
@@ -70,17 +102,43 @@ int  treatmnt_open(void)
 //  Purpose: allocates memory for computing pollutant removals by treatment.
 //
 {
+    int j, p, n = 0;
+    int np = Nobjects[POLLUT];
+
     R = NULL;
     Cin = NULL;
-    if ( Nobjects[POLLUT] > 0 )
+    NodeCin = NULL;
+    NodeQin = NULL;
+    NodeR = NULL;
+    Items = NULL;
+    BatchValues = NULL;
+    if ( np > 0 )
     {
-        R = (double *) calloc(Nobjects[POLLUT], sizeof(double));
-        Cin = (double *) calloc(Nobjects[POLLUT], sizeof(double));
-        if ( R == NULL || Cin == NULL)
+        // --- count the node-pollutant pairs with a batched expression
+        for (j = 0; j < Nobjects[NODE]; j++)
+        {
+            if ( Node[j].treatment == NULL ) continue;
+            for (p = 0; p < np; p++)
+            {
+                if ( Node[j].treatment[p].equation &&
+                     Exprs[Node[j].treatment[p].exprIndex].batch ) n++;
+            }
+        }
+
+        R = (double *) calloc(np, sizeof(double));
+        NodeCin = (double *) calloc(Nobjects[NODE] * np + 1, sizeof(double));
+        NodeQin = (double *) calloc(Nobjects[NODE] + 1, sizeof(double));
+        NodeR = (double *) malloc((Nobjects[NODE] * np + 1) * sizeof(double));
+        Items = (int *) malloc((n + 1) * sizeof(int));
+        BatchValues = (double *) malloc((n + 1) * sizeof(double));
+        if ( R == NULL || NodeCin == NULL || NodeQin == NULL ||
+             NodeR == NULL || Items == NULL || BatchValues == NULL )
         {
             report_writeErrorMsg(ERR_MEMORY, "");
             return FALSE;
         }
+        for (j = 0; j < Nobjects[NODE] * np; j++) NodeR[j] = -1.0;
+        Cin = NodeCin;
     }
     return TRUE;
 }
@@ -95,7 +153,12 @@ void treatmnt_close(void)
 //
 {
     FREE(R);
-    FREE(Cin);
+    FREE(NodeCin);
+    FREE(NodeQin);
+    FREE(NodeR);
+    FREE(Items);
+    FREE(BatchValues);
+    Cin = NULL;
 }
 
 //=============================================================================
@@ -110,8 +173,7 @@ int  treatmnt_readExpression(char* tok[], int ntoks)
 {
     char  s[MAXLINE+1];
     char* expr;
-    int   i, j, k, p;
-    MathExpr* equation;                // ptr. to a math. expression
+    int   i, j, k, p, e;
 
     // --- retrieve node & pollutant
     if ( ntoks < 3 ) return error_setInpError(ERR_ITEMS, "");
@@ -144,44 +206,128 @@ int  treatmnt_readExpression(char* tok[], int ntoks)
         if ( !createTreatment(j) ) return error_setInpError(ERR_MEMORY, "");
     }
 
-    // --- create a parsed expression tree from the string expr
-    //     (getVariableIndex is the function that converts a treatment
-    //      variable's name into an index number) 
-    equation = mathexpr_create(expr, getVariableIndex);
-    if ( equation == NULL )
-        return error_setInpError(ERR_MATH_EXPR, "");
+    // --- find the expression among those already read for other nodes
+    //     or else add it to them
+    e = findExpression(expr);
+    if ( e == -2 ) return error_setInpError(ERR_MEMORY, "");
+    if ( e < 0 ) return error_setInpError(ERR_MATH_EXPR, "");
 
     // --- save the treatment parameters in the node's treatment object
     if (Node[j].treatment != NULL)
     {
         Node[j].treatment[p].treatType = k;
-        Node[j].treatment[p].equation = equation;
+        Node[j].treatment[p].equation = Exprs[e].equation;
+        Node[j].treatment[p].exprIndex = e;
     }
     return 0;
 }
 
 //=============================================================================
 
+int  findExpression(char* expr)
+//
+//  Input:   expr = text of a treatment expression
+//  Output:  returns index of the shared expression, -1 if the expression
+//           has an error, or -2 if memory runs out
+//  Purpose: finds the compiled copy of a treatment expression, compiling
+//           it the first time it is read.
+//
+{
+    int        e;
+    size_t     n;
+    MathExpr*  equation;
+    TTreatExpr* newExprs;
+
+    if ( ExprTable == NULL )
+    {
+        ExprTable = HTcreate();
+        if ( ExprTable == NULL ) return -2;
+    }
+    e = HTfind(ExprTable, expr);
+    if ( e != NOTFOUND ) return e;
+
+    // --- create a parsed expression tree from the string expr
+    //     (getVariableIndex is the function that converts a treatment
+    //      variable's name into an index number) 
+    UsesRemoval = FALSE;
+    equation = mathexpr_create(expr, getVariableIndex);
+    if ( equation == NULL ) return -1;
+
+    // --- add it to the shared expressions
+    if ( NumExprs == MaxExprs )
+    {
+        n = (MaxExprs == 0) ? 16 : 2 * MaxExprs;
+        newExprs = (TTreatExpr *) realloc(Exprs, n * sizeof(TTreatExpr));
+        if ( newExprs == NULL )
+        {
+            mathexpr_delete(equation);
+            return -2;
+        }
+        Exprs = newExprs;
+        MaxExprs = (int)n;
+    }
+    e = NumExprs;
+    n = strlen(expr) + 1;
+    Exprs[e].text = (char *) malloc(n);
+    if ( Exprs[e].text == NULL )
+    {
+        mathexpr_delete(equation);
+        return -2;
+    }
+    memcpy(Exprs[e].text, expr, n);
+    Exprs[e].equation = equation;
+    Exprs[e].batch = !UsesRemoval;
+    Exprs[e].count = 0;
+    Exprs[e].start = 0;
+    if ( !HTinsert(ExprTable, Exprs[e].text, e) )
+    {
+        FREE(Exprs[e].text);
+        mathexpr_delete(equation);
+        return -2;
+    }
+    NumExprs++;
+    return e;
+}
+
+//=============================================================================
+
 void treatmnt_delete(int j)
 //
 //  Input:   j = node index
 //  Output:  none
 //  Purpose: deletes the treatment objects for each pollutant at a node.
+//           (Their expressions are shared with other nodes and are
+//           deleted by treatmnt_deleteExpressions.)
 //
 {
-    int p;
-    if ( Node[j].treatment )
+    FREE(Node[j].treatment);
+}
+
+//=============================================================================
+
+void treatmnt_deleteExpressions(void)
+//
+//  Input:   none
+//  Output:  none
+//  Purpose: deletes the treatment expressions shared by all nodes.
+//
+{
+    int e;
+    for (e = 0; e < NumExprs; e++)
     {
-        for (p=0; p<Nobjects[POLLUT]; p++)
-            mathexpr_delete(Node[j].treatment[p].equation);
-        free(Node[j].treatment);
+        mathexpr_delete(Exprs[e].equation);
+        free(Exprs[e].text);
     }
-    Node[j].treatment = NULL;
+    FREE(Exprs);
+    NumExprs = 0;
+    MaxExprs = 0;
+    if ( ExprTable ) HTfree(ExprTable);
+    ExprTable = NULL;
 }
 
 //=============================================================================
 
-void  treatmnt_setInflow(double qIn, double wIn[])
+void  treatmnt_setInflow(int j, double qIn, double wIn[])
 //
 //  Input:   j = node index
 //           qIn = flow inflow rate (cfs)
@@ -191,6 +337,8 @@ void  treatmnt_setInflow(double qIn, double wIn[])
 //
 {
     int    p;
+    NodeQin[j] = qIn;
+    Cin = NodeCin + j * Nobjects[POLLUT];
     if ( qIn > 0.0 )
         for (p = 0; p < Nobjects[POLLUT]; p++) Cin[p] = wIn[p]/qIn;
     else
@@ -221,9 +369,15 @@ void  treatmnt_treat(int j, double q, double v, double tStep)
     Dt = tStep;                        // current time step
     Q  = q;                            // current inflow rate
     V  = v;                            // current node volume
+    Cin = NodeCin + j * Nobjects[POLLUT];
 
-    // --- initialze each removal to indicate no value 
-    for ( p = 0; p < Nobjects[POLLUT]; p++) R[p] = -1.0;
+    // --- initialze each removal to indicate no value, except for those
+    //     already found by treatmnt_findRemovals
+    for ( p = 0; p < Nobjects[POLLUT]; p++)
+    {
+        R[p] = NodeR[j * Nobjects[POLLUT] + p];
+        NodeR[j * Nobjects[POLLUT] + p] = -1.0;
+    }
 
     // --- determine removal of each pollutant
     for ( p = 0; p < Nobjects[POLLUT]; p++)
@@ -303,6 +457,72 @@ void  treatmnt_treat(int j, double q, double v, double tStep)
 
 //=============================================================================
 
+void  treatmnt_findRemovals(double tStep)
+//
+//  Input:   tStep = routing time step (sec)
+//  Output:  none
+//  Purpose: evaluates each shared treatment expression that does not refer
+//           to other removals for all of the nodes that use it at once,
+//           saving the removals for treatmnt_treat.
+//
+{
+    int    j, p, e, i, k, n;
+    int    np = Nobjects[POLLUT];
+    TTreatment* treatment;
+
+    if ( NumExprs == 0 || np == 0 ) return;
+    Dt = tStep;
+    for (e = 0; e < NumExprs; e++) Exprs[e].count = 0;
+
+    // --- count the node-pollutant pairs that need each expression
+    //     (skipping those whose removal treatmnt_treat sets without it)
+    for (k = 0; k < 2; k++)
+    {
+        for (j = 0; j < Nobjects[NODE]; j++)
+        {
+            if ( Node[j].treatment == NULL ) continue;
+            for (p = 0; p < np; p++)
+            {
+                treatment = &Node[j].treatment[p];
+                if ( treatment->equation == NULL ) continue;
+                e = treatment->exprIndex;
+                if ( !Exprs[e].batch ) continue;
+                if ( treatment->treatType == REMOVAL && NodeQin[j] <= ZERO )
+                    continue;
+                if ( Node[j].extPollutFlag[p] == 1 ) continue;
+                if ( Node[j].newQual[p] == 0.0 ) continue;
+                if ( k == 1 ) Items[Exprs[e].start++] = j * np + p;
+                else Exprs[e].count++;
+            }
+        }
+
+        // --- find where each expression's pairs start (filling them in
+        //     below advances each start to the end of its pairs)
+        if ( k == 0 ) for (e = 0, n = 0; e < NumExprs; e++)
+        {
+            Exprs[e].start = n;
+            n += Exprs[e].count;
+        }
+    }
+
+    // --- evaluate each expression for all of its pairs
+    for (e = 0; e < NumExprs; e++)
+    {
+        n = Exprs[e].count;
+        if ( n == 0 ) continue;
+        BatchItems = Items + Exprs[e].start - n;
+        mathexpr_evalBatch(Exprs[e].equation, n, getBatchValue, BatchValues);
+        for (i = 0; i < n; i++)
+        {
+            J = BatchItems[i] / np;
+            p = BatchItems[i] % np;
+            NodeR[BatchItems[i]] = setRemoval(p, BatchValues[i]);
+        }
+    }
+}
+
+//=============================================================================
+
 int  createTreatment(int j)
 //
 //  Input:   j = node index
@@ -348,7 +568,11 @@ int  getVariableIndex(char* s)
     if ( UCHAR(s[0]) == 'R' && s[1] == '_')
     {
         k = project_findObject(POLLUT, s+2);
-        if ( k >= 0 ) return (Nobjects[POLLUT] + k + m);
+        if ( k >= 0 )
+        {
+            UsesRemoval = TRUE;
+            return (Nobjects[POLLUT] + k + m);
+        }
     }
     return -1;
 }
@@ -419,6 +643,23 @@ double getVariableValue(int varCode)
 
 //=============================================================================
 
+double getBatchValue(int varCode, int item)
+//
+//  Input:   varCode = code number of process variable or pollutant
+//           item = index of a node-pollutant pair in the current batch
+//  Output:  returns current value of variable
+//  Purpose: finds current value of a process variable or pollutant concen.
+//           at the node of a batched node-pollutant pair.
+//
+{
+    J = BatchItems[item] / Nobjects[POLLUT];
+    Q = NodeQin[J];
+    Cin = NodeCin + J * Nobjects[POLLUT];
+    return getVariableValue(varCode);
+}
+
+//=============================================================================
+
 double  getRemoval(int p)
 //
 //  Input:   p = pollutant index
@@ -455,20 +696,29 @@ double  getRemoval(int p)
     // --- apply treatment eqn.
     treatment = &Node[J].treatment[p];
     r = mathexpr_eval(treatment->equation, getVariableValue);
+    R[p] = setRemoval(p, r);
+    return R[p];
+}
+
+//=============================================================================
+
+double  setRemoval(int p, double r)
+//
+//  Input:   p = pollutant index
+//           r = value of the pollutant's treatment expression
+//  Output:  returns fractional removal of pollutant
+//  Purpose: converts the value of a treatment expression at node J into
+//           a fractional removal.
+//
+{
+    double c0 = Node[J].newQual[p];    // initial node concentration
+
     r = MAX(0.0, r);
 
     // --- case where treatment eqn. is for removal
-    if ( treatment->treatType == REMOVAL )
-    {
-        r = MIN(1.0, r);
-        R[p] = r;
-    }
+    if ( Node[J].treatment[p].treatType == REMOVAL ) return MIN(1.0, r);
 
     // --- case where treatment eqn. is for effluent concen.
-    else
-    {
-        r = MIN(c0, r);
-        R[p] = 1.0 - r/c0;
-    }
-    return R[p];
+    r = MIN(c0, r);
+    return 1.0 - r/c0;
 }
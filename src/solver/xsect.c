@@ -34,6 +34,9 @@
 //   - Support added for Street cross sections.
 //   Build 5.2.2:
 //   - Feasibility check added to Mod. Baskethandle & Rect.-Round shapes.
+//   Build 5.2.4+:
+//   - Batch versions of getAofY, getWofY, getRofY & getSofA added that
+//     look up tabulated shapes for many cross sections at once.
 //-----------------------------------------------------------------------------
 #define _CRT_SECURE_NO_DEPRECATE
 
@@ -44,6 +47,7 @@
 #define  RECT_ALFMAX        0.97
 #define  RECT_TRIANG_ALFMAX 0.98
 #define  RECT_ROUND_ALFMAX  0.98
+#define  XSECT_BATCH        64     // max. number of sections done together
 
 #include "xsect.dat"    // File containing geometry tables for rounded shapes
 
@@ -90,6 +94,9 @@ typedef struct
     TXsect* xsect;            // pointer to a cross section object
 } TXsectStar;
 
+// Geometric quantities computed by the batch functions
+enum XsectBatchType {BATCH_AofY, BATCH_WofY, BATCH_RofY, BATCH_SofA};
+
 //-----------------------------------------------------------------------------
 //  External functions (declared in funcs.h)
 //-----------------------------------------------------------------------------
@@ -107,6 +114,10 @@ typedef struct
 //  xsect_getAofY
 //  xsect_getRofY
 //  xsect_getWofY
+//  xsect_getAofYBatch
+//  xsect_getWofYBatch
+//  xsect_getRofYBatch
+//  xsect_getSofABatch
 //  xsect_getYcrit
 
 //-----------------------------------------------------------------------------
@@ -122,6 +133,14 @@ static double lookup(double x, double *table, int nItems);
 static double invLookup(double y, double *table, int nItems);
 static int    locate(double y, double *table, int nItems);
 
+static void   getBatch(int quantity, TXsect* xsect[], double x[], double v[],
+              int n);
+static double* getBatchTable(int quantity, int type, int* nItems);
+static void   tableBatch(int quantity, TXsect* xsect[], double x[], double v[],
+              int n, double* table, int nItems);
+static void   lookupBatch(double x[], double y[], int n, double *table,
+              int nItems);
+
 static double rect_closed_getSofA(TXsect* xsect, double a);
 static double rect_closed_getdSdA(TXsect* xsect, double a);
 static double rect_closed_getRofA(TXsect* xsect, double a);
@@ -1097,6 +1116,69 @@ double xsect_getRofY(TXsect *xsect, double y)
 
 //=============================================================================
 
+void xsect_getAofYBatch(TXsect* xsect[], double y[], double a[], int n)
+//
+//  Input:   xsect = array of ptrs. to cross section data structures
+//           y = array of depths (ft)
+//           n = number of cross sections
+//  Output:  a = array of areas (ft2)
+//  Purpose: computes the area at a given depth for each of several cross
+//           sections.
+//
+//  Note:    consecutive cross sections with the same tabulated shape are
+//           evaluated together, so callers should group sections by shape.
+//
+{
+    getBatch(BATCH_AofY, xsect, y, a, n);
+}
+
+//=============================================================================
+
+void xsect_getWofYBatch(TXsect* xsect[], double y[], double w[], int n)
+//
+//  Input:   xsect = array of ptrs. to cross section data structures
+//           y = array of depths (ft)
+//           n = number of cross sections
+//  Output:  w = array of top widths (ft)
+//  Purpose: computes the top width at a given depth for each of several
+//           cross sections.
+//
+{
+    getBatch(BATCH_WofY, xsect, y, w, n);
+}
+
+//=============================================================================
+
+void xsect_getRofYBatch(TXsect* xsect[], double y[], double r[], int n)
+//
+//  Input:   xsect = array of ptrs. to cross section data structures
+//           y = array of depths (ft)
+//           n = number of cross sections
+//  Output:  r = array of hydraulic radii (ft)
+//  Purpose: computes the hydraulic radius at a given depth for each of
+//           several cross sections.
+//
+{
+    getBatch(BATCH_RofY, xsect, y, r, n);
+}
+
+//=============================================================================
+
+void xsect_getSofABatch(TXsect* xsect[], double a[], double s[], int n)
+//
+//  Input:   xsect = array of ptrs. to cross section data structures
+//           a = array of areas (ft2)
+//           n = number of cross sections
+//  Output:  s = array of section factors (ft^(8/3))
+//  Purpose: computes the section factor at a given area for each of
+//           several cross sections.
+//
+{
+    getBatch(BATCH_SofA, xsect, a, s, n);
+}
+
+//=============================================================================
+
 double xsect_getRofA(TXsect *xsect, double a)
 //
 //  Input:   xsect = ptr. to a cross section data structure
@@ -1609,6 +1691,237 @@ int locate(double y, double *table, int jLast)
 
 //=============================================================================
 
+void getBatch(int quantity, TXsect* xsect[], double x[], double v[], int n)
+//
+//  Input:   quantity = type of geometric quantity to compute
+//           xsect = array of ptrs. to cross section data structures
+//           x = array of depths (or areas for section factor)
+//           n = number of cross sections
+//  Output:  v = array of computed quantities
+//  Purpose: computes a geometric quantity for several cross sections,
+//           batching the table lookups of each run of consecutive
+//           sections with the same tabulated shape.
+//
+{
+    int     j, k, m, nItems;
+    double* table;
+
+    for (j = 0; j < n; j += m)
+    {
+        // --- find run of sections with same shape as section j
+        //     (no longer than a batch so its data stays in the cache)
+        m = 1;
+        while ( j + m < n && m < XSECT_BATCH &&
+                xsect[j+m]->type == xsect[j]->type ) m++;
+
+        // --- shape's quantity comes from a fixed geometry table
+        table = getBatchTable(quantity, xsect[j]->type, &nItems);
+        if ( table )
+        {
+            tableBatch(quantity, &xsect[j], &x[j], &v[j], m, table, nItems);
+            continue;
+        }
+
+        // --- otherwise evaluate each section individually
+        for (k = j; k < j + m; k++) switch ( quantity )
+        {
+          case BATCH_AofY: v[k] = xsect_getAofY(xsect[k], x[k]); break;
+          case BATCH_WofY: v[k] = xsect_getWofY(xsect[k], x[k]); break;
+          case BATCH_RofY: v[k] = xsect_getRofY(xsect[k], x[k]); break;
+          case BATCH_SofA: v[k] = xsect_getSofA(xsect[k], x[k]); break;
+        }
+    }
+}
+
+//=============================================================================
+
+double* getBatchTable(int quantity, int type, int* nItems)
+//
+//  Input:   quantity = type of geometric quantity
+//           type = cross section shape
+//  Output:  nItems = number of items in geometry table;
+//           returns ptr. to geometry table or NULL if quantity is not
+//           found from a direct lookup in a table for the shape
+//  Purpose: finds the geometry table used to compute a quantity for a shape.
+//
+{
+    switch ( quantity )
+    {
+    case BATCH_AofY:
+        switch ( type )
+        {
+          case FORCE_MAIN:
+          case CIRCULAR:      *nItems = N_A_Circ;        return A_Circ;
+          case EGGSHAPED:     *nItems = N_A_Egg;         return A_Egg;
+          case HORSESHOE:     *nItems = N_A_Horseshoe;   return A_Horseshoe;
+          case BASKETHANDLE:  *nItems = N_A_Baskethandle;
+                              return A_Baskethandle;
+          case HORIZ_ELLIPSE: *nItems = N_A_HorizEllipse;
+                              return A_HorizEllipse;
+          case VERT_ELLIPSE:  *nItems = N_A_VertEllipse; return A_VertEllipse;
+          case ARCH:          *nItems = N_A_Arch;        return A_Arch;
+        }
+        break;
+
+    case BATCH_WofY:
+        switch ( type )
+        {
+          case FORCE_MAIN:
+          case CIRCULAR:      *nItems = N_W_Circ;        return W_Circ;
+          case EGGSHAPED:     *nItems = N_W_Egg;         return W_Egg;
+          case HORSESHOE:     *nItems = N_W_Horseshoe;   return W_Horseshoe;
+          case GOTHIC:        *nItems = N_W_Gothic;      return W_Gothic;
+          case CATENARY:      *nItems = N_W_Catenary;    return W_Catenary;
+          case SEMIELLIPTICAL:*nItems = N_W_SemiEllip;   return W_SemiEllip;
+          case BASKETHANDLE:  *nItems = N_W_BasketHandle;
+                              return W_BasketHandle;
+          case SEMICIRCULAR:  *nItems = N_W_SemiCirc;    return W_SemiCirc;
+          case HORIZ_ELLIPSE: *nItems = N_W_HorizEllipse;
+                              return W_HorizEllipse;
+          case VERT_ELLIPSE:  *nItems = N_W_VertEllipse; return W_VertEllipse;
+          case ARCH:          *nItems = N_W_Arch;        return W_Arch;
+        }
+        break;
+
+    case BATCH_RofY:
+        switch ( type )
+        {
+          case FORCE_MAIN:
+          case CIRCULAR:      *nItems = N_R_Circ;        return R_Circ;
+          case EGGSHAPED:     *nItems = N_R_Egg;         return R_Egg;
+          case HORSESHOE:     *nItems = N_R_Horseshoe;   return R_Horseshoe;
+          case BASKETHANDLE:  *nItems = N_R_Baskethandle;
+                              return R_Baskethandle;
+          case HORIZ_ELLIPSE: *nItems = N_R_HorizEllipse;
+                              return R_HorizEllipse;
+          case VERT_ELLIPSE:  *nItems = N_R_VertEllipse; return R_VertEllipse;
+          case ARCH:          *nItems = N_R_Arch;        return R_Arch;
+        }
+        break;
+
+    case BATCH_SofA:
+        switch ( type )
+        {
+          case FORCE_MAIN:
+          case CIRCULAR:      *nItems = N_S_Circ;        return S_Circ;
+          case EGGSHAPED:     *nItems = N_S_Egg;         return S_Egg;
+          case HORSESHOE:     *nItems = N_S_Horseshoe;   return S_Horseshoe;
+          case GOTHIC:        *nItems = N_S_Gothic;      return S_Gothic;
+          case CATENARY:      *nItems = N_S_Catenary;    return S_Catenary;
+          case SEMIELLIPTICAL:*nItems = N_S_SemiEllip;   return S_SemiEllip;
+          case BASKETHANDLE:  *nItems = N_S_BasketHandle;
+                              return S_BasketHandle;
+          case SEMICIRCULAR:  *nItems = N_S_SemiCirc;    return S_SemiCirc;
+        }
+        break;
+    }
+    return NULL;
+}
+
+//=============================================================================
+
+void tableBatch(int quantity, TXsect* xsect[], double x[], double v[], int n,
+                double* table, int nItems)
+//
+//  Input:   quantity = type of geometric quantity to compute
+//           xsect = array of ptrs. to cross sections of the same shape
+//           x = array of depths (or areas for section factor)
+//           n = number of cross sections (at most XSECT_BATCH)
+//           table = geometry table for the quantity and shape
+//           nItems = number of items in table
+//  Output:  v = array of computed quantities
+//  Purpose: computes a tabulated quantity for several cross sections of
+//           the same shape (with the same results as the scalar functions).
+//
+{
+    double u[XSECT_BATCH];             // normalized depths or areas
+    double w[XSECT_BATCH];             // normalized quantities
+    double f[XSECT_BATCH];             // full values of quantities
+    TXsect* xs;
+    int    k;
+
+    // --- normalize depths (or areas) and save full values of quantity
+    for (k = 0; k < n; k++)
+    {
+        xs = xsect[k];
+        switch ( quantity )
+        {
+          case BATCH_AofY: u[k] = x[k] / xs->yFull; f[k] = xs->aFull; break;
+          case BATCH_WofY: u[k] = x[k] / xs->yFull; f[k] = xs->wMax;  break;
+          case BATCH_RofY: u[k] = x[k] / xs->yFull; f[k] = xs->rFull; break;
+          case BATCH_SofA: u[k] = x[k] / xs->aFull; f[k] = xs->sFull; break;
+        }
+    }
+
+    // --- look up normalized quantities & scale by their full values
+    lookupBatch(u, w, n, table, nItems);
+    for (k = 0; k < n; k++) v[k] = f[k] * w[k];
+
+    // --- zero depth has zero area
+    if ( quantity == BATCH_AofY )
+    {
+        for (k = 0; k < n; k++) if ( x[k] <= 0.0 ) v[k] = 0.0;
+    }
+
+    // --- circular shapes use special function for small a/aFull
+    if ( quantity == BATCH_SofA &&
+        (xsect[0]->type == CIRCULAR || xsect[0]->type == FORCE_MAIN) )
+    {
+        for (k = 0; k < n; k++)
+            if ( u[k] < 0.04 ) v[k] = f[k] * getScircular(u[k]);
+    }
+}
+
+//=============================================================================
+
+void lookupBatch(double x[], double y[], int n, double *table, int nItems)
+//
+//  Input:   x = array of values of independent variable in a geometry table
+//           n = number of values
+//           table = ptr. to geometry table
+//           nItems = number of equally spaced items in table
+//  Output:  y = array of values of dependent table variable
+//  Purpose: looks up several values in a geometry table at once.
+//
+//  Note:    values are found exactly as lookup() would find them. The
+//           linear interpolation is done without branching so that it can
+//           be vectorized, and the few values falling in the first two
+//           table segments are then redone by lookup() itself.
+//
+{
+    double delta, x0, t0, t1, yj;
+    int    i, j, k, low = 0, last = nItems - 1;
+    double yLast = table[last];
+
+    delta = 1.0 / ((double)nItems-1);
+
+#pragma omp simd private(x0, t0, t1, yj, i, k) reduction(|:low)
+    for (j = 0; j < n; j++)
+    {
+        // --- find which segment of table contains x
+        i = (int)(x[j] / delta);
+        k = ( i < last - 1 ) ? i : last - 1;
+        k = ( k > 0 ) ? k : 0;
+        low |= ( i < 2 );
+
+        // --- linearly interpolate a y-value
+        x0 = k * delta;
+        t0 = table[k];
+        t1 = table[k+1];
+        yj = t0 + (x[j] - x0) * (t1 - t0) / delta;
+        yj = ( yj < 0.0 ) ? 0.0 : yj;
+        y[j] = ( i >= last ) ? yLast : yj;
+    }
+
+    // --- values in first two segments use quadratic interpolation
+    if ( low ) for (j = 0; j < n; j++)
+    {
+        if ( x[j] / delta < 2.0 ) y[j] = lookup(x[j], table, nItems);
+    }
+}
+
+//=============================================================================
+
 double getQcritical(double yc, void* p)
 //
 //  Input:   yc = critical depth (ft)
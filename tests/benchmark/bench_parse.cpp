@@ -0,0 +1,130 @@
+/*
+ ******************************************************************************
+ Project:      OWA SWMM
+ Version:      5.2.4
+ Module:       bench_parse.cpp
+ Description:  times reading of input files of increasing size
+ Authors:      see AUTHORS
+ Copyright:    see AUTHORS
+ License:      see LICENSE
+ Last Updated: 10/16/2026
+ ******************************************************************************
+*/
+
+// Usage: bench_parse [max nodes] [repeats]
+//
+// Writes models with 1000, 2000, 4000, ... junctions (up to max nodes),
+// each a chain of conduits draining to an outfall with a subcatchment,
+// an external inflow and a dry weather inflow per junction, and reports
+// the best times taken by swmm_open to read each of them and by
+// swmm_close to free them. Parse time per object should stay roughly
+// constant as the model grows.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+
+#include "swmm5.h"
+
+using namespace std;
+
+
+static void writeModel(const char *inpFile, int nodes)
+{
+    ofstream f(inpFile);
+    int i;
+
+    f << "[OPTIONS]\n"
+         "FLOW_UNITS CFS\n"
+         "FLOW_ROUTING KINWAVE\n"
+         "START_DATE 01/01/2020\n"
+         "END_DATE 01/01/2020\n"
+         "END_TIME 01:00:00\n\n";
+
+    f << "[RAINGAGES]\nRG1 INTENSITY 0:15 1.0 TIMESERIES RAIN\n";
+
+    f << "\n[SUBCATCHMENTS]\n";
+    for (i = 0; i < nodes; i++)
+        f << "Sub" << i << " RG1 Node" << i << " 5 50 500 0.5 0\n";
+
+    f << "\n[SUBAREAS]\n";
+    for (i = 0; i < nodes; i++)
+        f << "Sub" << i << " 0.01 0.1 0.05 0.05 25 OUTLET\n";
+
+    f << "\n[INFILTRATION]\n";
+    for (i = 0; i < nodes; i++)
+        f << "Sub" << i << " 3.0 0.5 4 7 0\n";
+
+    f << "\n[JUNCTIONS]\n";
+    for (i = 0; i < nodes; i++)
+        f << "Node" << i << " " << 0.01 * (nodes - i) << " 6 0 0 0\n";
+
+    f << "\n[OUTFALLS]\nOut 0 FREE NO\n";
+
+    f << "\n[CONDUITS]\n";
+    for (i = 0; i < nodes; i++)
+        f << "Pipe" << i << " Node" << i << " "
+          << (i + 1 < nodes ? "Node" + to_string(i + 1) : string("Out"))
+          << " 400 0.013 0 0\n";
+
+    f << "\n[XSECTIONS]\n";
+    for (i = 0; i < nodes; i++)
+        f << "Pipe" << i << " CIRCULAR 2 0 0 0 1\n";
+
+    f << "\n[INFLOWS]\n";
+    for (i = 0; i < nodes; i++)
+        f << "Node" << i << " FLOW INFLOW FLOW 1.0 1.0 0.1\n";
+
+    f << "\n[DWF]\n";
+    for (i = 0; i < nodes; i++)
+        f << "Node" << i << " FLOW 0.05\n";
+
+    f << "\n[TIMESERIES]\nRAIN 0:00 0.5\nRAIN 1:00 0.0\n"
+         "INFLOW 0:00 0.0\nINFLOW 1:00 1.0\n";
+}
+
+
+int main(int argc, char *argv[])
+{
+    int    maxNodes = (argc > 1) ? atoi(argv[1]) : 256000;
+    int    repeats = (argc > 2) ? atoi(argv[2]) : 3;
+    int    nodes, k, error;
+    double best, bestClose, secs;
+
+    if ( maxNodes < 1000 || repeats < 1 )
+    {
+        printf("usage: bench_parse [max nodes] [repeats]\n");
+        return 1;
+    }
+
+    printf("\n     nodes   objects   parse time   close time   time/object\n");
+    for (nodes = 1000; nodes <= maxNodes; nodes *= 2)
+    {
+        writeModel("bench_parse.inp", nodes);
+        best = 0.0;
+        bestClose = 0.0;
+        for (k = 0; k < repeats; k++)
+        {
+            auto t0 = chrono::steady_clock::now();
+            error = swmm_open("bench_parse.inp", "bench_parse.rpt", "");
+            auto t1 = chrono::steady_clock::now();
+            swmm_close();
+            auto t2 = chrono::steady_clock::now();
+            if ( error )
+            {
+                printf("swmm_open failed with error %d\n", error);
+                return 1;
+            }
+            secs = chrono::duration<double>(t1 - t0).count();
+            if ( k == 0 || secs < best ) best = secs;
+            secs = chrono::duration<double>(t2 - t1).count();
+            if ( k == 0 || secs < bestClose ) bestClose = secs;
+        }
+
+        // --- each junction has a subcatchment, a conduit & two inflows
+        printf("%10d %9d %10.3f s %10.3f s %10.2f us\n", nodes,
+               5 * nodes + 2, best, bestClose, 1.0e6 * best / (5 * nodes + 2));
+    }
+    return 0;
+}
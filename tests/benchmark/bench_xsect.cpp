@@ -0,0 +1,161 @@
+/*
+ ******************************************************************************
+ Project:      OWA SWMM
+ Version:      5.2.4
+ Module:       bench_xsect.cpp
+ Description:  times batched against scalar cross section geometry functions
+ Authors:      see AUTHORS
+ Copyright:    see AUTHORS
+ License:      see LICENSE
+ Last Updated: 10/16/2026
+ ******************************************************************************
+*/
+
+// Usage: bench_xsect [sections] [repeats]
+//
+// Creates a set of cross sections of mixed shapes, grouped by shape, and
+// reports the best time per section taken to compute area, top width and
+// hydraulic radius at random depths and section factor at random areas,
+// first one section at a time and then with the batch functions. The
+// batch results are checked against the scalar ones.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+extern "C" {
+#include "headers.h"
+}
+
+using namespace std;
+
+
+typedef double (*ScalarFunc)(TXsect*, double);
+typedef void   (*BatchFunc)(TXsect**, double*, double*, int);
+
+
+static void addShapes(vector<TXsect> &xsects, int n)
+{
+    // --- shape, depth and extra parameters of each kind of section
+    const struct { int type; double p[4]; } kinds[] = {
+        {CIRCULAR,       {2.0, 0, 0, 0}},
+        {CIRCULAR,       {4.5, 0, 0, 0}},
+        {FORCE_MAIN,     {3.0, 130, 0, 0}},
+        {EGGSHAPED,      {3.0, 0, 0, 0}},
+        {HORSESHOE,      {4.0, 0, 0, 0}},
+        {GOTHIC,         {4.0, 0, 0, 0}},
+        {CATENARY,       {4.0, 0, 0, 0}},
+        {SEMIELLIPTICAL, {4.0, 0, 0, 0}},
+        {BASKETHANDLE,   {4.0, 0, 0, 0}},
+        {SEMICIRCULAR,   {4.0, 0, 0, 0}},
+        {HORIZ_ELLIPSE,  {3.0, 5.0, 0, 0}},
+        {ARCH,           {3.0, 4.0, 0, 0}},
+        {TRAPEZOIDAL,    {3.0, 4.0, 1.0, 1.0}},
+    };
+    const int nKinds = sizeof(kinds) / sizeof(kinds[0]);
+    TXsect xsect;
+    double p[4];
+    int    i, k;
+
+    for (i = 0; i < n; i++)
+    {
+        k = rand() % nKinds;
+        copy(kinds[k].p, kinds[k].p + 4, p);
+        p[0] *= 0.5 + (double)rand() / RAND_MAX;
+        xsect_setParams(&xsect, kinds[k].type, p, 1.0);
+        xsects.push_back(xsect);
+    }
+
+    // --- group the sections by shape
+    sort(xsects.begin(), xsects.end(),
+         [](const TXsect &a, const TXsect &b) { return a.type < b.type; });
+}
+
+
+static double timeScalar(ScalarFunc f, vector<TXsect*> &xs, vector<double> &x,
+                         vector<double> &v, int repeats)
+{
+    double best = 0.0;
+    size_t i;
+
+    for (int k = 0; k < repeats; k++)
+    {
+        auto t0 = chrono::steady_clock::now();
+        for (i = 0; i < xs.size(); i++) v[i] = f(xs[i], x[i]);
+        auto t1 = chrono::steady_clock::now();
+        double secs = chrono::duration<double>(t1 - t0).count();
+        if ( k == 0 || secs < best ) best = secs;
+    }
+    return best;
+}
+
+
+static double timeBatch(BatchFunc f, vector<TXsect*> &xs, vector<double> &x,
+                        vector<double> &v, int repeats)
+{
+    double best = 0.0;
+
+    for (int k = 0; k < repeats; k++)
+    {
+        auto t0 = chrono::steady_clock::now();
+        f(xs.data(), x.data(), v.data(), (int)xs.size());
+        auto t1 = chrono::steady_clock::now();
+        double secs = chrono::duration<double>(t1 - t0).count();
+        if ( k == 0 || secs < best ) best = secs;
+    }
+    return best;
+}
+
+
+int main(int argc, char *argv[])
+{
+    int    n = (argc > 1) ? atoi(argv[1]) : 100000;
+    int    repeats = (argc > 2) ? atoi(argv[2]) : 20;
+    int    i, k, differ, total = 0;
+    double tScalar, tBatch;
+
+    const struct { const char *name; ScalarFunc scalar; BatchFunc batch;
+                   int useArea; } funcs[] = {
+        {"AofY", xsect_getAofY, xsect_getAofYBatch, 0},
+        {"WofY", xsect_getWofY, xsect_getWofYBatch, 0},
+        {"RofY", xsect_getRofY, xsect_getRofYBatch, 0},
+        {"SofA", xsect_getSofA, xsect_getSofABatch, 1},
+    };
+
+    if ( n < 1 || repeats < 1 )
+    {
+        printf("usage: bench_xsect [sections] [repeats]\n");
+        return 1;
+    }
+
+    vector<TXsect>  xsects;
+    vector<TXsect*> xs(n);
+    vector<double>  y(n), a(n), v1(n), v2(n);
+
+    srand(1);
+    addShapes(xsects, n);
+    for (i = 0; i < n; i++)
+    {
+        xs[i] = &xsects[i];
+        y[i] = xsects[i].yFull * rand() / RAND_MAX;
+        a[i] = xsects[i].aFull * rand() / RAND_MAX;
+    }
+
+    printf("\nsections %d\n", n);
+    printf("function   scalar     batch    speedup   differences\n");
+    for (k = 0; k < 4; k++)
+    {
+        vector<double> &x = funcs[k].useArea ? a : y;
+        tScalar = timeScalar(funcs[k].scalar, xs, x, v1, repeats);
+        tBatch = timeBatch(funcs[k].batch, xs, x, v2, repeats);
+        differ = 0;
+        for (i = 0; i < n; i++) if ( v1[i] != v2[i] ) differ++;
+        total += differ;
+        printf("%-8s %6.2f ns %6.2f ns %8.2f x %10d\n", funcs[k].name,
+               1.0e9 * tScalar / n, 1.0e9 * tBatch / n, tScalar / tBatch,
+               differ);
+    }
+    return total > 0;
+}
@@ -17,9 +17,13 @@
 #include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <algorithm>
 #include <string>
+#include <vector>
 
 #include "swmm_output.h"
+#include "shared/outcodec.h"
 
 // NOTE: Reference data for the unit tests is currently tied to SWMM 5.1.7
 #define DATA_PATH "./test_example1.out"
@@ -288,6 +292,74 @@ BOOST_FIXTURE_TEST_CASE(test_getSystemSeries, Fixture) {
 }
 
 
+BOOST_FIXTURE_TEST_CASE(test_getElementSeries, Fixture) {
+    int nodes[3] = {0, 5, 13};
+    int attrs[2] = {SMO_invert_depth, SMO_total_inflow};
+
+    error = SMO_getElementSeries(p_handle, SMO_node, nodes, 3, attrs, 2, 2, 20,
+                                 &array, &array_dim);
+    BOOST_REQUIRE(error == 0);
+    BOOST_REQUIRE_EQUAL(array_dim, 3 * 2 * 18);
+
+    // each series must match the one retrieved on its own
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 2; j++) {
+            float* series = NULL;
+            int    len    = 0;
+
+            error = SMO_getNodeSeries(p_handle, nodes[i],
+                                      (SMO_nodeAttribute)attrs[j], 2, 20,
+                                      &series, &len);
+            BOOST_REQUIRE(error == 0);
+
+            std::vector<float> ref_vec(series, series + len);
+            float* test = array + (i * 2 + j) * len;
+            std::vector<float> test_vec(test, test + len);
+
+            BOOST_CHECK_EQUAL_COLLECTIONS(ref_vec.begin(), ref_vec.end(),
+                                          test_vec.begin(), test_vec.end());
+            SMO_freeMemory((void*)series);
+        }
+    }
+}
+
+BOOST_FIXTURE_TEST_CASE(test_getElementSeries_system, Fixture) {
+    int index   = 0;
+    int attr    = SMO_runoff_flow;
+    float* ref  = NULL;
+    int ref_dim = 0;
+
+    error = SMO_getElementSeries(p_handle, SMO_sys, &index, 1, &attr, 1, 0, 36,
+                                 &array, &array_dim);
+    BOOST_REQUIRE(error == 0);
+    error = SMO_getSystemSeries(p_handle, SMO_runoff_flow, 0, 36, &ref, &ref_dim);
+    BOOST_REQUIRE(error == 0);
+
+    BOOST_CHECK_EQUAL_COLLECTIONS(ref, ref + ref_dim, array, array + array_dim);
+    SMO_freeMemory((void*)ref);
+}
+
+BOOST_FIXTURE_TEST_CASE(test_getElementSeries_errors, Fixture) {
+    int links[2] = {1, 13};
+    int attrs[1] = {SMO_flow_rate_link};
+
+    // link index out of range
+    error = SMO_getElementSeries(p_handle, SMO_link, links, 2, attrs, 1, 0, 10,
+                                 &array, &array_dim);
+    BOOST_CHECK(error == 423);
+
+    // period beyond end of results
+    error = SMO_getElementSeries(p_handle, SMO_link, links, 1, attrs, 1, 0, 37,
+                                 &array, &array_dim);
+    BOOST_CHECK(error == 422);
+
+    // attribute out of range
+    attrs[0] = 99;
+    error = SMO_getElementSeries(p_handle, SMO_link, links, 1, attrs, 1, 0, 10,
+                                 &array, &array_dim);
+    BOOST_CHECK(error == 421);
+}
+
 BOOST_FIXTURE_TEST_CASE(test_getSubcatchResult, Fixture) {
     error = SMO_getSubcatchResult(p_handle, 1, 1, &array, &array_dim);
     BOOST_REQUIRE(error == 0);
@@ -361,3 +433,185 @@ BOOST_FIXTURE_TEST_CASE(test_getSystemResult, Fixture) {
 }
 
 BOOST_AUTO_TEST_SUITE_END()
+
+// Writes a copy of an output file with its results rearranged into the
+// columnar layout using chunks of the given number of periods (and
+// packed in blocks of the given number of series if blockSeries > 0)
+static void writeColumnarCopy(const char* src, const char* dst, int chunk,
+                              int blockSeries = 0)
+{
+    std::vector<char> in;
+    FILE* f = fopen(src, "rb");
+    int c;
+
+    while ((c = fgetc(f)) != EOF)
+        in.push_back((char)c);
+    fclose(f);
+
+    int epilogue[6];
+    memcpy(epilogue, &in[in.size() - sizeof(epilogue)], sizeof(epilogue));
+    long resultsPos = epilogue[2];
+    int  nPeriods   = epilogue[3];
+    long bytesPerPeriod =
+        ((long)in.size() - (long)sizeof(epilogue) - resultsPos) / nPeriods;
+    long nValues = (bytesPerPeriod - 8) / 4;
+
+    f = fopen(dst, "wb");
+    fwrite(&in[0], 1, resultsPos, f);
+    std::vector<long long> chunkPos(1, resultsPos);
+    for (int first = 0; first < nPeriods; first += chunk) {
+        int n = std::min(chunk, nPeriods - first);
+        long long bytes = 8 * n;
+        for (int i = 0; i < n; i++)
+            fwrite(&in[resultsPos + (first + i) * bytesPerPeriod], 8, 1, f);
+        std::vector<float> series(nValues * n);
+        for (long k = 0; k < nValues; k++)
+            for (int i = 0; i < n; i++)
+                memcpy(&series[k * n + i],
+                       &in[resultsPos + (first + i) * bytesPerPeriod + 8 + k * 4],
+                       4);
+        if (blockSeries == 0) {
+            fwrite(&series[0], 4, series.size(), f);
+            continue;
+        }
+        std::vector<int> sizes;
+        for (long k = 0; k < nValues; k += blockSeries) {
+            long m = std::min((long)blockSeries, nValues - k);
+            std::vector<unsigned char> work(4 * m * n);
+            std::vector<unsigned char> packed(outcodec_bound(m * n));
+            sizes.push_back((int)outcodec_pack(&series[k * n], m, n, &work[0],
+                                               &packed[0]));
+            fwrite(&packed[0], 1, sizes.back(), f);
+            bytes += sizes.back();
+        }
+        fwrite(&sizes[0], sizeof(int), sizes.size(), f);
+        chunkPos.push_back(chunkPos.back() + bytes + 4 * sizes.size());
+    }
+    if (blockSeries > 0) {
+        fwrite(&chunkPos[0], sizeof(long long), chunkPos.size(), f);
+        fwrite(&blockSeries, sizeof(int), 1, f);
+    }
+    int trailer[2] = {blockSeries > 0 ? 2 : 1, chunk};
+    fwrite(trailer, sizeof(int), 2, f);
+    epilogue[5] = 516114523;
+    fwrite(epilogue, sizeof(int), 6, f);
+    fclose(f);
+}
+
+struct ColumnarFixture {
+    ColumnarFixture(int blockSeries = 0) {
+        writeColumnarCopy(DATA_PATH, "./tmp_columnar.out", 5, blockSeries);
+        SMO_init(&std_handle);
+        std_error = SMO_open(std_handle, DATA_PATH);
+        SMO_init(&col_handle);
+        col_error = SMO_open(col_handle, "./tmp_columnar.out");
+    }
+    ~ColumnarFixture() {
+        SMO_close(std_handle);
+        SMO_close(col_handle);
+        remove("./tmp_columnar.out");
+    }
+
+    int        std_error;
+    int        col_error;
+    SMO_Handle std_handle;
+    SMO_Handle col_handle;
+};
+
+// Packs blocks of 40 series so that the last block of each chunk is partial
+struct CompressedFixture : ColumnarFixture {
+    CompressedFixture() : ColumnarFixture(40) {}
+};
+
+static void checkSeries(SMO_Handle std_handle, SMO_Handle col_handle)
+{
+    int    nPeriods, len1, len2;
+    float *series1, *series2;
+
+    SMO_getTimes(col_handle, SMO_numPeriods, &nPeriods);
+    BOOST_REQUIRE_EQUAL(nPeriods, 36);
+
+    // every node & link series, including ones that start and end
+    // part way through a chunk, must match the standard layout
+    for (int i = 0; i < 14; i++) {
+        for (int j = SMO_invert_depth; j <= SMO_flooding_losses; j++) {
+            SMO_getNodeSeries(std_handle, i, (SMO_nodeAttribute)j, 3, 33,
+                              &series1, &len1);
+            SMO_getNodeSeries(col_handle, i, (SMO_nodeAttribute)j, 3, 33,
+                              &series2, &len2);
+            BOOST_CHECK_EQUAL_COLLECTIONS(series1, series1 + len1,
+                                          series2, series2 + len2);
+            SMO_freeMemory((void*)series1);
+            SMO_freeMemory((void*)series2);
+        }
+    }
+    for (int i = 0; i < 13; i++) {
+        SMO_getLinkSeries(std_handle, i, SMO_flow_rate_link, 0, nPeriods,
+                          &series1, &len1);
+        SMO_getLinkSeries(col_handle, i, SMO_flow_rate_link, 0, nPeriods,
+                          &series2, &len2);
+        BOOST_CHECK_EQUAL_COLLECTIONS(series1, series1 + len1,
+                                      series2, series2 + len2);
+        SMO_freeMemory((void*)series1);
+        SMO_freeMemory((void*)series2);
+    }
+}
+
+static void checkResults(SMO_Handle std_handle, SMO_Handle col_handle)
+{
+    int    len1, len2;
+    float *values1, *values2;
+    int    links[3] = {0, 7, 12};
+    int    attrs[2] = {SMO_flow_rate_link, SMO_capacity};
+
+    for (int t = 0; t < 36; t += 7) {
+        SMO_getNodeResult(std_handle, t, 6, &values1, &len1);
+        SMO_getNodeResult(col_handle, t, 6, &values2, &len2);
+        BOOST_CHECK_EQUAL_COLLECTIONS(values1, values1 + len1,
+                                      values2, values2 + len2);
+        SMO_freeMemory((void*)values1);
+        SMO_freeMemory((void*)values2);
+
+        SMO_getSystemResult(std_handle, t, 0, &values1, &len1);
+        SMO_getSystemResult(col_handle, t, 0, &values2, &len2);
+        BOOST_CHECK_EQUAL_COLLECTIONS(values1, values1 + len1,
+                                      values2, values2 + len2);
+        SMO_freeMemory((void*)values1);
+        SMO_freeMemory((void*)values2);
+    }
+
+    SMO_getElementSeries(std_handle, SMO_link, links, 3, attrs, 2, 4, 36,
+                         &values1, &len1);
+    SMO_getElementSeries(col_handle, SMO_link, links, 3, attrs, 2, 4, 36,
+                         &values2, &len2);
+    BOOST_CHECK_EQUAL_COLLECTIONS(values1, values1 + len1,
+                                  values2, values2 + len2);
+    SMO_freeMemory((void*)values1);
+    SMO_freeMemory((void*)values2);
+}
+
+BOOST_AUTO_TEST_SUITE(test_output_columnar)
+
+BOOST_FIXTURE_TEST_CASE(test_columnar_series, ColumnarFixture) {
+    BOOST_REQUIRE(std_error == 0);
+    BOOST_REQUIRE(col_error == 0);
+    checkSeries(std_handle, col_handle);
+}
+
+BOOST_FIXTURE_TEST_CASE(test_columnar_results, ColumnarFixture) {
+    BOOST_REQUIRE(col_error == 0);
+    checkResults(std_handle, col_handle);
+}
+
+BOOST_FIXTURE_TEST_CASE(test_compressed_series, CompressedFixture) {
+    BOOST_REQUIRE(std_error == 0);
+    BOOST_REQUIRE(col_error == 0);
+    checkSeries(std_handle, col_handle);
+}
+
+BOOST_FIXTURE_TEST_CASE(test_compressed_results, CompressedFixture) {
+    BOOST_REQUIRE(col_error == 0);
+    checkResults(std_handle, col_handle);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,161 @@
+/*
+ ******************************************************************************
+ Project:      OWA SWMM
+ Version:      5.2.4
+ Module:       test_controls.cpp
+ Description:  tests for evaluating control rules
+ Authors:      see AUTHORS
+ Copyright:    see AUTHORS
+ License:      see LICENSE
+ Last Updated: 10/16/2026
+ ******************************************************************************
+*/
+
+#include <cstdio>
+#include <fstream>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include "test_solver.hpp"
+
+#define DATA_PATH_INP_CONTROLS "tmp_controls.inp"
+
+using namespace std;
+
+
+// Links whose settings are controlled by rules
+static const char *Links[] = {"OR1", "OR2", "W1", "OR3"};
+#define LINKS 4
+
+// Writes a storage unit filled by a storm hydrograph and drained through
+// three orifices and a weir whose settings are set by control rules. If
+// forced is true, each rule gets a premise on the simulation time that
+// never changes its result but has it evaluated at every time step.
+static void writeControls(bool forced)
+{
+    string always = forced ? "IF SIMULATION TIME < 0\nOR " : "IF ";
+    ofstream out(DATA_PATH_INP_CONTROLS);
+
+    out << "[OPTIONS]\nFLOW_UNITS CFS\nFLOW_ROUTING DYNWAVE\n"
+        << "START_DATE 01/01/2020\nSTART_TIME 00:00:00\n"
+        << "END_DATE 01/01/2020\nEND_TIME 06:00:00\n"
+        << "REPORT_STEP 00:15:00\nROUTING_STEP 0:00:30\n\n"
+        << "[JUNCTIONS]\nJ2 0 10 0 0 0\n\n"
+        << "[OUTFALLS]\nOUT -1 FREE NO\n\n"
+        << "[STORAGE]\nSU1 0 12 0 FUNCTIONAL 0 0 5000 0 0\n\n"
+        << "[CONDUITS]\nC1 J2 OUT 400 0.01 0 0 0 0\n\n"
+        << "[ORIFICES]\nOR1 SU1 J2 BOTTOM 0 0.65 NO 0\n"
+        << "OR2 SU1 J2 BOTTOM 0 0.65 NO 0\n"
+        << "OR3 SU1 J2 BOTTOM 0 0.65 NO 0\n\n"
+        << "[WEIRS]\nW1 SU1 J2 TRANSVERSE 6 3.33 NO 0 0\n\n"
+        << "[XSECTIONS]\nC1 CIRCULAR 4 0 0 0 1\n"
+        << "OR1 CIRCULAR 1 0 0 0\nOR2 RECT_CLOSED 0.5 1 0 0\n"
+        << "OR3 CIRCULAR 0.5 0 0 0\nW1 RECT_OPEN 4 5 0 0\n\n"
+        << "[INFLOWS]\nSU1 FLOW STORM\n\n"
+        << "[TIMESERIES]\nSTORM 0:00 0\nSTORM 1:00 40\nSTORM 2:00 40\n"
+        << "STORM 3:00 0\n\n"
+        << "[CURVES]\nOPENING CONTROL 0 0\nOPENING 2 0.3\nOPENING 8 1\n\n";
+
+    // --- a fixed setting that changes with the depth in the storage
+    //     unit, settings read from a curve of that depth and of another
+    //     link's setting, a setting that follows another link's setting
+    //     and one that closes an orifice when water backs up from the
+    //     junction
+    out << "[CONTROLS]\n"
+        << "RULE R1\n" << always << "NODE SU1 DEPTH > 4\n"
+        << "THEN ORIFICE OR1 SETTING = 1\nELSE ORIFICE OR1 SETTING = 0.2\n\n"
+        << "RULE R2\n" << always << "ORIFICE OR1 SETTING > 0\n"
+        << "THEN ORIFICE OR3 SETTING = CURVE OPENING\n\n"
+        << "RULE R3\n" << always << "NODE SU1 DEPTH > 0.5\n"
+        << "THEN ORIFICE OR2 SETTING = CURVE OPENING\n"
+        << "ELSE ORIFICE OR2 SETTING = 0\n\n"
+        << "RULE R4\n" << always << "ORIFICE OR1 SETTING = 1\n"
+        << "THEN WEIR W1 SETTING = 0.5\nELSE WEIR W1 SETTING = 1\n\n"
+        << "RULE R5\n" << always << "NODE J2 DEPTH > NODE SU1 DEPTH\n"
+        << "THEN ORIFICE OR2 SETTING = 0\nPRIORITY 5\n\n";
+}
+
+// Runs the project, saving the settings of the controlled links and the
+// depth in the storage unit at each time step
+static int runControls(vector<vector<double>> &settings, vector<double> &depths)
+{
+    int    i, error, su1, links[LINKS];
+    double value, elapsedTime = 0.0;
+
+    settings.assign(LINKS, vector<double>());
+    depths.clear();
+    error = swmm_open(DATA_PATH_INP_CONTROLS, DATA_PATH_RPT, DATA_PATH_OUT);
+    for (i = 0; i < LINKS && !error; i++)
+        error = swmm_getObjectIndex(SM_LINK, (char *)Links[i], &links[i]);
+    if ( !error ) error = swmm_getObjectIndex(SM_NODE, (char *)"SU1", &su1);
+    if ( !error ) error = swmm_start(0);
+    if ( !error )
+    {
+        do
+        {
+            error = swmm_step(&elapsedTime);
+            for (i = 0; i < LINKS && !error; i++)
+            {
+                error = swmm_getLinkResult(links[i], SM_SETTING, &value);
+                settings[i].push_back(value);
+            }
+            if ( !error ) error = swmm_getNodeResult(su1, SM_NODEDEPTH, &value);
+            depths.push_back(value);
+        } while ( elapsedTime > 0.0 && !error );
+        swmm_end();
+    }
+    swmm_close();
+    return error;
+}
+
+
+BOOST_AUTO_TEST_SUITE(test_controls)
+
+BOOST_AUTO_TEST_CASE(changing_premises) {
+    vector<vector<double>> settings, forcedSettings;
+    vector<double> depths, forcedDepths;
+
+    writeControls(false);
+    BOOST_REQUIRE_EQUAL(runControls(settings, depths), 0);
+    writeControls(true);
+    BOOST_REQUIRE_EQUAL(runControls(forcedSettings, forcedDepths), 0);
+
+    // --- rules whose premise variables keep their values between steps
+    //     act the same as rules evaluated at every step
+    BOOST_CHECK(settings == forcedSettings);
+    BOOST_CHECK(depths == forcedDepths);
+
+    // --- the storage unit fills past the depth of rule R1 and drains
+    //     again, so OR1 opens and later closes back down, and rule R4
+    //     follows it with the setting of W1
+    vector<double> &or1 = settings[0], &or2 = settings[1], &w1 = settings[2],
+                   &or3 = settings[3];
+    size_t open = 0, shut = 0;
+    for (size_t i = 1; i < or1.size(); i++)
+    {
+        if ( or1[i] == 1.0 && or1[i-1] == 0.2 && !open ) open = i;
+        if ( or1[i] == 0.2 && or1[i-1] == 1.0 && open ) shut = i;
+    }
+    BOOST_REQUIRE(open > 0);
+    BOOST_REQUIRE(shut > open);
+    BOOST_CHECK(or1.back() == 0.2);
+    for (size_t i = 1; i < w1.size(); i++)
+        BOOST_CHECK_EQUAL(w1[i], or1[i-1] == 1.0 ? 0.5 : 1.0);
+
+    // --- OR2's setting follows its curve as the depth changes
+    set<double> or2Settings(or2.begin(), or2.end());
+    BOOST_CHECK(or2Settings.size() > 10);
+    BOOST_CHECK(or2Settings.count(0.0) == 1);
+
+    // --- OR3's setting comes from its curve at OR1's setting, which a
+    //     rule that is not re-evaluated must still supply
+    set<double> or3Settings(or3.begin() + 1, or3.end());
+    BOOST_CHECK(or3Settings == set<double>({0.03, 0.15}));
+
+    remove(DATA_PATH_INP_CONTROLS);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,366 @@
+/*
+ ******************************************************************************
+ Project:      OWA SWMM
+ Version:      5.2.4
+ Module:       test_dynwave_solver.cpp
+ Description:  tests for the solver options of dynamic wave routing
+ Authors:      see AUTHORS
+ Copyright:    see AUTHORS
+ License:      see LICENSE
+ Last Updated: 10/16/2026
+ ******************************************************************************
+*/
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+#include <boost/test/unit_test.hpp>
+
+#include "test_solver.hpp"
+
+#define DATA_PATH_INP_SOLVER "tmp_dynwave_solver.inp"
+
+using namespace std;
+
+
+// Runs a project and returns its flow routing continuity error (%),
+// number of routing steps and system outflow volume (and optionally the
+// number of threads it was given and of sub-domains it was split into)
+static int runProject(const char *inpFile, float *flowErr, double *steps,
+                      double *outflow, double *threads = NULL,
+                      double *domains = NULL)
+{
+    int   error;
+    float runoffErr, qualErr;
+    SM_Profile profile = {0};
+    SM_RoutingTotals totals = {0};
+
+    error = swmm_open(inpFile, DATA_PATH_RPT, DATA_PATH_OUT);
+    if ( !error && threads ) error = swmm_getSimulationParam(SM_THREADS, threads);
+    if ( !error ) error = swmm_start(0);
+    if ( !error )
+    {
+        double elapsedTime = 0.0;
+        do error = swmm_step(&elapsedTime);
+        while ( elapsedTime > 0.0 && !error );
+        if ( !error ) error = swmm_getSystemRoutingTotals(&totals);
+        swmm_end();
+    }
+    if ( !error ) error = swmm_getMassBalErr(&runoffErr, flowErr, &qualErr);
+    if ( !error ) error = swmm_getProfile(&profile);
+    *steps = profile.routingSteps;
+    *outflow = totals.outflow;
+    if ( domains ) *domains = profile.routingDomains;
+    swmm_close();
+    return error;
+}
+
+
+// Copies the dynamic wave example with an option line added in place
+// of any line it has for the same option
+static void writeOptionCopy(const char *option)
+{
+    string line;
+    string keyword = string(option).substr(0, string(option).find(' '));
+    ifstream in(DATA_PATH_INP_INLETS_AND_DRAINS);
+    ofstream out(DATA_PATH_INP_SOLVER);
+
+    while ( getline(in, line) )
+    {
+        if ( line.substr(0, line.find_first_of(" \t")) == keyword ) continue;
+        out << line << "\n";
+        if ( line.find("[OPTIONS]") == 0 )
+            out << option << "\n";
+    }
+}
+
+
+// Writes a binary tree of junctions draining to one outfall (so it has
+// more nodes than links), with an option line added to its [OPTIONS]
+static void writeTreeNetwork(const char *option, int junctions)
+{
+    int   k, level, levels = 0;
+    ofstream out(DATA_PATH_INP_SOLVER);
+
+    for (k = junctions; k > 0; k /= 2) levels++;
+    out << "[OPTIONS]\n" << option << "\n"
+        << "FLOW_UNITS CFS\nFLOW_ROUTING DYNWAVE\n"
+        << "START_DATE 01/01/2020\nSTART_TIME 00:00:00\n"
+        << "END_DATE 01/01/2020\nEND_TIME 03:00:00\n"
+        << "REPORT_STEP 00:15:00\nROUTING_STEP 0:00:10\n"
+        << "VARIABLE_STEP 0.75\n\n";
+
+    // --- junction k drains to junction k/2 and junction 1 to the outfall
+    out << "[JUNCTIONS]\n";
+    for (k = 1; k <= junctions; k++)
+    {
+        for (level = 0; (k >> level) > 1; level++);
+        out << "J" << k << " " << 10 + level << " 10 0 0 0\n";
+    }
+    out << "\n[OUTFALLS]\nOUT 0 FREE NO\n\n[CONDUITS]\n";
+    for (k = 1; k <= junctions; k++)
+    {
+        out << "C" << k << " J" << k << " ";
+        if ( k == 1 ) out << "OUT";
+        else out << "J" << k / 2;
+        out << " 400 0.01 0 0 0 0\n";
+    }
+
+    // --- pipes grow toward the outfall
+    out << "\n[XSECTIONS]\n";
+    for (k = 1; k <= junctions; k++)
+    {
+        for (level = 0; (k >> level) > 1; level++);
+        out << "C" << k << " CIRCULAR " << 1.0 + 0.5 * (levels - level)
+            << " 0 0 0 1\n";
+    }
+
+    // --- a storm hydrograph enters at each leaf junction
+    out << "\n[INFLOWS]\n";
+    for (k = junctions / 2 + 1; k <= junctions; k++)
+        out << "J" << k << " FLOW HYDROGRAPH FLOW 1.0 1.0\n";
+    out << "\n[TIMESERIES]\nHYDROGRAPH 0:00 0\nHYDROGRAPH 0:30 0.5\n"
+        << "HYDROGRAPH 1:00 0.2\nHYDROGRAPH 2:00 0\n";
+}
+
+
+// Writes a square grid of junctions whose columns drain through short
+// sewers to a trunk line and an outfall, with cross connections between
+// columns, and whose junctions flood under a storm hydrograph (the fast
+// sewers need local time steps much shorter than the trunk's)
+static void writeGridNetwork(const char *option, int size)
+{
+    int r, c;
+    ofstream out(DATA_PATH_INP_SOLVER);
+
+    out << "[OPTIONS]\n" << option << "\n"
+        << "FLOW_UNITS CFS\nFLOW_ROUTING DYNWAVE\n"
+        << "START_DATE 01/01/2020\nSTART_TIME 00:00:00\n"
+        << "END_DATE 01/01/2020\nEND_TIME 06:00:00\n"
+        << "REPORT_STEP 00:15:00\nROUTING_STEP 0:00:30\n"
+        << "VARIABLE_STEP 0.75\n\n";
+
+    out << "[JUNCTIONS]\n";
+    for (r = 0; r < size; r++)
+        for (c = 0; c < size; c++)
+            out << "J" << r << "_" << c << " " << 10.0 * (size - r) + 0.05 * c
+                << " 8 0 0 200\n";
+    out << "\n[OUTFALLS]\nOUT " << 0.05 * size - 1.0 << " FREE NO\n\n";
+
+    // --- column sewers, trunk line & cross connections
+    out << "[CONDUITS]\n";
+    for (c = 0; c < size; c++)
+    {
+        for (r = 0; r < size - 1; r++)
+            out << "V" << r << "_" << c << " J" << r << "_" << c
+                << " J" << r + 1 << "_" << c << " 400 0.013 0 0\n";
+        if ( c > 0 )
+            out << "H" << c << " J" << size - 1 << "_" << c
+                << " J" << size - 1 << "_" << c - 1 << " 400 0.013 0 0\n";
+        for (r = 1; c % 2 == 1 && r < size - 1; r += 4)
+            out << "X" << r << "_" << c << " J" << r << "_" << c - 1
+                << " J" << r << "_" << c << " 300 0.015 1 1\n";
+    }
+    out << "HOUT J" << size - 1 << "_0 OUT 400 0.013 0 0\n\n";
+    out << "[XSECTIONS]\n";
+    for (c = 0; c < size; c++)
+    {
+        for (r = 0; r < size - 1; r++)
+            out << "V" << r << "_" << c << " CIRCULAR 2 0 0 0 1\n";
+        if ( c > 0 )
+            out << "H" << c << " CIRCULAR " << 3.0 + 0.1 * c << " 0 0 0 1\n";
+        for (r = 1; c % 2 == 1 && r < size - 1; r += 4)
+            out << "X" << r << "_" << c << " CIRCULAR 1 0 0 0 1\n";
+    }
+    out << "HOUT CIRCULAR " << 3.0 + 0.1 * size << " 0 0 0 1\n\n";
+
+    // --- the same storm hydrograph, scaled a little differently, enters
+    //     at every junction
+    out << "[TIMESERIES]\nHYD 0:00 0\nHYD 1:00 2\nHYD 3:00 0\n\n";
+    out << "[INFLOWS]\n";
+    for (r = 0; r < size; r++)
+        for (c = 0; c < size; c++)
+            out << "J" << r << "_" << c << " FLOW HYD FLOW 1.0 "
+                << 0.5 + 0.01 * ((r * 7 + c * 3) % 50) << "\n";
+}
+
+
+BOOST_AUTO_TEST_SUITE(test_dynwave_solver)
+
+BOOST_AUTO_TEST_CASE(newton_solver) {
+    float  picardErr, newtonErr;
+    double picardSteps, newtonSteps;
+    double picardOutflow, newtonOutflow;
+
+    writeOptionCopy("DYNWAVE_SOLVER PICARD");
+    BOOST_REQUIRE_EQUAL(runProject(DATA_PATH_INP_SOLVER, &picardErr,
+                                   &picardSteps, &picardOutflow), 0);
+    writeOptionCopy("DYNWAVE_SOLVER NEWTON");
+    BOOST_REQUIRE_EQUAL(runProject(DATA_PATH_INP_SOLVER, &newtonErr,
+                                   &newtonSteps, &newtonOutflow), 0);
+
+    // --- Newton iterations take fewer, larger time steps with a
+    //     comparable solution
+    BOOST_CHECK(fabs(newtonErr) < 1.0);
+    BOOST_CHECK(newtonSteps < picardSteps);
+    BOOST_CHECK_CLOSE(newtonOutflow, picardOutflow, 1.0);
+
+    remove(DATA_PATH_INP_SOLVER);
+}
+
+BOOST_AUTO_TEST_CASE(bad_solver_name) {
+    float  flowErr;
+    double steps, outflow;
+
+    writeOptionCopy("DYNWAVE_SOLVER GAUSS");
+    BOOST_CHECK(runProject(DATA_PATH_INP_SOLVER, &flowErr, &steps,
+                           &outflow) != 0);
+
+    remove(DATA_PATH_INP_SOLVER);
+}
+
+BOOST_AUTO_TEST_CASE(active_set) {
+    float  allErr, activeErr;
+    double allSteps, activeSteps;
+    double allOutflow, activeOutflow;
+
+    writeOptionCopy("ACTIVE_SET NO");
+    BOOST_REQUIRE_EQUAL(runProject(DATA_PATH_INP_SOLVER, &allErr,
+                                   &allSteps, &allOutflow), 0);
+    writeOptionCopy("ACTIVE_SET YES");
+    BOOST_REQUIRE_EQUAL(runProject(DATA_PATH_INP_SOLVER, &activeErr,
+                                   &activeSteps, &activeOutflow), 0);
+
+    // --- re-solving only unconverged nodes gives a comparable solution
+    BOOST_CHECK(fabs(activeErr) < 1.0);
+    BOOST_CHECK_CLOSE(activeOutflow, allOutflow, 0.1);
+
+    remove(DATA_PATH_INP_SOLVER);
+}
+
+BOOST_AUTO_TEST_CASE(local_step_classes) {
+    float  uniformErr, localErr;
+    double uniformSteps, localSteps;
+    double uniformOutflow, localOutflow;
+
+    writeOptionCopy("LOCAL_STEP_CLASSES 0");
+    BOOST_REQUIRE_EQUAL(runProject(DATA_PATH_INP_SOLVER, &uniformErr,
+                                   &uniformSteps, &uniformOutflow), 0);
+    writeOptionCopy("LOCAL_STEP_CLASSES 2");
+    BOOST_REQUIRE_EQUAL(runProject(DATA_PATH_INP_SOLVER, &localErr,
+                                   &localSteps, &localOutflow), 0);
+
+    // --- sub-stepping the fast conduits allows larger routing steps
+    //     with a comparable solution
+    BOOST_CHECK(fabs(localErr) < 1.0);
+    BOOST_CHECK(localSteps < uniformSteps);
+    BOOST_CHECK_CLOSE(localOutflow, uniformOutflow, 1.0);
+
+    remove(DATA_PATH_INP_SOLVER);
+}
+
+BOOST_AUTO_TEST_CASE(local_step_continuity) {
+    float  uniformErr, localErr;
+    double uniformSteps, localSteps;
+    double uniformOutflow, localOutflow;
+
+    writeGridNetwork("LOCAL_STEP_CLASSES 0", 10);
+    BOOST_REQUIRE_EQUAL(runProject(DATA_PATH_INP_SOLVER, &uniformErr,
+                                   &uniformSteps, &uniformOutflow), 0);
+    writeGridNetwork("LOCAL_STEP_CLASSES 3", 10);
+    BOOST_REQUIRE_EQUAL(runProject(DATA_PATH_INP_SOLVER, &localErr,
+                                   &localSteps, &localOutflow), 0);
+
+    // --- no volume is gained or lost where nodes of different step
+    //     classes meet, even with many flooded nodes
+    BOOST_TEST_MESSAGE("continuity error (%): uniform " << uniformErr
+                       << ", local " << localErr);
+    BOOST_CHECK_SMALL(localErr - uniformErr, 0.5f);
+    BOOST_CHECK(localSteps < uniformSteps);
+    BOOST_CHECK_CLOSE(localOutflow, uniformOutflow, 2.0);
+
+    remove(DATA_PATH_INP_SOLVER);
+}
+
+BOOST_AUTO_TEST_CASE(bad_step_classes) {
+    float  flowErr;
+    double steps, outflow;
+
+    writeOptionCopy("LOCAL_STEP_CLASSES 9");
+    BOOST_CHECK(runProject(DATA_PATH_INP_SOLVER, &flowErr, &steps,
+                           &outflow) != 0);
+
+    remove(DATA_PATH_INP_SOLVER);
+}
+
+BOOST_AUTO_TEST_CASE(thread_sub_domains) {
+    float  oneErr, manyErr;
+    double oneSteps, manySteps;
+    double oneOutflow, manyOutflow;
+    double threads, domains;
+
+    // --- a network with enough work to be shared by several threads
+    writeTreeNetwork("THREADS 1", 1023);
+    BOOST_REQUIRE_EQUAL(runProject(DATA_PATH_INP_SOLVER, &oneErr,
+                                   &oneSteps, &oneOutflow, &threads,
+                                   &domains), 0);
+    BOOST_CHECK_EQUAL(domains, 1.0);
+    writeTreeNetwork("THREADS 4", 1023);
+    BOOST_REQUIRE_EQUAL(runProject(DATA_PATH_INP_SOLVER, &manyErr,
+                                   &manySteps, &manyOutflow, &threads,
+                                   &domains), 0);
+
+    // --- each thread granted gets a sub-domain (ctest grants 4 threads
+    //     to OpenMP builds that are not reentrant)
+    BOOST_TEST_MESSAGE("threads: " << threads << ", sub-domains: " << domains);
+    BOOST_CHECK_EQUAL(domains, threads);
+
+    // --- splitting the network among threads does not change results
+    BOOST_CHECK(fabs(oneErr) < 1.0);
+    BOOST_CHECK_EQUAL(manyErr, oneErr);
+    BOOST_CHECK_EQUAL(manySteps, oneSteps);
+    BOOST_CHECK_EQUAL(manyOutflow, oneOutflow);
+
+    remove(DATA_PATH_INP_SOLVER);
+}
+
+BOOST_AUTO_TEST_CASE(network_ordering) {
+    float  inputErr, rcmErr;
+    double inputSteps, rcmSteps;
+    double inputOutflow, rcmOutflow;
+
+    writeOptionCopy("NETWORK_ORDERING INPUT");
+    BOOST_REQUIRE_EQUAL(runProject(DATA_PATH_INP_SOLVER, &inputErr,
+                                   &inputSteps, &inputOutflow), 0);
+    writeOptionCopy("NETWORK_ORDERING RCM");
+    BOOST_REQUIRE_EQUAL(runProject(DATA_PATH_INP_SOLVER, &rcmErr,
+                                   &rcmSteps, &rcmOutflow), 0);
+
+    // --- renumbering the solver's nodes & links does not change results
+    BOOST_CHECK_EQUAL(rcmErr, inputErr);
+    BOOST_CHECK_EQUAL(rcmSteps, inputSteps);
+    BOOST_CHECK_EQUAL(rcmOutflow, inputOutflow);
+
+    // --- a tree network has more nodes than links
+    writeTreeNetwork("NETWORK_ORDERING INPUT", 63);
+    BOOST_REQUIRE_EQUAL(runProject(DATA_PATH_INP_SOLVER, &inputErr,
+                                   &inputSteps, &inputOutflow), 0);
+    writeTreeNetwork("NETWORK_ORDERING RCM", 63);
+    BOOST_REQUIRE_EQUAL(runProject(DATA_PATH_INP_SOLVER, &rcmErr,
+                                   &rcmSteps, &rcmOutflow), 0);
+    BOOST_CHECK(fabs(inputErr) < 1.0);
+    BOOST_CHECK(inputOutflow > 0.0);
+    BOOST_CHECK_EQUAL(rcmErr, inputErr);
+    BOOST_CHECK_EQUAL(rcmSteps, inputSteps);
+    BOOST_CHECK_EQUAL(rcmOutflow, inputOutflow);
+
+    writeOptionCopy("NETWORK_ORDERING DFS");
+    BOOST_CHECK(runProject(DATA_PATH_INP_SOLVER, &rcmErr, &rcmSteps,
+                           &rcmOutflow) != 0);
+
+    remove(DATA_PATH_INP_SOLVER);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
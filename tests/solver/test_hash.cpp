@@ -0,0 +1,137 @@
+/*
+ ******************************************************************************
+ Project:      OWA SWMM
+ Version:      5.2.4
+ Module:       test_hash.cpp
+ Description:  tests for hash tables of object names
+ Authors:      see AUTHORS
+ Copyright:    see AUTHORS
+ License:      see LICENSE
+ Last Updated: 10/16/2026
+ ******************************************************************************
+*/
+
+#include <cctype>
+#include <string>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+extern "C" {
+#include "hash.h"
+
+// defined in hash.c but not declared in hash.h
+unsigned int hash(const char *str);
+}
+
+using namespace std;
+
+
+// Returns a copy of a key with the case of its letters swapped
+static string swapCase(const string &key)
+{
+    string s(key);
+    for (char &c : s) c = isupper(c) ? tolower(c) : toupper(c);
+    return s;
+}
+
+// Returns keys whose hash values all start at the same slot of a table
+// with the initial number of slots
+static vector<string> collidingKeys(unsigned int slot, int count)
+{
+    vector<string> keys;
+    for (int i = 0; (int)keys.size() < count; i++)
+    {
+        string key = "Node" + to_string(i);
+        if ( (::hash(key.c_str()) & (HTMINSIZE - 1)) == slot )
+            keys.push_back(key);
+    }
+    return keys;
+}
+
+
+BOOST_AUTO_TEST_SUITE(test_hash)
+
+BOOST_AUTO_TEST_CASE(collisions) {
+    // --- keys that collide at the last slot wrap around to the first
+    //     slots, alongside keys that start there
+    vector<string> keys = collidingKeys(HTMINSIZE - 1, 8);
+    vector<string> front = collidingKeys(0, 4);
+    keys.insert(keys.end(), front.begin(), front.end());
+    HTtable *ht = HTcreate();
+    BOOST_REQUIRE(ht != NULL);
+
+    for (size_t i = 0; i < keys.size(); i++)
+        BOOST_REQUIRE(HTinsert(ht, &keys[i][0], (int)i));
+    BOOST_CHECK_EQUAL(ht->size, (unsigned)HTMINSIZE);
+    BOOST_CHECK_EQUAL(ht->count, keys.size());
+    for (size_t i = 0; i < keys.size(); i++)
+    {
+        BOOST_CHECK_EQUAL(HTfind(ht, keys[i].c_str()), (int)i);
+        BOOST_CHECK(HTfindKey(ht, keys[i].c_str()) == &keys[i][0]);
+    }
+
+    // --- a missing key that collides with them is not found
+    vector<string> more = collidingKeys(HTMINSIZE - 1, 9);
+    BOOST_CHECK_EQUAL(HTfind(ht, more[8].c_str()), NOTFOUND);
+    BOOST_CHECK(HTfindKey(ht, more[8].c_str()) == NULL);
+    HTfree(ht);
+}
+
+BOOST_AUTO_TEST_CASE(growth) {
+    const int n = 5000;
+    vector<string> keys;
+    for (int i = 0; i < n; i++) keys.push_back("J" + to_string(i * 7919));
+    HTtable *ht = HTcreate();
+    BOOST_REQUIRE(ht != NULL);
+
+    // --- the number of slots doubles to keep the table under half full
+    for (int i = 0; i < n; i++)
+    {
+        unsigned int size = ht->size;
+        BOOST_REQUIRE(HTinsert(ht, &keys[i][0], i));
+        BOOST_CHECK_EQUAL(ht->count, (unsigned)(i + 1));
+        BOOST_CHECK(ht->size == size || ht->size == 2 * size);
+        BOOST_CHECK(2 * ht->count <= ht->size);
+    }
+    BOOST_CHECK_EQUAL(ht->size, 16384u);
+
+    // --- every key is still found after the table has grown
+    for (int i = 0; i < n; i++)
+        BOOST_CHECK_EQUAL(HTfind(ht, keys[i].c_str()), i);
+    BOOST_CHECK_EQUAL(HTfind(ht, "J1"), NOTFOUND);
+    BOOST_CHECK_EQUAL(HTfind(ht, "J"), NOTFOUND);
+    HTfree(ht);
+}
+
+BOOST_AUTO_TEST_CASE(case_insensitive) {
+    vector<string> keys = {"Outfall_1", "junction-a", "PUMP", "Storage.Unit2",
+                           "weir", "x"};
+    HTtable *ht = HTcreate();
+    BOOST_REQUIRE(ht != NULL);
+    for (size_t i = 0; i < keys.size(); i++)
+        BOOST_REQUIRE(HTinsert(ht, &keys[i][0], (int)i));
+
+    // --- keys are found whatever the case of their letters
+    for (size_t i = 0; i < keys.size(); i++)
+    {
+        string other = swapCase(keys[i]);
+        BOOST_CHECK_EQUAL(::hash(other.c_str()), ::hash(keys[i].c_str()));
+        BOOST_CHECK_EQUAL(HTfind(ht, other.c_str()), (int)i);
+        BOOST_CHECK(HTfindKey(ht, other.c_str()) == &keys[i][0]);
+    }
+
+    // --- but other characters must match exactly
+    BOOST_CHECK_EQUAL(HTfind(ht, "junction_a"), NOTFOUND);
+    BOOST_CHECK_EQUAL(HTfind(ht, "Outfall_1 "), NOTFOUND);
+    BOOST_CHECK_EQUAL(HTfind(ht, "PUM"), NOTFOUND);
+
+    // --- inserting a key again in another case replaces its data
+    string pump = "Pump";
+    BOOST_REQUIRE(HTinsert(ht, &pump[0], 99));
+    BOOST_CHECK_EQUAL(ht->count, keys.size());
+    BOOST_CHECK_EQUAL(HTfind(ht, "PUMP"), 99);
+    HTfree(ht);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,245 @@
+/*
+ ******************************************************************************
+ Project:      OWA SWMM
+ Version:      5.2.4
+ Module:       test_input.cpp
+ Description:  tests for reading input files in parallel
+ Authors:      see AUTHORS
+ Copyright:    see AUTHORS
+ License:      see LICENSE
+ Last Updated: 10/16/2026
+ ******************************************************************************
+*/
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include "test_solver.hpp"
+
+#define DATA_PATH_INP_INPUT "tmp_input.inp"
+
+// Size of the generated network, which has more lines in each parsed
+// section than are needed to parse them in parallel
+#define JUNCTIONS 300
+#define TSERIES   20
+
+// Error code returned when an input file has errors
+#define ERR_INPUT 200
+
+using namespace std;
+
+
+// The lines of a generated input file
+struct InputFile {
+    vector<string> lines;
+
+    // --- adds a line and returns its line number
+    int add(const string &line) {
+        lines.push_back(line);
+        return (int)lines.size();
+    }
+
+    // --- writes the file with the THREADS option set to threads
+    void write(const string &threads) {
+        ofstream out(DATA_PATH_INP_INPUT);
+        for (const string &line : lines)
+        {
+            if ( line.find("THREADS ") == 0 ) out << "THREADS " << threads << "\n";
+            else out << line << "\n";
+        }
+    }
+};
+
+// An input error expected at a line of a section
+struct InputError {
+    int    code;
+    int    line;
+    string section;
+    string text;
+};
+
+// Writes a chain of junctions with their conduits, cross sections and
+// inflow time series, replacing the lines listed in bad with erroneous
+// versions and recording the errors they are expected to give
+static InputFile makeInput(const vector<string> &bad, vector<InputError> &errors)
+{
+    InputFile inp;
+    int k;
+
+    // --- bad lines are keyed by the line they replace
+    auto put = [&](const string &section, const string &line)
+    {
+        for (size_t i = 0; i + 2 < bad.size(); i += 3)
+        {
+            if ( bad[i] == line )
+            {
+                int n = inp.add(bad[i+1]);
+                errors.push_back({stoi(bad[i+2]), n, section, bad[i+1]});
+                return;
+            }
+        }
+        inp.add(line);
+    };
+
+    inp.add("[TITLE]");
+    inp.add("Parallel input test");
+    inp.add("");
+    inp.add("[OPTIONS]");
+    inp.add("THREADS 1");
+    inp.add("FLOW_UNITS CFS");
+    inp.add("FLOW_ROUTING DYNWAVE");
+    inp.add("START_DATE 01/01/2020");
+    inp.add("END_DATE 01/01/2020");
+    inp.add("END_TIME 01:00:00");
+    inp.add("");
+
+    inp.add("[JUNCTIONS]");
+    for (k = 1; k <= JUNCTIONS; k++)
+        put("JUNC", "J" + to_string(k) + " " + to_string(100 - k / 10.0) +
+                         " 10 0 0 0");
+    inp.add("");
+    inp.add("[OUTFALLS]");
+    inp.add("OUT 60 FREE NO");
+    inp.add("");
+
+    inp.add("[CONDUITS]");
+    inp.add(";;Name From To Length Roughness");
+    for (k = 1; k <= JUNCTIONS; k++)
+    {
+        string to = (k == JUNCTIONS) ? "OUT" : "J" + to_string(k + 1);
+        put("CONDUIT", "C" + to_string(k) + " J" + to_string(k) + " " + to +
+                        " 100 0.01 0 0 0 0");
+        if ( k % 50 == 0 ) inp.add("");
+    }
+    inp.add("");
+
+    inp.add("[XSECTIONS]");
+    for (k = 1; k <= JUNCTIONS; k++)
+        put("XSECT", "C" + to_string(k) + " CIRCULAR 2 0 0 0 1");
+    inp.add("");
+
+    // --- each junction takes inflow from one of the time series, whose
+    //     entries are interleaved
+    inp.add("[INFLOWS]");
+    for (k = 1; k <= JUNCTIONS; k++)
+        inp.add("J" + to_string(k) + " FLOW TS" + to_string(k % TSERIES + 1));
+    inp.add("");
+    inp.add("[TIMESERIES]");
+    for (int h = 0; h <= 6; h++)
+    {
+        for (k = 1; k <= TSERIES; k++)
+            put("TIMESERIES", "TS" + to_string(k) + " 0:" + to_string(10 * h) +
+                              " " + to_string((h % 3) * 0.1 * k));
+    }
+    inp.add("");
+    return inp;
+}
+
+// Opens the generated input file with a number of threads, returning the
+// error code and the report's text without the lines that record when it
+// was run
+static int openInput(InputFile &inp, const string &threads, string &report)
+{
+    string line;
+
+    inp.write(threads);
+    int error = swmm_open(DATA_PATH_INP_INPUT, DATA_PATH_RPT, DATA_PATH_OUT);
+    swmm_close();
+    ifstream in(DATA_PATH_RPT);
+    report.clear();
+    while ( getline(in, line) )
+    {
+        if ( line.find("Analysis begun") != string::npos ||
+             line.find("Analysis ended") != string::npos ||
+             line.find("Total elapsed") != string::npos ) continue;
+
+        // --- a reentrant build warns that it uses a single thread
+        if ( line.empty() || line.find("WARNING 13") != string::npos )
+            continue;
+        report += line + "\n";
+    }
+    return error;
+}
+
+// Checks that each expected error is reported, in file order, at the
+// line number it has in the input file (the report names a section by
+// the keyword that identifies it)
+static void checkErrors(const string &report, const vector<InputError> &errors)
+{
+    size_t pos = 0;
+    for (const InputError &e : errors)
+    {
+        string where = "at line " + to_string(e.line) + " of [" +
+                       e.section + "] section:\n  " + e.text;
+        size_t next = report.find(where, pos);
+        BOOST_CHECK_MESSAGE(next != string::npos, "missing: " << where);
+        if ( next == string::npos ) continue;
+        string code = "ERROR " + to_string(e.code);
+        BOOST_CHECK_EQUAL(report.rfind(code, next), report.rfind("ERROR", next));
+        pos = next;
+    }
+}
+
+
+BOOST_AUTO_TEST_SUITE(test_input)
+
+BOOST_AUTO_TEST_CASE(parallel_parse) {
+    vector<InputError> errors;
+    string serial, parallel;
+    InputFile inp = makeInput({}, errors);
+
+    // --- a project read by several threads (ctest grants 4 threads to
+    //     OpenMP builds) matches one read by a single thread
+    BOOST_REQUIRE_EQUAL(openInput(inp, "1", serial), 0);
+    BOOST_REQUIRE_EQUAL(openInput(inp, "4", parallel), 0);
+    BOOST_CHECK(serial == parallel);
+    remove(DATA_PATH_INP_INPUT);
+}
+
+BOOST_AUTO_TEST_CASE(parse_errors) {
+    vector<InputError> errors;
+    string serial, parallel;
+
+    // --- errors in each section read by several threads, including
+    //     lines that name unknown objects
+    InputFile inp = makeInput({
+        "C50 J50 J51 100 0.01 0 0 0 0",   "C50 J50 J51 abc 0.01 0 0 0 0", "211",
+        "C120 J120 J121 100 0.01 0 0 0 0", "C120 J120 JX 100 0.01 0 0 0 0", "209",
+        "C70 CIRCULAR 2 0 0 0 1",         "C70 BOGUS 2 0 0 0 1",          "205",
+        "C200 CIRCULAR 2 0 0 0 1",        "CX CIRCULAR 2 0 0 0 1",        "209",
+        "TS5 0:30 0.000000",              "TS5 0:30 x",                   "211",
+        "C299 CIRCULAR 2 0 0 0 1",        "C299 CIRCULAR -2 0 0 0 1",     "211"},
+        errors);
+    BOOST_REQUIRE_EQUAL(errors.size(), 6u);
+
+    // --- each error is reported once with its own line number, in the
+    //     order the lines appear in the file
+    BOOST_CHECK_EQUAL(openInput(inp, "1", serial), ERR_INPUT);
+    checkErrors(serial, errors);
+    BOOST_CHECK_EQUAL(openInput(inp, "4", parallel), ERR_INPUT);
+    checkErrors(parallel, errors);
+    BOOST_CHECK(serial == parallel);
+    remove(DATA_PATH_INP_INPUT);
+}
+
+BOOST_AUTO_TEST_CASE(duplicate_ids) {
+    vector<InputError> errors;
+    string report;
+
+    // --- objects named twice, far apart in sections read by several
+    //     threads, are found by the count of objects before parsing
+    InputFile inp = makeInput({
+        "J250 75.000000 10 0 0 0",       "J20 75.000000 10 0 0 0",       "207",
+        "C280 J280 J281 100 0.01 0 0 0 0", "C3 J280 J281 100 0.01 0 0 0 0", "207"},
+        errors);
+    BOOST_REQUIRE_EQUAL(errors.size(), 2u);
+    BOOST_CHECK_EQUAL(openInput(inp, "4", report), ERR_INPUT);
+    checkErrors(report, errors);
+    remove(DATA_PATH_INP_INPUT);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
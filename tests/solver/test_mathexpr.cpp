@@ -0,0 +1,226 @@
+/*
+ ******************************************************************************
+ Project:      OWA SWMM
+ Version:      5.2.4
+ Module:       test_mathexpr.cpp
+ Description:  tests for compiled math expressions
+ Authors:      see AUTHORS
+ Copyright:    see AUTHORS
+ License:      see LICENSE
+ Last Updated: 10/16/2026
+ ******************************************************************************
+*/
+
+#include <cmath>
+#include <functional>
+#include <string>
+
+#include <boost/test/unit_test.hpp>
+
+extern "C" {
+#include "mathexpr.h"
+}
+
+using namespace std;
+
+
+// Variables x, y & z and the number of times their values are requested
+static double Vars[3];
+static int    Requests;
+
+static int getVar(char *name)
+{
+    string s(name);
+    if ( s == "x" || s == "X" ) return 0;
+    if ( s == "y" || s == "Y" ) return 1;
+    if ( s == "z" || s == "Z" ) return 2;
+    return -1;
+}
+
+static double getVal(int i)
+{
+    Requests++;
+    return Vars[i];
+}
+
+// Compiles a formula and checks its value against a reference computed
+// directly from its terms, for several values of its variables
+static void checkFormula(const char *formula,
+                         function<double(double, double, double)> ref)
+{
+    const double values[][3] = {{1.5, -2.25, 4.0}, {0.3, 0.7, 0.2},
+                                {-1.0, 2.0, 9.0}, {0.0, 0.5, 1.0}};
+    string s(formula);
+    MathExpr *expr = mathexpr_create(&s[0], getVar);
+
+    BOOST_REQUIRE_MESSAGE(expr != NULL, formula);
+    for (auto &v : values)
+    {
+        Vars[0] = v[0];
+        Vars[1] = v[1];
+        Vars[2] = v[2];
+        double expected = ref(v[0], v[1], v[2]);
+        if ( expected != expected ) expected = 0.0;
+        BOOST_CHECK_MESSAGE(fabs(mathexpr_eval(expr, getVal) - expected) <=
+                            1.0e-12 * (1.0 + fabs(expected)), formula);
+    }
+    mathexpr_delete(expr);
+}
+
+static int countOpcode(MathExpr *expr, int opcode)
+{
+    int n = 0;
+    for (int i = 0; i < expr->count; i++)
+        if ( expr->code[i].opcode == opcode ) n++;
+    return n;
+}
+
+
+BOOST_AUTO_TEST_SUITE(test_mathexpr)
+
+BOOST_AUTO_TEST_CASE(arithmetic) {
+    checkFormula("x + y * z - x / z",
+        [](double x, double y, double z) { return x + y * z - x / z; });
+    checkFormula("(x + y) * (z - x) / (-(3 - y))",
+        [](double x, double y, double z) { return (x + y) * (z - x) / -(3 - y); });
+    checkFormula("-x*(-y) + 2.5e-1*z",
+        [](double x, double y, double z) { return -x * -y + 0.25 * z; });
+
+    // --- '^' gives 0 for a base that is not positive
+    checkFormula("z^0.5 + x^2",
+        [](double x, double, double z)
+        { return pow(z, 0.5) + (x > 0.0 ? pow(x, 2) : 0.0); });
+}
+
+BOOST_AUTO_TEST_CASE(functions) {
+    checkFormula("cos(x)*sin(y) - tan(z) + cot(z)",
+        [](double x, double y, double z)
+        { return cos(x) * sin(y) - tan(z) + 1.0 / tan(z); });
+    checkFormula("abs(y) + sgn(y) + sqrt(z) + log(z) + exp(x) + log10(z)",
+        [](double x, double y, double z)
+        { return fabs(y) + (y > 0) - (y < 0) + sqrt(z) + log(z) + exp(x) +
+                 log10(z); });
+    checkFormula("atan(x) + acot(y) + sinh(x) - cosh(y) + tanh(z)",
+        [](double x, double y, double z)
+        { return atan(x) + 1.57079632679489661923 - atan(y) + sinh(x) -
+                 cosh(y) + tanh(z); });
+    checkFormula("step(x) + 2*step(y)",
+        [](double x, double y, double)
+        { return (x > 0.0) + 2.0 * (y > 0.0); });
+
+    // --- an illegal operation gives 0 instead of NaN
+    checkFormula("asin(z) + acos(z)",
+        [](double, double, double z) { return asin(z) + acos(z); });
+}
+
+BOOST_AUTO_TEST_CASE(repeated_subexpressions) {
+    checkFormula("(x+y)*(x+y) + sin(x+y)",
+        [](double x, double y, double)
+        { return (x + y) * (x + y) + sin(x + y); });
+    checkFormula("exp(x*y) / (1 + exp(x*y)) - x*y",
+        [](double x, double y, double)
+        { return exp(x * y) / (1 + exp(x * y)) - x * y; });
+    checkFormula("sqrt(z)*sqrt(z) + sqrt(z)/(x*x+1) + x*x",
+        [](double x, double, double z)
+        { return sqrt(z) * sqrt(z) + sqrt(z) / (x * x + 1) + x * x; });
+
+    // --- a repeated subexpression is evaluated once and its value reused
+    string s = "(x+y)*(x+y) + sin(x+y)";
+    MathExpr *expr = mathexpr_create(&s[0], getVar);
+    BOOST_REQUIRE(expr != NULL);
+    BOOST_CHECK_EQUAL(expr->saveCount, 1);
+    BOOST_CHECK_EQUAL(countOpcode(expr, 3), 2);
+    mathexpr_delete(expr);
+
+    // --- each variable's value is requested once per evaluation
+    s = "x*x + x*y + y - X";
+    expr = mathexpr_create(&s[0], getVar);
+    BOOST_REQUIRE(expr != NULL);
+    Requests = 0;
+    mathexpr_eval(expr, getVal);
+    BOOST_CHECK_EQUAL(Requests, 2);
+    mathexpr_delete(expr);
+}
+
+BOOST_AUTO_TEST_CASE(constant_folding) {
+    const char *formulas[] = {"2*3 + 4", "-(2^3) + sqrt(16)", "exp(0)*cos(0)"};
+    const double values[] = {10.0, -4.0, 1.0};
+
+    // --- operations on numbers alone compile to a single number
+    for (int i = 0; i < 3; i++)
+    {
+        string s(formulas[i]);
+        MathExpr *expr = mathexpr_create(&s[0], getVar);
+        BOOST_REQUIRE(expr != NULL);
+        BOOST_CHECK_EQUAL(expr->count, 1);
+        BOOST_CHECK_EQUAL(mathexpr_eval(expr, getVal), values[i]);
+        mathexpr_delete(expr);
+    }
+
+    // --- constant terms next to variables are folded too
+    string s = "x + 2*3";
+    MathExpr *expr = mathexpr_create(&s[0], getVar);
+    BOOST_REQUIRE(expr != NULL);
+    BOOST_CHECK_EQUAL(expr->count, 3);
+    mathexpr_delete(expr);
+    checkFormula("x + 2*3",
+        [](double x, double, double) { return x + 6.0; });
+}
+
+BOOST_AUTO_TEST_CASE(batch) {
+    // --- variable values of each item in a batch
+    const int n = 150;
+    static double items[n][3];
+    for (int j = 0; j < n; j++)
+    {
+        items[j][0] = 0.05 * j - 2.0;
+        items[j][1] = sin(0.3 * j);
+        items[j][2] = 0.1 * (j % 17);
+    }
+    auto getItemVal = [](int i, int j) { return items[j][i]; };
+
+    // --- a batch gives the same values as evaluating each item in turn,
+    //     over several blocks of items and for a stack deeper than the
+    //     batch evaluator's fixed buffer
+    string deep = "x";
+    for (int k = 0; k < 20; k++) deep = "y+(" + deep + ")*z";
+    const string formulas[] = {"x + y * z - x / z", "(x+y)*(x+y) + sin(x+y)",
+                               "z^0.5 + x^2 + asin(z)", "step(x)*2*3 - y",
+                               deep};
+    for (const string &f : formulas)
+    {
+        string s(f);
+        MathExpr *expr = mathexpr_create(&s[0], getVar);
+        BOOST_REQUIRE_MESSAGE(expr != NULL, f);
+        double result[n];
+        mathexpr_evalBatch(expr, n, getItemVal, result);
+        for (int j = 0; j < n; j++)
+        {
+            Vars[0] = items[j][0];
+            Vars[1] = items[j][1];
+            Vars[2] = items[j][2];
+            BOOST_CHECK_EQUAL(result[j], mathexpr_eval(expr, getVal));
+        }
+        mathexpr_delete(expr);
+    }
+
+    // --- a missing expression gives 0 for every item
+    double result[3] = {1.0, 1.0, 1.0};
+    mathexpr_evalBatch(NULL, 3, getItemVal, result);
+    for (double r : result) BOOST_CHECK_EQUAL(r, 0.0);
+}
+
+BOOST_AUTO_TEST_CASE(malformed) {
+    const char *formulas[] = {"(x + y", "x + y)", "x +", "x y", "x * -y",
+                              "w + 1", ""};
+
+    for (auto f : formulas)
+    {
+        string s(f);
+        MathExpr *expr = mathexpr_create(&s[0], getVar);
+        BOOST_CHECK_MESSAGE(expr == NULL, f);
+        mathexpr_delete(expr);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,137 @@
+/*
+ ******************************************************************************
+ Project:      OWA SWMM
+ Version:      5.2.4
+ Module:       test_mempool.cpp
+ Description:  tests for allocating memory from pools
+ Authors:      see AUTHORS
+ Copyright:    see AUTHORS
+ License:      see LICENSE
+ Last Updated: 10/16/2026
+ ******************************************************************************
+*/
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+extern "C" {
+#include "mempool.h"
+}
+
+using namespace std;
+
+
+// Size of the memory blocks that make up a pool (see mempool.c)
+#define BLOCK_SIZE 64000
+
+// A piece of memory allocated from a pool and filled with its own byte
+struct Piece {
+    char *ptr;
+    long  size;
+    char  fill;
+};
+
+// Allocates pieces of varying sizes from a pool until more than the
+// given number of bytes have been allocated
+static vector<Piece> allocPieces(alloc_handle_t *pool, long total, char fill)
+{
+    vector<Piece> pieces;
+    long n = 0;
+
+    for (int i = 0; n <= total; i++)
+    {
+        Piece p = {NULL, 1 + (i * 37) % 500, (char)(fill + i)};
+        p.ptr = pool ? AllocFromPool(pool, p.size) : Alloc(p.size);
+        BOOST_REQUIRE(p.ptr != NULL);
+        memset(p.ptr, p.fill, p.size);
+        pieces.push_back(p);
+        n += p.size;
+    }
+    return pieces;
+}
+
+// Checks that no piece was overwritten by another one
+static bool checkPieces(const vector<Piece> &pieces)
+{
+    for (const Piece &p : pieces)
+        for (long i = 0; i < p.size; i++)
+            if ( p.ptr[i] != p.fill ) return false;
+    return true;
+}
+
+
+BOOST_AUTO_TEST_SUITE(test_mempool)
+
+BOOST_AUTO_TEST_CASE(aligned_pieces) {
+    alloc_handle_t *pool = AllocNewPool();
+    BOOST_REQUIRE(pool != NULL);
+
+    // --- every piece is aligned for doubles & pointers, even after
+    //     odd sized pieces and across several blocks
+    vector<Piece> pieces = allocPieces(pool, 3 * BLOCK_SIZE, 'a');
+    for (const Piece &p : pieces)
+        BOOST_CHECK_EQUAL((uintptr_t)p.ptr % 8, 0u);
+    BOOST_CHECK(checkPieces(pieces));
+
+    // --- a piece as large as a block gets a block of its own
+    char *big = AllocFromPool(pool, BLOCK_SIZE - 8);
+    BOOST_REQUIRE(big != NULL);
+    memset(big, 'z', BLOCK_SIZE - 8);
+    BOOST_CHECK(checkPieces(pieces));
+    AllocDeletePool(pool);
+}
+
+BOOST_AUTO_TEST_CASE(separate_pools) {
+    alloc_handle_t *current = AllocInit();
+    alloc_handle_t *pool1 = AllocNewPool();
+    alloc_handle_t *pool2 = AllocNewPool();
+    BOOST_REQUIRE(current && pool1 && pool2);
+
+    // --- creating a pool does not change the current pool
+    BOOST_CHECK(AllocSetPool(current) == current);
+
+    // --- pieces from pools used in turn stay apart
+    vector<Piece> pieces;
+    for (int i = 0; i < 10; i++)
+    {
+        for (const Piece &p : allocPieces(pool1, BLOCK_SIZE / 3, 'a'))
+            pieces.push_back(p);
+        for (const Piece &p : allocPieces(pool2, BLOCK_SIZE / 5, 'k'))
+            pieces.push_back(p);
+        for (const Piece &p : allocPieces(NULL, BLOCK_SIZE / 7, 'u'))
+            pieces.push_back(p);
+    }
+    BOOST_CHECK(checkPieces(pieces));
+    BOOST_CHECK(AllocSetPool(current) == current);
+
+    // --- deleting one pool leaves the others intact
+    pieces.clear();
+    for (const Piece &p : allocPieces(pool2, 2 * BLOCK_SIZE, 'k'))
+        pieces.push_back(p);
+    AllocDeletePool(pool1);
+    AllocDeletePool(NULL);
+    BOOST_CHECK(checkPieces(pieces));
+    AllocDeletePool(pool2);
+    AllocFreePool();
+    BOOST_CHECK(AllocSetPool(NULL) == NULL);
+}
+
+BOOST_AUTO_TEST_CASE(reset_pool) {
+    BOOST_REQUIRE(AllocInit() != NULL);
+    vector<Piece> first = allocPieces(NULL, 3 * BLOCK_SIZE, 'a');
+
+    // --- a reset pool hands out the same memory again, re-using the
+    //     blocks it already has
+    AllocReset();
+    vector<Piece> second = allocPieces(NULL, 3 * BLOCK_SIZE, 'p');
+    BOOST_REQUIRE_EQUAL(second.size(), first.size());
+    for (size_t i = 0; i < first.size(); i++)
+        BOOST_CHECK(second[i].ptr == first[i].ptr);
+    BOOST_CHECK(checkPieces(second));
+    AllocFreePool();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,19 @@
+/*
+ ******************************************************************************
+ Project:      OWA SWMM
+ Version:      5.2.4
+ Module:       test_modules.cpp
+ Description:  tests for internal solver modules
+ Authors:      see AUTHORS
+ Copyright:    see AUTHORS
+ License:      see LICENSE
+ Last Updated: 10/16/2026
+ ******************************************************************************
+*/
+
+// The test suites of this module call solver functions directly, so they
+// are linked against a solver library that exports all of its functions
+
+#define BOOST_TEST_MODULE solver_modules
+
+#include <boost/test/included/unit_test.hpp>
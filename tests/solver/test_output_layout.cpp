@@ -0,0 +1,111 @@
+/*
+ ******************************************************************************
+ Project:      OWA SWMM
+ Version:      5.2.4
+ Module:       test_output_layout.cpp
+ Description:  tests for saving results in the columnar output file layouts
+ Authors:      see AUTHORS
+ Copyright:    see AUTHORS
+ License:      see LICENSE
+ Last Updated: 10/15/2026
+ ******************************************************************************
+*/
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include "test_solver.hpp"
+
+#define DATA_PATH_INP_COLUMNAR "tmp_columnar.inp"
+#define DATA_PATH_OUT_COLUMNAR "tmp_columnar.out"
+
+using namespace std;
+
+
+// Runs a project and returns the dates and the saved node depths,
+// link flows and subcatchment runoff of every reporting period
+static int runProject(const char *inpFile, const char *outFile,
+                      vector<double> *values)
+{
+    int i, period, nPeriods, error;
+
+    error = swmm_open(inpFile, DATA_PATH_RPT, outFile);
+    if ( !error ) error = swmm_start(1);
+    if ( !error )
+    {
+        double elapsedTime = 0.0;
+        do error = swmm_step(&elapsedTime);
+        while ( elapsedTime > 0.0 && !error );
+        swmm_end();
+    }
+    if ( !error )
+    {
+        nPeriods = (int)swmm_getValue(swmm_TOTALSTEPS, 0);
+        for (period = 1; period <= nPeriods; period++)
+        {
+            values->push_back(swmm_getSavedValue(swmm_CURRENTDATE, 0, period));
+            for (i = 0; i < swmm_getCount(swmm_NODE); i++)
+                values->push_back(swmm_getSavedValue(swmm_NODE_DEPTH, i, period));
+            for (i = 0; i < swmm_getCount(swmm_LINK); i++)
+                values->push_back(swmm_getSavedValue(swmm_LINK_FLOW, i, period));
+            for (i = 0; i < swmm_getCount(swmm_SUBCATCH); i++)
+                values->push_back(swmm_getSavedValue(swmm_SUBCATCH_RUNOFF, i,
+                                                     period));
+        }
+    }
+    swmm_close();
+    return error;
+}
+
+
+// Copies the example with an output layout option added
+static void writeLayoutCopy(const char *layout)
+{
+    string line;
+    ifstream in(DATA_PATH_INP);
+    ofstream out(DATA_PATH_INP_COLUMNAR);
+
+    while ( getline(in, line) )
+    {
+        out << line << "\n";
+        if ( line.find("[OPTIONS]") == 0 )
+            out << "OUTPUT_LAYOUT " << layout << "\n";
+    }
+}
+
+
+BOOST_AUTO_TEST_SUITE(test_output_layout)
+
+BOOST_AUTO_TEST_CASE(columnar_layout) {
+    vector<double> ref, test;
+
+    writeLayoutCopy("COLUMNAR");
+    BOOST_REQUIRE_EQUAL(runProject(DATA_PATH_INP, DATA_PATH_OUT, &ref), 0);
+    BOOST_REQUIRE_EQUAL(runProject(DATA_PATH_INP_COLUMNAR,
+                                   DATA_PATH_OUT_COLUMNAR, &test), 0);
+    BOOST_REQUIRE(ref.size() > 0);
+    BOOST_CHECK(test == ref);
+
+    remove(DATA_PATH_INP_COLUMNAR);
+    remove(DATA_PATH_OUT_COLUMNAR);
+}
+
+BOOST_AUTO_TEST_CASE(compressed_layout) {
+    vector<double> ref, test;
+
+    writeLayoutCopy("COMPRESSED");
+    BOOST_REQUIRE_EQUAL(runProject(DATA_PATH_INP, DATA_PATH_OUT, &ref), 0);
+    BOOST_REQUIRE_EQUAL(runProject(DATA_PATH_INP_COLUMNAR,
+                                   DATA_PATH_OUT_COLUMNAR, &test), 0);
+    BOOST_REQUIRE(ref.size() > 0);
+    BOOST_CHECK(test == ref);
+
+    remove(DATA_PATH_INP_COLUMNAR);
+    remove(DATA_PATH_OUT_COLUMNAR);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
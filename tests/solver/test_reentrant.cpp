@@ -0,0 +1,120 @@
+/*
+ ******************************************************************************
+ Project:      OWA SWMM
+ Version:      5.2.4
+ Module:       test_reentrant.cpp
+ Description:  tests for concurrent projects in a reentrant solver build
+ Authors:      see AUTHORS
+ Copyright:    see AUTHORS
+ License:      see LICENSE
+ Last Updated: 10/16/2026
+ ******************************************************************************
+*/
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include "test_solver.hpp"
+
+#define NUM_PROJECTS 4
+
+using namespace std;
+
+
+// Runs a project to completion on the calling thread, recording the
+// depth at every node after each routing step
+static int runProject(int k, vector<double> *depths)
+{
+    string rpt = "tmp_reentrant" + to_string(k) + ".rpt";
+    string out = "tmp_reentrant" + to_string(k) + ".out";
+    double elapsedTime = 0.0;
+    int i, nNodes, error;
+
+    error = swmm_open(DATA_PATH_INP, rpt.c_str(), out.c_str());
+    if ( !error ) error = swmm_start(0);
+    if ( !error )
+    {
+        nNodes = swmm_getCount(swmm_NODE);
+        do
+        {
+            error = swmm_step(&elapsedTime);
+            for (i = 0; i < nNodes; i++)
+                depths->push_back(swmm_getValue(swmm_NODE_DEPTH, i));
+        } while ( elapsedTime > 0.0 && !error );
+        swmm_end();
+    }
+    swmm_close();
+    remove(rpt.c_str());
+    remove(out.c_str());
+    return error;
+}
+
+
+BOOST_AUTO_TEST_SUITE(test_reentrant)
+
+BOOST_AUTO_TEST_CASE(concurrent_projects) {
+    vector<double> ref;
+    vector<double> depths[NUM_PROJECTS];
+    int errors[NUM_PROJECTS];
+    vector<thread> workers;
+
+    BOOST_REQUIRE_EQUAL(runProject(NUM_PROJECTS, &ref), 0);
+    BOOST_REQUIRE(ref.size() > 0);
+
+    for (int k = 0; k < NUM_PROJECTS; k++)
+        workers.push_back(thread([k, &depths, &errors]()
+        {
+            errors[k] = runProject(k, &depths[k]);
+        }));
+    for (auto &w : workers) w.join();
+
+    for (int k = 0; k < NUM_PROJECTS; k++)
+    {
+        BOOST_CHECK_EQUAL(errors[k], 0);
+        BOOST_CHECK(depths[k] == ref);
+    }
+}
+
+BOOST_FIXTURE_TEST_CASE(single_thread_projects, FixtureOpenClose) {
+    double value;
+    int warnings = swmm_getWarnings();
+
+    // --- a reentrant build runs each project on its calling thread only
+    //     and warns when asked for more
+    BOOST_REQUIRE_EQUAL(swmm_setSimulationParam(SM_THREADS, 1), 0);
+    BOOST_CHECK_EQUAL(swmm_getWarnings(), warnings);
+    BOOST_REQUIRE_EQUAL(swmm_setSimulationParam(SM_THREADS, 4), 0);
+    BOOST_REQUIRE_EQUAL(swmm_getSimulationParam(SM_THREADS, &value), 0);
+    BOOST_CHECK_EQUAL(value, 1);
+    BOOST_CHECK_EQUAL(swmm_getWarnings(), warnings + 1);
+}
+
+BOOST_AUTO_TEST_CASE(threads_option) {
+    const char *inp = "tmp_reentrant_threads.inp";
+    string line;
+    double value;
+
+    // --- copy the test input with its THREADS option raised to 4
+    ifstream in(DATA_PATH_INP);
+    ofstream out(inp);
+    while ( getline(in, line) )
+    {
+        if ( line.find("THREADS") == 0 ) line = "THREADS 4";
+        out << line << "\n";
+    }
+    out.close();
+
+    BOOST_REQUIRE_EQUAL(swmm_open(inp, DATA_PATH_RPT, DATA_PATH_OUT), 0);
+    BOOST_REQUIRE_EQUAL(swmm_getSimulationParam(SM_THREADS, &value), 0);
+    BOOST_CHECK_EQUAL(value, 1);
+    BOOST_CHECK_EQUAL(swmm_getWarnings(), 1);
+    swmm_close();
+    remove(inp);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
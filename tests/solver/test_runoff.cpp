@@ -0,0 +1,75 @@
+/*
+ ******************************************************************************
+ Project:      OWA SWMM
+ Version:      5.2.4
+ Module:       test_runoff.cpp
+ Description:  tests for computing subcatchment runoff in parallel
+ Authors:      see AUTHORS
+ Copyright:    see AUTHORS
+ License:      see LICENSE
+ Last Updated: 10/16/2026
+ ******************************************************************************
+*/
+
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include "test_solver.hpp"
+
+using namespace std;
+
+
+// Runs the example project with a number of threads, saving the runoff
+// rate of every subcatchment at every time step and the system totals
+static int runThreads(int threads, vector<double> &rates,
+                      SM_RunoffTotals *totals)
+{
+    int    i, n, error;
+    double rate, elapsedTime = 0.0;
+
+    error = swmm_open(DATA_PATH_INP, DATA_PATH_RPT, DATA_PATH_OUT);
+    if ( !error ) error = swmm_setSimulationParam(SM_THREADS, threads);
+    if ( !error ) error = swmm_countObjects(SM_SUBCATCH, &n);
+    if ( !error ) error = swmm_start(0);
+    if ( !error )
+    {
+        do
+        {
+            error = swmm_step(&elapsedTime);
+            for (i = 0; i < n && !error; i++)
+            {
+                error = swmm_getSubcatchResult(i, SM_SUBCRUNOFF, &rate);
+                rates.push_back(rate);
+            }
+        } while ( elapsedTime > 0.0 && !error );
+        if ( !error ) error = swmm_getSystemRunoffTotals(totals);
+        swmm_end();
+    }
+    swmm_close();
+    return error;
+}
+
+
+BOOST_AUTO_TEST_SUITE(test_runoff)
+
+BOOST_AUTO_TEST_CASE(parallel_subcatchments) {
+    vector<double>  oneRates, twoRates;
+    SM_RunoffTotals oneTotals = {0}, twoTotals = {0};
+
+    // --- the example's 8 subcatchments are enough for 2 threads
+    BOOST_REQUIRE_EQUAL(runThreads(1, oneRates, &oneTotals), 0);
+    BOOST_REQUIRE_EQUAL(runThreads(2, twoRates, &twoTotals), 0);
+
+    // --- each subcatchment's runoff does not depend on its thread
+    BOOST_REQUIRE_EQUAL(twoRates.size(), oneRates.size());
+    BOOST_CHECK(twoRates == oneRates);
+
+    // --- totals merged from each thread's share match the serial ones
+    BOOST_CHECK_CLOSE(twoTotals.runoff, oneTotals.runoff, 1.0e-6);
+    BOOST_CHECK_CLOSE(twoTotals.infil, oneTotals.infil, 1.0e-6);
+    BOOST_CHECK_CLOSE(twoTotals.evap, oneTotals.evap, 1.0e-6);
+    BOOST_CHECK_CLOSE(twoTotals.finalStorage, oneTotals.finalStorage, 1.0e-6);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,221 @@
+/*
+ ******************************************************************************
+ Project:      OWA SWMM
+ Version:      5.2.4
+ Module:       test_snapshot.cpp
+ Description:  tests for opening projects from snapshots of their data
+ Authors:      see AUTHORS
+ Copyright:    see AUTHORS
+ License:      see LICENSE
+ Last Updated: 10/16/2026
+ ******************************************************************************
+*/
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include <boost/test/unit_test.hpp>
+
+#include "test_solver.hpp"
+
+#define DATA_PATH_INP_SNAP  "tmp_snapshot.inp"
+#define DATA_PATH_SNAP      "tmp_snapshot.snap"
+#define DATA_PATH_RPT_REF   "tmp_snapshot_ref.rpt"
+#define DATA_PATH_OUT_REF   "tmp_snapshot_ref.out"
+
+// Title of the example project and the one marked in its snapshots
+#define TITLE        "Example 1"
+#define MARKED_TITLE "Example X"
+
+using namespace std;
+
+
+static string readFile(const char *name)
+{
+    ifstream in(name, ios::binary);
+    stringstream s;
+    s << in.rdbuf();
+    return s.str();
+}
+
+static void writeFile(const char *name, const string &contents)
+{
+    ofstream out(name, ios::binary | ios::trunc);
+    out << contents;
+}
+
+// Returns the report file without the lines that record when it was run
+static string readReport(const char *name)
+{
+    string line, text;
+    ifstream in(name);
+
+    while ( getline(in, line) )
+    {
+        if ( line.find("Analysis begun") != string::npos ||
+             line.find("Analysis ended") != string::npos ||
+             line.find("Total elapsed") != string::npos ) continue;
+        text += line + "\n";
+    }
+    return text;
+}
+
+// Runs a project opened from its input file or, if a snapshot file is
+// named, through swmm_openSnapshot
+static int runProject(const char *inpFile, const char *rptFile,
+                      const char *outFile, const char *snapFile)
+{
+    int    error;
+    double elapsedTime = 0.0;
+
+    if ( snapFile ) error = swmm_openSnapshot(inpFile, rptFile, outFile,
+                                              snapFile);
+    else error = swmm_open(inpFile, rptFile, outFile);
+    if ( !error ) error = swmm_start(1);
+    if ( !error )
+    {
+        do error = swmm_step(&elapsedTime);
+        while ( elapsedTime > 0.0 && !error );
+        swmm_end();
+        swmm_report();
+    }
+    swmm_close();
+    return error;
+}
+
+// Changes the title in the report text saved at the end of a snapshot,
+// so a report shows whether it was replayed from that snapshot
+static bool markSnapshot()
+{
+    string snap = readFile(DATA_PATH_SNAP);
+    size_t pos = snap.rfind(TITLE);
+
+    if ( pos == string::npos ) return false;
+    snap.replace(pos, strlen(MARKED_TITLE), MARKED_TITLE);
+    writeFile(DATA_PATH_SNAP, snap);
+    return true;
+}
+
+
+struct FixtureSnapshot {
+    string snapshot;
+
+    // --- runs a copy of the example from its input file, then saves a
+    //     snapshot of it and marks it
+    FixtureSnapshot() {
+        writeFile(DATA_PATH_INP_SNAP, readFile(DATA_PATH_INP));
+        remove(DATA_PATH_SNAP);
+        BOOST_REQUIRE_EQUAL(runProject(DATA_PATH_INP_SNAP, DATA_PATH_RPT_REF,
+                                       DATA_PATH_OUT_REF, NULL), 0);
+        BOOST_REQUIRE_EQUAL(swmm_openSnapshot(DATA_PATH_INP_SNAP,
+            DATA_PATH_RPT, DATA_PATH_OUT, DATA_PATH_SNAP), 0);
+        swmm_close();
+        snapshot = readFile(DATA_PATH_SNAP);
+        BOOST_REQUIRE(snapshot.size() > 0);
+        BOOST_REQUIRE(markSnapshot());
+    }
+    ~FixtureSnapshot() {
+        remove(DATA_PATH_INP_SNAP);
+        remove(DATA_PATH_SNAP);
+        remove(DATA_PATH_RPT_REF);
+        remove(DATA_PATH_OUT_REF);
+    }
+
+    // --- checks that a run gives the same results as the reference run
+    //     and reports whether its data came from the marked snapshot
+    bool runFromSnapshot() {
+        BOOST_REQUIRE_EQUAL(runProject(DATA_PATH_INP_SNAP, DATA_PATH_RPT,
+                                       DATA_PATH_OUT, DATA_PATH_SNAP), 0);
+        BOOST_CHECK(readFile(DATA_PATH_OUT) == readFile(DATA_PATH_OUT_REF));
+        string report = readReport(DATA_PATH_RPT);
+        bool marked = report.find(MARKED_TITLE) != string::npos;
+        if ( marked ) report.replace(report.find(MARKED_TITLE),
+                                     strlen(TITLE), TITLE);
+        BOOST_CHECK(report == readReport(DATA_PATH_RPT_REF));
+        return marked;
+    }
+
+    // --- checks that a run fell back to the input file and replaced the
+    //     snapshot with one that the next run uses
+    void checkFallback() {
+        BOOST_CHECK(!runFromSnapshot());
+        BOOST_CHECK_EQUAL(readFile(DATA_PATH_SNAP).size(), snapshot.size());
+        BOOST_REQUIRE(markSnapshot());
+        BOOST_CHECK(runFromSnapshot());
+    }
+};
+
+
+BOOST_AUTO_TEST_SUITE(test_snapshot)
+
+BOOST_FIXTURE_TEST_CASE(round_trip, FixtureSnapshot) {
+    // --- the project's data are read from the snapshot and give the same
+    //     results as when read from the input file
+    BOOST_CHECK(runFromSnapshot());
+    BOOST_CHECK(runFromSnapshot());
+}
+
+BOOST_FIXTURE_TEST_CASE(stale_input, FixtureSnapshot) {
+    // --- any change to the input file changes its hash
+    writeFile(DATA_PATH_INP_SNAP, readFile(DATA_PATH_INP) + ";changed\n");
+    BOOST_CHECK(!runFromSnapshot());
+
+    // --- the snapshot was replaced by one of the changed input file
+    BOOST_REQUIRE(markSnapshot());
+    BOOST_CHECK(runFromSnapshot());
+}
+
+BOOST_FIXTURE_TEST_CASE(truncated_file, FixtureSnapshot) {
+    writeFile(DATA_PATH_SNAP, snapshot.substr(0, snapshot.size() / 2));
+    checkFallback();
+    writeFile(DATA_PATH_SNAP, snapshot.substr(0, snapshot.size() - 1));
+    checkFallback();
+    writeFile(DATA_PATH_SNAP, "");
+    checkFallback();
+}
+
+BOOST_FIXTURE_TEST_CASE(corrupt_file, FixtureSnapshot) {
+    string snap = readFile(DATA_PATH_SNAP);
+
+    // --- a damaged file signature
+    snap[0] = 'X';
+    writeFile(DATA_PATH_SNAP, snap);
+    checkFallback();
+
+    // --- a file that is not a snapshot at all
+    writeFile(DATA_PATH_SNAP, readFile(DATA_PATH_INP));
+    checkFallback();
+}
+
+BOOST_FIXTURE_TEST_CASE(wrong_version, FixtureSnapshot) {
+    string snap = readFile(DATA_PATH_SNAP);
+    int    version;
+
+    // --- the engine & snapshot version follows the 8 byte signature
+    memcpy(&version, &snap[8], sizeof(version));
+    version++;
+    memcpy(&snap[8], &version, sizeof(version));
+    writeFile(DATA_PATH_SNAP, snap);
+    checkFallback();
+}
+
+BOOST_AUTO_TEST_CASE(unsupported_project) {
+    // --- street inlets & treatment functions are not saved to snapshots
+    const char *inpFiles[] = {DATA_PATH_INP_INLETS_AND_DRAINS,
+                              DATA_PATH_INP_POLLUT_NODE};
+
+    for (int i = 0; i < 2; i++)
+    {
+        remove(DATA_PATH_SNAP);
+        BOOST_CHECK_EQUAL(swmm_openSnapshot(inpFiles[i], DATA_PATH_RPT,
+            DATA_PATH_OUT, DATA_PATH_SNAP), 0);
+        swmm_close();
+        ifstream snap(DATA_PATH_SNAP);
+        BOOST_CHECK(!snap.good());
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,372 @@
+/*
+ ******************************************************************************
+ Project:      OWA SWMM
+ Version:      5.2.4
+ Module:       test_table.cpp
+ Description:  tests for curve and time series table lookups
+ Authors:      see AUTHORS
+ Copyright:    see AUTHORS
+ License:      see LICENSE
+ Last Updated: 10/16/2026
+ ******************************************************************************
+*/
+
+#include <cmath>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+extern "C" {
+#include "headers.h"
+
+// defined in table.c but not declared in funcs.h
+double table_interpolate(double x, double x1, double y1, double x2, double y2);
+}
+
+using namespace std;
+
+
+// A curve or time series table built from lists of x & y values
+struct Table {
+    TTable t;
+    vector<double> x, y;
+
+    Table(const vector<double> &xs, const vector<double> &ys, int type) :
+        x(xs), y(ys)
+    {
+        table_init(&t);
+        t.curveType = type;
+        for (size_t i = 0; i < x.size(); i++)
+            BOOST_REQUIRE(table_addEntry(&t, x[i], y[i]));
+        BOOST_REQUIRE_EQUAL(table_validate(&t), 0);
+    }
+    ~Table() { table_deleteEntries(&t); }
+
+    int n() { return (int)x.size(); }
+
+    // --- interpolates between points i-1 and i
+    double interp(int i, double v) {
+        return table_interpolate(v, x[i-1], y[i-1], x[i], y[i]);
+    }
+};
+
+// Curves with unevenly spaced, evenly spaced and nearly evenly spaced
+// (by roundoff) x-values
+static vector<Table*> makeCurves()
+{
+    vector<Table*> curves;
+    vector<double> x, y;
+
+    curves.push_back(new Table({0.0, 0.5, 1.25, 3.0, 3.5, 7.0},
+                               {0.0, 10.0, 12.0, 30.0, 31.0, 80.0},
+                               STORAGE_CURVE));
+    curves.push_back(new Table({1.0, 2.0, 3.0, 4.0, 5.0},
+                               {2.0, 8.0, 8.0, 5.0, 20.0},
+                               RATING_CURVE));
+    for (int i = 0; i <= 20; i++)
+    {
+        x.push_back(0.1 * i);
+        y.push_back(i * i);
+    }
+    curves.push_back(new Table(x, y, STORAGE_CURVE));
+    return curves;
+}
+
+// Points below, on, between and beyond the x-values of a curve
+static vector<double> lookupPoints(Table *c)
+{
+    vector<double> v = {c->x[0] - 1.0, c->x[c->n()-1] + 2.5};
+    for (int i = 0; i < c->n(); i++)
+    {
+        v.push_back(c->x[i]);
+        if ( i > 0 )
+        {
+            v.push_back(c->x[i] - 1.0e-9);
+            v.push_back(0.3 * c->x[i-1] + 0.7 * c->x[i]);
+        }
+    }
+    return v;
+}
+
+// A time series of unevenly spaced points, more than fit in a table's
+// initial data arrays
+static Table *makeTimeSeries()
+{
+    vector<double> x, y;
+    double t = 100.0;
+
+    for (int i = 0; i < 50; i++)
+    {
+        t += 0.25 + (i % 7) * 0.5;
+        x.push_back(t);
+        y.push_back(sin(0.3 * i) * 10.0 + i);
+    }
+    return new Table(x, y, -1);
+}
+
+// Value of a time series found by scanning its points in order
+static double tseriesRef(Table *ts, double x, char extend)
+{
+    int n = ts->n();
+
+    if ( x < ts->x[0] || x > ts->x[n-1] )
+    {
+        if ( extend == FALSE ) return 0.0;
+        return (x < ts->x[0]) ? ts->y[0] : ts->y[n-1];
+    }
+    int i = 1;
+    while ( ts->x[i] < x ) i++;
+    return ts->interp(i, x);
+}
+
+// Times that step forward through a time series, jump ahead, move back
+// and fall outside of it
+static vector<double> tseriesTimes(Table *ts)
+{
+    vector<double> t;
+    int n = ts->n();
+    double first = ts->x[0], last = ts->x[n-1];
+
+    for (double x = first - 1.0; x <= last + 1.0; x += 0.2) t.push_back(x);
+    for (int i = 0; i < n; i += 7) t.push_back(ts->x[i]);
+    for (int i = n - 1; i >= 0; i -= 3)
+    {
+        t.push_back(ts->x[i]);
+        t.push_back(ts->x[i] - 0.1);
+    }
+    t.insert(t.end(), {last, last + 5.0, first, first - 5.0, first, last,
+                       (first + last) / 2.0, (first + last) / 2.0});
+
+    // --- times in a repeatable random order
+    unsigned r = 12345;
+    for (int i = 0; i < 200; i++)
+    {
+        r = r * 1103515245 + 12345;
+        t.push_back(first - 2.0 + (last - first + 4.0) * (r % 10000) / 1.0e4);
+    }
+    return t;
+}
+
+static void checkValue(double value, double ref)
+{
+    BOOST_CHECK_MESSAGE(fabs(value - ref) <= 1.0e-12 * (1.0 + fabs(ref)),
+                        value << " != " << ref);
+}
+
+
+BOOST_AUTO_TEST_SUITE(test_table)
+
+BOOST_AUTO_TEST_CASE(even_spacing) {
+    vector<Table*> curves = makeCurves();
+
+    // --- only points spaced evenly (to within roundoff) are located
+    //     directly instead of by binary search
+    BOOST_CHECK_EQUAL(curves[0]->t.dxGrid, 0.0);
+    BOOST_CHECK_EQUAL(curves[1]->t.dxGrid, 1.0);
+    BOOST_CHECK_CLOSE(curves[2]->t.dxGrid, 0.1, 1.0e-9);
+    for (Table *c : curves) delete c;
+}
+
+BOOST_AUTO_TEST_CASE(curve_lookup) {
+    for (Table *c : makeCurves())
+    {
+        int n = c->n();
+        for (double v : lookupPoints(c))
+        {
+            // --- reference values found by scanning the points in order
+            int i = 0;
+            while ( i < n && c->x[i] < v ) i++;
+            double y = (i == 0) ? c->y[0] :
+                       (i == n) ? c->y[n-1] : c->interp(i, v);
+            BOOST_CHECK_EQUAL(table_lookup(&c->t, v), y);
+
+            // --- lookup with extrapolation beyond the last point
+            double yEx = y;
+            if ( i == 0 && c->x[0] > 0.0 ) yEx = v / c->x[0] * c->y[0];
+            if ( i == n )
+            {
+                double s = (c->y[n-1] - c->y[n-2]) / (c->x[n-1] - c->x[n-2]);
+                yEx = c->y[n-1] + (s > 0.0 ? s : 0.0) * (v - c->x[n-1]);
+            }
+            BOOST_CHECK_EQUAL(table_lookupEx(&c->t, v), yEx);
+
+            // --- slope of the segment holding v
+            int k = (i == 0) ? 1 : (i == n) ? n - 1 : i;
+            BOOST_CHECK_EQUAL(table_getSlope(&c->t, v),
+                (c->y[k] - c->y[k-1]) / (c->x[k] - c->x[k-1]));
+
+            // --- y-value of the first point beyond v
+            k = 0;
+            while ( k < n - 1 && c->x[k] <= v ) k++;
+            BOOST_CHECK_EQUAL(table_intervalLookup(&c->t, v), c->y[k]);
+        }
+        delete c;
+    }
+}
+
+BOOST_AUTO_TEST_CASE(curve_inverse_lookup) {
+    for (Table *c : makeCurves())
+    {
+        int n = c->n();
+        for (int i = 0; i < n; i++)
+        {
+            for (double f : {0.0, 0.4, 1.0})
+            {
+                double v = (i == 0) ? c->y[0] - f :
+                           c->y[i-1] + f * (c->y[i] - c->y[i-1]);
+
+                // --- reference found by scanning the y-values in order
+                int k = 1;
+                while ( k < n && v > c->y[k] ) k++;
+                double x = (v <= c->y[0]) ? c->x[0] :
+                           (k == n) ? c->x[n-1] :
+                           table_interpolate(v, c->y[k-1], c->x[k-1],
+                                             c->y[k], c->x[k]);
+                BOOST_CHECK_EQUAL(table_inverseLookup(&c->t, v), x);
+            }
+        }
+        delete c;
+    }
+}
+
+BOOST_AUTO_TEST_CASE(storage_curve) {
+    for (Table *c : makeCurves())
+    {
+        if ( c->t.curveType != STORAGE_CURVE )
+        {
+            delete c;
+            continue;
+        }
+
+        // --- volume accumulated by the end area method up to each point
+        //     and the depth that holds that volume
+        double v = 0.0;
+        for (int i = 0; i < c->n(); i++)
+        {
+            if ( i > 0 ) v += (c->y[i-1] + c->y[i]) / 2.0 * (c->x[i] - c->x[i-1]);
+            BOOST_CHECK_CLOSE(table_getStorageVolume(&c->t, c->x[i]), v, 1.0e-9);
+            if ( v > 0.0 )
+                BOOST_CHECK_CLOSE(table_getStorageDepth(&c->t, v), c->x[i],
+                                  1.0e-6);
+        }
+
+        // --- depths between and beyond points recovered from their volumes
+        for (double d : lookupPoints(c))
+        {
+            if ( d <= 0.0 ) continue;
+            v = table_getStorageVolume(&c->t, d);
+            BOOST_CHECK_CLOSE(table_getStorageDepth(&c->t, v), d, 1.0e-6);
+        }
+        delete c;
+    }
+}
+
+BOOST_AUTO_TEST_CASE(empty_curve) {
+    TTable t;
+    table_init(&t);
+    t.curveType = STORAGE_CURVE;
+    BOOST_CHECK_EQUAL(table_validate(&t), 0);
+    BOOST_CHECK_EQUAL(table_lookup(&t, 1.0), 0.0);
+    BOOST_CHECK_EQUAL(table_lookupEx(&t, 1.0), 0.0);
+    BOOST_CHECK_EQUAL(table_intervalLookup(&t, 1.0), 0.0);
+    BOOST_CHECK_EQUAL(table_inverseLookup(&t, 1.0), 0.0);
+    BOOST_CHECK_EQUAL(table_getStorageVolume(&t, 1.0), 0.0);
+    table_deleteEntries(&t);
+}
+
+BOOST_AUTO_TEST_CASE(table_growth) {
+    TTable t;
+    table_init(&t);
+
+    // --- data arrays double in size as entries are added
+    for (int i = 0; i < 50; i++)
+    {
+        BOOST_REQUIRE(table_addEntry(&t, i, 2.0 * i));
+        BOOST_CHECK_EQUAL(t.nPoints, i + 1);
+        BOOST_CHECK_EQUAL(t.maxPoints, i < 16 ? 16 : i < 32 ? 32 : 64);
+    }
+
+    // --- unused space is released once the table is validated
+    BOOST_CHECK_EQUAL(table_validate(&t), 0);
+    BOOST_CHECK_EQUAL(t.maxPoints, 50);
+    BOOST_CHECK_EQUAL(t.dxMin, 1.0);
+    for (int i = 0; i < 50; i++)
+    {
+        BOOST_CHECK_EQUAL(t.xData[i], i);
+        BOOST_CHECK_EQUAL(t.yData[i], 2.0 * i);
+    }
+    table_deleteEntries(&t);
+    BOOST_CHECK(t.xData == NULL && t.yData == NULL);
+    BOOST_CHECK_EQUAL(t.nPoints, 0);
+
+    // --- x-values must increase
+    BOOST_REQUIRE(table_addEntry(&t, 1.0, 1.0));
+    BOOST_REQUIRE(table_addEntry(&t, 2.0, 1.0));
+    BOOST_REQUIRE(table_addEntry(&t, 2.0, 3.0));
+    BOOST_CHECK_EQUAL(table_validate(&t), ERR_CURVE_SEQUENCE);
+    table_deleteEntries(&t);
+}
+
+BOOST_AUTO_TEST_CASE(tseries_cursor) {
+    Table *ts = makeTimeSeries();
+    vector<double> times = tseriesTimes(ts);
+
+    // --- the table's own cursor follows times in any order
+    for (char extend : {TRUE, FALSE})
+    {
+        table_tseriesInit(&ts->t);
+        BOOST_CHECK_EQUAL(ts->t.cursor, 1);
+        for (double x : times)
+        {
+            checkValue(table_tseriesLookup(&ts->t, x, extend),
+                       tseriesRef(ts, x, extend));
+            BOOST_CHECK(ts->t.cursor >= 1 && ts->t.cursor < ts->n());
+        }
+    }
+
+    // --- so does a caller's cursor, without moving the table's cursor
+    //     or another caller's cursor
+    int cursor1 = 0, cursor2 = ts->n() - 1;
+    int cursor = ts->t.cursor;
+    for (size_t i = 0; i < times.size(); i++)
+    {
+        double x1 = times[i], x2 = times[times.size() - 1 - i];
+        checkValue(table_tseriesValue(&ts->t, &cursor1, x1, TRUE),
+                   tseriesRef(ts, x1, TRUE));
+        int saved = cursor1;
+        checkValue(table_tseriesValue(&ts->t, &cursor2, x2, FALSE),
+                   tseriesRef(ts, x2, FALSE));
+        BOOST_CHECK_EQUAL(cursor1, saved);
+        checkValue(table_tseriesValue(&ts->t, NULL, x1, TRUE),
+                   tseriesRef(ts, x1, TRUE));
+    }
+    BOOST_CHECK_EQUAL(ts->t.cursor, cursor);
+
+    // --- a cursor left at a point beyond the table is ignored
+    cursor = 1000;
+    double x = ts->x[5] + 0.1;
+    checkValue(table_tseriesValue(&ts->t, &cursor, x, TRUE),
+               tseriesRef(ts, x, TRUE));
+    BOOST_CHECK_EQUAL(cursor, 6);
+    delete ts;
+}
+
+BOOST_AUTO_TEST_CASE(short_tseries) {
+    Table one({5.0}, {3.0}, -1);
+    Table two({5.0, 7.0}, {3.0, 1.0}, -1);
+
+    // --- a single point gives its value at all times if extended
+    table_tseriesInit(&one.t);
+    BOOST_CHECK_EQUAL(table_tseriesLookup(&one.t, 5.0, TRUE), 3.0);
+    BOOST_CHECK_EQUAL(table_tseriesLookup(&one.t, 9.0, TRUE), 3.0);
+    BOOST_CHECK_EQUAL(table_tseriesLookup(&one.t, 5.0, FALSE), 0.0);
+
+    table_tseriesInit(&two.t);
+    BOOST_CHECK_EQUAL(table_tseriesLookup(&two.t, 6.0, FALSE), 2.0);
+    BOOST_CHECK_EQUAL(table_tseriesLookup(&two.t, 7.0, FALSE), 1.0);
+    BOOST_CHECK_EQUAL(table_tseriesLookup(&two.t, 4.0, FALSE), 0.0);
+    BOOST_CHECK_EQUAL(table_tseriesLookup(&two.t, 4.0, TRUE), 3.0);
+    BOOST_CHECK_EQUAL(table_tseriesLookup(&two.t, 8.0, TRUE), 1.0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
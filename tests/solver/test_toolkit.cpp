@@ -106,6 +106,12 @@ BOOST_AUTO_TEST_CASE(model_not_open) {
 
     error = swmm_getNodePollut(0, SM_NODEQUAL, &result_array, &length);
     BOOST_CHECK_EQUAL(error, ERR_TKAPI_INPUTNOTOPEN);
+
+
+    //Run time profile
+    SM_Profile profile;
+    error = swmm_getProfile(&profile);
+    BOOST_CHECK_EQUAL(error, ERR_TKAPI_INPUTNOTOPEN);
 }
 
 BOOST_AUTO_TEST_SUITE_END()
@@ -1012,6 +1018,22 @@ BOOST_FIXTURE_TEST_CASE(test_flow_dir_during_sim, FixtureBeforeStep_Flow_Dir){
     BOOST_REQUIRE(error == ERR_NONE);
     swmm_end();
 }
+// Testing Run Time Profile (Before End Simulation)
+BOOST_FIXTURE_TEST_CASE(get_profile_after_sim, FixtureBeforeEnd){
+    int error;
+    SM_Profile profile;
+
+    error = swmm_getProfile(&profile);
+    BOOST_REQUIRE(error == ERR_NONE);
+
+    BOOST_CHECK(profile.input > 0.0);
+    BOOST_CHECK(profile.runoff > 0.0);
+    BOOST_CHECK(profile.routing > 0.0);
+    BOOST_CHECK(profile.runoffSteps > 0.0);
+    BOOST_CHECK(profile.routingSteps > 0.0);
+    BOOST_CHECK(profile.routingTrials >= profile.routingSteps);
+}
+
 // Testing Results Getters (Before End Simulation)
 // BOOST_FIXTURE_TEST_CASE(get_results_after_sim, FixtureBeforeEnd){
 //     int error;